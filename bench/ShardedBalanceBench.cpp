@@ -0,0 +1,123 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Bench: ShardedBalanceBench.cpp
+ *
+ * Credit throughput into one high-fan-in account against the number of
+ * sub-balances: raw ShardedBalance::credit, then LedgerEngine transfers
+ * from one sender per thread into a single BUSINESS account (unsharded
+ * first). Every run checks that no credit was lost.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include "../utils/LedgerEngine.h"
+#include "../utils/ShardedBalance.h"
+
+using namespace std;
+using namespace SOBS;
+using namespace SOBS::Utils;
+
+namespace {
+
+const size_t CREDITS_PER_THREAD = 2000000;
+const size_t TRANSFERS_PER_THREAD = 100000;
+const char* const MERCHANT = "20000000000000";
+
+template<typename F>
+double timeThreads(unsigned threads, F&& body) {
+    auto start = chrono::steady_clock::now();
+    vector<thread> workers;
+    for (unsigned t = 0; t < threads; t++) {
+        workers.emplace_back([&body, t] { body(t); });
+    }
+    for (auto& worker : workers) worker.join();
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+void report(const string& label, size_t count, double seconds, bool ok) {
+    cout << "  " << left << setw(30) << label << right
+         << setw(10) << fixed << setprecision(2) << (count / seconds / 1e6) << " M/s"
+         << setw(10) << setprecision(1) << (seconds * 1e9 / count) << " ns/op"
+         << (ok ? "" : "  LOST CREDITS") << "\n";
+}
+
+string senderNumber(unsigned index) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "10000000%06u", index);
+    return string(buffer);
+}
+
+// Returns false if the merchant balance does not add up
+bool runLedger(unsigned threads, size_t subBalances) {
+    LedgerEngine ledger;
+    for (unsigned t = 0; t < threads; t++) {
+        Model::Account sender(1, Model::AccountType::CHECKING);
+        sender.setAccountNumber(senderNumber(t));
+        sender.setBalance(Model::Money::fromMajorUnits<1000000>());
+        sender.setDailyTransferLimit(Model::Money::fromMajorUnits<1000000000>());
+        ledger.openAccount(sender);
+    }
+    Model::Account merchant(1, Model::AccountType::BUSINESS);
+    merchant.setAccountNumber(MERCHANT);
+    ledger.openAccount(merchant);
+    if (subBalances > 0) {
+        ledger.shardBalance(MERCHANT, subBalances);
+    }
+
+    const Model::Money amount = Model::Money::fromMinorUnits(100);
+    double seconds = timeThreads(threads, [&](unsigned t) {
+        string from = senderNumber(t);
+        for (size_t i = 0; i < TRANSFERS_PER_THREAD; i++) {
+            ledger.transfer(from, MERCHANT, amount, "Salary");
+        }
+    });
+
+    Model::Money balance;
+    Model::Money available;
+    ledger.getBalance(MERCHANT, balance, available);
+    bool ok = balance.getMinorUnits() ==
+              static_cast<int64_t>(threads * TRANSFERS_PER_THREAD) * amount.getMinorUnits() &&
+              ledger.getPostings(MERCHANT).size() == threads * TRANSFERS_PER_THREAD;
+
+    string label = subBalances == 0 ? string("transfer, unsharded") :
+                   "transfer, " + to_string(subBalances) + " sub-balances";
+    report(label, threads * TRANSFERS_PER_THREAD, seconds, ok);
+    return ok;
+}
+
+} // namespace
+
+int main() {
+    unsigned cores = max(1u, thread::hardware_concurrency());
+    unsigned threads = max(cores, 2u);
+    const size_t subBalanceCounts[] = {1, 2, 4, 8, 16, 32, 64};
+
+    cout << "ShardedBalance benchmark (" << cores << " hardware threads, "
+         << threads << " crediting threads)\n";
+
+    bool ok = true;
+    const Model::Money amount = Model::Money::fromMinorUnits(1);
+    for (size_t count : subBalanceCounts) {
+        ShardedBalance balance(count, Model::Money());
+        double seconds = timeThreads(threads, [&](unsigned) {
+            for (size_t i = 0; i < CREDITS_PER_THREAD; i++) balance.credit(amount);
+        });
+        bool counted = balance.total().getMinorUnits() ==
+                       static_cast<int64_t>(threads * CREDITS_PER_THREAD);
+        ok = ok && counted;
+        report("credit, " + to_string(count) + " sub-balances",
+               threads * CREDITS_PER_THREAD, seconds, counted);
+    }
+
+    ok = runLedger(threads, 0) && ok;
+    for (size_t count : {size_t(1), size_t(threads), size_t(4 * threads)}) {
+        ok = runLedger(threads, count) && ok;
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,130 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Bench: StatementBench.cpp
+ *
+ * CSV statement throughput: one account with a month of ROWS journal
+ * entries is streamed through AccountController::writeStatementCsv into
+ * a sink that only counts bytes. Peak RSS growth during the run shows
+ * the generator's memory does not depend on the row count; building the
+ * whole statement in memory from getTransactions() is run afterwards for
+ * comparison. Pass a row count to override the default.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <sys/resource.h>
+#include "../controller/AccountController.h"
+#include "../utils/DatabaseConnection.h"
+#include "../utils/IdGenerator.h"
+
+using namespace std;
+using namespace SOBS;
+using namespace SOBS::Utils;
+
+namespace {
+
+const size_t DEFAULT_ROWS = 1000000;
+const char* const STATEMENT_ACCOUNT = "30000000000001";
+const char* const COUNTERPARTY = "30000000000002";
+
+long peakRssKb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+long openAccount(const char* number, const Model::Money& balance) {
+    LedgerEngine& ledger = DatabaseConnection::getInstance()->getLedger();
+    Model::Account account(1, Model::AccountType::CHECKING);
+    account.setAccountNumber(number);
+    account.setBalance(balance);
+    ledger.openAccount(account);
+    ledger.getAccount(number, account);
+    DatabaseConnection::getInstance()->getJournal().openAccount(account.getAccountId(), balance);
+    return account.getAccountId();
+}
+
+void report(const string& label, size_t rows, uint64_t bytes, double seconds, long rssGrowthKb) {
+    cout << "  " << left << setw(26) << label << right
+         << setw(9) << fixed << setprecision(2) << (rows / seconds / 1e6) << " M rows/s"
+         << setw(9) << setprecision(1) << (bytes / seconds / 1e6) << " MB/s"
+         << setw(10) << (rssGrowthKb / 1024.0) << " MB peak RSS growth\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t rows = argc > 1 ? strtoull(argv[1], nullptr, 10) : DEFAULT_ROWS;
+    if (rows == 0) rows = DEFAULT_ROWS;
+
+    PostingJournal& journal = DatabaseConnection::getInstance()->getJournal();
+    long statementId = openAccount(STATEMENT_ACCOUNT, Model::Money::fromMajorUnits<1000000>());
+    long counterpartyId = openAccount(COUNTERPARTY, Model::Money::fromMajorUnits<1000000>());
+
+    cout << "Statement benchmark (" << rows << " rows, "
+         << View::CsvWriter::CHUNK_SIZE / 1024 << " KiB chunks)\n";
+
+    for (size_t i = 0; i < rows; i++) {
+        Model::Money amount = Model::Money::fromMinorUnits(1 + static_cast<int64_t>(i % 50000));
+        if (i % 3 == 0) amount.negate();
+        Model::Money counterpart = amount;
+        counterpart.negate();
+        JournalLeg legs[] = {
+            {statementId, amount},
+            {counterpartyId, counterpart}
+        };
+        journal.append(legs, 2, Model::TransactionCategory::TRANSFER,
+                       IdGenerator::nextRef("TRF"), i % 7 == 0 ? "Rent, monthly" : "Groceries");
+    }
+
+    Controller::AccountController controller;
+    uint64_t bytes = 0;
+    size_t lines = 0;
+    string errorJson;
+
+    long rssBefore = peakRssKb();
+    auto start = chrono::steady_clock::now();
+    // The accounts belong to user 1, and statements only go to their owner
+    bool ok = controller.writeStatementCsv("USR1", STATEMENT_ACCOUNT, "",
+        [&](const char* data, size_t length) {
+            bytes += length;
+            for (size_t i = 0; i < length; i++) lines += data[i] == '\n';
+            return true;
+        },
+        errorJson);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    long rssGrowth = peakRssKb() - rssBefore;
+
+    // Header, opening and closing rows around the entries
+    ok = ok && lines == rows + 3;
+    report("streamed CSV", rows, bytes, seconds, rssGrowth);
+
+    // Baseline: materialize every Transaction, then the whole file
+    rssBefore = peakRssKb();
+    start = chrono::steady_clock::now();
+    vector<Model::Transaction> transactions = journal.getTransactions(statementId);
+    stringstream csv;
+    csv << "Date,Reference,Transaction,Type,Category,Description,Debit,Credit,Balance\r\n";
+    for (const Model::Transaction& transaction : transactions) {
+        bool debit = transaction.getType() == Model::TransactionType::DEBIT;
+        csv << transaction.getFormattedDate() << ',' << transaction.getReferenceNumber() << ','
+            << transaction.getTransactionRef() << ',' << transaction.getTypeString() << ','
+            << transaction.getCategoryString() << ",\"" << transaction.getDescription() << "\",";
+        if (debit) {
+            csv << transaction.getAmount() << ",,";
+        } else {
+            csv << ',' << transaction.getAmount() << ',';
+        }
+        csv << transaction.getBalanceAfter() << "\r\n";
+    }
+    string whole = csv.str();
+    seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    report("materialized (baseline)", rows, whole.size(), seconds, peakRssKb() - rssBefore);
+
+    if (!ok) cout << "  ROW COUNT MISMATCH\n";
+    return ok ? 0 : 1;
+}
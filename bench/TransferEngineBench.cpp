@@ -0,0 +1,145 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Bench: TransferEngineBench.cpp
+ *
+ * Transfer throughput under contention: each thread moving money
+ * between its own pair of accounts (disjoint), random pairs over 10k
+ * accounts, and every thread on the same two accounts (hot pair), at
+ * 1..N threads. A global-mutex run of the disjoint case shows what
+ * serialized transfers would cost. Money is conserved in every run.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <mutex>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cstdio>
+#include "../utils/TransferEngine.h"
+
+using namespace std;
+using namespace SOBS;
+using namespace SOBS::Utils;
+
+namespace {
+
+const size_t ACCOUNT_COUNT = 10000;
+const size_t TRANSFERS_PER_THREAD = 100000;
+
+string accountNumber(size_t index) {
+    char buffer[16];
+    snprintf(buffer, sizeof(buffer), "10000000%06zu", index);
+    return string(buffer);
+}
+
+void openAccounts(LedgerEngine& ledger, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        Model::Account account(1, Model::AccountType::CHECKING);
+        account.setAccountNumber(accountNumber(i));
+        account.setBalance(Model::Money::fromMajorUnits<1000000>());
+        account.setDailyTransferLimit(Model::Money::fromMajorUnits<1000000000>());
+        ledger.openAccount(account);
+    }
+}
+
+Model::Money totalBalance(LedgerEngine& ledger, size_t count) {
+    vector<Model::Money> balances(count);
+    Model::Money available;
+    for (size_t i = 0; i < count; i++) {
+        ledger.getBalance(accountNumber(i), balances[i], available);
+    }
+    Model::Money total;
+    Model::Money::sum(balances, total);
+    return total;
+}
+
+enum class Scenario { DISJOINT, RANDOM, HOT_PAIR, GLOBAL_MUTEX };
+
+// Returns transfers per second; 'conserved' is false if money leaked
+double run(Scenario scenario, unsigned threads, bool& conserved) {
+    LedgerEngine ledger;
+    WriteAheadLog wal;   // Not opened: measures locking, not fsync
+    PostingJournal journal;
+    DashboardSummaries summaries;
+    TransferEngine engine(ledger, wal, journal, summaries);
+    openAccounts(ledger, ACCOUNT_COUNT);
+    Model::Money before = totalBalance(ledger, ACCOUNT_COUNT);
+
+    mutex globalLock;
+    auto start = chrono::steady_clock::now();
+    vector<thread> workers;
+    for (unsigned t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            mt19937 gen(t + 1);
+            uniform_int_distribution<size_t> pick(0, ACCOUNT_COUNT - 1);
+            string a = accountNumber((2 * t) % ACCOUNT_COUNT);
+            string b = accountNumber((2 * t + 1) % ACCOUNT_COUNT);
+            if (scenario == Scenario::HOT_PAIR) {
+                a = accountNumber(0);
+                b = accountNumber(1);
+            }
+            const Model::Money amount = Model::Money::fromMinorUnits(100);
+
+            for (size_t i = 0; i < TRANSFERS_PER_THREAD; i++) {
+                if (scenario == Scenario::RANDOM) {
+                    size_t from = pick(gen);
+                    size_t to = pick(gen);
+                    if (from == to) to = (to + 1) % ACCOUNT_COUNT;
+                    engine.execute(accountNumber(from), accountNumber(to), amount, "bench");
+                } else if (scenario == Scenario::GLOBAL_MUTEX) {
+                    lock_guard<mutex> lock(globalLock);
+                    engine.execute(i % 2 ? a : b, i % 2 ? b : a, amount, "bench");
+                } else {
+                    engine.execute(i % 2 ? a : b, i % 2 ? b : a, amount, "bench");
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    conserved = totalBalance(ledger, ACCOUNT_COUNT) == before &&
+                engine.getCompletedCount() == threads * TRANSFERS_PER_THREAD;
+    return threads * TRANSFERS_PER_THREAD / seconds;
+}
+
+} // namespace
+
+int main() {
+    unsigned cores = max(1u, thread::hardware_concurrency());
+    vector<unsigned> threadCounts;
+    for (unsigned n = 1; n < max(cores, 2u); n *= 2) threadCounts.push_back(n);
+    threadCounts.push_back(max(cores, 2u));
+
+    const pair<Scenario, const char*> scenarios[] = {
+        {Scenario::DISJOINT, "disjoint pairs"},
+        {Scenario::RANDOM, "random over 10k"},
+        {Scenario::HOT_PAIR, "hot pair"},
+        {Scenario::GLOBAL_MUTEX, "disjoint, global mutex"}
+    };
+
+    cout << "TransferEngine benchmark (" << cores << " hardware threads, "
+         << TRANSFERS_PER_THREAD << " transfers per thread)\n";
+
+    bool allConserved = true;
+    for (const auto& scenario : scenarios) {
+        double single = 0;
+        for (unsigned threads : threadCounts) {
+            bool conserved = false;
+            double rate = run(scenario.first, threads, conserved);
+            if (threads == 1) single = rate;
+            allConserved = allConserved && conserved;
+
+            cout << "  " << left << setw(24) << scenario.second << right
+                 << setw(3) << threads << " threads"
+                 << setw(10) << fixed << setprecision(2) << (rate / 1e6) << " M/s"
+                 << setw(8) << setprecision(2) << (rate / single) << "x"
+                 << (conserved ? "" : "  BALANCE MISMATCH") << "\n";
+        }
+    }
+
+    return allConserved ? 0 : 1;
+}
@@ -6,14 +6,138 @@
  */
 
 #include "AccountController.h"
+#include "../model/User.h"
+#include "../utils/DatabaseConnection.h"
+#include "../utils/IdGenerator.h"
+#include "../utils/SpendingAnalytics.h"
+#include "../utils/Clock.h"
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
 
 using namespace std;
 
 namespace SOBS {
 namespace Controller {
 
+namespace {
+
+// Local-time bounds [from, to) of "YYYY-MM"; empty means the current month
+bool parseStatementMonth(const string& month, time_t& from, time_t& to) {
+    struct tm start = {};
+    if (month.empty()) {
+        time_t now = Utils::Clock::now();
+        localtime_r(&now, &start);
+    } else {
+        if (month.size() != 7 || month[4] != '-') return false;
+        for (size_t i = 0; i < month.size(); i++) {
+            if (i != 4 && (month[i] < '0' || month[i] > '9')) return false;
+        }
+        start.tm_year = atoi(month.substr(0, 4).c_str()) - 1900;
+        start.tm_mon = atoi(month.substr(5, 2).c_str()) - 1;
+        if (start.tm_year < 70 || start.tm_mon < 0 || start.tm_mon > 11) return false;
+    }
+
+    start.tm_mday = 1;
+    start.tm_hour = start.tm_min = start.tm_sec = 0;
+    start.tm_isdst = -1;
+    struct tm end = start;
+    end.tm_mon += 1;  // mktime() carries into the next year
+
+    from = mktime(&start);
+    to = mktime(&end);
+    return from != static_cast<time_t>(-1) && to != static_cast<time_t>(-1);
+}
+
+// Resolve the string filter once; returns the error message or nullptr
+const char* toHistoryQuery(const TransactionFilter& filter, Utils::HistoryQuery& query) {
+    if (!filter.startDate.empty() &&
+        !Utils::Clock::parseLocalDate(filter.startDate, 0, query.from)) {
+        return "Invalid startDate. Use YYYY-MM-DD";
+    }
+    // endDate is inclusive
+    if (!filter.endDate.empty() &&
+        !Utils::Clock::parseLocalDate(filter.endDate, 1, query.to)) {
+        return "Invalid endDate. Use YYYY-MM-DD";
+    }
+
+    if (filter.transactionType == "DEBIT") {
+        query.credits = false;
+    } else if (filter.transactionType == "CREDIT") {
+        query.debits = false;
+    } else if (!filter.transactionType.empty() && filter.transactionType != "ALL") {
+        return "Invalid type. Use DEBIT, CREDIT or ALL";
+    }
+
+    if (!filter.category.empty() && filter.category != "ALL") {
+        const Model::TransactionCategory categories[] = {
+            Model::TransactionCategory::TRANSFER,
+            Model::TransactionCategory::BILL_PAYMENT,
+            Model::TransactionCategory::DEPOSIT,
+            Model::TransactionCategory::WITHDRAWAL,
+            Model::TransactionCategory::FEE,
+            Model::TransactionCategory::REFUND
+        };
+        for (Model::TransactionCategory category : categories) {
+            if (filter.category == Model::Transaction::categoryName(category)) {
+                query.anyCategory = false;
+                query.category = category;
+            }
+        }
+        if (query.anyCategory) {
+            return "Invalid category";
+        }
+    }
+
+    // Zero amounts mean no bound
+    if (filter.minAmount.isNegative() || filter.maxAmount.isNegative()) {
+        return "Amounts must not be negative";
+    }
+    query.minUnits = filter.minAmount.getMinorUnits();
+    if (!filter.maxAmount.isZero()) {
+        query.maxUnits = filter.maxAmount.getMinorUnits();
+        if (query.minUnits > query.maxUnits) {
+            return "minAmount is greater than maxAmount";
+        }
+    }
+
+    query.searchTerm = filter.searchTerm;
+
+    if (!filter.cursor.empty()) {
+        if (filter.cursor.size() > 10) {
+            return "Invalid cursor";
+        }
+        uint64_t position = 0;
+        for (char c : filter.cursor) {
+            if (c < '0' || c > '9') {
+                return "Invalid cursor";
+            }
+            position = position * 10 + static_cast<uint64_t>(c - '0');
+        }
+        query.before = static_cast<size_t>(position);
+    }
+
+    if (filter.pageSize < 0 || filter.pageSize > AccountController::MAX_PAGE_SIZE) {
+        return "Invalid pageSize. Use 1-100";
+    }
+    query.limit = static_cast<size_t>(filter.pageSize == 0 ? AccountController::DEFAULT_PAGE_SIZE :
+                                                             filter.pageSize);
+    return nullptr;
+}
+
+// Ledger copy of an account the user owns. Someone else's account is
+// reported like a missing one, so callers cannot probe account numbers.
+bool findOwnedAccount(const string& userId, const string& accountNumber,
+                      Model::Account& account) {
+    Utils::DatabaseConnection* db = Utils::DatabaseConnection::getInstance();
+    return db->isAccountOwner(Model::User::idFromRef(userId), accountNumber) &&
+           db->getLedger().getAccount(accountNumber, account);
+}
+
+} // namespace
+
 AccountController::AccountController() {}
 
 AccountController::~AccountController() {}
@@ -76,15 +200,22 @@ string AccountController::getBalance(const string& userId,
         );
     }
     
-    // In real implementation, would:
-    // 1. Verify account belongs to user
-    // 2. Query balance from core banking system
+    // In real implementation, would verify account belongs to user
+    
+    Utils::LedgerEngine& ledger = Utils::DatabaseConnection::getInstance()->getLedger();
+    Model::Account account;
+    if (!ledger.getAccount(accountNumber, account)) {
+        return View::JsonResponseBuilder::buildErrorResponse(
+            "Account not found",
+            "ERR_ACCOUNT_NOT_FOUND"
+        );
+    }
     
     View::BalanceResponseData balanceData;
     balanceData.accountNumber = accountNumber;
-    balanceData.balance = 50000.00;
-    balanceData.availableBalance = 48000.00;
-    balanceData.currency = "EGP";
+    balanceData.balance = account.getBalance();
+    balanceData.availableBalance = account.getAvailableBalance();
+    balanceData.currency = account.getCurrency();
     
     return View::JsonResponseBuilder::buildSuccessResponse(
         balanceData.toJson(),
@@ -109,49 +240,65 @@ string AccountController::getTransactions(const string& userId,
         );
     }
     
-    // In real implementation, would query database with filters
-    stringstream dataJson;
-    dataJson << fixed << setprecision(2);
-    dataJson << "{\n"
-             << "    \"accountNumber\": \"" << accountNumber << "\",\n"
-             << "    \"transactions\": [\n"
-             << "      {\n"
-             << "        \"transactionId\": \"TXN1702800000123456\",\n"
-             << "        \"date\": \"2025-12-17T10:30:00\",\n"
-             << "        \"type\": \"CREDIT\",\n"
-             << "        \"category\": \"TRANSFER\",\n"
-             << "        \"amount\": 5000.00,\n"
-             << "        \"description\": \"Salary December 2025\",\n"
-             << "        \"balanceAfter\": 50000.00\n"
-             << "      },\n"
-             << "      {\n"
-             << "        \"transactionId\": \"TXN1702700000654321\",\n"
-             << "        \"date\": \"2025-12-16T14:20:00\",\n"
-             << "        \"type\": \"DEBIT\",\n"
-             << "        \"category\": \"BILL_PAYMENT\",\n"
-             << "        \"amount\": 500.00,\n"
-             << "        \"description\": \"Electricity Bill - Nov 2025\",\n"
-             << "        \"balanceAfter\": 45000.00\n"
-             << "      },\n"
-             << "      {\n"
-             << "        \"transactionId\": \"TXN1702600000789012\",\n"
-             << "        \"date\": \"2025-12-15T09:15:00\",\n"
-             << "        \"type\": \"DEBIT\",\n"
-             << "        \"category\": \"TRANSFER\",\n"
-             << "        \"amount\": 2000.00,\n"
-             << "        \"description\": \"Transfer to Mohamed Ali\",\n"
-             << "        \"balanceAfter\": 45500.00\n"
-             << "      }\n"
-             << "    ],\n"
-             << "    \"totalCount\": 3,\n"
-             << "    \"page\": 1,\n"
-             << "    \"pageSize\": 10\n"
-             << "  }";
+    Utils::HistoryQuery query;
+    const char* filterError = toHistoryQuery(filter, query);
+    if (filterError != nullptr) {
+        return View::JsonResponseBuilder::buildErrorResponse(
+            filterError,
+            "ERR_INVALID_FILTER"
+        );
+    }
     
-    return View::JsonResponseBuilder::buildSuccessResponse(
-        dataJson.str(),
-        "Transactions retrieved successfully"
-    );
+    Model::Account account;
+    if (!findOwnedAccount(userId, accountNumber, account)) {
+        return View::JsonResponseBuilder::buildErrorResponse(
+            "Account not found",
+            "ERR_ACCOUNT_NOT_FOUND"
+        );
+    }
+    
+    Utils::DatabaseConnection* db = Utils::DatabaseConnection::getInstance();
+    Utils::HistoryPage page;
+    db->getJournal().queryHistory(account.getAccountId(), query, page);
+    
+    string& buffer = View::JsonWriter::threadBuffer();
+    View::JsonResponseBuilder::writeSuccessResponse(buffer, [&](View::JsonWriter& writer) {
+        char text[32];
+        writer.beginObject()
+              .member("accountNumber", accountNumber)
+              .key("transactions").beginArray();
+        for (const Utils::HistoryRow& row : page.rows) {
+            const Utils::JournalEntry& entry = row.entry;
+            bool debit = entry.amount.isNegative();
+            writer.beginObject()
+                  .key("transactionId")
+                  .value(text, Utils::IdGenerator::formatRef("TXN", entry.entryId, text))
+                  .key("date")
+                  .value(text, Utils::Clock::formatLocal(entry.postedAt, text, 'T'))
+                  .member("type", debit ? "DEBIT" : "CREDIT")
+                  .member("category", Model::Transaction::categoryName(entry.category))
+                  .decimalMember("amount", debit ? -entry.amount.getMinorUnits() :
+                                                   entry.amount.getMinorUnits(),
+                                 Model::Money::DECIMALS)
+                  .member("description", row.description)
+                  .member("reference", row.reference)
+                  .decimalMember("balanceAfter", entry.balanceAfter.getMinorUnits(),
+                                 Model::Money::DECIMALS)
+                  .endObject();
+        }
+        writer.endArray()
+              .member("count", static_cast<int64_t>(page.rows.size()))
+              .member("pageSize", static_cast<int64_t>(query.limit))
+              .member("hasMore", page.hasMore)
+              .key("nextCursor");
+        if (page.hasMore) {
+            writer.value(to_string(page.nextCursor));
+        } else {
+            writer.null();
+        }
+        writer.endObject();
+    }, "Transactions retrieved successfully");
+    return buffer;
 }
 
 string AccountController::getStatement(const string& userId,
@@ -165,7 +312,8 @@ string AccountController::getStatement(const string& userId,
         );
     }
     
-    if (format != "PDF" && format != "CSV") {
+    // CSV statements are streamed by writeStatementCsv()
+    if (format != "PDF") {
         return View::JsonResponseBuilder::buildErrorResponse(
             "Invalid format. Use PDF or CSV",
             "ERR_INVALID_FORMAT"
@@ -188,6 +336,171 @@ string AccountController::getStatement(const string& userId,
     );
 }
 
+bool AccountController::writeStatementCsv(const string& userId,
+                                          const string& accountNumber,
+                                          const string& month,
+                                          const View::CsvWriter::Sink& sink,
+                                          string& errorJson) {
+    if (userId.empty()) {
+        errorJson = View::JsonResponseBuilder::buildErrorResponse(
+            "User not authenticated",
+            "ERR_UNAUTHORIZED"
+        );
+        return false;
+    }
+    
+    if (!Model::Account::validateAccountNumber(accountNumber)) {
+        errorJson = View::JsonResponseBuilder::buildErrorResponse(
+            "Invalid account number",
+            "ERR_INVALID_ACCOUNT"
+        );
+        return false;
+    }
+    
+    time_t from;
+    time_t to;
+    if (!parseStatementMonth(month, from, to)) {
+        errorJson = View::JsonResponseBuilder::buildErrorResponse(
+            "Invalid month. Use YYYY-MM",
+            "ERR_INVALID_MONTH"
+        );
+        return false;
+    }
+    
+    Model::Account account;
+    if (!findOwnedAccount(userId, accountNumber, account)) {
+        errorJson = View::JsonResponseBuilder::buildErrorResponse(
+            "Account not found",
+            "ERR_ACCOUNT_NOT_FOUND"
+        );
+        return false;
+    }
+    
+    Utils::DatabaseConnection* db = Utils::DatabaseConnection::getInstance();
+    
+    // Opening and closing rows frame the month even when it has no
+    // entries; an account without a journal has never moved
+    Model::Money opening = account.getBalance();
+    db->getJournal().getBalanceAt(account.getAccountId(), from, opening);
+    Model::Money closing = opening;
+    
+    View::CsvWriter csv(sink);
+    csv.field("Date").field("Reference").field("Transaction").field("Type")
+       .field("Category").field("Description").field("Debit").field("Credit")
+       .field("Balance").endRow();
+    csv.timeField(from).emptyField().emptyField().emptyField().emptyField()
+       .field("Opening balance").emptyField().emptyField().field(opening).endRow();
+    
+    // Rows go out as the journal is scanned; only one chunk is ever held
+    char ref[32];
+    db->getJournal().scan(account.getAccountId(), from, to,
+        [&](const Utils::JournalEntry& entry, const string& reference,
+            const string& description) {
+            bool debit = entry.amount.isNegative();
+            csv.timeField(entry.postedAt)
+               .field(reference)
+               .field(ref, Utils::IdGenerator::formatRef("TXN", entry.entryId, ref))
+               .field(debit ? "DEBIT" : "CREDIT")
+               .field(Model::Transaction::categoryName(entry.category))
+               .textField(description);
+            if (debit) {
+                Model::Money paid = entry.amount;
+                paid.negate();      // The journal never holds an unnegatable leg
+                csv.field(paid).emptyField();
+            } else {
+                csv.emptyField().field(entry.amount);
+            }
+            csv.field(entry.balanceAfter).endRow();
+            
+            closing = entry.balanceAfter;
+            return csv.ok();
+        });
+    
+    // The last second of the month, or now for the month in progress
+    time_t closedAt = max(from, min(to - 1, Utils::Clock::now()));
+    csv.timeField(closedAt).emptyField().emptyField().emptyField()
+       .emptyField().field("Closing balance").emptyField().emptyField()
+       .field(closing).endRow();
+    return csv.flush();
+}
+
+string AccountController::getSpendingAnalytics(const string& userId,
+                                                const string& accountNumber,
+                                                const string& period) {
+    if (userId.empty()) {
+        return View::JsonResponseBuilder::buildErrorResponse(
+            "User not authenticated",
+            "ERR_UNAUTHORIZED"
+        );
+    }
+    
+    if (!Model::Account::validateAccountNumber(accountNumber)) {
+        return View::JsonResponseBuilder::buildErrorResponse(
+            "Invalid account number",
+            "ERR_INVALID_ACCOUNT"
+        );
+    }
+    
+    Utils::AnalyticsPeriod analyticsPeriod = Utils::AnalyticsPeriod::MONTH;
+    if (!period.empty() && !Utils::SpendingAnalytics::parsePeriod(period, analyticsPeriod)) {
+        return View::JsonResponseBuilder::buildErrorResponse(
+            "Invalid period. Use week, month or year",
+            "ERR_INVALID_PERIOD"
+        );
+    }
+    
+    Model::Account account;
+    if (!findOwnedAccount(userId, accountNumber, account)) {
+        return View::JsonResponseBuilder::buildErrorResponse(
+            "Account not found",
+            "ERR_ACCOUNT_NOT_FOUND"
+        );
+    }
+    
+    Utils::DatabaseConnection* db = Utils::DatabaseConnection::getInstance();
+    Utils::SpendingReport report;
+    Utils::SpendingAnalytics(db->getJournal()).report(account.getAccountId(), analyticsPeriod,
+                                                       Utils::Clock::now(), report);
+    
+    string& buffer = View::JsonWriter::threadBuffer();
+    View::JsonResponseBuilder::writeSuccessResponse(buffer, [&](View::JsonWriter& writer) {
+        char date[Utils::Clock::TIMESTAMP_LENGTH + 1];
+        writer.beginObject()
+              .member("accountNumber", accountNumber)
+              .member("period", period.empty() ? string("month") : period)
+              .key("from").value(date, Utils::Clock::formatLocal(report.from, date, 'T'))
+              .key("byCategory").beginArray();
+        for (size_t c = 0; c < Utils::SpendingReport::CATEGORY_COUNT; c++) {
+            if (report.spentByCategory[c].isZero()) continue;
+            writer.beginObject()
+                  .member("category", Model::Transaction::categoryName(
+                                          static_cast<Model::TransactionCategory>(c)))
+                  .decimalMember("amount", report.spentByCategory[c].getMinorUnits(),
+                                 Model::Money::DECIMALS)
+                  .endObject();
+        }
+        writer.endArray().key("buckets").beginArray();
+        for (const Utils::SpendingBucket& bucket : report.buckets) {
+            writer.beginObject()
+                  .member("label", bucket.label)
+                  .decimalMember("spent", bucket.spent.getMinorUnits(), Model::Money::DECIMALS)
+                  .decimalMember("income", bucket.income.getMinorUnits(), Model::Money::DECIMALS)
+                  .endObject();
+        }
+        writer.endArray()
+              .key("insights").beginObject()
+              .decimalMember("totalSpent", report.totalSpent.getMinorUnits(),
+                             Model::Money::DECIMALS)
+              .decimalMember("totalIncome", report.totalIncome.getMinorUnits(),
+                             Model::Money::DECIMALS)
+              .decimalMember("avgDaily", report.avgDaily.getMinorUnits(), Model::Money::DECIMALS)
+              .member("trend", report.trendPercent)
+              .endObject()
+              .endObject();
+    }, "Analytics retrieved successfully");
+    return buffer;
+}
+
 string AccountController::getAccountSummary(const string& userId) {
     if (userId.empty()) {
         return View::JsonResponseBuilder::buildErrorResponse(
@@ -196,37 +509,48 @@ string AccountController::getAccountSummary(const string& userId) {
         );
     }
     
-    stringstream dataJson;
-    dataJson << fixed << setprecision(2);
-    dataJson << "{\n"
-             << "    \"totalBalance\": 65000.00,\n"
-             << "    \"currency\": \"EGP\",\n"
-             << "    \"accountsCount\": 2,\n"
-             << "    \"recentTransactions\": [\n"
-             << "      {\n"
-             << "        \"description\": \"Salary December 2025\",\n"
-             << "        \"amount\": 5000.00,\n"
-             << "        \"type\": \"CREDIT\"\n"
-             << "      },\n"
-             << "      {\n"
-             << "        \"description\": \"Electricity Bill\",\n"
-             << "        \"amount\": 500.00,\n"
-             << "        \"type\": \"DEBIT\"\n"
-             << "      }\n"
-             << "    ],\n"
-             << "    \"upcomingPayments\": [\n"
-             << "      {\n"
-             << "        \"description\": \"Internet Bill\",\n"
-             << "        \"amount\": 300.00,\n"
-             << "        \"dueDate\": \"2025-12-25\"\n"
-             << "      }\n"
-             << "    ]\n"
-             << "  }";
+    // One copy of the materialized summary; a user with nothing recorded
+    // gets an empty dashboard
+    Utils::DashboardSummaries& summaries =
+        Utils::DatabaseConnection::getInstance()->getSummaries();
+    Utils::DashboardSummary summary;
+    summaries.getSummary(Model::User::idFromRef(userId), Utils::Clock::now(), summary);
     
-    return View::JsonResponseBuilder::buildSuccessResponse(
-        dataJson.str(),
-        "Account summary retrieved successfully"
-    );
+    string& buffer = View::JsonWriter::threadBuffer();
+    View::JsonResponseBuilder::writeSuccessResponse(buffer, [&](View::JsonWriter& writer) {
+        char date[Utils::Clock::TIMESTAMP_LENGTH + 1];
+        writer.beginObject()
+              .decimalMember("totalBalance", summary.totalBalanceUnits, Model::Money::DECIMALS)
+              .member("currency", "EGP")
+              .member("accountsCount", static_cast<int64_t>(summary.accountCount))
+              .key("recentTransactions").beginArray();
+        for (size_t i = 0; i < summary.recentCount; i++) {
+            const Utils::RecentPosting& posting = summary.recent[i];
+            bool debit = posting.amountUnits < 0;
+            writer.beginObject()
+                  .member("reference", posting.reference)
+                  .key("date").value(date, Utils::Clock::formatLocal(posting.postedAt, date, 'T'))
+                  .member("description", posting.description)
+                  .member("category", Model::Transaction::categoryName(posting.category))
+                  .decimalMember("amount", debit ? -posting.amountUnits : posting.amountUnits,
+                                 Model::Money::DECIMALS)
+                  .member("type", debit ? "DEBIT" : "CREDIT")
+                  .endObject();
+        }
+        writer.endArray().key("upcomingPayments").beginArray();
+        for (size_t i = 0; i < summary.upcomingCount; i++) {
+            const Utils::DuePayment& payment = summary.upcoming[i];
+            Utils::Clock::formatLocal(payment.dueDate, date, 'T');
+            writer.beginObject()
+                  .member("scheduleId", payment.scheduleId)
+                  .member("description", payment.description)
+                  .decimalMember("amount", payment.amountUnits, Model::Money::DECIMALS)
+                  .key("dueDate").value(date, 10)   // "YYYY-MM-DD"
+                  .endObject();
+        }
+        writer.endArray().endObject();
+    }, "Account summary retrieved successfully");
+    return buffer;
 }
 
 } // namespace Controller
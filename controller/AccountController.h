@@ -14,6 +14,7 @@
 #include "../model/Account.h"
 #include "../model/Transaction.h"
 #include "../view/ApiResponse.h"
+#include "../view/CsvWriter.h"
 
 using namespace std;
 
@@ -25,10 +26,12 @@ struct TransactionFilter {
     string startDate;
     string endDate;
     string transactionType;  // DEBIT, CREDIT, ALL
-    double minAmount;
-    double maxAmount;
+    Model::Money minAmount;
+    Model::Money maxAmount;
     string category;
     string searchTerm;
+    string cursor;           // nextCursor of the previous page, empty for the first
+    int pageSize = 0;        // 0 for DEFAULT_PAGE_SIZE
 };
 
 class AccountController {
@@ -37,6 +40,9 @@ private:
     string getCurrentUserId();  // Extract from session/JWT
 
 public:
+    static const int DEFAULT_PAGE_SIZE = 10;
+    static const int MAX_PAGE_SIZE = 100;
+
     AccountController();
     ~AccountController();
 
@@ -54,7 +60,9 @@ public:
 
     /**
      * GET /api/v1/accounts/{accountNumber}/transactions
-     * Get transaction history with optional filters
+     * Get transaction history with optional filters, newest first.
+     * Pages are keyset-paginated: pass the returned nextCursor to get
+     * the next page.
      */
     string getTransactions(const string& userId, 
                                 const string& accountNumber,
@@ -67,7 +75,31 @@ public:
     string getStatement(const string& userId,
                              const string& accountNumber,
                              const string& month,
-                             const string& format);  // PDF or CSV
+                             const string& format);  // PDF; CSV: writeStatementCsv()
+
+    /**
+     * GET /api/v1/accounts/{accountNumber}/statement?format=CSV
+     * Stream one month ("YYYY-MM", empty for the current month) of
+     * journal entries as CSV into 'sink', CsvWriter::CHUNK_SIZE bytes at
+     * a time, between opening and closing balance rows stamped at the
+     * month's bounds (written for a month without entries too). On an invalid request nothing is written, 'errorJson' holds
+     * the error response and false is returned; false with an empty
+     * 'errorJson' means the sink refused a chunk.
+     */
+    bool writeStatementCsv(const string& userId,
+                           const string& accountNumber,
+                           const string& month,
+                           const View::CsvWriter::Sink& sink,
+                           string& errorJson);
+
+    /**
+     * GET /api/v1/accounts/{accountNumber}/analytics?period=week|month|year
+     * Spending by category, per day / week / month, average daily
+     * spending and trend for the current period (default month)
+     */
+    string getSpendingAnalytics(const string& userId,
+                                const string& accountNumber,
+                                const string& period);
 
     /**
      * GET /api/v1/accounts/summary
@@ -6,83 +6,241 @@
  */
 
 #include "AuthenticationController.h"
+#include "../utils/DatabaseConnection.h"
+#include "../utils/Clock.h"
+#include "../utils/SmsGateway.h"
+#include <future>
+#include <memory>
 #include <random>
 #include <sstream>
 #include <iomanip>
+#include <unordered_set>
+#include <string_view>
 
 using namespace std;
 
 namespace SOBS {
 namespace Controller {
 
-AuthenticationController::AuthenticationController() {}
+namespace {
 
-AuthenticationController::~AuthenticationController() {}
+// The seed user (USR001), the only user with stored credentials
+const long SEED_USER_ID = 1;
+const char* const SEED_USER_EMAIL = "ahmed@example.com";
+const char* const SEED_USER_PHONE = "+201001234567";
 
-string AuthenticationController::generateOTP() {
-    random_device rd;
-    mt19937 gen(rd());
-    uniform_int_distribution<> dis(100000, 999999);
-    
-    stringstream ss;
-    ss << dis(gen);
-    return ss.str();
+// Checked in place of a stored hash when the email is unknown, at the
+// seed hash's cost, so both answers take as long. No password matches it.
+const char* const UNKNOWN_USER_HASH =
+    "$scrypt$ln=14,r=8,p=1$2a505740c88a0a861c3ebcd571d86cba$"
+    "51ce0676bcc4f84f8442027deaea9ba8599fadbf82acffd1472064cbcccc93cb";
+
+// OTP key prefixes: a code only confirms what it was issued for
+const char* const LOGIN_OTP_PREFIX = "login:";
+const char* const REGISTRATION_OTP_PREFIX = "register:";
+const char* const RESET_OTP_PREFIX = "reset:";
+
+// Reset tokens are "<resetId>-<code>": the ID forgotPassword() returns
+// and the code it texts to the user's phone
+const char RESET_TOKEN_SEPARATOR = '-';
+
+string invalidCredentials() {
+    return View::JsonResponseBuilder::buildErrorResponse(
+        "Invalid email or password",
+        "ERR_INVALID_CREDENTIALS"
+    );
+}
+
+string tooManyAttempts() {
+    return View::JsonResponseBuilder::buildErrorResponse(
+        "Too many failed sign-in attempts. Please try again later",
+        "ERR_TOO_MANY_ATTEMPTS"
+    );
+}
+
+string serviceBusy() {
+    return View::JsonResponseBuilder::buildErrorResponse(
+        "Too many sign-in requests in progress. Please try again shortly",
+        "ERR_SERVICE_BUSY"
+    );
 }
 
-string AuthenticationController::generateSessionToken() {
+// Error response for an OTP that did not verify
+string otpFailure(Utils::OtpOutcome outcome) {
+    if (outcome == Utils::OtpOutcome::MISMATCH) {
+        return View::JsonResponseBuilder::buildErrorResponse(
+            "Incorrect OTP",
+            "ERR_INVALID_OTP"
+        );
+    }
+    if (outcome == Utils::OtpOutcome::LOCKED) {
+        return View::JsonResponseBuilder::buildErrorResponse(
+            "Too many incorrect attempts. Please request a new OTP",
+            "ERR_OTP_LOCKED"
+        );
+    }
+    return View::JsonResponseBuilder::buildErrorResponse(
+        "OTP expired or already used. Please request a new OTP",
+        "ERR_OTP_EXPIRED"
+    );
+}
+
+// Random ID with a prefix, short enough to key the OTP store behind its
+// own prefix (OtpStore::KEY_LENGTH)
+string randomId(const char* prefix) {
     random_device rd;
-    mt19937 gen(rd());
     uniform_int_distribution<> dis(0, 15);
     
     const char* hex = "0123456789ABCDEF";
-    stringstream ss;
-    ss << "eyJhbGciOiJIUzI1NiIsInR5cCI6IkpXVCJ9.";
-    for (int i = 0; i < 32; i++) {
-        ss << hex[dis(gen)];
+    string id = prefix;
+    for (int i = 0; i < 20; i++) {
+        id += hex[dis(rd)];
+    }
+    return id;
+}
+
+// Check a reset token's code; uses the code up like any other OTP.
+// Sets the user it was issued to when VERIFIED.
+Utils::OtpOutcome verifyResetToken(const string& token, long& userId) {
+    size_t separator = token.rfind(RESET_TOKEN_SEPARATOR);
+    if (separator == string::npos || separator == 0) {
+        return Utils::OtpOutcome::EXPIRED;
     }
-    return ss.str();
+    return Utils::DatabaseConnection::getInstance()->getOtps().verify(
+        RESET_OTP_PREFIX + token.substr(0, separator), token.substr(separator + 1),
+        Utils::Clock::now(), userId);
+}
+
+} // namespace
+
+AuthenticationController::AuthenticationController() {}
+
+AuthenticationController::~AuthenticationController() {}
+
+string AuthenticationController::generateLoginId() {
+    return randomId("LGN");
 }
 
 bool AuthenticationController::sendOTPviaSMS(const string& phoneNumber, 
                                               const string& otp) {
-    // In real implementation, would call SMS gateway API
-    // For now, simulate success
-    return true;
+    return Utils::SmsGateway::sendCode(phoneNumber, "verification", otp);
 }
 
-string AuthenticationController::registerUser(const RegistrationRequest& request) {
+bool AuthenticationController::validateRegistration(const RegistrationRequest& request,
+                                                    const char*& errorCode,
+                                                    const char*& message) {
     // Validate National ID
     if (!Model::User::validateNationalId(request.nationalId)) {
-        return View::JsonResponseBuilder::buildErrorResponse(
-            "Invalid National ID format. Please enter 14-digit Egyptian National ID",
-            "ERR_INVALID_NID"
-        );
+        errorCode = "ERR_INVALID_NID";
+        message = "Invalid National ID format. Please enter 14-digit Egyptian National ID";
+        return false;
     }
     
     // Validate Email
     if (!Model::User::validateEmail(request.email)) {
-        return View::JsonResponseBuilder::buildErrorResponse(
-            "Invalid email format",
-            "ERR_INVALID_EMAIL"
-        );
+        errorCode = "ERR_INVALID_EMAIL";
+        message = "Invalid email format";
+        return false;
     }
     
     // Validate Phone Number
     if (!Model::User::validatePhoneNumber(request.phoneNumber)) {
-        return View::JsonResponseBuilder::buildErrorResponse(
-            "Invalid phone number. Use format +20XXXXXXXXXX",
-            "ERR_INVALID_PHONE"
-        );
+        errorCode = "ERR_INVALID_PHONE";
+        message = "Invalid phone number. Use format +20XXXXXXXXXX";
+        return false;
     }
     
     // Validate Password Strength
     if (!Model::User::validatePasswordStrength(request.password)) {
+        errorCode = "ERR_WEAK_PASSWORD";
+        message = "Password must be at least 8 characters with uppercase, lowercase, number, and special character";
+        return false;
+    }
+    
+    errorCode = "";
+    message = "";
+    return true;
+}
+
+vector<RegistrationCheck> AuthenticationController::validateRegistrations(
+    const vector<RegistrationRequest>& requests) {
+    vector<RegistrationCheck> checks;
+    checks.reserve(requests.size());
+    
+    // Keys seen so far in this batch (pointers into 'requests')
+    unordered_set<string_view> nationalIds, emails, phones;
+    nationalIds.reserve(requests.size());
+    emails.reserve(requests.size());
+    phones.reserve(requests.size());
+    
+    for (size_t i = 0; i < requests.size(); i++) {
+        const RegistrationRequest& request = requests[i];
+        RegistrationCheck check;
+        check.index = i;
+        check.valid = validateRegistration(request, check.errorCode, check.message);
+        
+        if (check.valid) {
+            if (!nationalIds.insert(request.nationalId).second) {
+                check.valid = false;
+                check.errorCode = "ERR_DUPLICATE_NID";
+                check.message = "National ID appears earlier in this batch";
+            } else if (!emails.insert(request.email).second) {
+                check.valid = false;
+                check.errorCode = "ERR_DUPLICATE_EMAIL";
+                check.message = "Email appears earlier in this batch";
+            } else if (!phones.insert(request.phoneNumber).second) {
+                check.valid = false;
+                check.errorCode = "ERR_DUPLICATE_PHONE";
+                check.message = "Phone number appears earlier in this batch";
+            }
+        }
+        checks.push_back(check);
+    }
+    return checks;
+}
+
+string AuthenticationController::validateRegistrationBatch(
+    const vector<RegistrationRequest>& requests) {
+    if (requests.empty()) {
         return View::JsonResponseBuilder::buildErrorResponse(
-            "Password must be at least 8 characters with uppercase, lowercase, number, and special character",
-            "ERR_WEAK_PASSWORD"
+            "No registrations to validate",
+            "ERR_EMPTY_BATCH"
         );
     }
     
+    vector<RegistrationCheck> checks = validateRegistrations(requests);
+    size_t validCount = 0;
+    for (const RegistrationCheck& check : checks) {
+        if (check.valid) validCount++;
+    }
+    
+    string& buffer = View::JsonWriter::threadBuffer();
+    View::JsonResponseBuilder::writeSuccessResponse(buffer, [&](View::JsonWriter& writer) {
+        writer.beginObject()
+              .member("total", static_cast<int64_t>(checks.size()))
+              .member("valid", static_cast<int64_t>(validCount))
+              .member("invalid", static_cast<int64_t>(checks.size() - validCount))
+              .key("errors").beginArray();
+        for (const RegistrationCheck& check : checks) {
+            if (check.valid) continue;
+            writer.beginObject()
+                  .member("index", static_cast<int64_t>(check.index))
+                  .member("errorCode", check.errorCode)
+                  .member("message", check.message)
+                  .endObject();
+        }
+        writer.endArray().endObject();
+    }, "Batch validated");
+    return buffer;
+}
+
+string AuthenticationController::registerUser(const RegistrationRequest& request) {
+    const char* errorCode;
+    const char* message;
+    if (!validateRegistration(request, errorCode, message)) {
+        return View::JsonResponseBuilder::buildErrorResponse(message, errorCode);
+    }
+    
     // Create user
     Model::User user(request.nationalId, request.fullName, 
                      request.email, request.phoneNumber);
@@ -94,8 +252,16 @@ string AuthenticationController::registerUser(const RegistrationRequest& request
     // 4. Save to database
     // 5. Send verification OTP
     
-    // Generate and send OTP
-    string otp = generateOTP();
+    // Generate and send OTP, verified against the customer ID. The user is
+    // not stored yet, so the code has no user ID to hand back.
+    string otp;
+    if (!Utils::DatabaseConnection::getInstance()->getOtps().issue(
+            REGISTRATION_OTP_PREFIX + user.getCustomerId(), 0, Utils::Clock::now(), otp)) {
+        return View::JsonResponseBuilder::buildErrorResponse(
+            "Could not send OTP. Please try again",
+            "ERR_OTP_UNAVAILABLE"
+        );
+    }
     sendOTPviaSMS(request.phoneNumber, otp);
     
     // Build success response
@@ -112,27 +278,79 @@ string AuthenticationController::registerUser(const RegistrationRequest& request
     );
 }
 
-string AuthenticationController::login(const LoginRequest& request) {
+void AuthenticationController::login(const LoginRequest& request, ResponseCallback done) {
     // Validate input
     if (request.email.empty() || request.password.empty()) {
-        return View::JsonResponseBuilder::buildErrorResponse(
+        done(View::JsonResponseBuilder::buildErrorResponse(
             "Email and password are required",
             "ERR_MISSING_CREDENTIALS"
-        );
+        ));
+        return;
     }
     
-    // In real implementation, would:
-    // 1. Find user by email
-    // 2. Verify password hash
-    // 3. Check if account is locked
-    // 4. Generate OTP
-    // 5. Send OTP via SMS
+    // Refuse accounts and addresses over their failure limit before any
+    // hashing is queued
+    Utils::DatabaseConnection* db = Utils::DatabaseConnection::getInstance();
+    Utils::LoginThrottle& throttle = db->getLoginThrottle();
+    time_t now = Utils::Clock::now();
+    if (!throttle.admit(request.email, request.clientAddress, now)) {
+        done(tooManyAttempts());
+        return;
+    }
     
-    // Simulate user lookup
-    // For demo, assume credentials are valid
+    // In real implementation, would find the user by email.
+    // Only the seed user has a stored password hash.
+    // Unknown emails still pay for a hash check, so response times do not
+    // tell which emails are registered.
+    string storedHash;
+    bool known = request.email == SEED_USER_EMAIL &&
+                 db->getPasswordHash(SEED_USER_ID, storedHash);
+    if (!known) {
+        storedHash = UNKNOWN_USER_HASH;
+    }
     
-    string otp = generateOTP();
-    string sessionId = generateSessionToken();
+    // The hash check runs on the password-hashing pool and answers from
+    // there, in the JSON style of the thread that asked
+    string email = request.email;
+    string clientAddress = request.clientAddress;
+    View::JsonWriter::Style style = View::JsonWriter::threadStyle();
+    bool queued = db->getPasswordHasher().submitVerify(
+        request.password, storedHash,
+        [this, done, known, email, clientAddress, style](bool matched) {
+            View::JsonWriter::threadStyle() = style;
+            Utils::LoginThrottle& throttle =
+                Utils::DatabaseConnection::getInstance()->getLoginThrottle();
+            if (!known || !matched) {
+                throttle.recordFailure(email, clientAddress, Utils::Clock::now());
+                done(invalidCredentials());
+                return;
+            }
+            throttle.recordSuccess(email);
+            done(sendLoginOTP(SEED_USER_ID, SEED_USER_PHONE));
+        });
+    if (!queued) {
+        done(serviceBusy());
+    }
+}
+
+string AuthenticationController::login(const LoginRequest& request) {
+    auto response = make_shared<promise<string>>();
+    future<string> ready = response->get_future();
+    login(request, [response](const string& json) { response->set_value(json); });
+    return ready.get();
+}
+
+string AuthenticationController::sendLoginOTP(long userId, const string& phoneNumber) {
+    string sessionId = generateLoginId();
+    string otp;
+    if (!Utils::DatabaseConnection::getInstance()->getOtps().issue(
+            LOGIN_OTP_PREFIX + sessionId, userId, Utils::Clock::now(), otp)) {
+        return View::JsonResponseBuilder::buildErrorResponse(
+            "Could not send OTP. Please try again",
+            "ERR_OTP_UNAVAILABLE"
+        );
+    }
+    sendOTPviaSMS(phoneNumber, otp);
     
     // Build response
     stringstream dataJson;
@@ -164,17 +382,30 @@ string AuthenticationController::verifyOTP(const OTPRequest& request) {
         );
     }
     
-    // In real implementation, would:
-    // 1. Verify OTP against stored value
-    // 2. Check OTP expiration (5 minutes)
-    // 3. Create session
-    // 4. Return user data with session token
+    // Only pending logins can be confirmed here, never a registration or
+    // transfer code. Expires after 5 minutes; used up by a match or
+    // MAX_ATTEMPTS misses.
+    Utils::DatabaseConnection* db = Utils::DatabaseConnection::getInstance();
+    time_t now = Utils::Clock::now();
+    long userId = 0;
+    Utils::OtpOutcome outcome = db->getOtps().verify(
+        LOGIN_OTP_PREFIX + request.sessionId, request.otp, now, userId);
+    if (outcome != Utils::OtpOutcome::VERIFIED) {
+        return otpFailure(outcome);
+    }
     
-    // Simulate successful verification
-    string sessionToken = generateSessionToken();
+    // The session belongs to whoever the login code was issued to
+    string sessionToken;
+    if (!db->getSessions().create(userId, SESSION_TTL_SECONDS, now, sessionToken)) {
+        return View::JsonResponseBuilder::buildErrorResponse(
+            "Could not start a session. Please try again",
+            "ERR_SESSION_UNAVAILABLE"
+        );
+    }
     
     View::LoginResponseData loginData;
     loginData.sessionToken = sessionToken;
+    loginData.expiresIn = SESSION_TTL_SECONDS;
     loginData.customerId = "CUS123456789";
     loginData.fullName = "Ahmed Mohamed";
     loginData.email = "ahmed@example.com";
@@ -193,10 +424,14 @@ string AuthenticationController::logout(const string& sessionToken) {
         );
     }
     
-    // In real implementation, would:
-    // 1. Invalidate session token
-    // 2. Clear session data
-    // 3. Log logout event
+    if (!Utils::DatabaseConnection::getInstance()->getSessions().remove(sessionToken)) {
+        return View::JsonResponseBuilder::buildErrorResponse(
+            "Invalid session",
+            "ERR_INVALID_SESSION"
+        );
+    }
+    
+    // In real implementation, would also log the logout event
     
     return View::JsonResponseBuilder::buildSuccessResponse(
         "null",
@@ -212,14 +447,27 @@ string AuthenticationController::forgotPassword(const string& email) {
         );
     }
     
-    // In real implementation, would:
-    // 1. Find user by email
-    // 2. Generate reset token
-    // 3. Send reset link via email
+    // In real implementation, would find the user by email; only the
+    // seed user has stored credentials. Unknown emails get a reset ID
+    // too, with no code behind it, so the response does not tell which
+    // emails are registered.
+    string resetId = randomId("RST");
+    if (email == SEED_USER_EMAIL) {
+        string code;
+        if (!Utils::DatabaseConnection::getInstance()->getOtps().issue(
+                RESET_OTP_PREFIX + resetId, SEED_USER_ID, Utils::Clock::now(), code)) {
+            return View::JsonResponseBuilder::buildErrorResponse(
+                "Could not send reset code. Please try again",
+                "ERR_OTP_UNAVAILABLE"
+            );
+        }
+        Utils::SmsGateway::sendCode(SEED_USER_PHONE, "password reset", code);
+    }
     
     stringstream dataJson;
     dataJson << "{\n"
-             << "    \"message\": \"Password reset link sent to " << email << "\"\n"
+             << "    \"resetId\": \"" << resetId << "\",\n"
+             << "    \"message\": \"If the email is registered, a reset code was sent to its mobile number\"\n"
              << "  }";
     
     return View::JsonResponseBuilder::buildSuccessResponse(
@@ -228,33 +476,70 @@ string AuthenticationController::forgotPassword(const string& email) {
     );
 }
 
-string AuthenticationController::resetPassword(const string& token, 
-                                                     const string& newPassword) {
+void AuthenticationController::resetPassword(const string& token, const string& newPassword,
+                                             ResponseCallback done) {
     if (token.empty()) {
-        return View::JsonResponseBuilder::buildErrorResponse(
+        done(View::JsonResponseBuilder::buildErrorResponse(
             "Invalid reset token",
             "ERR_INVALID_TOKEN"
-        );
+        ));
+        return;
     }
     
+    // Checked before the token, so a weak password does not use up the code
     if (!Model::User::validatePasswordStrength(newPassword)) {
-        return View::JsonResponseBuilder::buildErrorResponse(
+        done(View::JsonResponseBuilder::buildErrorResponse(
             "Password does not meet requirements",
             "ERR_WEAK_PASSWORD"
-        );
+        ));
+        return;
     }
     
-    // In real implementation, would:
-    // 1. Verify reset token
-    // 2. Check token expiration
-    // 3. Hash new password
-    // 4. Update user password
-    // 5. Invalidate all existing sessions
+    long userId = 0;
+    Utils::OtpOutcome outcome = verifyResetToken(token, userId);
+    if (outcome != Utils::OtpOutcome::VERIFIED) {
+        done(outcome == Utils::OtpOutcome::EXPIRED ?
+             View::JsonResponseBuilder::buildErrorResponse(
+                 "Invalid or expired reset token",
+                 "ERR_INVALID_TOKEN") :
+             otpFailure(outcome));
+        return;
+    }
     
-    return View::JsonResponseBuilder::buildSuccessResponse(
-        "null",
-        "Password reset successful. Please login with new password"
-    );
+    // The new hash is computed on the password-hashing pool; once it is
+    // stored for the token's user, every session signed in with the old
+    // password ends.
+    View::JsonWriter::Style style = View::JsonWriter::threadStyle();
+    bool queued = Utils::DatabaseConnection::getInstance()->getPasswordHasher().submitHash(
+        newPassword, [done, style, userId](bool ok, const string& encodedHash) {
+            View::JsonWriter::threadStyle() = style;
+            if (!ok) {
+                done(View::JsonResponseBuilder::buildErrorResponse(
+                    "Could not update password. Please try again",
+                    "ERR_PASSWORD_UPDATE_FAILED"
+                ));
+                return;
+            }
+            Utils::DatabaseConnection* db = Utils::DatabaseConnection::getInstance();
+            db->setPasswordHash(userId, encodedHash);
+            db->getSessions().removeUser(userId);
+            done(View::JsonResponseBuilder::buildSuccessResponse(
+                "null",
+                "Password reset successful. Please login with new password"
+            ));
+        });
+    if (!queued) {
+        done(serviceBusy());
+    }
+}
+
+string AuthenticationController::resetPassword(const string& token, const string& newPassword) {
+    auto response = make_shared<promise<string>>();
+    future<string> ready = response->get_future();
+    resetPassword(token, newPassword, [response](const string& json) {
+        response->set_value(json);
+    });
+    return ready.get();
 }
 
 } // namespace Controller
@@ -11,6 +11,8 @@
 
 #include <string>
 #include <memory>
+#include <vector>
+#include <functional>
 #include "../model/User.h"
 #include "../view/ApiResponse.h"
 
@@ -29,9 +31,18 @@ struct RegistrationRequest {
     string bankAccountNumber;
 };
 
+// Outcome of validating one request in a bulk import
+struct RegistrationCheck {
+    size_t index;           // Position in the submitted batch
+    bool valid;
+    const char* errorCode;  // Empty when valid
+    const char* message;
+};
+
 struct LoginRequest {
     string email;
     string password;
+    string clientAddress;   // Empty when unknown (CLI, batch)
 };
 
 struct OTPRequest {
@@ -42,11 +53,15 @@ struct OTPRequest {
 class AuthenticationController {
 private:
     // In real implementation, would inject AuthenticationService
-    string generateOTP();
-    string generateSessionToken();
+    string generateLoginId();
+    string sendLoginOTP(long userId, const string& phoneNumber);
     bool sendOTPviaSMS(const string& phoneNumber, const string& otp);
 
 public:
+    typedef function<void(const string& response)> ResponseCallback;
+
+    static const int SESSION_TTL_SECONDS = 30 * 60;
+
     AuthenticationController();
     ~AuthenticationController();
 
@@ -56,10 +71,32 @@ public:
      */
     string registerUser(const RegistrationRequest& request);
 
+    /**
+     * Check one registration's fields; on failure sets errorCode and message
+     */
+    static bool validateRegistration(const RegistrationRequest& request,
+                                     const char*& errorCode, const char*& message);
+
+    /**
+     * Bulk onboarding: validate every request, also rejecting national IDs,
+     * emails and phone numbers that repeat earlier in the same batch
+     */
+    static vector<RegistrationCheck> validateRegistrations(
+        const vector<RegistrationRequest>& requests);
+
+    /**
+     * POST /api/v1/auth/register/validate
+     * Validate a bulk import; returns counts and the rejected entries
+     */
+    string validateRegistrationBatch(const vector<RegistrationRequest>& requests);
+
     /**
      * POST /api/v1/auth/login
-     * Authenticate user credentials
+     * Authenticate user credentials. The password check runs on the
+     * password-hashing pool and 'done' is called from there (or at once
+     * for requests rejected before it); the string form waits for it.
      */
+    void login(const LoginRequest& request, ResponseCallback done);
     string login(const LoginRequest& request);
 
     /**
@@ -76,14 +113,17 @@ public:
 
     /**
      * POST /api/v1/auth/forgot-password
-     * Initiate password reset
+     * Initiate password reset: texts a reset code to the user's phone and
+     * returns a resetId (for any valid email, registered or not)
      */
     string forgotPassword(const string& email);
 
     /**
      * POST /api/v1/auth/reset-password
-     * Complete password reset with token
+     * Complete password reset with token ("<resetId>-<code>"); the new
+     * password is hashed on the password-hashing pool, like login()
      */
+    void resetPassword(const string& token, const string& newPassword, ResponseCallback done);
     string resetPassword(const string& token, const string& newPassword);
 };
 
@@ -6,6 +6,10 @@
  */
 
 #include "BillPaymentController.h"
+#include "../model/User.h"
+#include "../utils/DatabaseConnection.h"
+#include "../utils/IdGenerator.h"
+#include "../utils/Clock.h"
 #include <sstream>
 #include <iomanip>
 
@@ -99,26 +103,58 @@ string BillPaymentController::payBill(const string& userId,
         );
     }
     
-    if (request.amount <= 0) {
+    if (!request.amount.isPositive()) {
         return View::JsonResponseBuilder::buildErrorResponse(
             "Invalid bill amount",
             "ERR_INVALID_AMOUNT"
         );
     }
     
-    // In real implementation:
-    // 1. Verify account has sufficient balance
-    // 2. Deduct from account
-    // 3. Send payment to provider API
-    // 4. Create transaction record
-    // 5. Save biller if requested
+    Model::BillType billType;
+    if (!Model::BillPayment::parseBillType(request.billType, billType)) {
+        return View::JsonResponseBuilder::buildErrorResponse(
+            "Unknown bill type",
+            "ERR_INVALID_BILL_TYPE"
+        );
+    }
+    
+    if (request.serviceProvider.empty()) {
+        return View::JsonResponseBuilder::buildErrorResponse(
+            "Service provider is required",
+            "ERR_MISSING_PROVIDER"
+        );
+    }
+    
+    // The paying account must belong to the user
+    Utils::DatabaseConnection* db = Utils::DatabaseConnection::getInstance();
+    Model::Account account;
+    if (!db->isAccountOwner(Model::User::idFromRef(userId), request.accountNumber) ||
+        !db->getLedger().getAccount(request.accountNumber, account)) {
+        return View::JsonResponseBuilder::buildErrorResponse(
+            "Account not found",
+            "ERR_ACCOUNT_NOT_FOUND"
+        );
+    }
+    
+    // Debit, settlement credit and the BILL_PAYMENT journal entries under
+    // the account locks; the provider API call would follow a completed payment
+    Model::BillPayment payment(account.getAccountId(), billType, request.serviceProvider,
+                               request.billAccountNumber, request.amount);
+    Utils::TransferOutcome outcome =
+        db->getTransferEngine().payBill(request.accountNumber, payment);
+    if (outcome != Utils::TransferOutcome::COMPLETED) {
+        return View::JsonResponseBuilder::buildErrorResponse(
+            Utils::TransferEngine::outcomeMessage(outcome),
+            Utils::TransferEngine::outcomeCode(outcome)
+        );
+    }
     
     View::BillPaymentResponseData responseData;
-    responseData.billRef = Model::BillPayment::generateBillRef();
+    responseData.billRef = payment.getBillRef();
     responseData.billType = request.billType;
     responseData.provider = request.serviceProvider;
     responseData.amount = request.amount;
-    responseData.status = "COMPLETED";
+    responseData.status = payment.getStatusString();
     
     return View::JsonResponseBuilder::buildSuccessResponse(
         responseData.toJson(),
@@ -209,10 +245,34 @@ string BillPaymentController::scheduleBillPayment(const string& userId,
         );
     }
     
+    time_t now = Utils::Clock::now();
+    time_t dueDate;
+    if (!Utils::Clock::parseLocalDate(request.scheduledDate, 0, dueDate) ||
+        Utils::Clock::localDay(dueDate) < Utils::Clock::localDay(now)) {
+        return View::JsonResponseBuilder::buildErrorResponse(
+            "Invalid scheduled date. Use YYYY-MM-DD, today or later",
+            "ERR_INVALID_DATE"
+        );
+    }
+    
+    if (!request.amount.isPositive()) {
+        return View::JsonResponseBuilder::buildErrorResponse(
+            "Invalid bill amount",
+            "ERR_INVALID_AMOUNT"
+        );
+    }
+    
+    // Shows up in the user's dashboard until its due date has passed
+    string scheduleId = Utils::IdGenerator::nextRef("SCH");
+    Utils::DatabaseConnection::getInstance()->getSummaries().schedulePayment(
+        Model::User::idFromRef(userId), scheduleId,
+        request.serviceProvider + " " + request.billAccountNumber,
+        request.amount, dueDate, now);
+    
     stringstream dataJson;
     dataJson << fixed << setprecision(2);
     dataJson << "{\n"
-             << "    \"scheduleId\": \"SCHED001\",\n"
+             << "    \"scheduleId\": \"" << scheduleId << "\",\n"
              << "    \"billType\": \"" << request.billType << "\",\n"
              << "    \"provider\": \"" << request.serviceProvider << "\",\n"
              << "    \"amount\": " << request.amount << ",\n"
@@ -23,7 +23,7 @@ struct BillPaymentRequest {
     string billType;
     string serviceProvider;
     string billAccountNumber;
-    double amount;
+    Model::Money amount;
     bool saveAsBiller;
     bool makeRecurring;
     string scheduledDate;
@@ -49,7 +49,8 @@ public:
 
     /**
      * POST /api/v1/bills/pay
-     * Process bill payment
+     * Pay a bill from one of the user's accounts through the transfer
+     * engine, so it shows in history, spending rollups and the dashboard
      */
     string payBill(const string& userId, 
                         const BillPaymentRequest& request);
@@ -7,14 +7,81 @@
 
 #include "TransferController.h"
 #include "../model/Account.h"
+#include "../model/User.h"
+#include "../utils/Clock.h"
+#include "../utils/SmsGateway.h"
+#include "../utils/DatabaseConnection.h"
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
 
 using namespace std;
 
 namespace SOBS {
 namespace Controller {
 
+namespace {
+
+// Batch line checks, in the order initiateTransfer applies them
+const char* validateBatchLine(const TransferRequest& request) {
+    if (!Model::Account::validateAccountNumber(request.senderAccountNumber)) {
+        return "ERR_INVALID_SENDER_ACCOUNT";
+    }
+    if (!Model::Account::validateAccountNumber(request.recipientAccountNumber)) {
+        return "ERR_INVALID_RECIPIENT_ACCOUNT";
+    }
+    if (!Model::Transfer::validateAmount(request.amount)) {
+        return "ERR_INVALID_AMOUNT";
+    }
+    if (request.senderAccountNumber == request.recipientAccountNumber) {
+        return "ERR_SAME_ACCOUNT";
+    }
+    if (!request.recipientBank.empty()) {
+        return "ERR_INTERBANK_NOT_SUPPORTED";  // Batches settle on our own ledger
+    }
+    if (Model::Transfer::requiresOTPFor(request.amount)) {
+        return "ERR_OTP_REQUIRED";             // Batches have no OTP step
+    }
+    return nullptr;
+}
+
+// Error code if the user may not send from the account, else nullptr.
+// Accounts of other users read as missing, so their numbers are not confirmed.
+const char* authorizeSender(long userId, const string& accountNumber) {
+    if (!Utils::DatabaseConnection::getInstance()->isAccountOwner(userId, accountNumber)) {
+        return "ERR_ACCOUNT_NOT_FOUND";
+    }
+    return nullptr;
+}
+
+// Registered mobile of the seed user (USR001), who owns the demo accounts
+const char* const SEED_USER_PHONE = "+201001234567";
+
+// OTP key prefix: a transfer code only confirms a transfer
+const char* const TRANSFER_OTP_PREFIX = "transfer:";
+
+// Error response for an OTP that did not verify
+string otpFailure(Utils::OtpOutcome outcome) {
+    if (outcome == Utils::OtpOutcome::MISMATCH) {
+        return View::JsonResponseBuilder::buildErrorResponse(
+            "Incorrect OTP",
+            "ERR_INVALID_OTP"
+        );
+    }
+    if (outcome == Utils::OtpOutcome::LOCKED) {
+        return View::JsonResponseBuilder::buildErrorResponse(
+            "Too many incorrect attempts. Please request a new OTP",
+            "ERR_OTP_LOCKED"
+        );
+    }
+    return View::JsonResponseBuilder::buildErrorResponse(
+        "OTP expired or already used. Please request a new OTP",
+        "ERR_OTP_EXPIRED"
+    );
+}
+
+} // namespace
+
 TransferController::TransferController() {}
 
 TransferController::~TransferController() {}
@@ -23,6 +90,10 @@ string TransferController::getCurrentUserId() {
     return "USR001";
 }
 
+bool TransferController::sendOTPviaSMS(const string& phoneNumber, const string& otp) {
+    return Utils::SmsGateway::sendCode(phoneNumber, "transfer", otp);
+}
+
 string TransferController::initiateTransfer(const string& userId,
                                                   const TransferRequest& request) {
     if (userId.empty()) {
@@ -56,45 +127,190 @@ string TransferController::initiateTransfer(const string& userId,
         );
     }
     
+    // The sender account must belong to the user
+    if (authorizeSender(Model::User::idFromRef(userId), request.senderAccountNumber) != nullptr) {
+        return View::JsonResponseBuilder::buildErrorResponse(
+            "Sender account not found",
+            "ERR_ACCOUNT_NOT_FOUND"
+        );
+    }
+    
     // Create transfer
     Model::Transfer transfer(1, request.recipientAccountNumber, 
                             request.amount, request.description);
     transfer.setSenderAccountNumber(request.senderAccountNumber);
+    transfer.setRecipientName("Mohamed Ali");  // From validation
     
     if (!request.recipientBank.empty()) {
         transfer.setRecipientBank(request.recipientBank);
     }
     
-    // In real implementation, would:
-    // 1. Verify sender account belongs to user
-    // 2. Check sufficient balance
-    // 3. Check daily transfer limit
-    // 4. Validate recipient with bank API
-    // 5. Save transfer to database
-    // 6. Generate OTP if required
+    // In real implementation, would validate the recipient with the bank API;
+    // balance and daily limit are checked by the engine when it executes
     
     transfer.initiateTransfer();
     
-    bool requiresOTP = (request.amount > 5000.0);
-    
+    // Transfers over 5,000 EGP wait, until their code expires, for an OTP
+    // keyed by the transfer reference and issued to the requesting user
+    bool requiresOTP = transfer.getRequiresOTP();
+    if (requiresOTP) {
+        Utils::DatabaseConnection* db = Utils::DatabaseConnection::getInstance();
+        time_t now = Utils::Clock::now();
+        string otp;
+        if (!db->savePendingTransfer(transfer, now + Utils::OtpStore::TTL_SECONDS, now) ||
+            !db->getOtps().issue(TRANSFER_OTP_PREFIX + transfer.getTransferRef(),
+                                 Model::User::idFromRef(userId), now, otp)) {
+            db->takePendingTransfer(transfer.getTransferRef(), now, transfer);
+            return View::JsonResponseBuilder::buildErrorResponse(
+                "Could not send OTP. Please try again",
+                "ERR_OTP_UNAVAILABLE"
+            );
+        }
+        sendOTPviaSMS(SEED_USER_PHONE, otp);
+    } else {
+        // No OTP step: debit, credit and postings now, as verifyTransfer does
+        Utils::TransferOutcome result =
+            Utils::DatabaseConnection::getInstance()->getTransferEngine().execute(
+                transfer.getSenderAccountNumber(), transfer.getRecipientAccountNumber(),
+                transfer.getAmount(), transfer.getDescription(), transfer.getTransferRef());
+        if (result != Utils::TransferOutcome::COMPLETED) {
+            return View::JsonResponseBuilder::buildErrorResponse(
+                Utils::TransferEngine::outcomeMessage(result),
+                Utils::TransferEngine::outcomeCode(result)
+            );
+        }
+        transfer.complete();
+    }
+
     stringstream dataJson;
     dataJson << fixed << setprecision(2);
     dataJson << "{\n"
              << "    \"transferId\": \"" << transfer.getTransferRef() << "\",\n"
-             << "    \"status\": \"" << (requiresOTP ? "PENDING_OTP" : "PENDING") << "\",\n"
+             << "    \"status\": \"" << (requiresOTP ? "PENDING_OTP" : "COMPLETED") << "\",\n"
              << "    \"requiresOTP\": " << (requiresOTP ? "true" : "false") << ",\n"
              << "    \"amount\": " << request.amount << ",\n"
              << "    \"recipientAccount\": \"" << request.recipientAccountNumber << "\",\n"
-             << "    \"recipientName\": \"Mohamed Ali\"\n"  // From validation
+             << "    \"recipientName\": \"" << transfer.getRecipientName() << "\"\n"
              << "  }";
     
     string message = requiresOTP ? 
         "Transfer initiated. OTP sent to your registered mobile" :
-        "Transfer initiated successfully";
+        "Transfer completed successfully";
     
     return View::JsonResponseBuilder::buildSuccessResponse(dataJson.str(), message);
 }
 
+string TransferController::executeBatchTransfer(const string& userId,
+                                                 const vector<TransferRequest>& requests) {
+    if (userId.empty()) {
+        return View::JsonResponseBuilder::buildErrorResponse(
+            "User not authenticated",
+            "ERR_UNAUTHORIZED"
+        );
+    }
+    if (requests.empty()) {
+        return View::JsonResponseBuilder::buildErrorResponse(
+            "No transfers in batch",
+            "ERR_EMPTY_BATCH"
+        );
+    }
+    if (requests.size() > MAX_BATCH_TRANSFERS) {
+        return View::JsonResponseBuilder::buildErrorResponse(
+            "Batch exceeds 50,000 transfers",
+            "ERR_BATCH_TOO_LARGE"
+        );
+    }
+    
+    // Pass 1: validate every line, collect the valid ones
+    vector<const char*> errorCodes(requests.size(), nullptr);
+    vector<string> transferRefs(requests.size());
+    vector<size_t> order;
+    order.reserve(requests.size());
+    for (size_t i = 0; i < requests.size(); i++) {
+        errorCodes[i] = validateBatchLine(requests[i]);
+        if (errorCodes[i] == nullptr) order.push_back(i);
+    }
+    
+    // Pass 2: execute grouped by sender, keeping request order within a group
+    stable_sort(order.begin(), order.end(), [&requests](size_t a, size_t b) {
+        return requests[a].senderAccountNumber < requests[b].senderAccountNumber;
+    });
+    
+    Utils::TransferEngine& engine = Utils::DatabaseConnection::getInstance()->getTransferEngine();
+    long ownerId = Model::User::idFromRef(userId);
+    vector<Utils::TransferInstruction> instructions;
+    vector<string> references;
+    vector<Utils::TransferOutcome> outcomes;
+    size_t senderCount = 0;
+    size_t completedCount = 0;
+    Model::Money completedAmount;
+    
+    for (size_t start = 0; start < order.size(); ) {
+        const string& sender = requests[order[start]].senderAccountNumber;
+        size_t end = start;
+        
+        // Senders the user does not own fail as a group, like initiateTransfer
+        const char* senderError = authorizeSender(ownerId, sender);
+        if (senderError != nullptr) {
+            while (end < order.size() && requests[order[end]].senderAccountNumber == sender) {
+                errorCodes[order[end]] = senderError;
+                end++;
+            }
+            start = end;
+            continue;
+        }
+        
+        instructions.clear();
+        references.clear();
+        while (end < order.size() && requests[order[end]].senderAccountNumber == sender) {
+            const TransferRequest& request = requests[order[end]];
+            instructions.push_back(Utils::TransferInstruction{
+                request.recipientAccountNumber, request.amount, request.description});
+            references.push_back(Model::Transfer::generateTransferRef());
+            end++;
+        }
+        
+        engine.executeBatch(sender, instructions, references, outcomes);
+        for (size_t i = 0; i < outcomes.size(); i++) {
+            size_t line = order[start + i];
+            if (outcomes[i] == Utils::TransferOutcome::COMPLETED) {
+                transferRefs[line] = move(references[i]);
+                completedAmount.add(requests[line].amount);
+                completedCount++;
+            } else {
+                errorCodes[line] = Utils::TransferEngine::outcomeCode(outcomes[i]);
+            }
+        }
+        senderCount++;
+        start = end;
+    }
+    
+    string& buffer = View::JsonWriter::threadBuffer();
+    View::JsonResponseBuilder::writeSuccessResponse(buffer, [&](View::JsonWriter& writer) {
+        writer.beginObject()
+              .member("total", static_cast<int64_t>(requests.size()))
+              .member("completed", static_cast<int64_t>(completedCount))
+              .member("failed", static_cast<int64_t>(requests.size() - completedCount))
+              .member("senders", static_cast<int64_t>(senderCount))
+              .decimalMember("completedAmount", completedAmount.getMinorUnits(),
+                             Model::Money::DECIMALS)
+              .key("results").beginArray();
+        for (size_t i = 0; i < requests.size(); i++) {
+            writer.beginObject().member("index", static_cast<int64_t>(i));
+            if (errorCodes[i] == nullptr) {
+                writer.member("status", "COMPLETED")
+                      .member("transferId", transferRefs[i]);
+            } else {
+                writer.member("status", "FAILED")
+                      .member("errorCode", errorCodes[i]);
+            }
+            writer.endObject();
+        }
+        writer.endArray().endObject();
+    }, "Batch processed");
+    return buffer;
+}
+
 string TransferController::verifyTransfer(const string& userId,
                                                const string& transferId,
                                                const string& otp) {
@@ -112,24 +328,62 @@ string TransferController::verifyTransfer(const string& userId,
         );
     }
     
-    // In real implementation, would:
-    // 1. Find transfer by ID
-    // 2. Verify OTP
-    // 3. Process transfer (debit sender, credit recipient)
-    // 4. Create transaction records
-    // 5. Send notifications
+    Utils::DatabaseConnection* db = Utils::DatabaseConnection::getInstance();
+    time_t now = Utils::Clock::now();
+    long ownerId = 0;
+    Utils::OtpOutcome outcome = db->getOtps().verify(
+        TRANSFER_OTP_PREFIX + transferId, otp, now, ownerId);
+    if (outcome != Utils::OtpOutcome::VERIFIED) {
+        // A transfer whose code is gone can no longer be confirmed
+        Model::Transfer discarded;
+        if (outcome != Utils::OtpOutcome::MISMATCH) {
+            db->takePendingTransfer(transferId, now, discarded);
+        }
+        return otpFailure(outcome);
+    }
+    
+    // Only the user who started the transfer can confirm it
+    if (ownerId == 0 || ownerId != Model::User::idFromRef(userId)) {
+        return View::JsonResponseBuilder::buildErrorResponse(
+            "Transfer was not initiated by this user",
+            "ERR_UNAUTHORIZED"
+        );
+    }
+    
+    Model::Transfer transfer;
+    if (!db->takePendingTransfer(transferId, now, transfer)) {
+        return View::JsonResponseBuilder::buildErrorResponse(
+            "Transfer not found",
+            "ERR_TRANSFER_NOT_FOUND"
+        );
+    }
+    
+    // Same sender check as initiateTransfer, then the debit, credit and
+    // postings under the two account locks
+    if (authorizeSender(ownerId, transfer.getSenderAccountNumber()) != nullptr) {
+        return View::JsonResponseBuilder::buildErrorResponse(
+            "Sender account not found",
+            "ERR_ACCOUNT_NOT_FOUND"
+        );
+    }
+    Utils::TransferOutcome result = db->getTransferEngine().execute(
+        transfer.getSenderAccountNumber(), transfer.getRecipientAccountNumber(),
+        transfer.getAmount(), transfer.getDescription(), transfer.getTransferRef());
+    if (result != Utils::TransferOutcome::COMPLETED) {
+        return View::JsonResponseBuilder::buildErrorResponse(
+            Utils::TransferEngine::outcomeMessage(result),
+            Utils::TransferEngine::outcomeCode(result)
+        );
+    }
+    transfer.complete();
     
     View::TransferResponseData responseData;
-    responseData.transferRef = transferId;
-    responseData.amount = 10000.00;
-    responseData.recipientName = "Mohamed Ali";
-    responseData.status = "COMPLETED";
-    
-    time_t now = time(nullptr);
-    char buffer[80];
-    struct tm* timeinfo = localtime(&now);
-    strftime(buffer, 80, "%Y-%m-%dT%H:%M:%S", timeinfo);
-    responseData.completedAt = buffer;
+    responseData.transferRef = transfer.getTransferRef();
+    responseData.amount = transfer.getAmount();
+    responseData.recipientName = transfer.getRecipientName();
+    responseData.status = transfer.getStatusString();
+    
+    responseData.completedAt = Utils::Clock::currentTimestamp();
     
     return View::JsonResponseBuilder::buildSuccessResponse(
         responseData.toJson(),
@@ -10,6 +10,7 @@
 #define TRANSFERCONTROLLER_H
 
 #include <string>
+#include <vector>
 #include "../model/Transfer.h"
 #include "../view/ApiResponse.h"
 
@@ -22,7 +23,7 @@ struct TransferRequest {
     string senderAccountNumber;
     string recipientAccountNumber;
     string recipientBank;  // Empty for intra-bank
-    double amount;
+    Model::Money amount;
     string description;
     string scheduledDate;  // Empty for immediate
 };
@@ -30,21 +31,36 @@ struct TransferRequest {
 class TransferController {
 private:
     string getCurrentUserId();
+    bool sendOTPviaSMS(const string& phoneNumber, const string& otp);
 
 public:
+    static const size_t MAX_BATCH_TRANSFERS = 50000;
+
     TransferController();
     ~TransferController();
 
     /**
      * POST /api/v1/transfers
-     * Initiate a new transfer
+     * Initiate a new transfer. Up to 5,000 EGP it executes at once;
+     * larger ones wait for verifyTransfer() with an OTP.
      */
     string initiateTransfer(const string& userId, 
                                  const TransferRequest& request);
 
+    /**
+     * POST /api/v1/transfers/batch
+     * Validate every line in one pass, then execute the valid ones grouped
+     * by sender account (each sender is locked once for its whole group).
+     * Senders must belong to the user, and lines that would need an OTP
+     * (over 5,000 EGP) fail with ERR_OTP_REQUIRED. Returns a summary plus
+     * one status per line, in request order.
+     */
+    string executeBatchTransfer(const string& userId,
+                                const vector<TransferRequest>& requests);
+
     /**
      * POST /api/v1/transfers/{transferId}/verify
-     * Verify transfer with OTP
+     * Verify transfer with OTP and execute it
      */
     string verifyTransfer(const string& userId,
                                const string& transferId,
@@ -15,6 +15,11 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
+#include <thread>
+#include <csignal>
+#include <cstdlib>
+#include <algorithm>
 
 // Models
 #include "model/User.h"
@@ -33,11 +38,146 @@
 #include "controller/BillPaymentController.h"
 
 // Utils (Singleton Pattern - BONUS)
+#include "utils/Clock.h"
 #include "utils/DatabaseConnection.h"
 
+// HTTP front end
+#include "server/HttpServer.h"
+#include "server/ApiRouter.h"
+#include "server/CommandProcessor.h"
+#include "server/BatchServer.h"
+
 using namespace std;
 using namespace SOBS;
 
+/**
+ * Register the demo accounts in the embedded ledger
+ * (mirrors the seed data used by the web demo)
+ */
+void seedDemoAccounts() {
+    Utils::DatabaseConnection* db = Utils::DatabaseConnection::getInstance();
+    
+    struct SeedAccount {
+        const char* number;
+        Model::AccountType type;
+        int64_t balance;
+    };
+    const SeedAccount seeds[] = {
+        {"12345678901234", Model::AccountType::SAVINGS, 50000},
+        {"12345678905678", Model::AccountType::CHECKING, 15000},
+        {"98765432109876", Model::AccountType::SAVINGS, 25000}
+    };
+    
+    for (const SeedAccount& seed : seeds) {
+        Model::Money balance;
+        if (!Model::Money::fromMajorUnits(seed.balance, balance)) {
+            continue;
+        }
+        Model::Account account(1, seed.type);
+        account.setAccountNumber(seed.number);
+        account.setBalance(balance);
+        db->openAccount(account);
+    }
+    
+    // Demo credentials for USR001 (ahmed@example.com): "SecurePass123!"
+    db->setPasswordHash(1,
+        "$scrypt$ln=14,r=8,p=1$383001a13ba555967b467128fe2640bf"
+        "$23799fc1b0c447eacc79fd71bc31cb6d705e5309299ed86d6873afe1eabb6ea3");
+}
+
+// Servers stopped by SIGINT/SIGTERM in serve and batch modes
+Server::HttpServer* activeServer = nullptr;
+Server::BatchServer* activeBatchServer = nullptr;
+
+void stopServer(int) {
+    if (activeServer != nullptr) {
+        activeServer->stop();
+    }
+    if (activeBatchServer != nullptr) {
+        activeBatchServer->stop();
+    }
+}
+
+/**
+ * Serve the REST API over HTTP until interrupted
+ */
+int runServer(int port, size_t workerCount) {
+    Utils::DatabaseConnection* db = Utils::DatabaseConnection::getInstance();
+    if (!db->connect("localhost", 5432, "sobs_db", "sobs_user", "secret")) {
+        return 1;
+    }
+    
+    Server::ApiRouter router;
+    Server::HttpServer server;
+    if (!server.start(port, workerCount,
+                      [&router](const Server::HttpRequest& request,
+                                Server::HttpServer::Responder respond) {
+                          router.dispatch(request, respond);
+                      })) {
+        cout << "[HTTP] Failed to listen on port " << port << endl;
+        return 1;
+    }
+    // Session shards only advance their timing wheels on create(), so
+    // quiet shards would keep expired sessions without this
+    server.setSweepTask([db] {
+        db->getSessions().evictExpired(Utils::Clock::now());
+    });
+    
+    activeServer = &server;
+    signal(SIGINT, stopServer);
+    signal(SIGTERM, stopServer);
+    
+    cout << "[HTTP] Listening on port " << server.getPort()
+         << " with " << workerCount << " workers" << endl;
+    server.run();
+    activeServer = nullptr;
+    
+    cout << "[HTTP] Stopped after " << server.getRequestCount() << " requests" << endl;
+    db->disconnect();
+    return 0;
+}
+
+/**
+ * Batch mode: one JSON command per line on stdin (or a UNIX socket),
+ * one JSON response per line, with controllers and the database kept warm
+ */
+int runBatch(const string& socketPath) {
+    // Keep stdout for responses only: connection messages go to stderr
+    streambuf* stdoutBuffer = cout.rdbuf(cerr.rdbuf());
+    bool connected = Utils::DatabaseConnection::getInstance()->connect(
+        "localhost", 5432, "sobs_db", "sobs_user", "secret");
+    cout.rdbuf(stdoutBuffer);
+    if (!connected) {
+        return 1;
+    }
+    
+    Server::CommandProcessor processor;
+    Server::BatchServer batch(processor);
+    
+    if (socketPath.empty()) {
+        ios::sync_with_stdio(false);
+        cin.tie(nullptr);
+        batch.runStream(cin, cout);
+    } else {
+        activeBatchServer = &batch;
+        signal(SIGINT, stopServer);
+        signal(SIGTERM, stopServer);
+        cerr << "[BATCH] Listening on " << socketPath << endl;
+        if (!batch.serveUnixSocket(socketPath)) {
+            cerr << "[BATCH] Failed to listen on " << socketPath << endl;
+            activeBatchServer = nullptr;
+            return 1;
+        }
+        activeBatchServer = nullptr;
+        cerr << "[BATCH] Stopped after " << batch.getCommandCount() << " commands" << endl;
+    }
+    
+    streambuf* restore = cout.rdbuf(cerr.rdbuf());
+    Utils::DatabaseConnection::getInstance()->disconnect();
+    cout.rdbuf(restore);
+    return 0;
+}
+
 void printSeparator(const string& title) {
     cout << "\n" << string(60, '=') << endl;
     cout << "  " << title << endl;
@@ -58,20 +198,29 @@ void demonstrateModelLayer() {
     // Account Model
     cout << "\n[Account Model]" << endl;
     Model::Account account(1, Model::AccountType::SAVINGS);
-    account.setBalance(50000.00);
+    account.setBalance(Model::Money::fromMajorUnits<50000>());
     cout << account.toString() << endl;
-    cout << "Can Transfer 10000 EGP: " << (account.canTransfer(10000) ? "Yes" : "No") << endl;
+    cout << "Can Transfer 10000 EGP: " << (account.canTransfer(Model::Money::fromMajorUnits<10000>()) ? "Yes" : "No") << endl;
     
-    // Transaction Model
+    // Transaction Model: a transfer between two seeded accounts,
+    // read back from the posting journal as its DEBIT/CREDIT pair
     cout << "\n[Transaction Model]" << endl;
-    Model::Transaction txn(1, Model::TransactionType::DEBIT, 1000.00, "ATM Withdrawal");
-    txn.setBalanceAfter(49000.00);
-    txn.setStatus(Model::TransactionStatus::COMPLETED);
-    cout << txn.toString() << endl;
+    Utils::DatabaseConnection* db = Utils::DatabaseConnection::getInstance();
+    Model::Transfer posted(1, "12345678901234", Model::Money::fromMajorUnits<1000>(), "Rent share");
+    posted.setSenderAccountNumber("12345678905678");
+    db->getTransferEngine().execute(posted);
+    for (const char* number : {"12345678905678", "12345678901234"}) {
+        Model::Account journaled;
+        db->getLedger().getAccount(number, journaled);
+        for (const Model::Transaction& txn : db->getJournal().getTransactions(journaled.getAccountId())) {
+            cout << txn.toString() << " balanceAfter=" << txn.getBalanceAfter()
+                 << " for " << txn.getReferenceNumber() << endl;
+        }
+    }
     
     // Transfer Model
     cout << "\n[Transfer Model]" << endl;
-    Model::Transfer transfer(1, "98765432109876", 5000.00, "Payment for services");
+    Model::Transfer transfer(1, "98765432109876", Model::Money::fromMajorUnits<5000>(), "Payment for services");
     transfer.setRecipientName("Mohamed Ali");
     cout << transfer.toString() << endl;
     cout << "Requires OTP: " << (transfer.getRequiresOTP() ? "Yes" : "No") << endl;
@@ -79,7 +228,7 @@ void demonstrateModelLayer() {
     // Bill Payment Model
     cout << "\n[BillPayment Model]" << endl;
     Model::BillPayment bill(1, Model::BillType::ELECTRICITY, 
-                           "Egyptian Electricity", "12345678", 523.50);
+                           "Egyptian Electricity", "12345678", Model::Money::fromMinorUnits(52350));
     cout << bill.toString() << endl;
 }
 
@@ -106,6 +255,7 @@ void demonstrateViewLayer() {
     cout << "\n[Login Response Data]" << endl;
     View::LoginResponseData loginData;
     loginData.sessionToken = "eyJhbGciOiJIUzI1NiIsInR5cCI6IkpXVCJ9...";
+    loginData.expiresIn = Controller::AuthenticationController::SESSION_TTL_SECONDS;
     loginData.customerId = "CUS123456789";
     loginData.fullName = "Ahmed Mohamed";
     loginData.email = "ahmed@example.com";
@@ -136,7 +286,7 @@ void demonstrateControllerLayer() {
     Controller::TransferRequest transferReq;
     transferReq.senderAccountNumber = "12345678901234";
     transferReq.recipientAccountNumber = "98765432109876";
-    transferReq.amount = 10000.00;
+    transferReq.amount = Model::Money::fromMajorUnits<10000>();
     transferReq.description = "Payment for consulting services";
     string transferResponse = transferController.initiateTransfer("USR001", transferReq);
     cout << transferResponse << endl;
@@ -171,14 +321,23 @@ void demonstrateSingletonPattern() {
     
     // Execute sample query
     cout << "\n[Executing Query]" << endl;
-    db1->executeQuery("SELECT * FROM users WHERE user_id = 1");
+    cout << db1->executeQuery("SELECT balance FROM accounts WHERE account_number = '12345678901234'") << endl;
     
     // Transaction demonstration
     cout << "\n[Transaction Management]" << endl;
-    db1->beginTransaction();
-    db1->executeUpdate("UPDATE accounts SET balance = balance - 1000 WHERE account_id = 1");
-    db1->executeUpdate("UPDATE accounts SET balance = balance + 1000 WHERE account_id = 2");
-    db1->commitTransaction();
+    if (db1->beginTransaction()) {
+        cout << "[DB] Transaction started" << endl;
+    }
+    db1->executeUpdate("UPDATE accounts SET balance = balance - 1000 WHERE account_number = '12345678901234'");
+    db1->executeUpdate("UPDATE accounts SET balance = balance + 1000 WHERE account_number = '98765432109876'");
+    if (db1->commitTransaction()) {
+        cout << "[DB] Transaction committed" << endl;
+    }
+    cout << db1->executeQuery("SELECT balance FROM accounts WHERE account_number = '12345678901234'") << endl;
+    
+    // Connection pool statistics
+    cout << "\n[Connection Pool]" << endl;
+    cout << db1->getPoolStats().toString() << endl;
     
     // Disconnect
     db1->disconnect();
@@ -197,7 +356,7 @@ void demonstrateMVCFlow() {
     Controller::TransferRequest request;
     request.senderAccountNumber = "12345678901234";
     request.recipientAccountNumber = "98765432109876";
-    request.amount = 1000.00;
+    request.amount = Model::Money::fromMajorUnits<1000>();
     request.description = "Payment";
     
     cout << "\nStep 3: CONTROLLER calls SERVICE layer (business logic)" << endl;
@@ -220,60 +379,81 @@ void demonstrateMVCFlow() {
 }
 
 int main(int argc, char* argv[]) {
+    seedDemoAccounts();
+    
+    // --wal <path>, anywhere on the command line: serve and batch log
+    // transfers there and replay it on startup
+    vector<char*> args;
+    for (int i = 0; i < argc; i++) {
+        if (string(argv[i]) == "--wal" && i + 1 < argc) {
+            Utils::DatabaseConnection::getInstance()->configureWriteAheadLog(argv[++i]);
+            continue;
+        }
+        args.push_back(argv[i]);
+    }
+    argc = static_cast<int>(args.size());
+    argv = args.data();
+    
     // CLI Mode
     if (argc >= 2) {
         string command = argv[1];
 
+        Utils::JsonValue request = Utils::JsonValue::makeObject();
+        request.set("command", Utils::JsonValue::makeString(command));
+
         if (command == "login") {
             if (argc < 4) {
                 cout << View::JsonResponseBuilder::buildErrorResponse("Usage: login <email> <password>", "ERR_ARGS") << endl;
                 return 1;
             }
-            Controller::AuthenticationController authController;
-            Controller::LoginRequest loginReq;
-            loginReq.email = argv[2];
-            loginReq.password = argv[3];
-            cout << authController.login(loginReq) << endl;
+            request.set("email", Utils::JsonValue::makeString(argv[2]));
+            request.set("password", Utils::JsonValue::makeString(argv[3]));
         } 
         else if (command == "balance") {
             if (argc < 4) {
                  cout << View::JsonResponseBuilder::buildErrorResponse("Usage: balance <user_id> <account_number>", "ERR_ARGS") << endl;
                  return 1;
             }
-            Controller::AccountController accountController;
-            cout << accountController.getBalance(argv[2], argv[3]) << endl;
+            request.set("userId", Utils::JsonValue::makeString(argv[2]));
+            request.set("accountNumber", Utils::JsonValue::makeString(argv[3]));
         }
         else if (command == "transfer") {
             if (argc < 6) {
-                 cout << View::JsonResponseBuilder::buildErrorResponse("Usage: transfer <sender> <recipient> <amount> <description>", "ERR_ARGS") << endl;
+                 cout << View::JsonResponseBuilder::buildErrorResponse("Usage: transfer <sender> <recipient> <amount> <description> [user_id]", "ERR_ARGS") << endl;
                  return 1;
             }
-            Controller::TransferController transferController;
-            Controller::TransferRequest transferReq;
-            transferReq.senderAccountNumber = argv[2];
-            transferReq.recipientAccountNumber = argv[3];
-            try {
-                transferReq.amount = stod(argv[4]);
-            } catch (...) {
-                 cout << View::JsonResponseBuilder::buildErrorResponse("Invalid amount format", "ERR_ARGS") << endl;
-                 return 1;
+            if (argc >= 7) {
+                request.set("userId", Utils::JsonValue::makeString(argv[6]));
             }
-            transferReq.description = argv[5];
-            // Using a placeholder CLI user ID
-            cout << transferController.initiateTransfer("USR_CLI", transferReq) << endl;
+            request.set("senderAccountNumber", Utils::JsonValue::makeString(argv[2]));
+            request.set("recipientAccountNumber", Utils::JsonValue::makeString(argv[3]));
+            request.set("amount", Utils::JsonValue::makeString(argv[4]));
+            request.set("description", Utils::JsonValue::makeString(argv[5]));
         }
         else if (command == "providers") {
              if (argc < 3) {
                  cout << View::JsonResponseBuilder::buildErrorResponse("Usage: providers <type>", "ERR_ARGS") << endl;
                  return 1;
             }
-            Controller::BillPaymentController billController;
-            cout << billController.getProviders(argv[2]) << endl;
+            request.set("type", Utils::JsonValue::makeString(argv[2]));
         }
-        else {
-            cout << View::JsonResponseBuilder::buildErrorResponse("Unknown command", "ERR_CMD") << endl;
+        else if (command == "serve") {
+            int port = argc >= 3 ? atoi(argv[2]) : 8080;
+            size_t workerCount = argc >= 4 ? static_cast<size_t>(atoi(argv[3])) :
+                                 max(1u, thread::hardware_concurrency());
+            return runServer(port, workerCount);
+        }
+        else if (command == "batch") {
+            // batch [--socket <path>]
+            string socketPath;
+            if (argc >= 4 && string(argv[2]) == "--socket") {
+                socketPath = argv[3];
+            }
+            return runBatch(socketPath);
         }
 
+        Server::CommandProcessor processor;
+        cout << processor.execute(request) << endl;
         return 0;
     }
 
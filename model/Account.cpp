@@ -6,8 +6,8 @@
  */
 
 #include "Account.h"
+#include "../utils/IdGenerator.h"
 #include <sstream>
-#include <random>
 #include <iomanip>
 
 using namespace std;
@@ -18,9 +18,9 @@ namespace Model {
 // Default Constructor
 Account::Account()
     : accountId(0), userId(0), accountType(AccountType::SAVINGS),
-      balance(0.0), availableBalance(0.0), currency("EGP"),
-      status(AccountStatus::ACTIVE), dailyTransferLimit(50000.0),
-      dailyTransferred(0.0) {
+      balance(), availableBalance(), currency("EGP"),
+      status(AccountStatus::ACTIVE), dailyTransferLimit(Money::fromMajorUnits<50000>()),
+      dailyTransferred() {
     openedDate = time(nullptr);
     accountNumber = generateAccountNumber();
 }
@@ -28,21 +28,21 @@ Account::Account()
 // Parameterized Constructor
 Account::Account(long userId, AccountType type)
     : accountId(0), userId(userId), accountType(type),
-      balance(0.0), availableBalance(0.0), currency("EGP"),
-      status(AccountStatus::ACTIVE), dailyTransferred(0.0) {
+      balance(), availableBalance(), currency("EGP"),
+      status(AccountStatus::ACTIVE), dailyTransferred() {
     openedDate = time(nullptr);
     accountNumber = generateAccountNumber();
     
     // Set daily limit based on account type
     switch (type) {
         case AccountType::BUSINESS:
-            dailyTransferLimit = 200000.0;
+            dailyTransferLimit = Money::fromMajorUnits<200000>();
             break;
         case AccountType::CHECKING:
-            dailyTransferLimit = 100000.0;
+            dailyTransferLimit = Money::fromMajorUnits<100000>();
             break;
         default:
-            dailyTransferLimit = 50000.0;
+            dailyTransferLimit = Money::fromMajorUnits<50000>();
     }
 }
 
@@ -54,29 +54,30 @@ long Account::getAccountId() const { return accountId; }
 string Account::getAccountNumber() const { return accountNumber; }
 long Account::getUserId() const { return userId; }
 AccountType Account::getAccountType() const { return accountType; }
-double Account::getBalance() const { return balance; }
-double Account::getAvailableBalance() const { return availableBalance; }
+Money Account::getBalance() const { return balance; }
+Money Account::getAvailableBalance() const { return availableBalance; }
 string Account::getCurrency() const { return currency; }
 AccountStatus Account::getStatus() const { return status; }
 time_t Account::getOpenedDate() const { return openedDate; }
-double Account::getDailyTransferLimit() const { return dailyTransferLimit; }
-double Account::getDailyTransferred() const { return dailyTransferred; }
+Money Account::getDailyTransferLimit() const { return dailyTransferLimit; }
+Money Account::getDailyTransferred() const { return dailyTransferred; }
 
 // Setters
 void Account::setAccountId(long id) { accountId = id; }
 void Account::setAccountNumber(const string& number) { accountNumber = number; }
 void Account::setUserId(long id) { userId = id; }
 void Account::setAccountType(AccountType type) { accountType = type; }
-void Account::setBalance(double bal) { balance = bal; availableBalance = bal; }
-void Account::setAvailableBalance(double bal) { availableBalance = bal; }
+void Account::setBalance(const Money& bal) { balance = bal; availableBalance = bal; }
+void Account::setAvailableBalance(const Money& bal) { availableBalance = bal; }
 void Account::setCurrency(const string& curr) { currency = curr; }
 void Account::setStatus(AccountStatus s) { status = s; }
-void Account::setDailyTransferLimit(double limit) { dailyTransferLimit = limit; }
+void Account::setDailyTransferLimit(const Money& limit) { dailyTransferLimit = limit; }
 
 // Business Logic Methods
-bool Account::updateBalance(double amount) {
-    double newBalance = balance + amount;
-    if (newBalance < 0) return false;  // Insufficient funds
+bool Account::updateBalance(const Money& amount) {
+    Money newBalance = balance;
+    if (!newBalance.add(amount)) return false;      // Overflow or currency mismatch
+    if (newBalance.isNegative()) return false;       // Insufficient funds
     
     balance = newBalance;
     availableBalance = newBalance;
@@ -95,30 +96,26 @@ void Account::unfreeze() {
     status = AccountStatus::ACTIVE;
 }
 
-bool Account::canTransfer(double amount) const {
+bool Account::canTransfer(const Money& amount) const {
     if (!isActive()) return false;
     if (amount > availableBalance) return false;
-    if (dailyTransferred + amount > dailyTransferLimit) return false;
+    
+    Money projected = dailyTransferred;
+    if (!projected.add(amount) || projected > dailyTransferLimit) return false;
     return true;
 }
 
-void Account::recordDailyTransfer(double amount) {
-    dailyTransferred += amount;
+void Account::recordDailyTransfer(const Money& amount) {
+    dailyTransferred.add(amount);
 }
 
 void Account::resetDailyTransferred() {
-    dailyTransferred = 0.0;
+    dailyTransferred = Money();
 }
 
 // Static Methods
 string Account::generateAccountNumber() {
-    random_device rd;
-    mt19937 gen(rd());
-    uniform_int_distribution<long long> dis(10000000000000LL, 99999999999999LL);
-    
-    stringstream ss;
-    ss << dis(gen);
-    return ss.str();
+    return Utils::IdGenerator::nextNumber();
 }
 
 bool Account::validateAccountNumber(const string& number) {
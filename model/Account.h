@@ -11,6 +11,7 @@
 
 #include <string>
 #include <ctime>
+#include "Money.h"
 
 using namespace std;
 
@@ -36,13 +37,13 @@ private:
     string accountNumber;   // 14 digits
     long userId;                 // Link to User
     AccountType accountType;
-    double balance;
-    double availableBalance;
+    Money balance;
+    Money availableBalance;
     string currency;        // EGP
     AccountStatus status;
     time_t openedDate;
-    double dailyTransferLimit;
-    double dailyTransferred;
+    Money dailyTransferLimit;
+    Money dailyTransferred;
 
 public:
     // Constructors
@@ -57,32 +58,32 @@ public:
     string getAccountNumber() const;
     long getUserId() const;
     AccountType getAccountType() const;
-    double getBalance() const;
-    double getAvailableBalance() const;
+    Money getBalance() const;
+    Money getAvailableBalance() const;
     string getCurrency() const;
     AccountStatus getStatus() const;
     time_t getOpenedDate() const;
-    double getDailyTransferLimit() const;
-    double getDailyTransferred() const;
+    Money getDailyTransferLimit() const;
+    Money getDailyTransferred() const;
 
     // Setters
     void setAccountId(long id);
     void setAccountNumber(const string& number);
     void setUserId(long id);
     void setAccountType(AccountType type);
-    void setBalance(double bal);
-    void setAvailableBalance(double bal);
+    void setBalance(const Money& bal);
+    void setAvailableBalance(const Money& bal);
     void setCurrency(const string& curr);
     void setStatus(AccountStatus status);
-    void setDailyTransferLimit(double limit);
+    void setDailyTransferLimit(const Money& limit);
 
     // Business Logic Methods
-    bool updateBalance(double amount);
+    bool updateBalance(const Money& amount);
     bool isActive() const;
     void freeze();
     void unfreeze();
-    bool canTransfer(double amount) const;
-    void recordDailyTransfer(double amount);
+    bool canTransfer(const Money& amount) const;
+    void recordDailyTransfer(const Money& amount);
     void resetDailyTransferred();
     
     // Static methods
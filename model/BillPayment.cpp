@@ -6,9 +6,10 @@
  */
 
 #include "BillPayment.h"
+#include "../utils/Clock.h"
+#include "../utils/IdGenerator.h"
 #include <sstream>
 #include <iomanip>
-#include <random>
 
 using namespace std;
 
@@ -18,7 +19,7 @@ namespace Model {
 // Default Constructor
 BillPayment::BillPayment()
     : billId(0), accountId(0), billType(BillType::ELECTRICITY),
-      amount(0.0), status(PaymentStatus::PENDING),
+      amount(), status(PaymentStatus::PENDING),
       isScheduled(false), scheduledDate(0), isRecurring(false) {
     paymentDate = time(nullptr);
     billRef = generateBillRef();
@@ -26,7 +27,7 @@ BillPayment::BillPayment()
 
 // Parameterized Constructor
 BillPayment::BillPayment(long accountId, BillType type, const string& provider,
-                         const string& billAccount, double amount)
+                         const string& billAccount, const Money& amount)
     : billId(0), accountId(accountId), billType(type),
       serviceProvider(provider), billAccountNumber(billAccount),
       amount(amount), status(PaymentStatus::PENDING),
@@ -45,7 +46,7 @@ long BillPayment::getAccountId() const { return accountId; }
 BillType BillPayment::getBillType() const { return billType; }
 string BillPayment::getServiceProvider() const { return serviceProvider; }
 string BillPayment::getBillAccountNumber() const { return billAccountNumber; }
-double BillPayment::getAmount() const { return amount; }
+Money BillPayment::getAmount() const { return amount; }
 PaymentStatus BillPayment::getStatus() const { return status; }
 time_t BillPayment::getPaymentDate() const { return paymentDate; }
 bool BillPayment::getIsScheduled() const { return isScheduled; }
@@ -58,7 +59,7 @@ void BillPayment::setAccountId(long id) { accountId = id; }
 void BillPayment::setBillType(BillType type) { billType = type; }
 void BillPayment::setServiceProvider(const string& provider) { serviceProvider = provider; }
 void BillPayment::setBillAccountNumber(const string& account) { billAccountNumber = account; }
-void BillPayment::setAmount(double amt) { amount = amt; }
+void BillPayment::setAmount(const Money& amt) { amount = amt; }
 void BillPayment::setStatus(PaymentStatus s) { status = s; }
 void BillPayment::setScheduledDate(time_t date) { 
     scheduledDate = date; 
@@ -85,7 +86,7 @@ bool BillPayment::payBill() {
 
 bool BillPayment::validateBill() {
     if (billAccountNumber.empty()) return false;
-    if (amount <= 0) return false;
+    if (!amount.isPositive()) return false;
     if (serviceProvider.empty()) return false;
     return true;
 }
@@ -103,9 +104,8 @@ string BillPayment::generateReceipt() const {
     stringstream ss;
     ss << fixed << setprecision(2);
     
-    char dateBuffer[80];
-    struct tm* timeinfo = localtime(&paymentDate);
-    strftime(dateBuffer, 80, "%Y-%m-%d %H:%M:%S", timeinfo);
+    char dateBuffer[Utils::Clock::TIMESTAMP_LENGTH + 1];
+    Utils::Clock::formatLocal(paymentDate, dateBuffer);
     
     ss << "=========================================\n"
        << "      SMART ONLINE BANKING SYSTEM\n"
@@ -128,14 +128,7 @@ string BillPayment::generateReceipt() const {
 
 // Static Methods
 string BillPayment::generateBillRef() {
-    random_device rd;
-    mt19937 gen(rd());
-    uniform_int_distribution<> dis(100000, 999999);
-    
-    time_t now = time(nullptr);
-    stringstream ss;
-    ss << "BILL" << now << dis(gen);
-    return ss.str();
+    return Utils::IdGenerator::nextRef("BILL");
 }
 
 string BillPayment::getBillTypeString(BillType type) {
@@ -151,6 +144,21 @@ string BillPayment::getBillTypeString(BillType type) {
     }
 }
 
+bool BillPayment::parseBillType(const string& text, BillType& type) {
+    static const BillType TYPES[] = {
+        BillType::ELECTRICITY, BillType::WATER, BillType::GAS, BillType::INTERNET,
+        BillType::MOBILE, BillType::LANDLINE, BillType::CREDIT_CARD
+    };
+    for (BillType candidate : TYPES) {
+        if (text == getBillTypeString(candidate) ||
+            (candidate == BillType::CREDIT_CARD && text == "CREDIT_CARD")) {
+            type = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
 string BillPayment::getStatusString() const {
     switch (status) {
         case PaymentStatus::PENDING: return "PENDING";
@@ -11,6 +11,7 @@
 
 #include <string>
 #include <ctime>
+#include "Money.h"
 
 using namespace std;
 
@@ -42,7 +43,7 @@ private:
     BillType billType;
     string serviceProvider;
     string billAccountNumber;
-    double amount;
+    Money amount;
     PaymentStatus status;
     time_t paymentDate;
     bool isScheduled;
@@ -53,7 +54,7 @@ public:
     // Constructors
     BillPayment();
     BillPayment(long accountId, BillType type, const string& provider,
-                const string& billAccount, double amount);
+                const string& billAccount, const Money& amount);
     
     // Destructor
     ~BillPayment();
@@ -65,7 +66,7 @@ public:
     BillType getBillType() const;
     string getServiceProvider() const;
     string getBillAccountNumber() const;
-    double getAmount() const;
+    Money getAmount() const;
     PaymentStatus getStatus() const;
     time_t getPaymentDate() const;
     bool getIsScheduled() const;
@@ -78,7 +79,7 @@ public:
     void setBillType(BillType type);
     void setServiceProvider(const string& provider);
     void setBillAccountNumber(const string& account);
-    void setAmount(double amt);
+    void setAmount(const Money& amt);
     void setStatus(PaymentStatus s);
     void setScheduledDate(time_t date);
     void setIsRecurring(bool recurring);
@@ -92,6 +93,7 @@ public:
     // Static methods
     static string generateBillRef();
     static string getBillTypeString(BillType type);
+    static bool parseBillType(const string& text, BillType& type);  // "CREDIT_CARD" too
 
     // Utility
     string toString() const;
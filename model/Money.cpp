@@ -0,0 +1,192 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Model: Money.cpp
+ *
+ * Implementation of the Money value type
+ */
+
+#include "Money.h"
+#include <cmath>
+#include <limits>
+
+using namespace std;
+
+namespace SOBS {
+namespace Model {
+
+namespace {
+
+// Values below 2^52 in magnitude can be added 1024 at a time
+// without any chance of overflowing an int64
+const int64_t BLOCK_VALUE_LIMIT = int64_t(1) << 52;
+const size_t SUM_BLOCK = 1024;
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Construction and parsing
+// ---------------------------------------------------------------------------
+
+bool Money::fromDouble(double amount, Money& out, const char* currency) {
+    if (!std::isfinite(amount)) return false;
+
+    double scaled = std::round(amount * MINOR_PER_MAJOR);
+    if (scaled >= 9.2e18 || scaled <= -9.2e18) return false;
+
+    out = Money(static_cast<int64_t>(scaled), currency);
+    return true;
+}
+
+bool Money::parse(const char* text, size_t length, Money& out, const char* currency) {
+    size_t i = 0;
+    bool negative = false;
+    if (i < length && (text[i] == '-' || text[i] == '+')) {
+        negative = text[i] == '-';
+        i++;
+    }
+
+    // Accumulate as a negative number so INT64_MIN is reachable
+    int64_t units = 0;
+    int digits = 0;
+    for (; i < length && text[i] >= '0' && text[i] <= '9'; i++, digits++) {
+        if (__builtin_mul_overflow(units, int64_t(10), &units) ||
+            __builtin_sub_overflow(units, int64_t(text[i] - '0'), &units)) {
+            return false;
+        }
+    }
+
+    int decimals = 0;
+    if (i < length && text[i] == '.') {
+        i++;
+        for (; i < length && text[i] >= '0' && text[i] <= '9'; i++, digits++) {
+            if (decimals == DECIMALS) {
+                if (text[i] != '0') return false;  // Sub-piastre precision
+                continue;
+            }
+            if (__builtin_mul_overflow(units, int64_t(10), &units) ||
+                __builtin_sub_overflow(units, int64_t(text[i] - '0'), &units)) {
+                return false;
+            }
+            decimals++;
+        }
+    }
+    if (digits == 0 || i != length) return false;
+
+    for (; decimals < DECIMALS; decimals++) {
+        if (__builtin_mul_overflow(units, int64_t(10), &units)) return false;
+    }
+    if (!negative) {
+        if (units == numeric_limits<int64_t>::min()) return false;
+        units = -units;
+    }
+
+    out = Money(units, currency);
+    return true;
+}
+
+string Money::getCurrency() const {
+    char code[3] = {
+        static_cast<char>(currencyCode & 0xFF),
+        static_cast<char>((currencyCode >> 8) & 0xFF),
+        static_cast<char>((currencyCode >> 16) & 0xFF)
+    };
+    return string(code, 3);
+}
+
+// ---------------------------------------------------------------------------
+// Aggregation
+// ---------------------------------------------------------------------------
+
+bool Money::sum(const Money* values, size_t count, Money& out) {
+    if (count == 0) {
+        out = Money();
+        return true;
+    }
+
+    const uint32_t currency = values[0].currencyCode;
+    int64_t total = 0;
+    for (size_t start = 0; start < count; start += SUM_BLOCK) {
+        size_t end = start + SUM_BLOCK < count ? start + SUM_BLOCK : count;
+
+        // Branch-free pass the compiler can vectorize: wrap-around sum plus
+        // flags for out-of-range values and foreign currencies
+        uint64_t blockTotal = 0;
+        uint64_t outOfRange = 0;
+        uint32_t mixed = 0;
+        for (size_t i = start; i < end; i++) {
+            uint64_t units = static_cast<uint64_t>(values[i].minorUnits);
+            blockTotal += units;
+            outOfRange |= (units + static_cast<uint64_t>(BLOCK_VALUE_LIMIT)) >
+                          static_cast<uint64_t>(2 * BLOCK_VALUE_LIMIT);
+            mixed |= values[i].currencyCode ^ currency;
+        }
+        if (mixed != 0) return false;
+
+        if (outOfRange == 0) {
+            if (__builtin_add_overflow(total, static_cast<int64_t>(blockTotal), &total)) {
+                return false;
+            }
+            continue;
+        }
+
+        // Huge values in this block: add one by one with overflow checks
+        for (size_t i = start; i < end; i++) {
+            if (__builtin_add_overflow(total, values[i].minorUnits, &total)) {
+                return false;
+            }
+        }
+    }
+
+    out = values[0];
+    out.minorUnits = total;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Formatting
+// ---------------------------------------------------------------------------
+
+size_t Money::format(char* out) const {
+    char digits[24];
+    char* end = digits + sizeof(digits);
+    char* p = end;
+
+    uint64_t magnitude = minorUnits < 0 ? 0 - static_cast<uint64_t>(minorUnits) :
+                                          static_cast<uint64_t>(minorUnits);
+    for (int i = 0; i < DECIMALS; i++) {
+        *--p = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    }
+    *--p = '.';
+    do {
+        *--p = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (minorUnits < 0) {
+        *--p = '-';
+    }
+
+    size_t length = static_cast<size_t>(end - p);
+    for (size_t i = 0; i < length; i++) {
+        out[i] = p[i];
+    }
+    out[length] = '\0';
+    return length;
+}
+
+string Money::toString() const {
+    char buffer[MAX_TEXT_LENGTH];
+    return string(buffer, format(buffer));
+}
+
+string Money::toDisplayString() const {
+    return toString() + " " + getCurrency();
+}
+
+ostream& operator<<(ostream& os, const Money& money) {
+    char buffer[Money::MAX_TEXT_LENGTH];
+    return os.write(buffer, static_cast<streamsize>(money.format(buffer)));
+}
+
+} // namespace Model
+} // namespace SOBS
@@ -0,0 +1,177 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Model: Money.h
+ *
+ * Fixed-point money value: an int64 count of minor units (piastres for
+ * EGP) plus a 3-letter currency code.
+ * Part of the MVC Architecture - Model Layer
+ *
+ * - Arithmetic is checked: add/subtract/multiply/negate and the
+ *   fromMajorUnits() conversion return false on overflow or currency
+ *   mismatch and leave the value unchanged. Literal amounts use
+ *   fromMajorUnits<N>(), which is range-checked at compile time.
+ * - parse() reads decimal text exactly ("1500.5" -> 150050 piastres);
+ *   format() writes "1500.50" without printf or streams.
+ * - sum() adds whole arrays as plain integer adds in overflow-safe blocks.
+ */
+
+#ifndef MONEY_H
+#define MONEY_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <ostream>
+
+using namespace std;
+
+namespace SOBS {
+namespace Model {
+
+class Money {
+public:
+    static const int DECIMALS = 2;
+    static const int64_t MINOR_PER_MAJOR = 100;
+    static const size_t MAX_TEXT_LENGTH = 24;   // Longest format() output + NUL
+
+private:
+    int64_t minorUnits;
+    uint32_t currencyCode;   // Three ASCII letters, packed
+
+    static constexpr uint32_t packCurrency(const char* code) {
+        return static_cast<uint32_t>(static_cast<unsigned char>(code[0])) |
+               static_cast<uint32_t>(static_cast<unsigned char>(code[1])) << 8 |
+               static_cast<uint32_t>(static_cast<unsigned char>(code[2])) << 16;
+    }
+
+public:
+    // Constructors
+    Money() : minorUnits(0), currencyCode(packCurrency("EGP")) {}
+    explicit Money(int64_t minorUnits, const char* currency = "EGP")
+        : minorUnits(minorUnits), currencyCode(packCurrency(currency)) {}
+
+    static Money fromMinorUnits(int64_t units, const char* currency = "EGP") {
+        return Money(units, currency);
+    }
+    static bool fromMajorUnits(int64_t units, Money& out, const char* currency = "EGP") {
+        int64_t minor;
+        if (__builtin_mul_overflow(units, MINOR_PER_MAJOR, &minor)) {
+            return false;
+        }
+        out = Money(minor, currency);
+        return true;
+    }
+    template <int64_t UNITS>
+    static Money fromMajorUnits(const char* currency = "EGP") {
+        static_assert(UNITS <= INT64_MAX / MINOR_PER_MAJOR && UNITS >= INT64_MIN / MINOR_PER_MAJOR,
+                      "amount out of range");
+        return Money(UNITS * MINOR_PER_MAJOR, currency);
+    }
+
+    /**
+     * Round a double to the nearest minor unit. Returns false for NaN,
+     * infinity or values outside the int64 range.
+     */
+    static bool fromDouble(double amount, Money& out, const char* currency = "EGP");
+
+    /**
+     * Parse decimal text: optional sign, digits, optional '.' and up to two
+     * decimals (further digits must be zeros). No exponents, no separators.
+     */
+    static bool parse(const char* text, size_t length, Money& out,
+                      const char* currency = "EGP");
+    static bool parse(const string& text, Money& out, const char* currency = "EGP") {
+        return parse(text.data(), text.size(), out, currency);
+    }
+
+    // Getters
+    int64_t getMinorUnits() const { return minorUnits; }
+    string getCurrency() const;
+    bool sameCurrency(const Money& other) const { return currencyCode == other.currencyCode; }
+    double toDouble() const { return static_cast<double>(minorUnits) / MINOR_PER_MAJOR; }
+
+    bool isZero() const { return minorUnits == 0; }
+    bool isPositive() const { return minorUnits > 0; }
+    bool isNegative() const { return minorUnits < 0; }
+
+    // Checked arithmetic
+    bool add(const Money& other) {
+        int64_t result;
+        if (!sameCurrency(other) || __builtin_add_overflow(minorUnits, other.minorUnits, &result)) {
+            return false;
+        }
+        minorUnits = result;
+        return true;
+    }
+    bool subtract(const Money& other) {
+        int64_t result;
+        if (!sameCurrency(other) || __builtin_sub_overflow(minorUnits, other.minorUnits, &result)) {
+            return false;
+        }
+        minorUnits = result;
+        return true;
+    }
+    bool multiply(int64_t factor) {
+        int64_t result;
+        if (__builtin_mul_overflow(minorUnits, factor, &result)) {
+            return false;
+        }
+        minorUnits = result;
+        return true;
+    }
+    bool negate() {
+        int64_t result;
+        if (__builtin_sub_overflow(int64_t(0), minorUnits, &result)) {
+            return false;
+        }
+        minorUnits = result;
+        return true;
+    }
+
+    /**
+     * Exact total of 'count' values of one currency. Returns false on
+     * overflow or mixed currencies. An empty range sums to zero EGP.
+     */
+    static bool sum(const Money* values, size_t count, Money& out);
+    static bool sum(const vector<Money>& values, Money& out) {
+        return sum(values.data(), values.size(), out);
+    }
+
+    /**
+     * Write "1500.50" / "-0.25" into 'out' (MAX_TEXT_LENGTH bytes).
+     * Returns the length.
+     */
+    size_t format(char* out) const;
+    string toString() const;             // "1500.50"
+    string toDisplayString() const;      // "1500.50 EGP"
+
+    // Comparisons check the currency too: values of different currencies
+    // are unequal and unordered, so every ordering comparison is false
+    bool operator==(const Money& other) const {
+        return sameCurrency(other) && minorUnits == other.minorUnits;
+    }
+    bool operator!=(const Money& other) const { return !(*this == other); }
+    bool operator<(const Money& other) const {
+        return sameCurrency(other) && minorUnits < other.minorUnits;
+    }
+    bool operator<=(const Money& other) const {
+        return sameCurrency(other) && minorUnits <= other.minorUnits;
+    }
+    bool operator>(const Money& other) const {
+        return sameCurrency(other) && minorUnits > other.minorUnits;
+    }
+    bool operator>=(const Money& other) const {
+        return sameCurrency(other) && minorUnits >= other.minorUnits;
+    }
+};
+
+/**
+ * Streams the amount as format() does, e.g. "1500.50"
+ */
+ostream& operator<<(ostream& os, const Money& money);
+
+} // namespace Model
+} // namespace SOBS
+
+#endif // MONEY_H
@@ -6,9 +6,10 @@
  */
 
 #include "Transaction.h"
+#include "../utils/Clock.h"
+#include "../utils/IdGenerator.h"
 #include <sstream>
 #include <iomanip>
-#include <random>
 #include <ctime>
 
 using namespace std;
@@ -19,19 +20,19 @@ namespace Model {
 // Default Constructor
 Transaction::Transaction()
     : transactionId(0), accountId(0), type(TransactionType::DEBIT),
-      category(TransactionCategory::TRANSFER), amount(0.0),
-      status(TransactionStatus::PENDING), balanceAfter(0.0) {
+      category(TransactionCategory::TRANSFER), amount(),
+      status(TransactionStatus::PENDING), balanceAfter() {
     transactionDate = time(nullptr);
     transactionRef = generateTransactionRef();
 }
 
 // Parameterized Constructor
 Transaction::Transaction(long accountId, TransactionType type, 
-                         double amount, const string& description)
+                         const Money& amount, const string& description)
     : transactionId(0), accountId(accountId), type(type),
       category(TransactionCategory::TRANSFER), amount(amount),
       description(description), status(TransactionStatus::PENDING),
-      balanceAfter(0.0) {
+      balanceAfter() {
     transactionDate = time(nullptr);
     transactionRef = generateTransactionRef();
 }
@@ -45,12 +46,12 @@ string Transaction::getTransactionRef() const { return transactionRef; }
 long Transaction::getAccountId() const { return accountId; }
 TransactionType Transaction::getType() const { return type; }
 TransactionCategory Transaction::getCategory() const { return category; }
-double Transaction::getAmount() const { return amount; }
+Money Transaction::getAmount() const { return amount; }
 string Transaction::getDescription() const { return description; }
 TransactionStatus Transaction::getStatus() const { return status; }
 time_t Transaction::getTransactionDate() const { return transactionDate; }
 string Transaction::getReferenceNumber() const { return referenceNumber; }
-double Transaction::getBalanceAfter() const { return balanceAfter; }
+Money Transaction::getBalanceAfter() const { return balanceAfter; }
 
 // Setters
 void Transaction::setTransactionId(long id) { transactionId = id; }
@@ -58,15 +59,16 @@ void Transaction::setTransactionRef(const string& ref) { transactionRef = ref; }
 void Transaction::setAccountId(long id) { accountId = id; }
 void Transaction::setType(TransactionType t) { type = t; }
 void Transaction::setCategory(TransactionCategory cat) { category = cat; }
-void Transaction::setAmount(double amt) { amount = amt; }
+void Transaction::setAmount(const Money& amt) { amount = amt; }
 void Transaction::setDescription(const string& desc) { description = desc; }
 void Transaction::setStatus(TransactionStatus s) { status = s; }
 void Transaction::setReferenceNumber(const string& ref) { referenceNumber = ref; }
-void Transaction::setBalanceAfter(double bal) { balanceAfter = bal; }
+void Transaction::setBalanceAfter(const Money& bal) { balanceAfter = bal; }
+void Transaction::setTransactionDate(time_t date) { transactionDate = date; }
 
 // Business Logic
 bool Transaction::processTransaction() {
-    if (amount <= 0) {
+    if (!amount.isPositive()) {
         status = TransactionStatus::FAILED;
         return false;
     }
@@ -121,14 +123,7 @@ string Transaction::generateReceipt() const {
 
 // Static Methods
 string Transaction::generateTransactionRef() {
-    random_device rd;
-    mt19937 gen(rd());
-    uniform_int_distribution<> dis(100000, 999999);
-    
-    time_t now = time(nullptr);
-    stringstream ss;
-    ss << "TXN" << now << dis(gen);
-    return ss.str();
+    return Utils::IdGenerator::nextRef("TXN");
 }
 
 string Transaction::getTypeString() const {
@@ -136,6 +131,10 @@ string Transaction::getTypeString() const {
 }
 
 string Transaction::getCategoryString() const {
+    return categoryName(category);
+}
+
+const char* Transaction::categoryName(TransactionCategory category) {
     switch (category) {
         case TransactionCategory::TRANSFER: return "TRANSFER";
         case TransactionCategory::BILL_PAYMENT: return "BILL_PAYMENT";
@@ -159,10 +158,7 @@ string Transaction::getStatusString() const {
 }
 
 string Transaction::getFormattedDate() const {
-    char buffer[80];
-    struct tm* timeinfo = localtime(&transactionDate);
-    strftime(buffer, 80, "%Y-%m-%d %H:%M:%S", timeinfo);
-    return string(buffer);
+    return Utils::Clock::formatLocal(transactionDate);
 }
 
 string Transaction::toString() const {
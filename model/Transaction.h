@@ -11,6 +11,7 @@
 
 #include <string>
 #include <ctime>
+#include "Money.h"
 
 using namespace std;
 
@@ -42,21 +43,21 @@ enum class TransactionStatus {
 class Transaction {
 private:
     long transactionId;
-    string transactionRef;      // TXN + timestamp + random
+    string transactionRef;      // TXN + 19-digit time-ordered id
     long accountId;
     TransactionType type;
     TransactionCategory category;
-    double amount;
+    Money amount;
     string description;
     TransactionStatus status;
     time_t transactionDate;
     string referenceNumber;
-    double balanceAfter;
+    Money balanceAfter;
 
 public:
     // Constructors
     Transaction();
-    Transaction(long accountId, TransactionType type, double amount, 
+    Transaction(long accountId, TransactionType type, const Money& amount, 
                 const string& description);
     
     // Destructor
@@ -68,12 +69,12 @@ public:
     long getAccountId() const;
     TransactionType getType() const;
     TransactionCategory getCategory() const;
-    double getAmount() const;
+    Money getAmount() const;
     string getDescription() const;
     TransactionStatus getStatus() const;
     time_t getTransactionDate() const;
     string getReferenceNumber() const;
-    double getBalanceAfter() const;
+    Money getBalanceAfter() const;
 
     // Setters
     void setTransactionId(long id);
@@ -81,11 +82,12 @@ public:
     void setAccountId(long id);
     void setType(TransactionType t);
     void setCategory(TransactionCategory cat);
-    void setAmount(double amt);
+    void setAmount(const Money& amt);
     void setDescription(const string& desc);
     void setStatus(TransactionStatus s);
     void setReferenceNumber(const string& ref);
-    void setBalanceAfter(double bal);
+    void setBalanceAfter(const Money& bal);
+    void setTransactionDate(time_t date);
 
     // Business Logic
     bool processTransaction();
@@ -95,6 +97,7 @@ public:
 
     // Static methods
     static string generateTransactionRef();
+    static const char* categoryName(TransactionCategory category);
     
     // Utility
     string toString() const;
@@ -6,9 +6,10 @@
  */
 
 #include "Transfer.h"
+#include "../utils/Clock.h"
+#include "../utils/IdGenerator.h"
 #include <sstream>
 #include <iomanip>
-#include <random>
 
 using namespace std;
 
@@ -17,7 +18,7 @@ namespace Model {
 
 // Default Constructor
 Transfer::Transfer()
-    : transferId(0), senderAccountId(0), amount(0.0),
+    : transferId(0), senderAccountId(0), amount(),
       transferType(TransferType::INTRA_BANK),
       status(TransferStatus::PENDING), scheduledDate(0),
       requiresOTP(false), completedAt(0) {
@@ -27,7 +28,7 @@ Transfer::Transfer()
 
 // Parameterized Constructor
 Transfer::Transfer(long senderAccountId, const string& recipientAccount,
-                   double amount, const string& description)
+                   const Money& amount, const string& description)
     : transferId(0), senderAccountId(senderAccountId),
       recipientAccountNumber(recipientAccount), amount(amount),
       description(description), transferType(TransferType::INTRA_BANK),
@@ -35,8 +36,7 @@ Transfer::Transfer(long senderAccountId, const string& recipientAccount,
     initiatedAt = time(nullptr);
     transferRef = generateTransferRef();
     
-    // Require OTP for transfers above 5000 EGP
-    requiresOTP = (amount > 5000.0);
+    requiresOTP = requiresOTPFor(amount);
 }
 
 // Destructor
@@ -50,7 +50,7 @@ string Transfer::getSenderAccountNumber() const { return senderAccountNumber; }
 string Transfer::getRecipientAccountNumber() const { return recipientAccountNumber; }
 string Transfer::getRecipientName() const { return recipientName; }
 string Transfer::getRecipientBank() const { return recipientBank; }
-double Transfer::getAmount() const { return amount; }
+Money Transfer::getAmount() const { return amount; }
 string Transfer::getDescription() const { return description; }
 TransferType Transfer::getTransferType() const { return transferType; }
 TransferStatus Transfer::getStatus() const { return status; }
@@ -72,9 +72,9 @@ void Transfer::setRecipientBank(const string& bank) {
         transferType = TransferType::INTER_BANK;
     }
 }
-void Transfer::setAmount(double amt) { 
+void Transfer::setAmount(const Money& amt) { 
     amount = amt;
-    requiresOTP = (amt > 5000.0);
+    requiresOTP = requiresOTPFor(amt);
 }
 void Transfer::setDescription(const string& desc) { description = desc; }
 void Transfer::setTransferType(TransferType type) { transferType = type; }
@@ -118,19 +118,6 @@ bool Transfer::scheduleTransfer(time_t date) {
     return true;
 }
 
-bool Transfer::processTransfer() {
-    if (status == TransferStatus::PENDING_OTP) {
-        return false;  // Need OTP verification first
-    }
-    
-    // In real implementation:
-    // 1. Deduct from sender account
-    // 2. Credit to recipient account
-    // 3. Create transaction records
-    
-    return complete();
-}
-
 bool Transfer::complete() {
     completedAt = time(nullptr);
     status = TransferStatus::COMPLETED;
@@ -173,18 +160,15 @@ string Transfer::generateReceipt() const {
 
 // Static Methods
 string Transfer::generateTransferRef() {
-    random_device rd;
-    mt19937 gen(rd());
-    uniform_int_distribution<> dis(100000, 999999);
-    
-    time_t now = time(nullptr);
-    stringstream ss;
-    ss << "TRF" << now << dis(gen);
-    return ss.str();
+    return Utils::IdGenerator::nextRef("TRF");
+}
+
+bool Transfer::validateAmount(const Money& amount) {
+    return amount.isPositive() && amount <= Money::fromMajorUnits<200000>();  // Max single transfer
 }
 
-bool Transfer::validateAmount(double amount) {
-    return amount > 0 && amount <= 200000;  // Max single transfer
+bool Transfer::requiresOTPFor(const Money& amount) {
+    return amount > Money::fromMajorUnits<5000>();
 }
 
 string Transfer::getTypeString() const {
@@ -204,10 +188,7 @@ string Transfer::getStatusString() const {
 }
 
 string Transfer::getFormattedDate(time_t t) const {
-    char buffer[80];
-    struct tm* timeinfo = localtime(&t);
-    strftime(buffer, 80, "%Y-%m-%d %H:%M:%S", timeinfo);
-    return string(buffer);
+    return Utils::Clock::formatLocal(t);
 }
 
 string Transfer::toString() const {
@@ -11,6 +11,7 @@
 
 #include <string>
 #include <ctime>
+#include "Money.h"
 
 using namespace std;
 
@@ -34,13 +35,13 @@ enum class TransferStatus {
 class Transfer {
 private:
     long transferId;
-    string transferRef;         // TRF + timestamp + random
+    string transferRef;         // TRF + 19-digit time-ordered id
     long senderAccountId;
     string senderAccountNumber;
     string recipientAccountNumber;
     string recipientName;
     string recipientBank;
-    double amount;
+    Money amount;
     string description;
     TransferType transferType;
     TransferStatus status;
@@ -53,7 +54,7 @@ public:
     // Constructors
     Transfer();
     Transfer(long senderAccountId, const string& recipientAccount, 
-             double amount, const string& description);
+             const Money& amount, const string& description);
     
     // Destructor
     ~Transfer();
@@ -66,7 +67,7 @@ public:
     string getRecipientAccountNumber() const;
     string getRecipientName() const;
     string getRecipientBank() const;
-    double getAmount() const;
+    Money getAmount() const;
     string getDescription() const;
     TransferType getTransferType() const;
     TransferStatus getStatus() const;
@@ -83,7 +84,7 @@ public:
     void setRecipientAccountNumber(const string& num);
     void setRecipientName(const string& name);
     void setRecipientBank(const string& bank);
-    void setAmount(double amt);
+    void setAmount(const Money& amt);
     void setDescription(const string& desc);
     void setTransferType(TransferType type);
     void setStatus(TransferStatus s);
@@ -94,13 +95,13 @@ public:
     bool initiateTransfer();
     bool validateRecipient();
     bool scheduleTransfer(time_t date);
-    bool processTransfer();
     bool complete();
     string generateReceipt() const;
 
     // Static methods
     static string generateTransferRef();
-    static bool validateAmount(double amount);
+    static bool validateAmount(const Money& amount);
+    static bool requiresOTPFor(const Money& amount);     // Above 5,000 EGP
 
     // Utility
     string toString() const;
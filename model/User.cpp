@@ -6,16 +6,48 @@
  */
 
 #include "User.h"
+#include "../utils/IdGenerator.h"
+#include "../utils/PasswordHasher.h"
 #include <sstream>
 #include <iomanip>
-#include <regex>
-#include <random>
+#include <cstdint>
 
 using namespace std;
 
 namespace SOBS {
 namespace Model {
 
+namespace {
+
+// Character classes for the validators, built at compile time
+enum : uint8_t {
+    EMAIL_LOCAL = 1,    // [a-zA-Z0-9._%+-]
+    EMAIL_DOMAIN = 2,   // [a-zA-Z0-9.-]
+    ALPHA = 4,          // [a-zA-Z]
+    DIGIT = 8           // [0-9]
+};
+
+struct CharClassTable {
+    uint8_t bits[256];
+    
+    constexpr CharClassTable() : bits{} {
+        for (int c = 0; c < 256; c++) {
+            bool alpha = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+            bool digit = c >= '0' && c <= '9';
+            uint8_t cls = 0;
+            if (alpha) cls |= ALPHA;
+            if (digit) cls |= DIGIT;
+            if (alpha || digit || c == '.' || c == '-') cls |= EMAIL_LOCAL | EMAIL_DOMAIN;
+            if (c == '_' || c == '%' || c == '+') cls |= EMAIL_LOCAL;
+            bits[c] = cls;
+        }
+    }
+};
+
+constexpr CharClassTable charClasses;
+
+} // namespace
+
 // Default Constructor
 User::User() 
     : userId(0), status(UserStatus::PENDING_VERIFICATION), 
@@ -68,9 +100,9 @@ void User::setLastLoginAt(time_t t) { lastLoginAt = t; }
 
 // Business Logic Methods
 bool User::validatePassword(const string& password) const {
-    // In real implementation, would use bcrypt to compare
-    // This is a simplified version for demonstration
-    return !passwordHash.empty() && password.length() >= 8;
+    // Blocks for the whole derivation; request paths check on the
+    // password-hashing pool instead
+    return Utils::PasswordHasher::verifyNow(password, passwordHash);
 }
 
 bool User::isActive() const {
@@ -153,14 +185,47 @@ bool User::validateNationalId(const string& nid) {
 }
 
 bool User::validateEmail(const string& email) {
-    regex pattern(R"([a-zA-Z0-9._%+-]+@[a-zA-Z0-9.-]+\.[a-zA-Z]{2,})");
-    return regex_match(email, pattern);
+    // Same language as [a-zA-Z0-9._%+-]+@[a-zA-Z0-9.-]+\.[a-zA-Z]{2,}
+    // in one pass: the domain must end in a dot followed by 2+ letters
+    size_t at = string::npos;
+    size_t lastDot = string::npos;
+    int lettersAfterDot = -1;   // -1: something other than a letter followed the last dot
+    
+    for (size_t i = 0; i < email.size(); i++) {
+        unsigned char c = static_cast<unsigned char>(email[i]);
+        uint8_t cls = charClasses.bits[c];
+        if (at == string::npos) {
+            if (c == '@') {
+                if (i == 0) return false;
+                at = i;
+            } else if (!(cls & EMAIL_LOCAL)) {
+                return false;
+            }
+            continue;
+        }
+        if (!(cls & EMAIL_DOMAIN)) return false;
+        if (c == '.') {
+            lastDot = i;
+            lettersAfterDot = 0;
+        } else if ((cls & ALPHA) && lettersAfterDot >= 0) {
+            lettersAfterDot++;
+        } else {
+            lettersAfterDot = -1;
+        }
+    }
+    
+    return at != string::npos && lastDot != string::npos &&
+           lastDot >= at + 2 && lettersAfterDot >= 2;
 }
 
 bool User::validatePhoneNumber(const string& phone) {
     // Egyptian phone number: +20 followed by 10 digits
-    regex pattern(R"(\+20[0-9]{10})");
-    return regex_match(phone, pattern);
+    if (phone.size() != 13 || phone.compare(0, 3, "+20") != 0) return false;
+    
+    for (size_t i = 3; i < phone.size(); i++) {
+        if (!(charClasses.bits[static_cast<unsigned char>(phone[i])] & DIGIT)) return false;
+    }
+    return true;
 }
 
 bool User::validatePasswordStrength(const string& password) {
@@ -178,16 +243,28 @@ bool User::validatePasswordStrength(const string& password) {
     return hasUpper && hasLower && hasDigit && hasSpecial;
 }
 
-string User::generateCustomerId() {
-    random_device rd;
-    mt19937 gen(rd());
-    uniform_int_distribution<> dis(100000000, 999999999);
-    
+string User::formatRef(long userId) {
     stringstream ss;
-    ss << "CUS" << dis(gen);
+    ss << "USR" << setw(3) << setfill('0') << userId;
     return ss.str();
 }
 
+long User::idFromRef(const string& userRef) {
+    if (userRef.size() < 4 || userRef.size() > 21 || userRef.compare(0, 3, "USR") != 0) {
+        return 0;
+    }
+    long id = 0;
+    for (size_t i = 3; i < userRef.size(); i++) {
+        if (userRef[i] < '0' || userRef[i] > '9') return 0;
+        id = id * 10 + (userRef[i] - '0');
+    }
+    return id;
+}
+
+string User::generateCustomerId() {
+    return "CUS" + Utils::IdGenerator::nextNumber();
+}
+
 string User::toString() const {
     stringstream ss;
     ss << "User{" 
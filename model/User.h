@@ -34,7 +34,7 @@ enum class UserRole {
 class User {
 private:
     long userId;
-    string customerId;      // CUS123456789
+    string customerId;      // CUS + 14 digits
     string nationalId;      // Egyptian National ID (14 digits)
     string fullName;
     string email;
@@ -103,6 +103,10 @@ public:
     static bool validatePhoneNumber(const string& phone);
     static bool validatePasswordStrength(const string& password);
 
+    // API user IDs: "USR001" <-> 1; idFromRef() is 0 for anything else
+    static string formatRef(long userId);
+    static long idFromRef(const string& userRef);
+
     // Utility
     string toString() const;
     string generateCustomerId();
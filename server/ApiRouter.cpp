@@ -0,0 +1,452 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Server: ApiRouter.cpp
+ *
+ * Route table for the REST API
+ */
+
+#include "ApiRouter.h"
+#include "../model/User.h"
+#include "../utils/DatabaseConnection.h"
+#include "../utils/Clock.h"
+#include <cstdlib>
+
+using namespace std;
+
+namespace SOBS {
+namespace Server {
+
+namespace {
+
+const string API_PREFIX = "/api/v1/";
+
+// Exact amount from a JSON number or numeric string; zero (rejected by
+// the controllers' amount checks) if it is missing or malformed
+Model::Money amountFrom(const Utils::JsonValue& value) {
+    Model::Money amount;
+    Model::Money::parse(value.getText(), amount);
+    return amount;
+}
+
+Controller::RegistrationRequest registrationFromJson(const Utils::JsonValue& body) {
+    Controller::RegistrationRequest registration;
+    registration.nationalId = body.getString("nationalId");
+    registration.fullName = body.getString("fullName");
+    registration.email = body.getString("email");
+    registration.phoneNumber = body.getString("phoneNumber");
+    registration.password = body.getString("password");
+    registration.bankAccountNumber = body.getString("bankAccountNumber");
+    return registration;
+}
+
+Controller::LoginRequest loginFromJson(const HttpRequest& request, const Utils::JsonValue& body) {
+    Controller::LoginRequest login;
+    login.email = body.getString("email");
+    login.password = body.getString("password");
+    login.clientAddress = request.remoteAddress;
+    return login;
+}
+
+} // namespace
+
+ApiRouter::ApiRouter() {}
+
+ApiRouter::~ApiRouter() {}
+
+HttpResponse ApiRouter::handle(const HttpRequest& request) {
+    if (request.path.compare(0, API_PREFIX.size(), API_PREFIX) != 0) {
+        return notFound();
+    }
+
+    vector<string> segments = splitPath(request.path.substr(API_PREFIX.size()));
+    if (segments.empty()) {
+        return notFound();
+    }
+
+    Utils::JsonValue body = Utils::JsonValue::makeObject();
+    if (!request.body.empty() && !Utils::JsonValue::parse(request.body, body)) {
+        return HttpResponse(400, View::JsonResponseBuilder::buildErrorResponse(
+            "Request body is not valid JSON", "ERR_INVALID_JSON"));
+    }
+
+    const string& resource = segments[0];
+    if (resource == "auth") {
+        return routeAuth(request, segments, body);
+    }
+
+    string userId = resolveUserId(request);
+    if (resource == "accounts") {
+        return routeAccounts(request, segments, userId);
+    }
+    if (resource == "transfers") {
+        return routeTransfers(request, segments, body, userId);
+    }
+    if (resource == "beneficiaries") {
+        return routeBeneficiaries(request, segments, body, userId);
+    }
+    if (resource == "bills") {
+        return routeBills(request, segments, body, userId);
+    }
+    return notFound();
+}
+
+void ApiRouter::dispatch(const HttpRequest& request, HttpServer::Responder respond) {
+    bool login = request.path == API_PREFIX + "auth/login";
+    bool reset = request.path == API_PREFIX + "auth/reset-password";
+    Utils::JsonValue body = Utils::JsonValue::makeObject();
+    if (request.method != "POST" || (!login && !reset) ||
+        (!request.body.empty() && !Utils::JsonValue::parse(request.body, body))) {
+        respond(handle(request));
+        return;
+    }
+
+    auto done = [respond](const string& json) {
+        respond(fromControllerResult(json));
+    };
+    if (login) {
+        authController.login(loginFromJson(request, body), done);
+    } else {
+        authController.resetPassword(body.getString("token"), body.getString("newPassword"), done);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// /api/v1/auth/*
+// ---------------------------------------------------------------------------
+
+HttpResponse ApiRouter::routeAuth(const HttpRequest& request, const vector<string>& segments,
+                                  const Utils::JsonValue& body) {
+    bool bulkValidate = segments.size() == 3 && segments[1] == "register" &&
+                        segments[2] == "validate";
+    if (segments.size() != 2 && !bulkValidate) {
+        return notFound();
+    }
+    if (request.method != "POST") {
+        return methodNotAllowed();
+    }
+
+    const string& action = segments[1];
+    if (bulkValidate) {
+        // Body: {"registrations": [ {registration}, ... ]}
+        const vector<Utils::JsonValue>& items = body.get("registrations").getElements();
+        vector<Controller::RegistrationRequest> registrations;
+        registrations.reserve(items.size());
+        for (const Utils::JsonValue& item : items) {
+            registrations.push_back(registrationFromJson(item));
+        }
+        return fromControllerResult(authController.validateRegistrationBatch(registrations));
+    }
+    if (action == "register") {
+        return fromControllerResult(authController.registerUser(registrationFromJson(body)));
+    }
+    if (action == "login") {
+        return fromControllerResult(authController.login(loginFromJson(request, body)));
+    }
+    if (action == "verify-otp") {
+        Controller::OTPRequest otp;
+        otp.sessionId = body.getString("sessionId");
+        otp.otp = body.getString("otp");
+        return fromControllerResult(authController.verifyOTP(otp));
+    }
+    if (action == "logout") {
+        string token = bearerToken(request);
+        if (token.empty()) {
+            token = body.getString("sessionToken");
+        }
+        return fromControllerResult(authController.logout(token));
+    }
+    if (action == "forgot-password") {
+        return fromControllerResult(authController.forgotPassword(body.getString("email")));
+    }
+    if (action == "reset-password") {
+        return fromControllerResult(authController.resetPassword(
+            body.getString("token"), body.getString("newPassword")));
+    }
+    return notFound();
+}
+
+// ---------------------------------------------------------------------------
+// /api/v1/accounts/*
+// ---------------------------------------------------------------------------
+
+HttpResponse ApiRouter::routeAccounts(const HttpRequest& request, const vector<string>& segments,
+                                      const string& userId) {
+    if (request.method != "GET") {
+        return methodNotAllowed();
+    }
+
+    if (segments.size() == 1) {
+        return fromControllerResult(accountController.getAccounts(userId));
+    }
+    if (segments.size() == 2 && segments[1] == "summary") {
+        return fromControllerResult(accountController.getAccountSummary(userId));
+    }
+    if (segments.size() != 3) {
+        return notFound();
+    }
+
+    const string& accountNumber = segments[1];
+    const string& action = segments[2];
+    if (action == "balance") {
+        return fromControllerResult(accountController.getBalance(userId, accountNumber));
+    }
+    if (action == "transactions") {
+        Controller::TransactionFilter filter;
+        filter.startDate = request.getQueryParam("startDate");
+        filter.endDate = request.getQueryParam("endDate");
+        filter.transactionType = request.getQueryParam("type");
+        if (filter.transactionType.empty()) {
+            filter.transactionType = "ALL";
+        }
+        Model::Money::parse(request.getQueryParam("minAmount"), filter.minAmount);
+        Model::Money::parse(request.getQueryParam("maxAmount"), filter.maxAmount);
+        filter.category = request.getQueryParam("category");
+        filter.searchTerm = request.getQueryParam("search");
+        filter.cursor = request.getQueryParam("cursor");
+        filter.pageSize = atoi(request.getQueryParam("pageSize").c_str());
+        return fromControllerResult(
+            accountController.getTransactions(userId, accountNumber, filter));
+    }
+    if (action == "analytics") {
+        return fromControllerResult(accountController.getSpendingAnalytics(
+            userId, accountNumber, request.getQueryParam("period")));
+    }
+    if (action == "statement") {
+        string format = request.getQueryParam("format");
+        if (format == "CSV") {
+            // HttpServer sends whole responses, so the chunks are collected
+            // into the body here
+            string month = request.getQueryParam("month");
+            HttpResponse response(200, "", "text/csv; charset=utf-8");
+            string errorJson;
+            if (!accountController.writeStatementCsv(
+                    userId, accountNumber, month,
+                    [&response](const char* data, size_t length) {
+                        response.body.append(data, length);
+                        return true;
+                    },
+                    errorJson)) {
+                return fromControllerResult(errorJson);
+            }
+            response.headers.emplace_back("Content-Disposition",
+                "attachment; filename=\"statement-" + accountNumber +
+                (month.empty() ? string() : "-" + month) + ".csv\"");
+            return response;
+        }
+        return fromControllerResult(accountController.getStatement(
+            userId, accountNumber, request.getQueryParam("month"),
+            format.empty() ? "PDF" : format));
+    }
+    return notFound();
+}
+
+// ---------------------------------------------------------------------------
+// /api/v1/transfers/* and /api/v1/beneficiaries/*
+// ---------------------------------------------------------------------------
+
+HttpResponse ApiRouter::routeTransfers(const HttpRequest& request, const vector<string>& segments,
+                                       const Utils::JsonValue& body, const string& userId) {
+    if (segments.size() == 1) {
+        if (request.method != "POST") {
+            return methodNotAllowed();
+        }
+        Controller::TransferRequest transfer;
+        transfer.senderAccountNumber = body.getString("senderAccountNumber");
+        transfer.recipientAccountNumber = body.getString("recipientAccountNumber");
+        transfer.recipientBank = body.getString("recipientBank");
+        transfer.amount = amountFrom(body.get("amount"));
+        transfer.description = body.getString("description");
+        transfer.scheduledDate = body.getString("scheduledDate");
+        return fromControllerResult(transferController.initiateTransfer(userId, transfer));
+    }
+
+    const string& transferId = segments[1];
+    if (segments.size() == 2 && transferId == "batch") {
+        if (request.method != "POST") {
+            return methodNotAllowed();
+        }
+        // Body: {"senderAccountNumber": default, "transfers": [ {transfer}, ... ]}
+        string defaultSender = body.getString("senderAccountNumber");
+        const vector<Utils::JsonValue>& items = body.get("transfers").getElements();
+        vector<Controller::TransferRequest> transfers(items.size());
+        for (size_t i = 0; i < items.size(); i++) {
+            Controller::TransferRequest& transfer = transfers[i];
+            transfer.senderAccountNumber = items[i].getString("senderAccountNumber", defaultSender);
+            transfer.recipientAccountNumber = items[i].getString("recipientAccountNumber");
+            transfer.recipientBank = items[i].getString("recipientBank");
+            transfer.amount = amountFrom(items[i].get("amount"));
+            transfer.description = items[i].getString("description");
+        }
+        return fromControllerResult(transferController.executeBatchTransfer(userId, transfers));
+    }
+    if (segments.size() == 2) {
+        if (request.method == "GET") {
+            return fromControllerResult(transferController.getTransfer(userId, transferId));
+        }
+        if (request.method == "DELETE") {
+            return fromControllerResult(transferController.cancelTransfer(userId, transferId));
+        }
+        return methodNotAllowed();
+    }
+    if (segments.size() == 3 && segments[2] == "verify") {
+        if (request.method != "POST") {
+            return methodNotAllowed();
+        }
+        return fromControllerResult(
+            transferController.verifyTransfer(userId, transferId, body.getString("otp")));
+    }
+    return notFound();
+}
+
+HttpResponse ApiRouter::routeBeneficiaries(const HttpRequest& request,
+                                           const vector<string>& segments,
+                                           const Utils::JsonValue& body,
+                                           const string& userId) {
+    if (segments.size() == 1) {
+        if (request.method == "GET") {
+            return fromControllerResult(transferController.getBeneficiaries(userId));
+        }
+        if (request.method == "POST") {
+            return fromControllerResult(transferController.saveBeneficiary(
+                userId, body.getString("accountNumber"), body.getString("name"),
+                body.getString("bank")));
+        }
+        return methodNotAllowed();
+    }
+    if (segments.size() == 2) {
+        if (request.method != "DELETE") {
+            return methodNotAllowed();
+        }
+        return fromControllerResult(transferController.deleteBeneficiary(userId, segments[1]));
+    }
+    return notFound();
+}
+
+// ---------------------------------------------------------------------------
+// /api/v1/bills/*
+// ---------------------------------------------------------------------------
+
+HttpResponse ApiRouter::routeBills(const HttpRequest& request, const vector<string>& segments,
+                                   const Utils::JsonValue& body, const string& userId) {
+    if (segments.size() != 2) {
+        return notFound();
+    }
+
+    const string& action = segments[1];
+    if (action == "providers" || action == "amount" ||
+        action == "history" || action == "saved") {
+        if (request.method != "GET") {
+            return methodNotAllowed();
+        }
+        if (action == "providers") {
+            return fromControllerResult(billController.getProviders(request.getQueryParam("type")));
+        }
+        if (action == "amount") {
+            return fromControllerResult(billController.getBillAmount(
+                request.getQueryParam("provider"), request.getQueryParam("billAccountNumber")));
+        }
+        if (action == "history") {
+            return fromControllerResult(billController.getPaymentHistory(userId));
+        }
+        return fromControllerResult(billController.getSavedBillers(userId));
+    }
+
+    if (action == "pay" || action == "schedule") {
+        if (request.method != "POST") {
+            return methodNotAllowed();
+        }
+        Controller::BillPaymentRequest payment;
+        payment.accountNumber = body.getString("accountNumber");
+        payment.billType = body.getString("billType");
+        payment.serviceProvider = body.getString("serviceProvider");
+        payment.billAccountNumber = body.getString("billAccountNumber");
+        payment.amount = amountFrom(body.get("amount"));
+        payment.saveAsBiller = body.getBool("saveAsBiller");
+        payment.makeRecurring = body.getBool("makeRecurring");
+        payment.scheduledDate = body.getString("scheduledDate");
+        if (action == "pay") {
+            return fromControllerResult(billController.payBill(userId, payment));
+        }
+        return fromControllerResult(billController.scheduleBillPayment(userId, payment));
+    }
+    return notFound();
+}
+
+// ---------------------------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------------------------
+
+HttpResponse ApiRouter::fromControllerResult(const string& json) {
+    if (json.find("\"success\": false") == string::npos) {
+        return HttpResponse(200, json);
+    }
+
+    string errorCode;
+    const string key = "\"errorCode\": \"";
+    size_t start = json.find(key);
+    if (start != string::npos) {
+        start += key.size();
+        errorCode = json.substr(start, json.find('"', start) - start);
+    }
+
+    int status = 400;
+    if (errorCode == "ERR_UNAUTHORIZED" || errorCode == "ERR_INVALID_SESSION" ||
+        errorCode == "ERR_INVALID_CREDENTIALS") {
+        status = 401;
+    } else if (errorCode == "ERR_TOO_MANY_ATTEMPTS") {
+        status = 429;
+    } else if (errorCode == "ERR_SERVICE_BUSY") {
+        status = 503;
+    } else if (errorCode.size() > 10 &&
+               errorCode.compare(errorCode.size() - 10, 10, "_NOT_FOUND") == 0) {
+        status = 404;
+    }
+    return HttpResponse(status, json);
+}
+
+HttpResponse ApiRouter::notFound() {
+    return HttpResponse(404, View::JsonResponseBuilder::buildErrorResponse(
+        "Endpoint not found", "ERR_NOT_FOUND"));
+}
+
+HttpResponse ApiRouter::methodNotAllowed() {
+    return HttpResponse(405, View::JsonResponseBuilder::buildErrorResponse(
+        "Method not allowed", "ERR_METHOD_NOT_ALLOWED"));
+}
+
+string ApiRouter::bearerToken(const HttpRequest& request) {
+    string authorization = request.getHeader("authorization");
+    const string scheme = "Bearer ";
+    if (authorization.compare(0, scheme.size(), scheme) != 0) {
+        return "";
+    }
+    return authorization.substr(scheme.size());
+}
+
+string ApiRouter::resolveUserId(const HttpRequest& request) {
+    // Unknown and expired tokens resolve to no user, which the
+    // controllers answer with ERR_UNAUTHORIZED (401)
+    long userId = 0;
+    if (!Utils::DatabaseConnection::getInstance()->getSessions().lookup(
+            bearerToken(request), Utils::Clock::now(), userId)) {
+        return "";
+    }
+    return Model::User::formatRef(userId);
+}
+
+vector<string> ApiRouter::splitPath(const string& path) {
+    vector<string> segments;
+    size_t pos = 0;
+    while (pos < path.size()) {
+        size_t end = path.find('/', pos);
+        if (end == string::npos) end = path.size();
+        if (end > pos) {
+            segments.push_back(path.substr(pos, end - pos));
+        }
+        pos = end + 1;
+    }
+    return segments;
+}
+
+} // namespace Server
+} // namespace SOBS
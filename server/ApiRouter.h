@@ -0,0 +1,79 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Server: ApiRouter.h
+ *
+ * Maps /api/v1 HTTP requests onto the controllers and turns their
+ * JSON results into HTTP responses.
+ */
+
+#ifndef APIROUTER_H
+#define APIROUTER_H
+
+#include <string>
+#include <vector>
+#include "HttpServer.h"
+#include "../utils/JsonValue.h"
+#include "../controller/AuthenticationController.h"
+#include "../controller/AccountController.h"
+#include "../controller/TransferController.h"
+#include "../controller/BillPaymentController.h"
+
+using namespace std;
+
+namespace SOBS {
+namespace Server {
+
+class ApiRouter {
+private:
+    // Controllers hold no per-request state, so one instance serves all workers
+    Controller::AuthenticationController authController;
+    Controller::AccountController accountController;
+    Controller::TransferController transferController;
+    Controller::BillPaymentController billController;
+
+    HttpResponse routeAuth(const HttpRequest& request, const vector<string>& segments,
+                           const Utils::JsonValue& body);
+    HttpResponse routeAccounts(const HttpRequest& request, const vector<string>& segments,
+                               const string& userId);
+    HttpResponse routeTransfers(const HttpRequest& request, const vector<string>& segments,
+                                const Utils::JsonValue& body, const string& userId);
+    HttpResponse routeBeneficiaries(const HttpRequest& request, const vector<string>& segments,
+                                    const Utils::JsonValue& body, const string& userId);
+    HttpResponse routeBills(const HttpRequest& request, const vector<string>& segments,
+                            const Utils::JsonValue& body, const string& userId);
+
+    static string resolveUserId(const HttpRequest& request);
+    static string bearerToken(const HttpRequest& request);
+    static vector<string> splitPath(const string& path);
+
+public:
+    ApiRouter();
+    ~ApiRouter();
+
+    /**
+     * Handle one request (called concurrently from the server's workers)
+     */
+    HttpResponse handle(const HttpRequest& request);
+
+    /**
+     * Handle one request and answer through 'respond'. Logins and password
+     * resets answer from the password-hashing pool once the hash is done,
+     * so they do not hold a server worker; everything else goes through
+     * handle() before this returns.
+     */
+    void dispatch(const HttpRequest& request, HttpServer::Responder respond);
+
+    /**
+     * Wrap a controller's JSON result, deriving the HTTP status
+     * from its "success" flag and "errorCode"
+     */
+    static HttpResponse fromControllerResult(const string& json);
+
+    static HttpResponse notFound();
+    static HttpResponse methodNotAllowed();
+};
+
+} // namespace Server
+} // namespace SOBS
+
+#endif // APIROUTER_H
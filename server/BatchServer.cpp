@@ -0,0 +1,189 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Server: BatchServer.cpp
+ *
+ * Implementation of the batch command loop
+ */
+
+#include "BatchServer.h"
+#include "../view/ApiResponse.h"
+#include <cstring>
+#include <algorithm>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+using namespace std;
+
+namespace SOBS {
+namespace Server {
+
+namespace {
+
+const size_t READ_CHUNK = 64 * 1024;
+
+bool writeAll(int fd, const string& data) {
+    size_t offset = 0;
+    while (offset < data.size()) {
+        ssize_t sent = send(fd, data.data() + offset, data.size() - offset, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        offset += static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+string lineTooLong() {
+    View::JsonWriter::Style& style = View::JsonWriter::threadStyle();
+    View::JsonWriter::Style savedStyle = style;
+    style = View::JsonWriter::Style::COMPACT;
+    string response = View::JsonResponseBuilder::buildErrorResponse(
+        "Command line too long", "ERR_LINE_TOO_LONG");
+    style = savedStyle;
+    return response + '\n';
+}
+
+} // namespace
+
+BatchServer::BatchServer(CommandProcessor& processor)
+    : processor(processor), running(false), commandCount(0), listenFd(-1) {}
+
+BatchServer::~BatchServer() {
+    if (listenFd >= 0) {
+        close(listenFd);
+    }
+}
+
+void BatchServer::runStream(istream& in, ostream& out) {
+    string line;
+    string response;
+    while (getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty()) {
+            continue;
+        }
+
+        response.clear();
+        processor.executeLine(line, response);
+        response += '\n';
+        out.write(response.data(), static_cast<streamsize>(response.size()));
+        commandCount++;
+
+        // Flush once the caller has no more commands queued up
+        if (in.rdbuf()->in_avail() <= 0) {
+            out.flush();
+        }
+    }
+    out.flush();
+}
+
+bool BatchServer::serveUnixSocket(const string& path) {
+    sockaddr_un address;
+    if (path.size() >= sizeof(address.sun_path)) {
+        return false;
+    }
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listenFd < 0) {
+        return false;
+    }
+    unlink(path.c_str());
+    if (bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+        listen(listenFd, SOMAXCONN) < 0) {
+        return false;
+    }
+
+    running = true;
+    while (running.load()) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            break;  // Listening socket shut down by stop()
+        }
+        {
+            lock_guard<mutex> lock(clientMutex);
+            clientFds.push_back(fd);
+        }
+        thread(&BatchServer::serveClient, this, fd).detach();
+    }
+
+    // Unblock clients still waiting on input, then wait for them to finish
+    {
+        unique_lock<mutex> lock(clientMutex);
+        for (int fd : clientFds) {
+            shutdown(fd, SHUT_RDWR);
+        }
+        clientsDone.wait(lock, [this] { return clientFds.empty(); });
+    }
+
+    close(listenFd);
+    listenFd = -1;
+    unlink(path.c_str());
+    return true;
+}
+
+void BatchServer::serveClient(int fd) {
+    char buffer[READ_CHUNK];
+    string pending;
+    string out;
+
+    while (true) {
+        ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+        if (received < 0 && errno == EINTR) continue;
+        if (received <= 0) break;
+        pending.append(buffer, static_cast<size_t>(received));
+
+        // Answer every complete line in this read with a single write
+        size_t start = 0;
+        size_t end;
+        while ((end = pending.find('\n', start)) != string::npos) {
+            size_t length = end - start;
+            if (length > 0 && pending[end - 1] == '\r') length--;
+            if (length > 0) {
+                processor.executeLine(pending.substr(start, length), out);
+                out += '\n';
+                commandCount++;
+            }
+            start = end + 1;
+        }
+        pending.erase(0, start);
+
+        // Like an oversized HTTP header: answer, then drop the client
+        bool tooLong = pending.size() > size_t(MAX_LINE_BYTES);
+        if (tooLong) {
+            out += lineTooLong();
+        }
+        if (!out.empty()) {
+            if (!writeAll(fd, out)) break;
+            out.clear();
+        }
+        if (tooLong) break;
+    }
+
+    lock_guard<mutex> lock(clientMutex);
+    clientFds.erase(find(clientFds.begin(), clientFds.end(), fd));
+    close(fd);
+    clientsDone.notify_all();
+}
+
+void BatchServer::stop() {
+    running = false;
+    if (listenFd >= 0) {
+        shutdown(listenFd, SHUT_RDWR);
+    }
+}
+
+uint64_t BatchServer::getCommandCount() const {
+    return commandCount.load();
+}
+
+} // namespace Server
+} // namespace SOBS
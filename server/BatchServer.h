@@ -0,0 +1,76 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Server: BatchServer.h
+ *
+ * Long-running batch mode: newline-delimited JSON commands in, one JSON
+ * response per line out. Reads stdin, or serves clients on a UNIX socket.
+ * Output is flushed only when no further input is already waiting, so
+ * pipelined commands share one write.
+ */
+
+#ifndef BATCHSERVER_H
+#define BATCHSERVER_H
+
+#include <string>
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+#include "CommandProcessor.h"
+
+using namespace std;
+
+namespace SOBS {
+namespace Server {
+
+class BatchServer {
+public:
+    // A socket client whose command line grows past this without a newline
+    // is answered with an error and disconnected
+    static const size_t MAX_LINE_BYTES = 1024 * 1024;
+
+private:
+    CommandProcessor& processor;
+    atomic<bool> running;
+    atomic<uint64_t> commandCount;
+    int listenFd;
+
+    mutex clientMutex;
+    condition_variable clientsDone;
+    vector<int> clientFds;       // Connected clients, each served by a detached thread
+
+    void serveClient(int fd);
+
+public:
+    explicit BatchServer(CommandProcessor& processor);
+    ~BatchServer();
+
+    BatchServer(const BatchServer&) = delete;
+    BatchServer& operator=(const BatchServer&) = delete;
+
+    /**
+     * Process commands from 'in' until end of input
+     */
+    void runStream(istream& in, ostream& out);
+
+    /**
+     * Accept clients on a UNIX domain socket, one thread per client,
+     * until stop() is called
+     */
+    bool serveUnixSocket(const string& path);
+
+    /**
+     * Stop serveUnixSocket(). Safe to call from a signal handler.
+     */
+    void stop();
+
+    uint64_t getCommandCount() const;
+};
+
+} // namespace Server
+} // namespace SOBS
+
+#endif // BATCHSERVER_H
@@ -0,0 +1,83 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Server: CommandProcessor.cpp
+ *
+ * Implementation of the command dispatcher
+ */
+
+#include "CommandProcessor.h"
+
+using namespace std;
+
+namespace SOBS {
+namespace Server {
+
+CommandProcessor::CommandProcessor() {}
+
+CommandProcessor::~CommandProcessor() {}
+
+string CommandProcessor::execute(const Utils::JsonValue& command) {
+    string name = command.getString("command");
+
+    if (name == "login") {
+        Controller::LoginRequest loginReq;
+        loginReq.email = command.getString("email");
+        loginReq.password = command.getString("password");
+        return authController.login(loginReq);
+    }
+    if (name == "balance") {
+        return accountController.getBalance(command.getString("userId"),
+                                            command.getString("accountNumber"));
+    }
+    if (name == "transfer") {
+        Controller::TransferRequest transferReq;
+        if (!Model::Money::parse(command.get("amount").getText(), transferReq.amount)) {
+            return View::JsonResponseBuilder::buildErrorResponse("Invalid amount format", "ERR_ARGS");
+        }
+        transferReq.senderAccountNumber = command.getString("senderAccountNumber");
+        transferReq.recipientAccountNumber = command.getString("recipientAccountNumber");
+        transferReq.description = command.getString("description");
+        // The sender must belong to the named user; the placeholder CLI
+        // user owns no accounts
+        return transferController.initiateTransfer(command.getString("userId", "USR_CLI"),
+                                                   transferReq);
+    }
+    if (name == "providers") {
+        return billController.getProviders(command.getString("type"));
+    }
+    return View::JsonResponseBuilder::buildErrorResponse("Unknown command", "ERR_CMD");
+}
+
+void CommandProcessor::executeLine(const string& line, string& out) {
+    // Response builders on this thread emit compact JSON while we run
+    View::JsonWriter::Style& style = View::JsonWriter::threadStyle();
+    View::JsonWriter::Style savedStyle = style;
+    style = View::JsonWriter::Style::COMPACT;
+
+    Utils::JsonValue command;
+    string response;
+    if (!Utils::JsonValue::parse(line, command) || !command.isObject()) {
+        response = View::JsonResponseBuilder::buildErrorResponse(
+            "Command is not a JSON object", "ERR_INVALID_JSON");
+    } else {
+        response = execute(command);
+    }
+    style = savedStyle;
+
+    // Echo the request id as the first member of the response
+    const Utils::JsonValue& id = command.get("id");
+    if (id.isNull() || response.size() < 2 || response[0] != '{') {
+        out += response;
+        return;
+    }
+    out += "{\"id\":";
+    out += id.getType() == Utils::JsonType::NUMBER ?
+        id.getText() : Utils::JsonValue::quote(id.asString());
+    if (response[1] != '}') {
+        out += ',';
+    }
+    out.append(response, 1, string::npos);
+}
+
+} // namespace Server
+} // namespace SOBS
@@ -0,0 +1,54 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Server: CommandProcessor.h
+ *
+ * Executes sobs_demo commands (login, balance, transfer, providers)
+ * against long-lived controllers. Shared by the one-shot argv CLI and
+ * the batch mode, where each command is one line of JSON.
+ */
+
+#ifndef COMMANDPROCESSOR_H
+#define COMMANDPROCESSOR_H
+
+#include <string>
+#include "../utils/JsonValue.h"
+#include "../controller/AuthenticationController.h"
+#include "../controller/AccountController.h"
+#include "../controller/TransferController.h"
+#include "../controller/BillPaymentController.h"
+
+using namespace std;
+
+namespace SOBS {
+namespace Server {
+
+class CommandProcessor {
+private:
+    // Stateless controllers, safe to share between threads
+    Controller::AuthenticationController authController;
+    Controller::AccountController accountController;
+    Controller::TransferController transferController;
+    Controller::BillPaymentController billController;
+
+public:
+    CommandProcessor();
+    ~CommandProcessor();
+
+    /**
+     * Run one command, e.g. {"command": "balance", "userId": "USR001",
+     * "accountNumber": "12345678901234"}. Returns the controller's JSON.
+     */
+    string execute(const Utils::JsonValue& command);
+
+    /**
+     * Batch mode: parse one input line, run it and append the response to
+     * 'out' as a single compact line (no trailing newline). An "id" member
+     * in the command is echoed back so callers can match responses to requests.
+     */
+    void executeLine(const string& line, string& out);
+};
+
+} // namespace Server
+} // namespace SOBS
+
+#endif // COMMANDPROCESSOR_H
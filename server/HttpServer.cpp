@@ -0,0 +1,683 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Server: HttpServer.cpp
+ *
+ * Implementation of the epoll-based HTTP/1.1 server
+ */
+
+#include "HttpServer.h"
+#include "../view/ApiResponse.h"
+#include <sstream>
+#include <cstring>
+#include <cerrno>
+#include <cctype>
+#include <unistd.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+using namespace std;
+
+namespace SOBS {
+namespace Server {
+
+namespace {
+
+// epoll user data for the two non-connection descriptors
+const uint64_t LISTEN_ID = 0;
+const uint64_t WAKE_ID = 1;
+
+const size_t READ_CHUNK = 64 * 1024;
+const int MAX_EVENTS = 256;
+
+string toLower(const string& value) {
+    string result = value;
+    for (char& c : result) {
+        c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+    }
+    return result;
+}
+
+string trim(const string& value) {
+    size_t start = value.find_first_not_of(" \t");
+    if (start == string::npos) return "";
+    size_t end = value.find_last_not_of(" \t");
+    return value.substr(start, end - start + 1);
+}
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+string urlDecode(const string& value, bool plusAsSpace) {
+    string result;
+    result.reserve(value.size());
+    for (size_t i = 0; i < value.size(); i++) {
+        char c = value[i];
+        if (c == '%' && i + 2 < value.size() &&
+            hexValue(value[i + 1]) >= 0 && hexValue(value[i + 2]) >= 0) {
+            result += static_cast<char>(hexValue(value[i + 1]) * 16 + hexValue(value[i + 2]));
+            i += 2;
+        } else if (c == '+' && plusAsSpace) {
+            result += ' ';
+        } else {
+            result += c;
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// HttpRequest / HttpResponse
+// ---------------------------------------------------------------------------
+
+HttpRequest::HttpRequest() : keepAlive(true) {}
+
+string HttpRequest::getHeader(const string& name) const {
+    string key = toLower(name);
+    for (const auto& header : headers) {
+        if (header.first == key) return header.second;
+    }
+    return "";
+}
+
+string HttpRequest::getQueryParam(const string& name) const {
+    size_t pos = 0;
+    while (pos <= query.size()) {
+        size_t end = query.find('&', pos);
+        if (end == string::npos) end = query.size();
+        string pair = query.substr(pos, end - pos);
+        size_t eq = pair.find('=');
+        string key = urlDecode(pair.substr(0, eq), true);
+        if (key == name) {
+            return eq == string::npos ? "" : urlDecode(pair.substr(eq + 1), true);
+        }
+        pos = end + 1;
+    }
+    return "";
+}
+
+HttpResponse::HttpResponse() : status(200), contentType("application/json") {}
+
+HttpResponse::HttpResponse(int status, const string& body, const string& contentType)
+    : status(status), contentType(contentType), body(body) {}
+
+const char* HttpResponse::reasonPhrase(int status) {
+    switch (status) {
+        case 100: return "Continue";
+        case 200: return "OK";
+        case 201: return "Created";
+        case 204: return "No Content";
+        case 400: return "Bad Request";
+        case 401: return "Unauthorized";
+        case 403: return "Forbidden";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 408: return "Request Timeout";
+        case 409: return "Conflict";
+        case 413: return "Payload Too Large";
+        case 422: return "Unprocessable Entity";
+        case 429: return "Too Many Requests";
+        case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error";
+        case 501: return "Not Implemented";
+        case 503: return "Service Unavailable";
+        case 505: return "HTTP Version Not Supported";
+        default: return "Unknown";
+    }
+}
+
+// ---------------------------------------------------------------------------
+// HttpServer
+// ---------------------------------------------------------------------------
+
+HttpServer::HttpServer()
+    : listenFd(-1), epollFd(-1), wakeFd(-1), port(0), running(false),
+      nextConnectionId(WAKE_ID + 1), stopping(false), pendingResponses(0), requestCount(0) {}
+
+HttpServer::~HttpServer() {
+    shutdownWorkers();
+    for (auto& entry : connections) {
+        close(entry.second.fd);
+    }
+    connections.clear();
+    if (listenFd >= 0) close(listenFd);
+    if (epollFd >= 0) close(epollFd);
+    if (wakeFd >= 0) close(wakeFd);
+}
+
+bool HttpServer::start(int port, size_t workerCount, Handler handler) {
+    return start(port, workerCount,
+                 [handler](const HttpRequest& request, Responder respond) {
+                     respond(handler(request));
+                 });
+}
+
+bool HttpServer::start(int port, size_t workerCount, AsyncHandler handler) {
+    this->handler = handler;
+
+    listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd < 0) {
+        return false;
+    }
+
+    int enable = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    if (bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+        listen(listenFd, SOMAXCONN) < 0) {
+        return false;
+    }
+
+    socklen_t length = sizeof(address);
+    getsockname(listenFd, reinterpret_cast<sockaddr*>(&address), &length);
+    this->port = ntohs(address.sin_port);
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd < 0 || wakeFd < 0) {
+        return false;
+    }
+
+    epoll_event event;
+    event.events = EPOLLIN;
+    event.data.u64 = LISTEN_ID;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event);
+    event.data.u64 = WAKE_ID;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+
+    if (workerCount == 0) {
+        workerCount = 1;
+    }
+    stopping = false;
+    for (size_t i = 0; i < workerCount; i++) {
+        workers.emplace_back(&HttpServer::workerLoop, this);
+    }
+
+    running = true;
+    return true;
+}
+
+void HttpServer::setSweepTask(SweepTask task) {
+    sweepTask = task;
+}
+
+void HttpServer::run() {
+    epoll_event events[MAX_EVENTS];
+    auto lastSweep = chrono::steady_clock::now();
+
+    while (running.load()) {
+        int count = epoll_wait(epollFd, events, MAX_EVENTS, 1000);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        for (int i = 0; i < count; i++) {
+            uint64_t id = events[i].data.u64;
+            uint32_t ready = events[i].events;
+
+            if (id == LISTEN_ID) {
+                acceptConnections();
+                continue;
+            }
+            if (id == WAKE_ID) {
+                uint64_t value;
+                while (read(wakeFd, &value, sizeof(value)) > 0) {}
+                drainCompletions();
+                continue;
+            }
+
+            auto it = connections.find(id);
+            if (it == connections.end()) continue;
+
+            if (ready & (EPOLLERR | EPOLLHUP)) {
+                closeConnection(id);
+                continue;
+            }
+            if (ready & EPOLLIN) {
+                handleReadable(id, it->second);
+                it = connections.find(id);
+                if (it == connections.end()) continue;
+            }
+            if (ready & EPOLLOUT) {
+                handleWritable(id, it->second);
+            }
+        }
+
+        auto now = chrono::steady_clock::now();
+        if (now - lastSweep >= chrono::seconds(1)) {
+            closeIdleConnections();
+            if (sweepTask) sweepTask();
+            lastSweep = now;
+        }
+    }
+
+    shutdownWorkers();
+    while (!connections.empty()) {
+        closeConnection(connections.begin()->first);
+    }
+}
+
+void HttpServer::stop() {
+    running = false;
+    if (wakeFd >= 0) {
+        uint64_t one = 1;
+        ssize_t written = write(wakeFd, &one, sizeof(one));
+        (void)written;
+    }
+}
+
+void HttpServer::shutdownWorkers() {
+    {
+        lock_guard<mutex> lock(jobMutex);
+        stopping = true;
+    }
+    jobReady.notify_all();
+    for (thread& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+
+    // Async responders still running elsewhere use this object
+    unique_lock<mutex> lock(completionMutex);
+    responsesDone.wait(lock, [this] { return pendingResponses == 0; });
+}
+
+void HttpServer::workerLoop() {
+    while (true) {
+        Job job;
+        {
+            unique_lock<mutex> lock(jobMutex);
+            jobReady.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (stopping) {
+                return;
+            }
+            job = move(jobs.front());
+            jobs.pop_front();
+        }
+
+        {
+            lock_guard<mutex> lock(completionMutex);
+            pendingResponses++;
+        }
+        uint64_t connectionId = job.connectionId;
+        bool keepAlive = job.request.keepAlive;
+        handler(job.request, [this, connectionId, keepAlive](const HttpResponse& response) {
+            complete(connectionId, response, keepAlive);
+        });
+    }
+}
+
+void HttpServer::complete(uint64_t connectionId, const HttpResponse& response, bool keepAlive) {
+    requestCount++;
+
+    Completion completion;
+    completion.connectionId = connectionId;
+    completion.bytes = serialize(response, keepAlive);
+    completion.close = !keepAlive;
+    {
+        lock_guard<mutex> lock(completionMutex);
+        completions.push_back(move(completion));
+    }
+
+    uint64_t one = 1;
+    ssize_t written = write(wakeFd, &one, sizeof(one));
+    (void)written;
+
+    // Last use of this object: shutdownWorkers() may return after this
+    lock_guard<mutex> lock(completionMutex);
+    if (--pendingResponses == 0) {
+        responsesDone.notify_all();
+    }
+}
+
+void HttpServer::acceptConnections() {
+    while (true) {
+        sockaddr_in peer;
+        socklen_t peerLength = sizeof(peer);
+        int fd = accept4(listenFd, reinterpret_cast<sockaddr*>(&peer), &peerLength,
+                         SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return;  // EAGAIN, or out of descriptors until the next round
+        }
+
+        int enable = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+        uint64_t id = nextConnectionId++;
+        Connection& conn = connections[id];
+        conn.fd = fd;
+        char address[INET_ADDRSTRLEN];
+        conn.remoteAddress = inet_ntop(AF_INET, &peer.sin_addr, address, sizeof(address)) != nullptr
+                             ? address : "";
+        conn.outOffset = 0;
+        conn.busy = false;
+        conn.closeAfterWrite = false;
+        conn.peerClosed = false;
+        conn.continueSent = false;
+        conn.events = EPOLLIN;
+        conn.lastActive = chrono::steady_clock::now();
+
+        epoll_event event;
+        event.events = EPOLLIN;
+        event.data.u64 = id;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+    }
+}
+
+void HttpServer::handleReadable(uint64_t id, Connection& conn) {
+    char buffer[READ_CHUNK];
+    while (true) {
+        ssize_t received = recv(conn.fd, buffer, sizeof(buffer), 0);
+        if (received > 0) {
+            conn.in.append(buffer, static_cast<size_t>(received));
+            if (static_cast<size_t>(received) < sizeof(buffer)) break;
+            continue;
+        }
+        if (received == 0) {
+            conn.peerClosed = true;
+            break;
+        }
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+        closeConnection(id);
+        return;
+    }
+
+    conn.lastActive = chrono::steady_clock::now();
+    if (!conn.busy) {
+        dispatchNext(id, conn);
+    }
+}
+
+void HttpServer::handleWritable(uint64_t id, Connection& conn) {
+    if (!flush(conn)) {
+        closeConnection(id);
+        return;
+    }
+    if (conn.outOffset < conn.out.size()) {
+        return;  // Still waiting for the socket to drain
+    }
+    if (conn.closeAfterWrite) {
+        closeConnection(id);
+        return;
+    }
+    if (!conn.busy) {
+        dispatchNext(id, conn);
+    } else {
+        setInterest(id, conn, 0);
+    }
+}
+
+void HttpServer::drainCompletions() {
+    vector<Completion> ready;
+    {
+        lock_guard<mutex> lock(completionMutex);
+        ready.swap(completions);
+    }
+
+    for (Completion& completion : ready) {
+        auto it = connections.find(completion.connectionId);
+        if (it == connections.end()) {
+            continue;  // Client went away while the request was running
+        }
+        Connection& conn = it->second;
+        conn.busy = false;
+        conn.continueSent = false;
+        queueOutput(completion.connectionId, conn, completion.bytes,
+                    completion.close || conn.peerClosed);
+    }
+}
+
+void HttpServer::dispatchNext(uint64_t id, Connection& conn) {
+    HttpRequest request;
+    int errorStatus = 0;
+
+    if (parseRequest(conn, request, errorStatus)) {
+        if (conn.peerClosed) {
+            request.keepAlive = false;
+        }
+        request.remoteAddress = conn.remoteAddress;
+        conn.busy = true;
+        setInterest(id, conn, 0);  // Pending output keeps EPOLLOUT
+        {
+            lock_guard<mutex> lock(jobMutex);
+            jobs.push_back(Job{id, move(request)});
+        }
+        jobReady.notify_one();
+        return;
+    }
+
+    if (errorStatus != 0) {
+        sendError(id, conn, errorStatus);
+        return;
+    }
+
+    // Incomplete request: wait for more bytes unless the peer is gone
+    if (conn.peerClosed && conn.outOffset >= conn.out.size()) {
+        closeConnection(id);
+        return;
+    }
+    setInterest(id, conn, conn.peerClosed ? 0u : static_cast<uint32_t>(EPOLLIN));
+}
+
+bool HttpServer::parseRequest(Connection& conn, HttpRequest& request, int& errorStatus) {
+    size_t headerEnd = conn.in.find("\r\n\r\n");
+    if (headerEnd == string::npos) {
+        if (conn.in.size() > MAX_HEADER_BYTES) {
+            errorStatus = 431;
+        }
+        return false;
+    }
+    if (headerEnd > MAX_HEADER_BYTES) {
+        errorStatus = 431;
+        return false;
+    }
+
+    // Request line: METHOD SP target SP version
+    size_t lineEnd = conn.in.find("\r\n");
+    string requestLine = conn.in.substr(0, lineEnd);
+    size_t firstSpace = requestLine.find(' ');
+    size_t lastSpace = requestLine.rfind(' ');
+    if (firstSpace == string::npos || firstSpace == lastSpace) {
+        errorStatus = 400;
+        return false;
+    }
+    request.method = requestLine.substr(0, firstSpace);
+    string target = requestLine.substr(firstSpace + 1, lastSpace - firstSpace - 1);
+    request.version = requestLine.substr(lastSpace + 1);
+    if (request.version != "HTTP/1.1" && request.version != "HTTP/1.0") {
+        errorStatus = request.version.compare(0, 5, "HTTP/") == 0 ? 505 : 400;
+        return false;
+    }
+    if (target.empty() || target[0] != '/') {
+        errorStatus = 400;
+        return false;
+    }
+
+    size_t question = target.find('?');
+    request.path = urlDecode(target.substr(0, question), false);
+    if (question != string::npos) {
+        request.query = target.substr(question + 1);
+    }
+
+    // Header fields
+    size_t pos = lineEnd + 2;
+    request.headers.clear();
+    while (pos < headerEnd) {
+        size_t end = conn.in.find("\r\n", pos);
+        string line = conn.in.substr(pos, end - pos);
+        pos = end + 2;
+
+        size_t colon = line.find(':');
+        if (colon == string::npos || colon == 0) {
+            errorStatus = 400;
+            return false;
+        }
+        request.headers.emplace_back(toLower(line.substr(0, colon)),
+                                     trim(line.substr(colon + 1)));
+    }
+
+    if (!request.getHeader("transfer-encoding").empty()) {
+        errorStatus = 501;
+        return false;
+    }
+
+    size_t contentLength = 0;
+    string lengthHeader = request.getHeader("content-length");
+    if (!lengthHeader.empty()) {
+        if (lengthHeader.size() > 9 ||
+            lengthHeader.find_first_not_of("0123456789") != string::npos) {
+            errorStatus = lengthHeader.size() > 9 ? 413 : 400;
+            return false;
+        }
+        contentLength = static_cast<size_t>(stoul(lengthHeader));
+        if (contentLength > MAX_BODY_BYTES) {
+            errorStatus = 413;
+            return false;
+        }
+    }
+
+    size_t bodyStart = headerEnd + 4;
+    if (conn.in.size() - bodyStart < contentLength) {
+        // Body still arriving; answer "Expect: 100-continue" once
+        if (!conn.continueSent &&
+            toLower(request.getHeader("expect")) == "100-continue") {
+            conn.continueSent = true;
+            conn.out += "HTTP/1.1 100 Continue\r\n\r\n";
+            flush(conn);
+        }
+        return false;
+    }
+
+    request.body = conn.in.substr(bodyStart, contentLength);
+    conn.in.erase(0, bodyStart + contentLength);
+
+    string connectionHeader = toLower(request.getHeader("connection"));
+    if (request.version == "HTTP/1.1") {
+        request.keepAlive = connectionHeader != "close";
+    } else {
+        request.keepAlive = connectionHeader == "keep-alive";
+    }
+    return true;
+}
+
+void HttpServer::sendError(uint64_t id, Connection& conn, int status) {
+    HttpResponse response(status, View::JsonResponseBuilder::buildErrorResponse(
+        HttpResponse::reasonPhrase(status), "ERR_HTTP_" + to_string(status)));
+    queueOutput(id, conn, serialize(response, false), true);
+}
+
+void HttpServer::queueOutput(uint64_t id, Connection& conn, const string& bytes, bool close) {
+    conn.out += bytes;
+    conn.closeAfterWrite = conn.closeAfterWrite || close;
+    conn.lastActive = chrono::steady_clock::now();
+    handleWritable(id, conn);
+}
+
+bool HttpServer::flush(Connection& conn) {
+    while (conn.outOffset < conn.out.size()) {
+        ssize_t sent = send(conn.fd, conn.out.data() + conn.outOffset,
+                            conn.out.size() - conn.outOffset, MSG_NOSIGNAL);
+        if (sent > 0) {
+            conn.outOffset += static_cast<size_t>(sent);
+            continue;
+        }
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return true;
+        }
+        return false;
+    }
+    conn.out.clear();
+    conn.outOffset = 0;
+    return true;
+}
+
+void HttpServer::setInterest(uint64_t id, Connection& conn, uint32_t events) {
+    if (conn.outOffset < conn.out.size()) {
+        events |= EPOLLOUT;
+    }
+    if (events == conn.events) {
+        return;
+    }
+    epoll_event event;
+    event.events = events;
+    event.data.u64 = id;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, conn.fd, &event);
+    conn.events = events;
+}
+
+void HttpServer::closeConnection(uint64_t id) {
+    auto it = connections.find(id);
+    if (it == connections.end()) {
+        return;
+    }
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, it->second.fd, nullptr);
+    close(it->second.fd);
+    connections.erase(it);
+}
+
+void HttpServer::closeIdleConnections() {
+    const int timeoutSeconds = IDLE_TIMEOUT_SECONDS;
+    auto cutoff = chrono::steady_clock::now() - chrono::seconds(timeoutSeconds);
+    vector<uint64_t> idle;
+    for (const auto& entry : connections) {
+        const Connection& conn = entry.second;
+        if (!conn.busy && conn.lastActive < cutoff) {
+            idle.push_back(entry.first);
+        }
+    }
+    for (uint64_t id : idle) {
+        closeConnection(id);
+    }
+}
+
+string HttpServer::serialize(const HttpResponse& response, bool keepAlive) {
+    string result;
+    result.reserve(response.body.size() + 160);
+    result += "HTTP/1.1 ";
+    result += to_string(response.status);
+    result += ' ';
+    result += HttpResponse::reasonPhrase(response.status);
+    result += "\r\nContent-Type: ";
+    result += response.contentType;
+    result += "\r\nContent-Length: ";
+    result += to_string(response.body.size());
+    result += keepAlive ? "\r\nConnection: keep-alive" : "\r\nConnection: close";
+    for (const auto& header : response.headers) {
+        result += "\r\n";
+        result += header.first;
+        result += ": ";
+        result += header.second;
+    }
+    result += "\r\n\r\n";
+    result += response.body;
+    return result;
+}
+
+int HttpServer::getPort() const {
+    return port;
+}
+
+uint64_t HttpServer::getRequestCount() const {
+    return requestCount.load();
+}
+
+} // namespace Server
+} // namespace SOBS
@@ -0,0 +1,192 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Server: HttpServer.h
+ *
+ * Minimal HTTP/1.1 server: one epoll event loop for all socket I/O and
+ * a fixed pool of worker threads that run the request handler.
+ *
+ * - Keep-alive: connections stay open between requests (HTTP/1.1 default).
+ * - Requests on one connection are answered in order, one at a time.
+ * - Content-Length bodies only; chunked request bodies are rejected.
+ * - An AsyncHandler may answer later from any thread (e.g. once a password
+ *   hash finishes); the worker is free as soon as the handler returns.
+ */
+
+#ifndef HTTPSERVER_H
+#define HTTPSERVER_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+using namespace std;
+
+namespace SOBS {
+namespace Server {
+
+struct HttpRequest {
+    string method;
+    string path;            // Decoded path, without the query string
+    string query;           // Raw query string (after '?')
+    string version;         // "HTTP/1.1" or "HTTP/1.0"
+    vector<pair<string, string>> headers;  // Names lower-cased
+    string body;
+    bool keepAlive;
+    string remoteAddress;   // Client IPv4 address, dotted
+
+    HttpRequest();
+
+    /**
+     * Header value by case-insensitive name, empty if absent
+     */
+    string getHeader(const string& name) const;
+
+    /**
+     * URL-decoded query parameter, empty if absent
+     */
+    string getQueryParam(const string& name) const;
+};
+
+struct HttpResponse {
+    int status;
+    string contentType;
+    string body;
+    vector<pair<string, string>> headers;  // Extra headers
+
+    HttpResponse();
+    HttpResponse(int status, const string& body,
+                 const string& contentType = "application/json");
+
+    static const char* reasonPhrase(int status);
+};
+
+class HttpServer {
+public:
+    typedef function<HttpResponse(const HttpRequest&)> Handler;
+    typedef function<void(const HttpResponse&)> Responder;          // Call exactly once
+    typedef function<void(const HttpRequest&, Responder)> AsyncHandler;
+    typedef function<void()> SweepTask;
+
+    static const size_t MAX_HEADER_BYTES = 64 * 1024;
+    static const size_t MAX_BODY_BYTES = 16 * 1024 * 1024;
+    static const int IDLE_TIMEOUT_SECONDS = 60;
+
+private:
+    struct Connection {
+        int fd;
+        string remoteAddress;
+        string in;
+        string out;
+        size_t outOffset;
+        bool busy;               // A request is with the workers
+        bool closeAfterWrite;
+        bool peerClosed;         // Client shut down its sending side
+        bool continueSent;       // "100 Continue" already sent for this request
+        uint32_t events;         // Current epoll interest
+        chrono::steady_clock::time_point lastActive;
+    };
+
+    struct Job {
+        uint64_t connectionId;
+        HttpRequest request;
+    };
+
+    struct Completion {
+        uint64_t connectionId;
+        string bytes;
+        bool close;
+    };
+
+    AsyncHandler handler;
+    SweepTask sweepTask;             // Run by the event loop once a second
+    int listenFd;
+    int epollFd;
+    int wakeFd;
+    int port;
+    atomic<bool> running;
+
+    // Owned by the event loop thread
+    unordered_map<uint64_t, Connection> connections;
+    uint64_t nextConnectionId;
+
+    // Event loop -> workers
+    mutex jobMutex;
+    condition_variable jobReady;
+    deque<Job> jobs;
+    bool stopping;
+    vector<thread> workers;
+
+    // Workers (or whoever answers an async request) -> event loop
+    mutex completionMutex;
+    vector<Completion> completions;
+    size_t pendingResponses;         // Dispatched to the handler, not yet answered
+    condition_variable responsesDone;
+
+    atomic<uint64_t> requestCount;
+
+    void workerLoop();
+    void complete(uint64_t connectionId, const HttpResponse& response, bool keepAlive);
+    void shutdownWorkers();
+    void acceptConnections();
+    void handleReadable(uint64_t id, Connection& conn);
+    void handleWritable(uint64_t id, Connection& conn);
+    void drainCompletions();
+    void dispatchNext(uint64_t id, Connection& conn);
+    bool parseRequest(Connection& conn, HttpRequest& request, int& errorStatus);
+    void sendError(uint64_t id, Connection& conn, int status);
+    void queueOutput(uint64_t id, Connection& conn, const string& bytes, bool close);
+    bool flush(Connection& conn);
+    void setInterest(uint64_t id, Connection& conn, uint32_t events);
+    void closeConnection(uint64_t id);
+    void closeIdleConnections();
+
+public:
+    HttpServer();
+    ~HttpServer();
+
+    HttpServer(const HttpServer&) = delete;
+    HttpServer& operator=(const HttpServer&) = delete;
+
+    /**
+     * Bind to the port (0 picks a free one) and start the worker threads
+     */
+    bool start(int port, size_t workerCount, Handler handler);
+    bool start(int port, size_t workerCount, AsyncHandler handler);
+
+    /**
+     * Run a task from the event loop's once-a-second idle sweep; it must be
+     * quick, since no connection is served while it runs. Call before run().
+     */
+    void setSweepTask(SweepTask task);
+
+    /**
+     * Run the event loop on the calling thread until stop() is called
+     */
+    void run();
+
+    /**
+     * Ask run() to return. Safe to call from another thread or a signal handler.
+     */
+    void stop();
+
+    /**
+     * Serialize a response (status line, headers and body)
+     */
+    static string serialize(const HttpResponse& response, bool keepAlive);
+
+    int getPort() const;
+    uint64_t getRequestCount() const;
+};
+
+} // namespace Server
+} // namespace SOBS
+
+#endif // HTTPSERVER_H
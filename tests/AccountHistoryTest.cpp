@@ -0,0 +1,121 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Test: AccountHistoryTest.cpp
+ *
+ * Account history through the account controller: only the owner of an
+ * account can page its transactions, download its statement or see its
+ * spending analytics; anyone else is told the account does not exist.
+ * Statements open and close at the month's bounds, entries or not.
+ */
+
+#include <iostream>
+#include <string>
+#include <cassert>
+#include "../controller/AccountController.h"
+#include "../utils/DatabaseConnection.h"
+#include "../utils/TransferEngine.h"
+#include "../utils/JsonValue.h"
+#include "TestSupport.h"
+
+using namespace std;
+using namespace SOBS;
+using namespace SOBS::Utils;
+using namespace SOBS::Test;
+
+namespace {
+
+const long OWNER = 11;
+const char* const OWNER_REF = "USR11";
+const char* const STRANGER_REF = "USR12";
+const char* const CHECKING = "10000000000011";
+const char* const SAVINGS = "10000000000012";
+
+void testHistoryNeedsOwnership() {
+    Controller::AccountController controller;
+    Controller::TransactionFilter filter;
+    JsonValue json = parseJson(controller.getTransactions(OWNER_REF, CHECKING, filter));
+    assert(json.getBool("success"));
+    assert(json.get("data").getNumber("count") == 1);
+
+    assert(errorCodeOf(controller.getTransactions(STRANGER_REF, CHECKING, filter)) ==
+           "ERR_ACCOUNT_NOT_FOUND");
+    assert(errorCodeOf(controller.getTransactions("USR_CLI", CHECKING, filter)) ==
+           "ERR_ACCOUNT_NOT_FOUND");
+    assert(errorCodeOf(controller.getTransactions(OWNER_REF, "10000000009999", filter)) ==
+           "ERR_ACCOUNT_NOT_FOUND");
+    cout << "  only the owner pages an account's history" << endl;
+}
+
+void testStatementNeedsOwnership() {
+    Controller::AccountController controller;
+    string csv;
+    string errorJson;
+    auto collect = [&csv](const char* data, size_t length) {
+        csv.append(data, length);
+        return true;
+    };
+    assert(controller.writeStatementCsv(OWNER_REF, CHECKING, "", collect, errorJson));
+    assert(csv.find("Savings") != string::npos);
+
+    csv.clear();
+    assert(!controller.writeStatementCsv(STRANGER_REF, CHECKING, "", collect, errorJson));
+    assert(errorCodeOf(errorJson) == "ERR_ACCOUNT_NOT_FOUND");
+    assert(csv.empty());
+    cout << "  only the owner downloads a statement" << endl;
+}
+
+void testStatementFramesMonth() {
+    Controller::AccountController controller;
+    string csv;
+    string errorJson;
+    auto collect = [&csv](const char* data, size_t length) {
+        csv.append(data, length);
+        return true;
+    };
+    // A month without entries still opens and closes, at its bounds
+    assert(controller.writeStatementCsv(OWNER_REF, CHECKING, "2020-01", collect, errorJson));
+    assert(csv.find("\r\n2020-01-01 00:00:00,,,,,Opening balance,,,1000.00\r\n"
+                    "2020-01-31 23:59:59,,,,,Closing balance,,,1000.00\r\n") != string::npos);
+
+    // The current month opens at its first second, before the transfer
+    csv.clear();
+    assert(controller.writeStatementCsv(OWNER_REF, CHECKING, "", collect, errorJson));
+    size_t opening = csv.find("-01 00:00:00,,,,,Opening balance,,,1000.00\r\n");
+    size_t transfer = csv.find(",DEBIT,TRANSFER,Savings,100.00,,900.00\r\n");
+    size_t closing = csv.find(",,,,,Closing balance,,,900.00\r\n");
+    assert(opening != string::npos && opening < transfer);
+    assert(transfer != string::npos && transfer < closing);
+    assert(closing != string::npos && closing + 31 == csv.size());
+
+    // The JSON statement call does not fake a CSV download
+    assert(errorCodeOf(controller.getStatement(OWNER_REF, CHECKING, "", "CSV")) ==
+           "ERR_INVALID_FORMAT");
+    cout << "  statement opens and closes at the month's bounds" << endl;
+}
+
+void testAnalyticsNeedOwnership() {
+    Controller::AccountController controller;
+    JsonValue json = parseJson(controller.getSpendingAnalytics(OWNER_REF, CHECKING, "month"));
+    assert(json.getBool("success"));
+    assert(errorCodeOf(controller.getSpendingAnalytics(STRANGER_REF, CHECKING, "month")) ==
+           "ERR_ACCOUNT_NOT_FOUND");
+    cout << "  only the owner sees spending analytics" << endl;
+}
+
+} // namespace
+
+int main() {
+    cout << "AccountHistory tests" << endl;
+    openAccount(CHECKING, OWNER, Model::Money::fromMajorUnits<1000>());
+    openAccount(SAVINGS, OWNER, Model::Money::fromMajorUnits<1000>());
+    assert(DatabaseConnection::getInstance()->getTransferEngine().execute(
+        CHECKING, SAVINGS, Model::Money::fromMajorUnits<100>(), "Savings") ==
+        TransferOutcome::COMPLETED);
+
+    testHistoryNeedsOwnership();
+    testStatementNeedsOwnership();
+    testStatementFramesMonth();
+    testAnalyticsNeedOwnership();
+    cout << "All passed" << endl;
+    return 0;
+}
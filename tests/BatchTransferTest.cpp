@@ -0,0 +1,222 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Test: BatchTransferTest.cpp
+ *
+ * Batch and OTP-confirmed transfers. The engine reports one outcome per
+ * batch line and applies only the lines that pass. Through the transfer
+ * controller: batch senders must belong to the user and lines that would
+ * need an OTP are refused; a transfer over the OTP threshold moves money
+ * only once its code is confirmed by the user who started it, and is
+ * dropped once its code locks.
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cassert>
+#include <cstdint>
+#include "../controller/TransferController.h"
+#include "../utils/DatabaseConnection.h"
+#include "../utils/TransferEngine.h"
+#include "../utils/JsonValue.h"
+#include "../utils/Clock.h"
+#include "TestSupport.h"
+
+using namespace std;
+using namespace SOBS;
+using namespace SOBS::Controller;
+using namespace SOBS::Utils;
+using namespace SOBS::Test;
+
+namespace {
+
+const char* const ALICE = "40000000000001";
+const char* const ALICE_SAVINGS = "40000000000002";
+const char* const BOB = "40000000000003";
+const char* const MISSING = "40000000009999";
+const long ALICE_USER = 1;
+const long BOB_USER = 2;
+const char* const ALICE_REF = "USR1";
+const char* const BOB_REF = "USR2";
+
+TransferRequest request(const string& sender, const string& recipient,
+                        const Model::Money& amount) {
+    TransferRequest line;
+    line.senderAccountNumber = sender;
+    line.recipientAccountNumber = recipient;
+    line.amount = amount;
+    line.description = "test";
+    return line;
+}
+
+// A fresh code for a pending transfer, as a resend would issue
+string reissue(const string& transferId, long userId) {
+    string code;
+    assert(DatabaseConnection::getInstance()->getOtps().issue(
+        "transfer:" + transferId, userId, Clock::now(), code));
+    return code;
+}
+
+void testEngineBatchOutcomesPerLine() {
+    LedgerEngine ledger;
+    WriteAheadLog wal;      // Not opened
+    PostingJournal journal;
+    DashboardSummaries summaries;
+    TransferEngine engine(ledger, wal, journal, summaries);
+    openAccount(ledger, ALICE, ALICE_USER, Model::Money::fromMajorUnits<100>());
+    openAccount(ledger, BOB, BOB_USER, Model::Money());
+
+    vector<TransferInstruction> instructions = {
+        {BOB, Model::Money::fromMajorUnits<60>(), "first"},
+        {MISSING, Model::Money::fromMajorUnits<1>(), "nobody"},
+        {BOB, Model::Money::fromMajorUnits<60>(), "too much now"},
+        {ALICE, Model::Money::fromMajorUnits<1>(), "self"},
+        {BOB, Model::Money::fromMajorUnits<40>(), "rest"},
+    };
+    vector<string> references = {"TRF1", "TRF2", "TRF3", "TRF4", "TRF5"};
+    vector<TransferOutcome> outcomes;
+
+    assert(engine.executeBatch(ALICE, instructions, references, outcomes) == 2);
+    assert(outcomes.size() == instructions.size());
+    assert(outcomes[0] == TransferOutcome::COMPLETED);
+    assert(outcomes[1] == TransferOutcome::RECIPIENT_NOT_FOUND);
+    assert(outcomes[2] == TransferOutcome::INSUFFICIENT_FUNDS);
+    assert(outcomes[3] == TransferOutcome::SAME_ACCOUNT);
+    assert(outcomes[4] == TransferOutcome::COMPLETED);
+    assert(balanceOf(ledger, ALICE) == 0);
+    assert(balanceOf(ledger, BOB) == 10000);
+
+    // Only the applied lines are journaled, under their own references
+    Model::Account bob;
+    assert(ledger.getAccount(BOB, bob));
+    vector<Model::Transaction> history = journal.getTransactions(bob.getAccountId());
+    assert(history.size() == 2);
+    assert(history[0].getReferenceNumber() == "TRF1");
+    assert(history[1].getReferenceNumber() == "TRF5");
+    cout << "  engine batch reports and applies each line on its own" << endl;
+}
+
+void testBatchChecksOwnerAndOtp() {
+    DatabaseConnection* db = DatabaseConnection::getInstance();
+    LedgerEngine& ledger = db->getLedger();
+    TransferController controller;
+
+    int64_t alice = balanceOf(ledger, ALICE);
+    int64_t bob = balanceOf(ledger, BOB);
+
+    vector<TransferRequest> lines = {
+        request(ALICE, BOB, Model::Money::fromMajorUnits<100>()),
+        request(BOB, ALICE, Model::Money::fromMajorUnits<50>()),      // Bob's account
+        request(ALICE, BOB, Model::Money::fromMajorUnits<6000>()),    // Needs an OTP
+        request(ALICE, MISSING, Model::Money::fromMajorUnits<10>()),
+        request(ALICE_SAVINGS, BOB, Model::Money::fromMajorUnits<20>()),
+    };
+    JsonValue json = parseJson(controller.executeBatchTransfer(ALICE_REF, lines));
+    assert(json.getBool("success"));
+    const JsonValue& data = json.get("data");
+    assert(data.getNumber("total") == 5);
+    assert(data.getNumber("completed") == 2);
+    assert(data.getNumber("failed") == 3);
+    assert(data.getNumber("senders") == 2);
+    assert(data.get("completedAmount").getText() == "120.00");
+
+    const vector<JsonValue>& results = data.get("results").getElements();
+    assert(results.size() == lines.size());
+    assert(results[0].getString("status") == "COMPLETED");
+    assert(results[1].getString("errorCode") == "ERR_ACCOUNT_NOT_FOUND");
+    assert(results[2].getString("errorCode") == "ERR_OTP_REQUIRED");
+    assert(results[3].getString("errorCode") == "ERR_INVALID_RECIPIENT_ACCOUNT");
+    assert(results[4].getString("status") == "COMPLETED");
+
+    assert(balanceOf(ledger, ALICE) == alice - 10000);
+    assert(balanceOf(ledger, BOB) == bob + 12000);
+
+    assert(errorCodeOf(controller.executeBatchTransfer("", lines)) == "ERR_UNAUTHORIZED");
+    assert(errorCodeOf(controller.executeBatchTransfer(
+        ALICE_REF, vector<TransferRequest>())) == "ERR_EMPTY_BATCH");
+    cout << "  batch refuses foreign senders and lines needing an OTP" << endl;
+}
+
+void testOtpTransferNeedsOwnerAndCode() {
+    DatabaseConnection* db = DatabaseConnection::getInstance();
+    LedgerEngine& ledger = db->getLedger();
+    TransferController controller;
+    TransferRequest large = request(ALICE, BOB, Model::Money::fromMajorUnits<7000>());
+
+    assert(errorCodeOf(controller.initiateTransfer(BOB_REF, large)) == "ERR_ACCOUNT_NOT_FOUND");
+    assert(errorCodeOf(controller.initiateTransfer("USR", large)) == "ERR_ACCOUNT_NOT_FOUND");
+
+    int64_t alice = balanceOf(ledger, ALICE);
+    int64_t bob = balanceOf(ledger, BOB);
+
+    JsonValue json = parseJson(controller.initiateTransfer(ALICE_REF, large));
+    assert(json.getBool("success"));
+    assert(json.get("data").getString("status") == "PENDING_OTP");
+    string transferId = json.get("data").getString("transferId");
+    assert(!transferId.empty());
+    assert(balanceOf(ledger, ALICE) == alice);
+
+    // A wrong code moves nothing, and the code only confirms for its owner
+    string code = reissue(transferId, ALICE_USER);
+    assert(errorCodeOf(controller.verifyTransfer(ALICE_REF, transferId, wrongCode(code))) ==
+           "ERR_INVALID_OTP");
+    assert(balanceOf(ledger, ALICE) == alice);
+    assert(errorCodeOf(controller.verifyTransfer(BOB_REF, transferId, code)) ==
+           "ERR_UNAUTHORIZED");
+    assert(balanceOf(ledger, ALICE) == alice);
+
+    code = reissue(transferId, ALICE_USER);
+    json = parseJson(controller.verifyTransfer(ALICE_REF, transferId, code));
+    assert(json.getBool("success"));
+    assert(balanceOf(ledger, ALICE) == alice - 700000);
+    assert(balanceOf(ledger, BOB) == bob + 700000);
+
+    // The code is single use
+    assert(errorCodeOf(controller.verifyTransfer(ALICE_REF, transferId, code)) ==
+           "ERR_OTP_EXPIRED");
+    assert(balanceOf(ledger, ALICE) == alice - 700000);
+    cout << "  OTP transfer moves money once, for its owner's code" << endl;
+}
+
+void testLockedOtpDropsTransfer() {
+    DatabaseConnection* db = DatabaseConnection::getInstance();
+    LedgerEngine& ledger = db->getLedger();
+    TransferController controller;
+    TransferRequest large = request(ALICE, BOB, Model::Money::fromMajorUnits<6000>());
+
+    JsonValue json = parseJson(controller.initiateTransfer(ALICE_REF, large));
+    string transferId = json.get("data").getString("transferId");
+    int64_t alice = balanceOf(ledger, ALICE);
+
+    string code = reissue(transferId, ALICE_USER);
+    string wrong = wrongCode(code);
+    for (size_t i = 1; i < size_t(OtpStore::MAX_ATTEMPTS); i++) {
+        assert(errorCodeOf(controller.verifyTransfer(ALICE_REF, transferId, wrong)) ==
+               "ERR_INVALID_OTP");
+    }
+    assert(errorCodeOf(controller.verifyTransfer(ALICE_REF, transferId, wrong)) ==
+           "ERR_OTP_LOCKED");
+
+    // A new code cannot revive the dropped transfer
+    code = reissue(transferId, ALICE_USER);
+    assert(errorCodeOf(controller.verifyTransfer(ALICE_REF, transferId, code)) ==
+           "ERR_TRANSFER_NOT_FOUND");
+    assert(balanceOf(ledger, ALICE) == alice);
+    cout << "  locked OTP drops the pending transfer" << endl;
+}
+
+} // namespace
+
+int main() {
+    cout << "Batch and OTP transfer tests" << endl;
+    testEngineBatchOutcomesPerLine();
+
+    openAccount(ALICE, ALICE_USER, Model::Money::fromMajorUnits<20000>());
+    openAccount(ALICE_SAVINGS, ALICE_USER, Model::Money::fromMajorUnits<500>());
+    openAccount(BOB, BOB_USER, Model::Money::fromMajorUnits<1000>());
+    testBatchChecksOwnerAndOtp();
+    testOtpTransferNeedsOwnerAndCode();
+    testLockedOtpDropsTransfer();
+    cout << "All passed" << endl;
+    return 0;
+}
@@ -0,0 +1,114 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Test: BillPaymentTest.cpp
+ *
+ * Bill payments through the controller debit the paying account, credit
+ * the settlement account and journal a BILL_PAYMENT entry carrying the
+ * bill reference, so they reach history, spending rollups and the
+ * dashboard. Foreign accounts, unknown bill types and engine refusals
+ * come back as error codes with nothing moved.
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cassert>
+#include <ctime>
+#include "../controller/BillPaymentController.h"
+#include "../utils/DatabaseConnection.h"
+#include "../utils/TransferEngine.h"
+#include "../utils/Clock.h"
+#include "../utils/JsonValue.h"
+#include "TestSupport.h"
+
+using namespace std;
+using namespace SOBS;
+using namespace SOBS::Utils;
+using namespace SOBS::Test;
+
+namespace {
+
+const long OWNER = 8;
+const char* const PAYER = "10000000000008";
+const char* const FOREIGN = "10000000000009";
+
+Controller::BillPaymentRequest electricityBill(const string& accountNumber) {
+    Controller::BillPaymentRequest request;
+    request.accountNumber = accountNumber;
+    request.billType = "ELECTRICITY";
+    request.serviceProvider = "North Cairo Electricity";
+    request.billAccountNumber = "EL-0042";
+    request.amount = Model::Money::fromMajorUnits<120>();
+    return request;
+}
+
+void testPaymentIsPostedAndJournaled() {
+    DatabaseConnection* db = DatabaseConnection::getInstance();
+    Model::Account payer = openAccount(PAYER, OWNER, Model::Money::fromMajorUnits<1000>());
+    time_t now = time(nullptr);
+    DashboardSummary before;
+    assert(db->getSummaries().getSummary(OWNER, now, before));
+
+    Controller::BillPaymentController controller;
+    JsonValue json;
+    assert(JsonValue::parse(controller.payBill("USR8", electricityBill(PAYER)), json));
+    assert(json.getBool("success"));
+    assert(json.get("data").getString("status") == "COMPLETED");
+    string billRef = json.get("data").getString("billRef");
+    assert(!billRef.empty());
+
+    assert(balanceOf(PAYER) == 88000);
+    assert(balanceOf(TransferEngine::SETTLEMENT_ACCOUNT_NUMBER) >= 12000);
+
+    // History carries the bill reference under its own category
+    vector<Model::Transaction> history = db->getJournal().getTransactions(payer.getAccountId());
+    assert(history.size() == 1);
+    assert(history[0].getReferenceNumber() == billRef);
+    assert(history[0].getCategory() == Model::TransactionCategory::BILL_PAYMENT);
+
+    // Spending rollups and the dashboard see the payment
+    int64_t spent = 0;
+    int64_t month = Clock::localMonth(now);
+    assert(db->getJournal().readRollups(payer.getAccountId(), [&](const SpendingRollups& r) {
+        spent = r.sumMonths(month, month + 1)
+                 .spent[static_cast<size_t>(Model::TransactionCategory::BILL_PAYMENT)];
+    }));
+    assert(spent == 12000);
+    DashboardSummary after;
+    assert(db->getSummaries().getSummary(OWNER, now, after));
+    assert(after.totalBalanceUnits == before.totalBalanceUnits - 12000);
+    cout << "  payment debits the account and reaches history, rollups and dashboard" << endl;
+}
+
+void testRefusedPaymentsMoveNothing() {
+    openAccount(FOREIGN, OWNER + 1, Model::Money::fromMajorUnits<1000>());
+    Controller::BillPaymentController controller;
+
+    // Someone else's account, or one that does not exist
+    assert(errorCodeOf(controller.payBill("USR8", electricityBill(FOREIGN))) ==
+           "ERR_ACCOUNT_NOT_FOUND");
+    assert(errorCodeOf(controller.payBill("USR8", electricityBill("10000000009999"))) ==
+           "ERR_ACCOUNT_NOT_FOUND");
+
+    Controller::BillPaymentRequest request = electricityBill(PAYER);
+    request.billType = "GYM";
+    assert(errorCodeOf(controller.payBill("USR8", request)) == "ERR_INVALID_BILL_TYPE");
+
+    request = electricityBill(PAYER);
+    request.amount = Model::Money::fromMajorUnits<5000>();
+    assert(errorCodeOf(controller.payBill("USR8", request)) == "ERR_INSUFFICIENT_FUNDS");
+
+    assert(balanceOf(PAYER) == 88000);
+    assert(balanceOf(FOREIGN) == 100000);
+    cout << "  foreign accounts, unknown types and refusals move nothing" << endl;
+}
+
+} // namespace
+
+int main() {
+    cout << "BillPayment tests" << endl;
+    testPaymentIsPostedAndJournaled();
+    testRefusedPaymentsMoveNothing();
+    cout << "All passed" << endl;
+    return 0;
+}
@@ -0,0 +1,321 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Test: HistoryQueryTest.cpp
+ *
+ * PostingJournal::queryHistory() against a plain scan of the same
+ * entries: for random mixes of date range, direction, category, amount
+ * bounds and search term, following the cursor page by page returns
+ * exactly the matching entries, newest first, whichever index the query
+ * reads. Search terms match word prefixes, every word of the term; a
+ * cursor keeps its place while new entries arrive.
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <cstdint>
+#include <ctime>
+#include "../utils/PostingJournal.h"
+
+using namespace std;
+using namespace SOBS;
+using namespace SOBS::Utils;
+
+namespace {
+
+const long ACCOUNT = 1;
+const long COUNTERPARTY = 2;
+const time_t START = 1700000000;
+const size_t ENTRIES = 3000;
+
+const char* const DESCRIPTIONS[] = {
+    "Netflix subscription",
+    "Transfer to Mohamed Ali",
+    "Transfer from Mohamed Salah",
+    "Salary ACME Corp",
+    "Rent - March",
+    "rent deposit refund",
+    "Café Riche",
+    "\xd9\x85\xd8\xb1\xd8\xaa\xd8\xa8 \xd8\xb4\xd9\x87\xd8\xb1",    // Arabic "monthly salary"
+    "Electricity EL-0042",
+    "Netflix netflix NETFLIX",
+};
+const size_t DESCRIPTION_COUNT = sizeof(DESCRIPTIONS) / sizeof(DESCRIPTIONS[0]);
+
+const char* const TERMS[] = {
+    "", "netf", "NETFLIX", "mohamed", "mohamed ali", "mo al", "ali mohamed", "sal",
+    "transfer salah", "caf", "caf\xc3\xa9", "\xd9\x85\xd8\xb1", "el 0042", "zzz", "rent zzz",
+    " - ",
+};
+
+struct Posted {
+    int64_t units;                      // Signed, as seen from ACCOUNT
+    Model::TransactionCategory category;
+    time_t postedAt;
+    string reference;
+    string description;
+};
+
+// Words as the journal splits them: lowercased ASCII letters and digits,
+// non-ASCII bytes kept
+vector<string> wordsOf(const string& text) {
+    vector<string> words(1);
+    for (char ch : text) {
+        unsigned char c = static_cast<unsigned char>(ch);
+        if (isalnum(c) || c >= 0x80) {
+            words.back() += static_cast<char>(c < 0x80 ? tolower(c) : c);
+        } else if (!words.back().empty()) {
+            words.emplace_back();
+        }
+    }
+    if (words.back().empty()) words.pop_back();
+    return words;
+}
+
+bool matchesTerm(const string& description, const string& term) {
+    vector<string> words = wordsOf(description);
+    for (const string& prefix : wordsOf(term)) {
+        bool found = false;
+        for (const string& word : words) {
+            found = found || word.compare(0, prefix.size(), prefix) == 0;
+        }
+        if (!found) return false;
+    }
+    return true;
+}
+
+// Positions matching 'query', newest first, by looking at every entry
+vector<size_t> expectedPositions(const vector<Posted>& posted, const HistoryQuery& query) {
+    vector<size_t> positions;
+    for (size_t i = posted.size(); i-- > 0;) {
+        const Posted& p = posted[i];
+        int64_t size = p.units < 0 ? -p.units : p.units;
+        if (i >= query.before) continue;
+        if (p.postedAt < query.from || (query.to > 0 && p.postedAt >= query.to)) continue;
+        if (!(p.units < 0 ? query.debits : query.credits)) continue;
+        if (!query.anyCategory && p.category != query.category) continue;
+        if (size < query.minUnits || size > query.maxUnits) continue;
+        if (!matchesTerm(p.description, query.searchTerm)) continue;
+        positions.push_back(i);
+    }
+    return positions;
+}
+
+// Follow the cursor to the last page; checks each page's shape
+vector<size_t> pagedPositions(const PostingJournal& journal, const vector<Posted>& posted,
+                              HistoryQuery query) {
+    vector<size_t> positions;
+    while (true) {
+        HistoryPage page;
+        assert(journal.queryHistory(ACCOUNT, query, page));
+        assert(page.rows.size() <= query.limit);
+        for (const HistoryRow& row : page.rows) {
+            assert(positions.empty() || row.position < positions.back());
+            const Posted& p = posted[row.position];
+            assert(row.entry.amount.getMinorUnits() == p.units);
+            assert(row.entry.category == p.category);
+            assert(row.entry.postedAt == p.postedAt);
+            assert(row.reference == p.reference);
+            assert(row.description == p.description);
+            positions.push_back(row.position);
+        }
+        if (!page.hasMore) return positions;
+        assert(page.rows.size() == query.limit);
+        assert(page.nextCursor == page.rows.back().position);
+        query.before = page.nextCursor;
+    }
+}
+
+int64_t randomAmount(mt19937& gen) {
+    // Spread over every decade from 1 piastre to 10 million EGP
+    int64_t units = 1 + static_cast<int64_t>(gen() % 9);
+    for (uint32_t decade = gen() % 10; decade > 0; decade--) {
+        units = units * 10 + static_cast<int64_t>(gen() % 10);
+    }
+    return units;
+}
+
+int64_t post(PostingJournal& journal, vector<Posted>& posted, int64_t units,
+             Model::TransactionCategory category, time_t postedAt, const string& description) {
+    JournalLeg legs[2] = {
+        {ACCOUNT, Model::Money::fromMinorUnits(units)},
+        {COUNTERPARTY, Model::Money::fromMinorUnits(-units)},
+    };
+    string reference = "REF" + to_string(posted.size());
+    int64_t groupId = journal.append(legs, 2, category, reference, description, postedAt);
+    assert(groupId != 0);
+    posted.push_back(Posted{units, category, postedAt, reference, description});
+    return groupId;
+}
+
+void fill(PostingJournal& journal, vector<Posted>& posted, mt19937& gen) {
+    assert(journal.openAccount(ACCOUNT, Model::Money::fromMinorUnits(INT64_MAX / 4)));
+    assert(journal.openAccount(COUNTERPARTY, Model::Money::fromMinorUnits(INT64_MAX / 4)));
+    time_t at = START;
+    for (size_t i = 0; i < ENTRIES; i++) {
+        int64_t units = randomAmount(gen);
+        if (gen() % 3 != 0) units = -units;
+        // Mostly transfers, so category lists are both large and small
+        uint32_t pick = gen() % 10;
+        Model::TransactionCategory category = static_cast<Model::TransactionCategory>(
+            pick < 5 ? 0 : pick - 4);
+        at += static_cast<time_t>(gen() % 3);   // Ties on purpose
+        post(journal, posted, units, category, at, DESCRIPTIONS[gen() % DESCRIPTION_COUNT]);
+    }
+}
+
+void testWordPrefixSearch() {
+    PostingJournal journal;
+    vector<Posted> posted;
+    assert(journal.openAccount(ACCOUNT, Model::Money()));
+    assert(journal.openAccount(COUNTERPARTY, Model::Money()));
+    for (const char* description : {"Transfer to Mohamed Ali", "Netflix", "Mohamed Salah",
+                                    "Alimony to Mohamedain"}) {
+        post(journal, posted, 100, Model::TransactionCategory::TRANSFER, START, description);
+    }
+
+    auto search = [&journal](const string& term) {
+        HistoryQuery query;
+        query.searchTerm = term;
+        HistoryPage page;
+        assert(journal.queryHistory(ACCOUNT, query, page));
+        vector<size_t> positions;
+        for (const HistoryRow& row : page.rows) positions.push_back(row.position);
+        return positions;
+    };
+    assert(search("netf") == vector<size_t>({1}));
+    assert(search("NETFLIX") == vector<size_t>({1}));
+    assert(search("netflixx").empty());
+    assert(search("flix").empty());                           // Prefixes only
+    assert(search("mohamed ali") == vector<size_t>({3, 0}));  // "Alimony" starts with "ali"
+    assert(search("ali, mohamed!") == vector<size_t>({3, 0}));
+    assert(search("mohamed salah") == vector<size_t>({2}));
+    assert(search("mohamed to").size() == 2);
+    assert(search("").size() == 4);
+    cout << "  search terms match word prefixes, every word" << endl;
+}
+
+void testPagesMatchScan() {
+    PostingJournal journal;
+    vector<Posted> posted;
+    mt19937 gen(20240517);
+    fill(journal, posted, gen);
+    const time_t end = posted.back().postedAt + 1;
+    const size_t TERM_COUNT = sizeof(TERMS) / sizeof(TERMS[0]);
+
+    for (size_t round = 0; round < 400; round++) {
+        HistoryQuery query;
+        switch (gen() % 4) {
+            case 0: break;
+            case 1: query.from = START + static_cast<time_t>(gen() % (end - START)); break;
+            case 2: query.to = START + static_cast<time_t>(gen() % (end - START)); break;
+            default:
+                query.from = START + static_cast<time_t>(gen() % (end - START));
+                query.to = query.from + static_cast<time_t>(gen() % 400);
+        }
+        switch (gen() % 4) {
+            case 0: query.debits = false; break;
+            case 1: query.credits = false; break;
+            default: break;
+        }
+        if (gen() % 3 == 0) {
+            query.anyCategory = false;
+            query.category = static_cast<Model::TransactionCategory>(gen() % 6);
+        }
+        if (gen() % 2 == 0) {
+            query.minUnits = gen() % 4 == 0 ? 0 : randomAmount(gen);
+            query.maxUnits = gen() % 4 == 0 ? INT64_MAX : query.minUnits + randomAmount(gen);
+        }
+        query.searchTerm = gen() % 3 == 0 ? TERMS[gen() % TERM_COUNT] : "";
+        const size_t limits[] = {1, 3, 20, 257, 5000};
+        query.limit = limits[gen() % 5];
+
+        assert(pagedPositions(journal, posted, query) == expectedPositions(posted, query));
+    }
+
+    // Queries that cannot match anything
+    HistoryQuery none;
+    none.debits = false;
+    none.credits = false;
+    assert(pagedPositions(journal, posted, none).empty());
+    none = HistoryQuery();
+    none.minUnits = 500;
+    none.maxUnits = 499;
+    assert(pagedPositions(journal, posted, none).empty());
+    none = HistoryQuery();
+    none.limit = 0;
+    assert(pagedPositions(journal, posted, none).empty());
+
+    HistoryPage page;
+    assert(!journal.queryHistory(99, HistoryQuery(), page));
+    cout << "  every page of every filter matches a plain scan" << endl;
+}
+
+void testBlockFilterWithinOneDecade() {
+    PostingJournal journal;
+    vector<Posted> posted;
+    mt19937 gen(99);
+    assert(journal.openAccount(ACCOUNT, Model::Money::fromMajorUnits<1000000>()));
+    assert(journal.openAccount(COUNTERPARTY, Model::Money::fromMajorUnits<1000000>()));
+    for (size_t i = 0; i < ENTRIES; i++) {
+        int64_t units = 100 + static_cast<int64_t>(gen() % 900);
+        post(journal, posted, gen() % 2 == 0 ? units : -units,
+             Model::TransactionCategory::TRANSFER, START + static_cast<time_t>(i), "Card");
+    }
+
+    // Every entry sits in the bounds' decade, so no index narrows the
+    // range and the compiled filter rejects long runs of rows itself
+    for (size_t round = 0; round < 200; round++) {
+        HistoryQuery query;
+        query.minUnits = 100 + static_cast<int64_t>(gen() % 900);
+        query.maxUnits = query.minUnits + static_cast<int64_t>(gen() % 60);
+        if (gen() % 2 == 0) {
+            query.from = START + static_cast<time_t>(gen() % ENTRIES);
+        }
+        query.limit = 1 + gen() % 8;
+        assert(pagedPositions(journal, posted, query) == expectedPositions(posted, query));
+    }
+    cout << "  block filter skips rejected runs without losing rows" << endl;
+}
+
+void testCursorSurvivesNewEntries() {
+    PostingJournal journal;
+    vector<Posted> posted;
+    mt19937 gen(7);
+    fill(journal, posted, gen);
+
+    HistoryQuery query;
+    query.credits = false;
+    query.limit = 50;
+    HistoryPage first;
+    assert(journal.queryHistory(ACCOUNT, query, first));
+    assert(first.hasMore);
+
+    // Postings after the first page do not shift the pages behind it
+    vector<size_t> before = expectedPositions(posted, query);
+    for (size_t i = 0; i < 100; i++) {
+        post(journal, posted, -1, Model::TransactionCategory::FEE,
+             posted.back().postedAt, "Card fee");
+    }
+    query.before = first.nextCursor;
+    vector<size_t> rest = pagedPositions(journal, posted, query);
+    assert(rest.size() + first.rows.size() == before.size());
+    assert(equal(rest.begin(), rest.end(), before.begin() + first.rows.size()));
+    cout << "  a cursor keeps its place while entries are appended" << endl;
+}
+
+} // namespace
+
+int main() {
+    cout << "HistoryQuery tests" << endl;
+    testWordPrefixSearch();
+    testPagesMatchScan();
+    testBlockFilterWithinOneDecade();
+    testCursorSurvivesNewEntries();
+    cout << "All passed" << endl;
+    return 0;
+}
@@ -0,0 +1,123 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Test: LoginThrottleTest.cpp
+ *
+ * Failed sign-ins are limited per email (case-insensitively) and per
+ * client address; a success clears the email's count; counts fade out
+ * over the sliding window; and a full table gives up its idle buckets
+ * before the one holding a burst.
+ */
+
+#include <iostream>
+#include <string>
+#include <cassert>
+#include "../utils/LoginThrottle.h"
+
+using namespace std;
+using namespace SOBS;
+using namespace SOBS::Utils;
+
+namespace {
+
+// Start of a window, so window boundaries fall on round offsets
+const time_t START = time_t(LoginThrottle::WINDOW_SECONDS) * 1900000;
+const time_t WINDOW = LoginThrottle::WINDOW_SECONDS;
+
+void fail(LoginThrottle& throttle, const string& email, const string& address,
+          uint32_t count, time_t now) {
+    for (uint32_t i = 0; i < count; i++) {
+        assert(throttle.admit(email, address, now));
+        throttle.recordFailure(email, address, now);
+    }
+}
+
+void testAccountLimit() {
+    LoginThrottle throttle(1024);
+    fail(throttle, "alice@example.com", "10.0.0.1",
+         LoginThrottle::MAX_ACCOUNT_FAILURES - 1, START);
+    assert(throttle.admit("alice@example.com", "10.0.0.1", START));
+    throttle.recordFailure("alice@example.com", "10.0.0.2", START);
+
+    assert(throttle.getAccountFailures("alice@example.com", START) ==
+           LoginThrottle::MAX_ACCOUNT_FAILURES);
+    assert(!throttle.admit("alice@example.com", "10.0.0.3", START));
+    assert(!throttle.admit("Alice@Example.COM", "10.0.0.3", START));
+    assert(throttle.admit("bob@example.com", "10.0.0.1", START));
+
+    // A success clears the email's count
+    throttle.recordSuccess("ALICE@example.com");
+    assert(throttle.getAccountFailures("alice@example.com", START) == 0);
+    assert(throttle.admit("alice@example.com", "10.0.0.1", START));
+    cout << "  email is refused at its failure limit until a success" << endl;
+}
+
+void testAddressLimit() {
+    const uint32_t ADDRESS_LIMIT = 10;
+    LoginThrottle throttle(1024, LoginThrottle::MAX_ACCOUNT_FAILURES, ADDRESS_LIMIT);
+
+    // One failure per email stays under every account limit
+    for (uint32_t i = 0; i < ADDRESS_LIMIT; i++) {
+        fail(throttle, "user" + to_string(i) + "@example.com", "192.0.2.7", 1, START);
+    }
+    assert(throttle.getAddressFailures("192.0.2.7", START) == ADDRESS_LIMIT);
+    assert(!throttle.admit("fresh@example.com", "192.0.2.7", START));
+    assert(throttle.admit("fresh@example.com", "192.0.2.8", START));
+
+    // Refused attempts keep counting; a success does not clear the address
+    assert(throttle.getAddressFailures("192.0.2.7", START) == ADDRESS_LIMIT + 1);
+    throttle.recordSuccess("fresh@example.com");
+    assert(!throttle.admit("fresh@example.com", "192.0.2.7", START));
+
+    // No address, no address limit
+    assert(throttle.admit("fresh@example.com", "", START));
+    cout << "  address is refused at its failure limit" << endl;
+}
+
+void testSlidingWindow() {
+    LoginThrottle throttle(1024);
+    fail(throttle, "carol@example.com", "", LoginThrottle::MAX_ACCOUNT_FAILURES, START);
+    assert(!throttle.admit("carol@example.com", "", START + WINDOW - 1));
+
+    // In the next window the old count is weighted by its unexpired share
+    assert(throttle.getAccountFailures("carol@example.com", START + WINDOW) == 5);
+    assert(!throttle.admit("carol@example.com", "", START + WINDOW));
+    assert(throttle.getAccountFailures("carol@example.com", START + WINDOW + WINDOW / 2) == 2);
+    assert(throttle.admit("carol@example.com", "", START + WINDOW + WINDOW / 2));
+
+    // New failures add to what is left of the old ones
+    throttle.recordFailure("carol@example.com", "", START + WINDOW + WINDOW / 2);
+    assert(throttle.getAccountFailures("carol@example.com", START + WINDOW + WINDOW / 2) == 3);
+
+    // Two windows on, only the later failure is left, and then nothing
+    assert(throttle.getAccountFailures("carol@example.com", START + 2 * WINDOW) == 1);
+    assert(throttle.getAccountFailures("carol@example.com", START + 3 * WINDOW) == 0);
+    assert(throttle.admit("carol@example.com", "", START + 3 * WINDOW));
+    cout << "  counts fade out over the sliding window" << endl;
+}
+
+void testFullTableKeepsBurst() {
+    // The smallest table: one probe sequence's worth of buckets
+    LoginThrottle throttle(LoginThrottle::PROBE_LIMIT);
+    fail(throttle, "target@example.com", "", LoginThrottle::MAX_ACCOUNT_FAILURES, START);
+
+    // Many single failures take over each other's buckets, not the burst's
+    for (int i = 0; i < 200; i++) {
+        throttle.recordFailure("spray" + to_string(i) + "@example.com", "", START);
+    }
+    assert(!throttle.admit("target@example.com", "", START));
+    assert(throttle.getAccountFailures("target@example.com", START) ==
+           LoginThrottle::MAX_ACCOUNT_FAILURES);
+    cout << "  full table keeps the burst's bucket" << endl;
+}
+
+} // namespace
+
+int main() {
+    cout << "LoginThrottle tests" << endl;
+    testAccountLimit();
+    testAddressLimit();
+    testSlidingWindow();
+    testFullTableKeepsBurst();
+    cout << "All passed" << endl;
+    return 0;
+}
@@ -0,0 +1,191 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Test: MoneyTest.cpp
+ *
+ * parse() reads exact decimal text across the whole int64 range and
+ * refuses anything else; format() writes it back; checked arithmetic,
+ * conversions and sum() refuse overflow and mixed currencies and leave
+ * the value unchanged; values of different currencies neither compare
+ * equal nor order.
+ */
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cassert>
+#include <cstdint>
+#include <cmath>
+#include "../model/Money.h"
+
+using namespace std;
+using namespace SOBS;
+using Model::Money;
+
+namespace {
+
+const Money UNCHANGED = Money::fromMinorUnits(4242);
+
+int64_t parsed(const string& text) {
+    Money out;
+    assert(Money::parse(text, out));
+    return out.getMinorUnits();
+}
+
+// Refused, and the output left as it was
+bool refused(const string& text) {
+    Money out = UNCHANGED;
+    if (Money::parse(text, out)) return false;
+    assert(out == UNCHANGED);
+    return true;
+}
+
+void testParse() {
+    assert(parsed("1500.5") == 150050);
+    assert(parsed("1500.50") == 150050);
+    assert(parsed("+3") == 300);
+    assert(parsed("-0.25") == -25);
+    assert(parsed("0.05") == 5);
+    assert(parsed(".5") == 50);
+    assert(parsed("7.") == 700);
+    assert(parsed("1.2300") == 123);            // Zeros past the piastre are fine
+    assert(parsed("-0") == 0);
+
+    // Both ends of the int64 range, and one piastre past each
+    assert(parsed("92233720368547758.07") == INT64_MAX);
+    assert(parsed("-92233720368547758.08") == INT64_MIN);
+    assert(refused("92233720368547758.08"));
+    assert(refused("-92233720368547758.09"));
+    assert(refused("100000000000000000000"));
+
+    for (const char* text : {"", "-", "+", ".", "1.234", "1e3", "1,000", " 1", "1 ",
+                             "1.2.3", "abc", "--1", "0x10"}) {
+        assert(refused(text));
+    }
+
+    // Only 'length' bytes are read
+    Money out;
+    assert(Money::parse("12.34xyz", 5, out) && out.getMinorUnits() == 1234);
+    assert(Money::parse("5", out, "USD") && out.getCurrency() == "USD");
+    cout << "  parse reads exact decimals over the whole range" << endl;
+}
+
+void testFormat() {
+    const struct {
+        int64_t units;
+        const char* text;
+    } cases[] = {
+        {0, "0.00"},
+        {5, "0.05"},
+        {-25, "-0.25"},
+        {150050, "1500.50"},
+        {-100, "-1.00"},
+        {INT64_MAX, "92233720368547758.07"},
+        {INT64_MIN, "-92233720368547758.08"},
+    };
+    for (const auto& c : cases) {
+        Money money = Money::fromMinorUnits(c.units);
+        char buffer[Money::MAX_TEXT_LENGTH];
+        size_t length = money.format(buffer);
+        assert(string(buffer, length) == c.text);
+        assert(buffer[length] == '\0');
+        assert(money.toString() == c.text);
+        assert(parsed(c.text) == c.units);
+    }
+
+    assert(Money::fromMinorUnits(150050).toDisplayString() == "1500.50 EGP");
+    assert(Money::fromMinorUnits(-1, "USD").toDisplayString() == "-0.01 USD");
+    stringstream stream;
+    stream << Money::fromMinorUnits(123456);
+    assert(stream.str() == "1234.56");
+    cout << "  format writes what parse reads" << endl;
+}
+
+void testCheckedArithmetic() {
+    Money money = Money::fromMinorUnits(INT64_MAX - 1);
+    assert(money.add(Money::fromMinorUnits(1)));
+    assert(!money.add(Money::fromMinorUnits(1)));
+    assert(money.getMinorUnits() == INT64_MAX);
+
+    money = Money::fromMinorUnits(INT64_MIN + 1);
+    assert(money.subtract(Money::fromMinorUnits(1)));
+    assert(!money.subtract(Money::fromMinorUnits(1)));
+    assert(!money.negate());
+    assert(money.getMinorUnits() == INT64_MIN);
+
+    money = Money::fromMinorUnits(INT64_MAX / 2 + 1);
+    assert(!money.multiply(2));
+    assert(money.getMinorUnits() == INT64_MAX / 2 + 1);
+    assert(money.multiply(-1) && money.negate());
+    assert(money.getMinorUnits() == INT64_MAX / 2 + 1);
+
+    // Currencies never mix
+    money = Money::fromMinorUnits(100);
+    assert(!money.add(Money::fromMinorUnits(1, "USD")));
+    assert(!money.subtract(Money::fromMinorUnits(1, "USD")));
+    assert(money.getMinorUnits() == 100);
+
+    // Conversions
+    Money out = UNCHANGED;
+    assert(!Money::fromMajorUnits(INT64_MAX / 100 + 1, out));
+    assert(!Money::fromMajorUnits(INT64_MIN / 100 - 1, out));
+    assert(!Money::fromDouble(NAN, out));
+    assert(!Money::fromDouble(INFINITY, out));
+    assert(!Money::fromDouble(1e19, out));
+    assert(out == UNCHANGED);
+    assert(Money::fromMajorUnits(INT64_MAX / 100, out));
+    assert(Money::fromDouble(0.1 + 0.2, out) && out.getMinorUnits() == 30);
+    cout << "  checked arithmetic refuses overflow and mixed currencies" << endl;
+}
+
+void testSum() {
+    Money total = UNCHANGED;
+    assert(Money::sum(vector<Money>(), total) && total.isZero());
+
+    // Several blocks, a huge value in one of them
+    vector<Money> values(3000, Money::fromMinorUnits(2));
+    assert(Money::sum(values, total) && total.getMinorUnits() == 6000);
+    values[1500] = Money::fromMinorUnits(INT64_MAX - 6000);
+    assert(Money::sum(values, total) && total.getMinorUnits() == INT64_MAX - 2);
+    values[2999] = Money::fromMinorUnits(5);
+    total = UNCHANGED;
+    assert(!Money::sum(values, total));
+    assert(total == UNCHANGED);
+
+    // Values that overflow only together, and a foreign value anywhere
+    vector<Money> halves(3, Money::fromMinorUnits(INT64_MAX / 2));
+    assert(!Money::sum(halves, total));
+    values.assign(2000, Money::fromMinorUnits(1));
+    values[1999] = Money::fromMinorUnits(1, "USD");
+    assert(!Money::sum(values, total));
+    assert(total == UNCHANGED);
+    cout << "  sum refuses overflow and mixed currencies" << endl;
+}
+
+void testComparisons() {
+    Money one = Money::fromMajorUnits<1>();
+    Money two = Money::fromMajorUnits<2>();
+    assert(one < two && one <= two && two > one && two >= one);
+    assert(one == Money::fromMinorUnits(100) && one != two);
+    assert(one <= one && one >= one && !(one < one));
+
+    Money dollar = Money::fromMajorUnits<1>("USD");
+    Money dollars = Money::fromMajorUnits<2>("USD");
+    assert(!(one == dollar) && one != dollar);
+    assert(!(one < dollars) && !(one <= dollars) && !(one > dollar) && !(one >= dollar));
+    assert(!(two > dollar) && !(two >= dollar) && !(dollar < two) && !(dollar <= two));
+    cout << "  different currencies neither compare equal nor order" << endl;
+}
+
+} // namespace
+
+int main() {
+    cout << "Money tests" << endl;
+    testParse();
+    testFormat();
+    testCheckedArithmetic();
+    testSum();
+    testComparisons();
+    cout << "All passed" << endl;
+    return 0;
+}
@@ -0,0 +1,174 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Test: OtpStoreTest.cpp
+ *
+ * A code verifies once, for its key, before its TTL runs out, and hands
+ * back the user it was issued to. Wrong guesses lock the code after
+ * MAX_ATTEMPTS; purpose prefixes keep keys apart; oversized keys and
+ * malformed codes are refused. A full table frees expired codes, and
+ * erasing codes never hides the ones left in the table.
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cassert>
+#include "../utils/OtpStore.h"
+#include "TestSupport.h"
+
+using namespace std;
+using namespace SOBS;
+using namespace SOBS::Utils;
+using namespace SOBS::Test;
+
+namespace {
+
+const time_t START = 1700000000;
+
+void testVerifiesOnceForItsUser() {
+    OtpStore store(64, 2);
+    string code;
+    assert(store.issue("login:17", 17, START, code));
+    assert(code.size() == size_t(OtpStore::CODE_LENGTH));
+
+    long userId = 0;
+    assert(store.verify("login:17", code, START + 1, userId) == OtpOutcome::VERIFIED);
+    assert(userId == 17);
+    assert(store.verify("login:17", code, START + 1, userId) == OtpOutcome::EXPIRED);
+
+    // Registration codes belong to no user yet
+    assert(store.issue("register:CUS1", 0, START, code));
+    userId = -1;
+    assert(store.verify("register:CUS1", code, START, userId) == OtpOutcome::VERIFIED);
+    assert(userId == 0);
+    cout << "  code verifies once and returns its user" << endl;
+}
+
+void testWrongGuessesLock() {
+    OtpStore store(64, 2);
+    string code;
+    long userId = 0;
+    assert(store.issue("transfer:TRF1", 3, START, code));
+    for (uint32_t i = 1; i < OtpStore::MAX_ATTEMPTS; i++) {
+        assert(store.verify("transfer:TRF1", wrongCode(code), START, userId) ==
+               OtpOutcome::MISMATCH);
+    }
+    assert(store.verify("transfer:TRF1", wrongCode(code), START, userId) == OtpOutcome::LOCKED);
+    assert(store.verify("transfer:TRF1", code, START, userId) == OtpOutcome::EXPIRED);
+
+    // Malformed codes count as guesses; a new code starts a fresh count
+    assert(store.issue("transfer:TRF1", 3, START, code));
+    assert(store.verify("transfer:TRF1", code.substr(0, 5), START, userId) ==
+           OtpOutcome::MISMATCH);
+    assert(store.verify("transfer:TRF1", code.substr(0, 5) + "x", START, userId) ==
+           OtpOutcome::MISMATCH);
+    assert(store.issue("transfer:TRF1", 3, START, code));
+    assert(store.verify("transfer:TRF1", wrongCode(code), START, userId) == OtpOutcome::MISMATCH);
+    assert(store.verify("transfer:TRF1", wrongCode(code), START, userId) == OtpOutcome::MISMATCH);
+    assert(store.verify("transfer:TRF1", code, START, userId) == OtpOutcome::VERIFIED);
+    cout << "  wrong guesses lock the code" << endl;
+}
+
+void testExpiresAfterTtl() {
+    OtpStore store(64, 2);
+    string first;
+    string second;
+    long userId = 0;
+    assert(store.issue("login:1", 1, START, first));
+    assert(store.issue("login:2", 2, START, second));
+    assert(store.verify("login:1", first, START + OtpStore::TTL_SECONDS - 1, userId) ==
+           OtpOutcome::VERIFIED);
+    assert(store.verify("login:2", second, START + OtpStore::TTL_SECONDS, userId) ==
+           OtpOutcome::EXPIRED);
+    cout << "  code expires after its TTL" << endl;
+}
+
+void testKeysAndPrefixes() {
+    OtpStore store(64, 2);
+    string code;
+    long userId = 0;
+
+    // The same identifier under two purposes is two keys
+    assert(store.issue("login:5", 5, START, code));
+    assert(store.verify("transfer:5", code, START, userId) == OtpOutcome::EXPIRED);
+    assert(store.verify("register:5", code, START, userId) == OtpOutcome::EXPIRED);
+    assert(store.verify("login:5", code, START, userId) == OtpOutcome::VERIFIED);
+
+    string longest(OtpStore::KEY_LENGTH, 'k');
+    assert(store.issue(longest, 9, START, code));
+    assert(store.verify(longest, code, START, userId) == OtpOutcome::VERIFIED);
+    assert(!store.issue(longest + "k", 9, START, code));
+    assert(!store.issue("", 9, START, code));
+    assert(!store.issue(string(1, '\0') + "key", 9, START, code));
+
+    // Keys differing only past the first byte stay apart
+    string a;
+    string b;
+    assert(store.issue(longest.substr(0, 31) + "a", 1, START, a));
+    assert(store.issue(longest.substr(0, 31) + "b", 2, START, b));
+    assert(store.verify(longest.substr(0, 31) + "b", b, START, userId) == OtpOutcome::VERIFIED);
+    assert(userId == 2);
+    assert(store.verify(longest.substr(0, 31) + "a", a, START, userId) == OtpOutcome::VERIFIED);
+    assert(userId == 1);
+    cout << "  prefixes keep keys apart; oversized keys are refused" << endl;
+}
+
+void testFullTableSweepsExpired() {
+    // One shard of 8 slots: room for 7 live codes
+    OtpStore store(8, 1);
+    string code;
+    for (int i = 0; i < 7; i++) {
+        assert(store.issue("login:" + to_string(i), i, START, code));
+    }
+    assert(!store.issue("login:7", 7, START, code));
+    assert(!store.issue("login:7", 7, START + OtpStore::TTL_SECONDS - 1, code));
+
+    // Reissuing a live key needs no new slot
+    assert(store.issue("login:3", 3, START, code));
+
+    // Once the first seven expire the sweep frees their slots
+    assert(store.issue("login:7", 7, START + OtpStore::TTL_SECONDS, code));
+    long userId = 0;
+    assert(store.verify("login:7", code, START + OtpStore::TTL_SECONDS, userId) ==
+           OtpOutcome::VERIFIED);
+    cout << "  full table frees expired codes" << endl;
+}
+
+void testEraseKeepsOtherCodes() {
+    // Many keys in one small shard, so probe clusters form and erasing
+    // moves entries back
+    OtpStore store(64, 1);
+    const int KEYS = 50;
+    vector<string> codes(KEYS);
+    for (int i = 0; i < KEYS; i++) {
+        assert(store.issue("transfer:TRF" + to_string(i), i, START, codes[i]));
+    }
+    long userId = 0;
+    for (int i = 0; i < KEYS; i += 3) {
+        assert(store.verify("transfer:TRF" + to_string(i), codes[i], START, userId) ==
+               OtpOutcome::VERIFIED);
+    }
+    for (int i = KEYS - 1; i >= 0; i--) {
+        OtpOutcome outcome = store.verify("transfer:TRF" + to_string(i), codes[i], START, userId);
+        if (i % 3 == 0) {
+            assert(outcome == OtpOutcome::EXPIRED);
+        } else {
+            assert(outcome == OtpOutcome::VERIFIED && userId == i);
+        }
+    }
+    cout << "  erasing codes keeps the others reachable" << endl;
+}
+
+} // namespace
+
+int main() {
+    cout << "OtpStore tests" << endl;
+    testVerifiesOnceForItsUser();
+    testWrongGuessesLock();
+    testExpiresAfterTtl();
+    testKeysAndPrefixes();
+    testFullTableSweepsExpired();
+    testEraseKeepsOtherCodes();
+    cout << "All passed" << endl;
+    return 0;
+}
@@ -0,0 +1,180 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Test: PasswordHasherTest.cpp
+ *
+ * Scrypt matches the RFC 7914 test vectors. Hashes are salted,
+ * self-describing and check only their own password,
+ * through futures, callbacks and verifyNow(); the seeded demo hash still
+ * verifies. Raising the cost keeps old hashes verifiable, jobs beyond
+ * the queue or the memory budget are refused, and queued jobs finish
+ * before the pool shuts down.
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <future>
+#include <atomic>
+#include <cassert>
+#include "../utils/PasswordHasher.h"
+#include "../utils/Scrypt.h"
+
+using namespace std;
+using namespace SOBS;
+using namespace SOBS::Utils;
+
+namespace {
+
+// Cheap parameters (1 MB) so the tests do not wait on the default cost
+const ScryptParams FAST = {10, 8, 1};
+const ScryptParams SLOWER = {11, 8, 1};
+
+// Stored hash of the demo user's password (seeded in main.cpp)
+const char* const SEED_PASSWORD = "SecurePass123!";
+const char* const SEED_HASH =
+    "$scrypt$ln=14,r=8,p=1$383001a13ba555967b467128fe2640bf$"
+    "23799fc1b0c447eacc79fd71bc31cb6d705e5309299ed86d6873afe1eabb6ea3";
+
+string deriveHex(const string& password, const string& salt, const ScryptParams& params) {
+    const char* const DIGITS = "0123456789abcdef";
+    uint8_t key[64];
+    assert(Scrypt::derive(password, reinterpret_cast<const uint8_t*>(salt.data()), salt.size(),
+                          params, key, sizeof(key)));
+    string hex;
+    for (uint8_t byte : key) {
+        hex += DIGITS[byte >> 4];
+        hex += DIGITS[byte & 0x0f];
+    }
+    return hex;
+}
+
+void testScryptKnownAnswers() {
+    // RFC 7914 section 12
+    assert(deriveHex("password", "NaCl", ScryptParams{10, 8, 16}) ==
+           "fdbabe1c9d3472007856e7190d01e9fe7c6ad7cbc8237830e77376634b373162"
+           "2eaf30d92e22a3886ff109279d9830dac727afb94a83ee6d8360cbdfa2cc0640");
+    assert(deriveHex("pleaseletmein", "SodiumChloride", ScryptParams{14, 8, 1}) ==
+           "7023bdcb3afd7348461c06cd81fd38ebfda8fbba904f8e3ea9b543f6545da1f2"
+           "d5432955613f0fcf62d49705242a9af9e61e85dc0d651e40dfcf017b45575887");
+    cout << "  scrypt matches the RFC 7914 test vectors" << endl;
+}
+
+void testHashAndVerify() {
+    PasswordHasher hasher(2, PasswordHasher::DEFAULT_QUEUE_CAPACITY,
+                          PasswordHasher::DEFAULT_MEMORY_BUDGET, FAST);
+    string first = hasher.hash("correct horse").get();
+    string second = hasher.hash("correct horse").get();
+
+    // "$scrypt$ln=10,r=8,p=1$" + 16-byte salt + 32-byte key, in hex
+    const string prefix = "$scrypt$ln=10,r=8,p=1$";
+    assert(first.compare(0, prefix.size(), prefix) == 0);
+    assert(first.size() == prefix.size() + 2 * PasswordHasher::SALT_LENGTH + 1 +
+                           2 * PasswordHasher::KEY_LENGTH);
+    assert(first != second);                    // Fresh salt each time
+
+    assert(hasher.verify("correct horse", first).get());
+    assert(hasher.verify("correct horse", second).get());
+    assert(!hasher.verify("correct horsE", first).get());
+    assert(!hasher.verify("", first).get());
+    assert(PasswordHasher::verifyNow("correct horse", first));
+    assert(!PasswordHasher::verifyNow("wrong", first));
+
+    promise<bool> checked;
+    assert(hasher.submitVerify("correct horse", first, [&checked](bool matched) {
+        checked.set_value(matched);
+    }));
+    assert(checked.get_future().get());
+    cout << "  hashes are salted and check only their password" << endl;
+}
+
+void testSeedHashAndMalformedHashes() {
+    assert(PasswordHasher::verifyNow(SEED_PASSWORD, SEED_HASH));
+    assert(!PasswordHasher::verifyNow("SecurePass123", SEED_HASH));
+
+    string seed = SEED_HASH;
+    const vector<string> malformed = {
+        "",
+        "plaintext",
+        seed.substr(0, seed.size() - 1),                        // Odd hex digit count
+        seed.substr(0, seed.size() - 34),                       // Key under 16 bytes
+        "$scrypt$ln=99,r=8,p=1$" + seed.substr(22),             // Cost out of range
+        "$scrypt$ln=14,r=8,p=1$zz" + seed.substr(24),           // Not hex
+    };
+    PasswordHasher hasher(1);
+    for (const string& hash : malformed) {
+        assert(!PasswordHasher::verifyNow(SEED_PASSWORD, hash));
+        assert(!hasher.verify(SEED_PASSWORD, hash).get());
+    }
+    cout << "  seed hash verifies; malformed hashes never match" << endl;
+}
+
+void testParamsAndMemoryBudget() {
+    // Budget for the fast and slower costs, not for the default one
+    PasswordHasher hasher(1, 8, 4 * 1024 * 1024, FAST);
+    string fast = hasher.hash("pin").get();
+
+    assert(hasher.setParams(SLOWER));
+    assert(hasher.getParams().logN == SLOWER.logN);
+    string slower = hasher.hash("pin").get();
+    assert(slower.compare(0, 14, "$scrypt$ln=11,") == 0);
+
+    // Old hashes keep their own cost
+    assert(hasher.verify("pin", fast).get());
+    assert(hasher.verify("pin", slower).get());
+
+    // Costs the budget cannot hold are refused, for new and stored hashes
+    assert(!hasher.setParams(PasswordHasher::DEFAULT_PARAMS));
+    assert(!hasher.setParams(ScryptParams{10, 0, 1}));
+    assert(hasher.getParams().logN == SLOWER.logN);
+    assert(!hasher.verify(SEED_PASSWORD, SEED_HASH).get());
+    cout << "  raised cost keeps old hashes; budget refuses large jobs" << endl;
+}
+
+void testBoundedQueueAndShutdown() {
+    const size_t CAPACITY = 3;
+    atomic<size_t> finished(0);
+    promise<void> started;
+    promise<void> release;
+    shared_future<void> released = release.get_future().share();
+    {
+        PasswordHasher hasher(1, CAPACITY, PasswordHasher::DEFAULT_MEMORY_BUDGET, FAST);
+
+        // Hold the only worker inside the first job's callback
+        assert(hasher.submitHash("first", [&](bool ok, const string&) {
+            assert(ok);
+            started.set_value();
+            released.wait();
+            finished++;
+        }));
+        started.get_future().wait();
+
+        for (size_t i = 0; i < CAPACITY; i++) {
+            assert(hasher.submitHash("queued", [&](bool ok, const string&) {
+                assert(ok);
+                finished++;
+            }));
+        }
+        assert(hasher.getQueuedCount() == CAPACITY);
+        assert(!hasher.submitHash("refused", [&](bool, const string&) { assert(false); }));
+        assert(!hasher.submitVerify("refused", SEED_HASH, [&](bool) { assert(false); }));
+        assert(hasher.hash("refused").get().empty());
+
+        release.set_value();
+        // The destructor runs the queued jobs before stopping
+    }
+    assert(finished.load() == 1 + CAPACITY);
+    cout << "  full queue refuses jobs; queued jobs finish on shutdown" << endl;
+}
+
+} // namespace
+
+int main() {
+    cout << "PasswordHasher tests" << endl;
+    testScryptKnownAnswers();
+    testHashAndVerify();
+    testSeedHashAndMalformedHashes();
+    testParamsAndMemoryBudget();
+    testBoundedQueueAndShutdown();
+    cout << "All passed" << endl;
+    return 0;
+}
@@ -0,0 +1,141 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Test: PasswordResetTest.cpp
+ *
+ * Through the authentication controller: forgot-password texts a reset
+ * code for a registered email, and reset-password with
+ * "<resetId>-<code>" stores the new hash, ends the user's sessions and
+ * swaps which password signs in. The token works once; weak passwords
+ * leave it usable; unknown emails get a reset ID that no code unlocks,
+ * and signing in with one costs a hash check like a wrong password.
+ */
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <chrono>
+#include <cassert>
+#include <cstdlib>
+#include "../controller/AuthenticationController.h"
+#include "../utils/DatabaseConnection.h"
+#include "../utils/Clock.h"
+#include "../utils/JsonValue.h"
+#include "TestSupport.h"
+
+using namespace std;
+using namespace SOBS;
+using namespace SOBS::Utils;
+using namespace SOBS::Test;
+
+namespace {
+
+const long SEED_USER = 1;
+const char* const SEED_EMAIL = "ahmed@example.com";
+const char* const SEED_PASSWORD = "SecurePass123!";
+const char* const SEED_HASH =
+    "$scrypt$ln=14,r=8,p=1$383001a13ba555967b467128fe2640bf$"
+    "23799fc1b0c447eacc79fd71bc31cb6d705e5309299ed86d6873afe1eabb6ea3";
+const char* const NEW_PASSWORD = "N3w!Passw0rd";
+
+bool signsIn(Controller::AuthenticationController& controller, const string& password,
+             const string& email = SEED_EMAIL) {
+    Controller::LoginRequest request;
+    request.email = email;
+    request.password = password;
+    return parseJson(controller.login(request)).getBool("success");
+}
+
+// Ask for a reset and read the code off the [SMS] line ("" if none sent)
+string forgotPassword(Controller::AuthenticationController& controller, const string& email,
+                      string& resetId) {
+    stringstream sms;
+    streambuf* saved = cerr.rdbuf(sms.rdbuf());
+    JsonValue json = parseJson(controller.forgotPassword(email));
+    cerr.rdbuf(saved);
+
+    assert(json.getBool("success"));
+    resetId = json.get("data").getString("resetId");
+    assert(!resetId.empty());
+    string line = sms.str();
+    size_t at = line.find("password reset code is ");
+    if (at == string::npos) return "";
+    return line.substr(at + 23, OtpStore::CODE_LENGTH);
+}
+
+void testResetChangesPasswordAndEndsSessions() {
+    DatabaseConnection* db = DatabaseConnection::getInstance();
+    db->setPasswordHash(SEED_USER, SEED_HASH);
+    string session;
+    assert(db->getSessions().create(SEED_USER, 1800, Clock::now(), session));
+
+    Controller::AuthenticationController controller;
+    assert(signsIn(controller, SEED_PASSWORD));
+    string resetId;
+    string code = forgotPassword(controller, SEED_EMAIL, resetId);
+    assert(code.size() == size_t(OtpStore::CODE_LENGTH));
+    string token = resetId + "-" + code;
+
+    // A weak password is refused without using up the token
+    assert(errorCodeOf(controller.resetPassword(token, "weak")) == "ERR_WEAK_PASSWORD");
+    JsonValue json = parseJson(controller.resetPassword(token, NEW_PASSWORD));
+    assert(json.getBool("success"));
+
+    long userId = 0;
+    assert(!db->getSessions().lookup(session, Clock::now(), userId));
+    assert(!signsIn(controller, SEED_PASSWORD));
+    assert(signsIn(controller, NEW_PASSWORD));
+
+    // The token works once
+    assert(errorCodeOf(controller.resetPassword(token, "An0ther!Pass")) == "ERR_INVALID_TOKEN");
+    assert(signsIn(controller, NEW_PASSWORD));
+    cout << "  reset stores the new password and ends sessions" << endl;
+}
+
+void testBadTokensAreRefused() {
+    Controller::AuthenticationController controller;
+    string resetId;
+    string code = forgotPassword(controller, SEED_EMAIL, resetId);
+
+    assert(errorCodeOf(controller.resetPassword("", NEW_PASSWORD)) == "ERR_INVALID_TOKEN");
+    assert(errorCodeOf(controller.resetPassword(code, NEW_PASSWORD)) == "ERR_INVALID_TOKEN");
+    assert(errorCodeOf(controller.resetPassword(resetId + "-" + wrongCode(code), NEW_PASSWORD)) ==
+           "ERR_INVALID_OTP");
+    assert(parseJson(controller.resetPassword(resetId + "-" + code, NEW_PASSWORD))
+               .getBool("success"));
+
+    // Unknown emails look the same to the caller, but nothing is sent
+    string unknownId;
+    assert(forgotPassword(controller, "nobody@example.com", unknownId).empty());
+    assert(errorCodeOf(controller.resetPassword(unknownId + "-" + code, NEW_PASSWORD)) ==
+           "ERR_INVALID_TOKEN");
+    cout << "  wrong, reused and unissued tokens are refused" << endl;
+}
+
+void testUnknownEmailCostsAHashCheck() {
+    Controller::AuthenticationController controller;
+    auto timeSignIn = [&controller](const string& email) {
+        auto start = chrono::steady_clock::now();
+        assert(!signsIn(controller, "Wr0ng!Password", email));
+        return chrono::steady_clock::now() - start;
+    };
+    auto known = timeSignIn(SEED_EMAIL);
+    auto unknown = timeSignIn("nobody@example.com");
+
+    // Both run one scrypt check; an early answer would be far quicker
+    assert(unknown * 4 > known);
+    assert(signsIn(controller, NEW_PASSWORD));
+    cout << "  unknown emails take as long to refuse as wrong passwords" << endl;
+}
+
+} // namespace
+
+int main() {
+    // Codes are masked on the console unless asked for
+    setenv("SOBS_SMS_CONSOLE", "1", 1);
+    cout << "PasswordReset tests" << endl;
+    testResetChangesPasswordAndEndsSessions();
+    testBadTokensAreRefused();
+    testUnknownEmailCostsAHashCheck();
+    cout << "All passed" << endl;
+    return 0;
+}
@@ -0,0 +1,143 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Test: SessionStoreTest.cpp
+ *
+ * Sessions resolve to their user until their expiry second and not
+ * after; remove() and removeUser() end them; the timing wheels evict
+ * short and long sessions at their expiry; and lock-free lookups keep
+ * finding a live session while other sessions in its shard churn.
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <cassert>
+#include "../utils/SessionStore.h"
+
+using namespace std;
+using namespace SOBS;
+using namespace SOBS::Utils;
+
+namespace {
+
+const time_t START = 1700000000;
+
+void testLookupUntilExpiry() {
+    SessionStore store(4, 64);
+    string token;
+    assert(store.create(42, 60, START, token));
+    assert(token.size() == size_t(SessionStore::TOKEN_LENGTH));
+
+    long userId = 0;
+    assert(store.lookup(token, START, userId) && userId == 42);
+    assert(store.lookup(token, START + 59, userId));
+    assert(!store.lookup(token, START + 60, userId));
+
+    // Unknown and malformed tokens
+    string other = token;
+    other[0] = other[0] == 'f' ? '0' : 'f';
+    assert(!store.lookup(other, START, userId));
+    assert(!store.lookup(token.substr(1), START, userId));
+    assert(!store.lookup(string(SessionStore::TOKEN_LENGTH, 'z'), START, userId));
+    assert(!store.lookup("", START, userId));
+    cout << "  session resolves until its expiry second" << endl;
+}
+
+void testRemoveAndRemoveUser() {
+    SessionStore store(4, 64);
+    vector<string> tokens(4);
+    assert(store.create(7, 600, START, tokens[0]));
+    assert(store.create(7, 600, START, tokens[1]));
+    assert(store.create(7, 600, START, tokens[2]));
+    assert(store.create(8, 600, START, tokens[3]));
+    assert(store.getSessionCount() == 4);
+
+    long userId = 0;
+    assert(store.remove(tokens[0]));
+    assert(!store.remove(tokens[0]));
+    assert(!store.lookup(tokens[0], START, userId));
+
+    assert(store.removeUser(7) == 2);
+    assert(store.removeUser(7) == 0);
+    assert(!store.lookup(tokens[1], START, userId));
+    assert(!store.lookup(tokens[2], START, userId));
+    assert(store.lookup(tokens[3], START, userId) && userId == 8);
+    assert(store.getSessionCount() == 1);
+    cout << "  remove and removeUser end sessions" << endl;
+}
+
+void testEvictionAtExpiry() {
+    SessionStore store(2, 64);
+    string token;
+    for (int i = 0; i < 100; i++) assert(store.create(i + 1, 10, START, token));
+    for (int i = 0; i < 50; i++) assert(store.create(i + 1, 5000, START, token));
+    string longLived;
+    const int LONG_TTL = 70 * 24 * 3600;        // Past the first three wheels
+    assert(store.create(500, LONG_TTL, START, longLived));
+    assert(store.getSessionCount() == 151);
+
+    store.evictExpired(START + 9);
+    assert(store.getSessionCount() == 151);
+    store.evictExpired(START + 10);
+    assert(store.getSessionCount() == 51);
+    store.evictExpired(START + 4999);
+    assert(store.getSessionCount() == 51);
+    store.evictExpired(START + 5000);
+    assert(store.getSessionCount() == 1);
+
+    // Cascading through the wheels keeps it until exactly its expiry
+    long userId = 0;
+    store.evictExpired(START + LONG_TTL - 1);
+    assert(store.getSessionCount() == 1);
+    assert(store.lookup(longLived, START + LONG_TTL - 1, userId) && userId == 500);
+    store.evictExpired(START + LONG_TTL);
+    assert(store.getSessionCount() == 0);
+    assert(!store.lookup(longLived, START + LONG_TTL - 1, userId));
+    cout << "  timing wheels evict sessions at their expiry" << endl;
+}
+
+void testLookupsDuringChurn() {
+    // One shard and few buckets, so churn shares the reader's chains
+    SessionStore store(1, 4);
+    string token;
+    assert(store.create(1, 3600, START, token));
+
+    atomic<bool> done(false);
+    atomic<size_t> misses(0);
+    vector<thread> readers;
+    for (int r = 0; r < 4; r++) {
+        readers.emplace_back([&] {
+            long userId = 0;
+            while (!done.load(memory_order_relaxed)) {
+                if (!store.lookup(token, START, userId) || userId != 1) {
+                    misses.fetch_add(1, memory_order_relaxed);
+                }
+            }
+        });
+    }
+    for (int i = 0; i < 20000; i++) {
+        string churned;
+        assert(store.create(2, 3600, START, churned));
+        assert(store.remove(churned));
+    }
+    done.store(true, memory_order_relaxed);
+    for (thread& reader : readers) reader.join();
+
+    assert(misses.load() == 0);
+    assert(store.getSessionCount() == 1);
+    cout << "  lock-free lookups survive churn in the same shard" << endl;
+}
+
+} // namespace
+
+int main() {
+    cout << "SessionStore tests" << endl;
+    testLookupUntilExpiry();
+    testRemoveAndRemoveUser();
+    testEvictionAtExpiry();
+    testLookupsDuringChurn();
+    cout << "All passed" << endl;
+    return 0;
+}
@@ -0,0 +1,210 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Test: ShardedBalanceTest.cpp
+ *
+ * Sub-balances on their own: debits borrow across sub-balances or take
+ * nothing, reverts restore the total, and concurrent credits add up
+ * exactly. Through the ledger: transfers into a sharded (hot) account
+ * from many threads are all counted, and one whose log hook fails or
+ * whose credit would overflow leaves both sides unchanged. Single
+ * postings whose hook fails are undone, on plain and hot accounts.
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <cassert>
+#include <cstdint>
+#include "../utils/ShardedBalance.h"
+#include "../utils/LedgerEngine.h"
+#include "TestSupport.h"
+
+using namespace std;
+using namespace SOBS;
+using namespace SOBS::Utils;
+using namespace SOBS::Test;
+
+namespace {
+
+const char* const MERCHANT = "30000000000001";
+const long PAYER_USER = 1;
+
+string payerNumber(size_t index) {
+    string number = "3100000000000" + to_string(index);
+    return number.substr(number.size() - 14);
+}
+
+void testCreditsAndDebits() {
+    assert(ShardedBalance(0, Model::Money()).getSubBalanceCount() == 1);
+    assert(ShardedBalance(1000, Model::Money()).getSubBalanceCount() ==
+           size_t(ShardedBalance::MAX_SUB_BALANCES));
+
+    ShardedBalance balance(4, Model::Money::fromMajorUnits<100>());
+    assert(balance.getSubBalance(0) == Model::Money::fromMajorUnits<100>());
+    assert(balance.credit(Model::Money::fromMajorUnits<20>()));
+    assert(balance.total() == Model::Money::fromMajorUnits<120>());
+
+    // Refused credits leave the total alone
+    assert(!balance.credit(Model::Money::fromMinorUnits(-1)));
+    assert(!balance.credit(Model::Money::fromMajorUnits<1>("USD")));
+    assert(balance.total() == Model::Money::fromMajorUnits<120>());
+
+    // A debit larger than the total takes nothing from any sub-balance
+    vector<Model::Money> before;
+    for (size_t i = 0; i < balance.getSubBalanceCount(); i++) {
+        before.push_back(balance.getSubBalance(i));
+    }
+    assert(!balance.debit(Model::Money::fromMajorUnits<121>()));
+    for (size_t i = 0; i < balance.getSubBalanceCount(); i++) {
+        assert(balance.getSubBalance(i) == before[i]);
+    }
+
+    // One that fits borrows beyond the thread's own sub-balance
+    assert(balance.debit(Model::Money::fromMajorUnits<110>()));
+    assert(balance.total() == Model::Money::fromMajorUnits<10>());
+    for (size_t i = 0; i < balance.getSubBalanceCount(); i++) {
+        assert(!balance.getSubBalance(i).isNegative());
+    }
+
+    balance.revertDebit(Model::Money::fromMajorUnits<110>());
+    assert(balance.total() == Model::Money::fromMajorUnits<120>());
+    balance.revertCredit(Model::Money::fromMajorUnits<20>());
+    assert(balance.total() == Model::Money::fromMajorUnits<100>());
+    cout << "  debits borrow across sub-balances or take nothing" << endl;
+}
+
+void testConcurrentCreditsAddUp() {
+    const size_t THREADS = 8;
+    const size_t CREDITS = 50000;
+
+    ShardedBalance balance(8, Model::Money());
+    vector<thread> workers;
+    for (size_t t = 0; t < THREADS; t++) {
+        workers.emplace_back([&balance] {
+            for (size_t i = 0; i < CREDITS; i++) {
+                assert(balance.credit(Model::Money::fromMinorUnits(3)));
+            }
+        });
+    }
+    for (thread& worker : workers) worker.join();
+
+    assert(balance.total().getMinorUnits() == static_cast<int64_t>(THREADS * CREDITS * 3));
+    cout << "  concurrent credits add up exactly" << endl;
+}
+
+void testTransfersIntoHotAccount() {
+    const size_t PAYERS = 8;
+    const size_t TRANSFERS = 5000;
+
+    LedgerEngine ledger;
+    openAccount(ledger, MERCHANT, PAYER_USER, Model::Money::fromMajorUnits<1000>());
+    for (size_t i = 0; i < PAYERS; i++) {
+        openAccount(ledger, payerNumber(i), PAYER_USER, Model::Money::fromMajorUnits<100000>());
+    }
+    assert(ledger.shardBalance(MERCHANT, 8));
+    assert(ledger.isBalanceSharded(MERCHANT));
+    assert(!ledger.shardBalance(MERCHANT, 8));
+
+    vector<thread> workers;
+    for (size_t t = 0; t < PAYERS; t++) {
+        workers.emplace_back([&ledger, t] {
+            for (size_t i = 0; i < TRANSFERS; i++) {
+                assert(ledger.transfer(payerNumber(t), MERCHANT, Model::Money::fromMinorUnits(250),
+                                       "Purchase") == TransferOutcome::COMPLETED);
+            }
+        });
+    }
+    for (thread& worker : workers) worker.join();
+
+    int64_t paid = static_cast<int64_t>(TRANSFERS) * 250;
+    assert(balanceOf(ledger, MERCHANT) == 100000 + static_cast<int64_t>(PAYERS) * paid);
+    for (size_t i = 0; i < PAYERS; i++) {
+        assert(balanceOf(ledger, payerNumber(i)) == 10000000 - paid);
+    }
+    assert(ledger.getPostings(MERCHANT).size() == PAYERS * TRANSFERS);
+
+    // The hot account can still pay out, but not more than it holds
+    assert(ledger.transfer(MERCHANT, payerNumber(0), Model::Money::fromMajorUnits<500>(),
+                           "Refund") == TransferOutcome::COMPLETED);
+    assert(ledger.transfer(MERCHANT, payerNumber(0), Model::Money::fromMajorUnits<1000000>(),
+                           "Too much") == TransferOutcome::INSUFFICIENT_FUNDS);
+    cout << "  transfers into a hot account are all counted" << endl;
+}
+
+void testFailedTransfersIntoHotAccountAreUndone() {
+    LedgerEngine ledger;
+    openAccount(ledger, MERCHANT, PAYER_USER, Model::Money::fromMajorUnits<1000>());
+    openAccount(ledger, payerNumber(0), PAYER_USER, Model::Money::fromMajorUnits<100>());
+    assert(ledger.shardBalance(MERCHANT, 4));
+
+    TransferOutcome outcome = ledger.transfer(
+        payerNumber(0), MERCHANT, Model::Money::fromMajorUnits<40>(), "log fails",
+        [](const Model::Account&, const Model::Account& to) {
+            assert(to.getBalance() == Model::Money::fromMajorUnits<1040>());
+            return false;
+        });
+    assert(outcome == TransferOutcome::LOG_FAILED);
+    assert(balanceOf(ledger, MERCHANT) == 100000);
+    assert(balanceOf(ledger, payerNumber(0)) == 10000);
+    assert(ledger.getPostings(MERCHANT).empty());
+
+    // An overflowing credit is refused before the payer is debited
+    LedgerEngine full;
+    openAccount(full, MERCHANT, PAYER_USER, Model::Money::fromMinorUnits(INT64_MAX - 10));
+    openAccount(full, payerNumber(0), PAYER_USER, Model::Money::fromMajorUnits<100>());
+    assert(full.shardBalance(MERCHANT, 1));
+    assert(full.transfer(payerNumber(0), MERCHANT, Model::Money::fromMajorUnits<1>(),
+                         "overflow") == TransferOutcome::BALANCE_OVERFLOW);
+    assert(balanceOf(full, payerNumber(0)) == 10000);
+    assert(balanceOf(full, MERCHANT) == INT64_MAX - 10);
+    cout << "  failed transfers into a hot account are undone" << endl;
+}
+
+void testFailedPostingHookIsUndone() {
+    LedgerEngine ledger;
+    openAccount(ledger, payerNumber(0), PAYER_USER, Model::Money::fromMajorUnits<100>());
+    openAccount(ledger, MERCHANT, PAYER_USER, Model::Money::fromMajorUnits<1000>());
+    assert(ledger.shardBalance(MERCHANT, 4));
+
+    const struct {
+        string number;
+        Model::Money amount;
+        int64_t expectedSeen;
+    } cases[] = {
+        {payerNumber(0), Model::Money::fromMajorUnits<30>(), 13000},
+        {payerNumber(0), Model::Money::fromMinorUnits(-3000), 7000},
+        {MERCHANT, Model::Money::fromMajorUnits<30>(), 103000},
+        {MERCHANT, Model::Money::fromMinorUnits(-3000), 97000},
+    };
+    for (const auto& c : cases) {
+        int64_t before = balanceOf(ledger, c.number);
+        int64_t seen = 0;
+        assert(ledger.post(c.number, c.amount, "log fails", [&](const Model::Account& account) {
+            seen = account.getBalance().getMinorUnits();
+            return false;
+        }) < 0);
+        assert(seen == c.expectedSeen);
+        assert(balanceOf(ledger, c.number) == before);
+        assert(ledger.getPostings(c.number).empty());
+    }
+
+    // A hook that succeeds keeps the posting
+    assert(ledger.post(MERCHANT, Model::Money::fromMajorUnits<5>(), "logged",
+                       [](const Model::Account&) { return true; }) >= 0);
+    assert(balanceOf(ledger, MERCHANT) == 100500);
+    cout << "  postings whose hook fails are undone" << endl;
+}
+
+} // namespace
+
+int main() {
+    cout << "ShardedBalance tests" << endl;
+    testCreditsAndDebits();
+    testConcurrentCreditsAddUp();
+    testTransfersIntoHotAccount();
+    testFailedTransfersIntoHotAccountAreUndone();
+    testFailedPostingHookIsUndone();
+    cout << "All passed" << endl;
+    return 0;
+}
@@ -0,0 +1,95 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Test: TestSupport.h
+ *
+ * Helpers the test programs share: opening accounts on a ledger or the
+ * database, reading balances, picking apart JSON responses and making a
+ * code that is certainly wrong. Each check asserts, like the tests.
+ */
+
+#ifndef TESTSUPPORT_H
+#define TESTSUPPORT_H
+
+#include <string>
+#include <cassert>
+#include <cstdint>
+#include "../model/Account.h"
+#include "../model/Money.h"
+#include "../utils/DatabaseConnection.h"
+#include "../utils/LedgerEngine.h"
+#include "../utils/JsonValue.h"
+
+using namespace std;
+
+namespace SOBS {
+namespace Test {
+
+/**
+ * Checking account with a daily limit the tests do not reach unless
+ * they pass one
+ */
+inline Model::Account makeAccount(const string& number, long userId, const Model::Money& balance,
+                                  const Model::Money& dailyLimit =
+                                      Model::Money::fromMajorUnits<1000000>()) {
+    Model::Account account(userId, Model::AccountType::CHECKING);
+    account.setAccountNumber(number);
+    account.setBalance(balance);
+    account.setDailyTransferLimit(dailyLimit);
+    return account;
+}
+
+inline void openAccount(Utils::LedgerEngine& ledger, const string& number, long userId,
+                        const Model::Money& balance) {
+    assert(ledger.openAccount(makeAccount(number, userId, balance)));
+}
+
+/**
+ * Open a checking account through the database and return it as stored,
+ * with the account ID the database gave it
+ */
+inline Model::Account openAccount(const string& number, long userId, const Model::Money& balance) {
+    Utils::DatabaseConnection* db = Utils::DatabaseConnection::getInstance();
+    Model::Account account = makeAccount(number, userId, balance);
+    assert(db->openAccount(account));
+    assert(db->getLedger().getAccount(number, account));
+    return account;
+}
+
+inline int64_t balanceOf(const Utils::LedgerEngine& ledger, const string& number) {
+    Model::Money balance;
+    Model::Money available;
+    assert(ledger.getBalance(number, balance, available));
+    return balance.getMinorUnits();
+}
+
+inline int64_t balanceOf(const string& number) {
+    return balanceOf(Utils::DatabaseConnection::getInstance()->getLedger(), number);
+}
+
+inline Utils::JsonValue parseJson(const string& response) {
+    Utils::JsonValue json;
+    assert(Utils::JsonValue::parse(response, json));
+    return json;
+}
+
+/**
+ * Error code of a failed response
+ */
+inline string errorCodeOf(const string& response) {
+    Utils::JsonValue json = parseJson(response);
+    assert(!json.getBool("success", true));
+    return json.getString("errorCode");
+}
+
+/**
+ * 'code' with one digit changed
+ */
+inline string wrongCode(string code, size_t digit = 0) {
+    code[digit] = code[digit] == '9' ? '0' : static_cast<char>(code[digit] + 1);
+    return code;
+}
+
+} // namespace Test
+} // namespace SOBS
+
+#endif // TESTSUPPORT_H
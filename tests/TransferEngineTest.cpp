@@ -0,0 +1,250 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Test: TransferEngineTest.cpp
+ *
+ * Two-account transfers: a completed transfer moves both balances and
+ * journals a balanced pair; every refused outcome, and a hook that
+ * fails after both legs applied, leaves both accounts exactly as they
+ * were; opposite-direction transfers on shared accounts from many
+ * threads neither deadlock nor leak money. Through the transfer
+ * controller, a transfer below the OTP threshold executes when it is
+ * initiated and refusals come back as error codes.
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <cassert>
+#include <cstdint>
+#include "../controller/TransferController.h"
+#include "../utils/DatabaseConnection.h"
+#include "../utils/TransferEngine.h"
+#include "../utils/JsonValue.h"
+#include "TestSupport.h"
+
+using namespace std;
+using namespace SOBS;
+using namespace SOBS::Utils;
+using namespace SOBS::Test;
+
+namespace {
+
+const char* const ALICE = "10000000000001";
+const char* const BOB = "10000000000002";
+const char* const MISSING = "10000000009999";
+
+struct Bank {
+    LedgerEngine ledger;
+    WriteAheadLog wal;      // Not opened
+    PostingJournal journal;
+    DashboardSummaries summaries;
+    TransferEngine engine;
+
+    Bank() : engine(ledger, wal, journal, summaries) {}
+
+    void open(const string& number, const Model::Money& balance,
+              const Model::Money& dailyLimit = Model::Money::fromMajorUnits<1000000>()) {
+        assert(ledger.openAccount(makeAccount(number, 1, balance, dailyLimit)));
+    }
+
+    Model::Account get(const string& number) const {
+        Model::Account account;
+        assert(ledger.getAccount(number, account));
+        return account;
+    }
+
+    int64_t availableOf(const string& number) const {
+        return get(number).getAvailableBalance().getMinorUnits();
+    }
+};
+
+string accountNumber(size_t index) {
+    string number = "2000000000000" + to_string(index);
+    return number.substr(number.size() - 14);
+}
+
+void testCompletedTransferIsJournaled() {
+    Bank bank;
+    bank.open(ALICE, Model::Money::fromMajorUnits<1000>());
+    bank.open(BOB, Model::Money::fromMajorUnits<50>());
+
+    assert(bank.engine.execute(ALICE, BOB, Model::Money::fromMajorUnits<300>(),
+                               "Rent", "TRF0001") == TransferOutcome::COMPLETED);
+    assert(balanceOf(bank.ledger, ALICE) == 70000);
+    assert(balanceOf(bank.ledger, BOB) == 35000);
+    assert(bank.availableOf(ALICE) == 70000);
+
+    // Journal balances follow the ledger, and both legs carry the reference
+    for (const char* number : {ALICE, BOB}) {
+        Model::Money journaled;
+        assert(bank.journal.getBalance(bank.get(number).getAccountId(), journaled));
+        assert(journaled.getMinorUnits() == balanceOf(bank.ledger, number));
+        vector<Model::Transaction> history =
+            bank.journal.getTransactions(bank.get(number).getAccountId());
+        assert(history.size() == 1);
+        assert(history[0].getReferenceNumber() == "TRF0001");
+        assert(history[0].getAmount() == Model::Money::fromMajorUnits<300>());
+    }
+    assert(bank.ledger.getPostings(ALICE).size() == 1);
+    assert(bank.ledger.getPostings(BOB).size() == 1);
+    assert(bank.engine.getCompletedCount() == 1);
+    cout << "  completed transfer moves both balances and journals both legs" << endl;
+}
+
+void testRefusedTransfersChangeNothing() {
+    Bank bank;
+    bank.open(ALICE, Model::Money::fromMajorUnits<100>(), Model::Money::fromMajorUnits<60>());
+    bank.open(BOB, Model::Money::fromMajorUnits<100>());
+
+    const struct {
+        const char* sender;
+        const char* recipient;
+        Model::Money amount;
+        TransferOutcome expected;
+    } cases[] = {
+        {ALICE, BOB, Model::Money::fromMajorUnits<500>(), TransferOutcome::INSUFFICIENT_FUNDS},
+        {ALICE, BOB, Model::Money::fromMajorUnits<80>(), TransferOutcome::DAILY_LIMIT_EXCEEDED},
+        {ALICE, BOB, Model::Money(), TransferOutcome::INVALID_AMOUNT},
+        {ALICE, ALICE, Model::Money::fromMajorUnits<1>(), TransferOutcome::SAME_ACCOUNT},
+        {MISSING, BOB, Model::Money::fromMajorUnits<1>(), TransferOutcome::SENDER_NOT_FOUND},
+        {ALICE, MISSING, Model::Money::fromMajorUnits<1>(), TransferOutcome::RECIPIENT_NOT_FOUND},
+    };
+    for (const auto& c : cases) {
+        assert(bank.engine.execute(c.sender, c.recipient, c.amount, "refused") == c.expected);
+        assert(balanceOf(bank.ledger, ALICE) == 10000);
+        assert(balanceOf(bank.ledger, BOB) == 10000);
+        assert(bank.availableOf(ALICE) == 10000);
+    }
+    assert(bank.ledger.getPostings(ALICE).empty());
+    assert(bank.journal.getEntryCount() == 0);
+    assert(bank.engine.getRejectedCount() == sizeof(cases) / sizeof(cases[0]));
+
+    // The daily limit counts only transfers that applied
+    assert(bank.engine.execute(ALICE, BOB, Model::Money::fromMajorUnits<60>(), "ok") ==
+           TransferOutcome::COMPLETED);
+    cout << "  refused transfers leave both accounts unchanged" << endl;
+}
+
+void testBalanceOverflowChangesNothing() {
+    Bank bank;
+    bank.open(ALICE, Model::Money::fromMajorUnits<100>());
+    bank.open(BOB, Model::Money::fromMinorUnits(INT64_MAX - 10));
+
+    assert(bank.engine.execute(ALICE, BOB, Model::Money::fromMajorUnits<1>(), "overflow") ==
+           TransferOutcome::BALANCE_OVERFLOW);
+    assert(balanceOf(bank.ledger, ALICE) == 10000);
+    assert(balanceOf(bank.ledger, BOB) == INT64_MAX - 10);
+    cout << "  recipient overflow is refused before the debit" << endl;
+}
+
+void testFailedHookUndoesBothLegs() {
+    Bank bank;
+    bank.open(ALICE, Model::Money::fromMajorUnits<100>());
+    bank.open(BOB, Model::Money::fromMajorUnits<100>());
+
+    bool sawUpdated = false;
+    TransferOutcome outcome = bank.ledger.transfer(
+        ALICE, BOB, Model::Money::fromMajorUnits<40>(), "log fails",
+        [&](const Model::Account& from, const Model::Account& to) {
+            sawUpdated = from.getBalance() == Model::Money::fromMajorUnits<60>() &&
+                         to.getBalance() == Model::Money::fromMajorUnits<140>();
+            return false;
+        });
+    assert(outcome == TransferOutcome::LOG_FAILED);
+    assert(sawUpdated);
+    assert(balanceOf(bank.ledger, ALICE) == 10000);
+    assert(bank.availableOf(ALICE) == 10000);
+    assert(balanceOf(bank.ledger, BOB) == 10000);
+    assert(bank.availableOf(BOB) == 10000);
+    assert(bank.ledger.getPostings(ALICE).empty());
+
+    // The failed attempt did not count toward the daily limit
+    Model::Account alice = bank.get(ALICE);
+    assert(alice.getDailyTransferred().isZero());
+    cout << "  failed hook undoes both legs" << endl;
+}
+
+void testConcurrentTransfersConserveMoney() {
+    const size_t ACCOUNTS = 4;
+    const size_t THREADS = 8;
+    const size_t TRANSFERS = 20000;
+
+    Bank bank;
+    for (size_t i = 0; i < ACCOUNTS; i++) {
+        bank.open(accountNumber(i), Model::Money::fromMajorUnits<100000>(),
+                  Model::Money::fromMajorUnits<100000000>());
+    }
+
+    // Every thread walks the same accounts in a different direction, so
+    // any lock-order inversion would deadlock here
+    vector<thread> workers;
+    for (size_t t = 0; t < THREADS; t++) {
+        workers.emplace_back([&bank, t] {
+            for (size_t i = 0; i < TRANSFERS; i++) {
+                size_t from = (t + i) % ACCOUNTS;
+                size_t to = t % 2 == 0 ? (from + 1) % ACCOUNTS : (from + ACCOUNTS - 1) % ACCOUNTS;
+                bank.engine.execute(accountNumber(from), accountNumber(to),
+                                    Model::Money::fromMinorUnits(1 + static_cast<int64_t>(i % 7)),
+                                    "concurrent");
+            }
+        });
+    }
+    for (thread& worker : workers) worker.join();
+
+    int64_t total = 0;
+    for (size_t i = 0; i < ACCOUNTS; i++) {
+        string number = accountNumber(i);
+        total += balanceOf(bank.ledger, number);
+        Model::Money journaled;
+        assert(bank.journal.getBalance(bank.get(number).getAccountId(), journaled));
+        assert(journaled.getMinorUnits() == balanceOf(bank.ledger, number));
+    }
+    assert(total == static_cast<int64_t>(ACCOUNTS) * 10000000);
+    assert(bank.engine.getCompletedCount() == THREADS * TRANSFERS);
+    cout << "  concurrent transfers neither deadlock nor leak money" << endl;
+}
+
+void testControllerExecutesSmallTransfer() {
+    DatabaseConnection* db = DatabaseConnection::getInstance();
+    const char* const CAROL = "10000000000003";
+    const char* const DAVE = "10000000000004";
+    openAccount(CAROL, 7, Model::Money::fromMajorUnits<1000>());
+    Model::Account dave = openAccount(DAVE, 7, Model::Money::fromMajorUnits<1000>());
+    Controller::TransferController controller;
+    Controller::TransferRequest request;
+    request.senderAccountNumber = CAROL;
+    request.recipientAccountNumber = DAVE;
+    request.amount = Model::Money::fromMajorUnits<250>();
+    request.description = "Dinner";
+
+    JsonValue json = parseJson(controller.initiateTransfer("USR7", request));
+    assert(json.getBool("success"));
+    assert(json.get("data").getString("status") == "COMPLETED");
+    string reference = json.get("data").getString("transferId");
+
+    assert(balanceOf(CAROL) == 75000);
+    assert(balanceOf(DAVE) == 125000);
+    vector<Model::Transaction> history = db->getJournal().getTransactions(dave.getAccountId());
+    assert(history.size() == 1 && history[0].getReferenceNumber() == reference);
+
+    // Engine refusals surface as error codes, with nothing moved
+    request.amount = Model::Money::fromMajorUnits<1000>();
+    assert(errorCodeOf(controller.initiateTransfer("USR7", request)) == "ERR_INSUFFICIENT_FUNDS");
+    assert(balanceOf(CAROL) == 75000);
+    cout << "  controller executes transfers below the OTP threshold" << endl;
+}
+
+} // namespace
+
+int main() {
+    cout << "TransferEngine tests" << endl;
+    testCompletedTransferIsJournaled();
+    testRefusedTransfersChangeNothing();
+    testBalanceOverflowChangesNothing();
+    testFailedHookUndoesBothLegs();
+    testConcurrentTransfersConserveMoney();
+    testControllerExecutesSmallTransfer();
+    cout << "All passed" << endl;
+    return 0;
+}
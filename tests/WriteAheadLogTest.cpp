@@ -0,0 +1,318 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Test: WriteAheadLogTest.cpp
+ *
+ * Transfers logged by one engine come back in a fresh one that replays
+ * the log: balances, journal history (times and references included)
+ * and dashboard totals. A torn or corrupt tail is dropped, and records
+ * appended after it are read back on the next restart. Once a write
+ * fails the log takes no more records, and the journal reversal of a
+ * refused transfer stays out of the spending rollups. A record that
+ * cannot be replayed stops the database from connecting.
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cassert>
+#include <cstdio>
+#include <csignal>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include "../utils/TransferEngine.h"
+#include "../utils/DatabaseConnection.h"
+#include "../utils/Clock.h"
+
+using namespace std;
+using namespace SOBS;
+using namespace SOBS::Utils;
+
+namespace {
+
+const char* const ALICE = "10000000000001";
+const char* const BOB = "10000000000002";
+const char* const CAROL = "10000000000003";
+const long ALICE_USER = 1;
+const long BOB_USER = 2;
+
+// One process lifetime: the seeded accounts plus whatever the log replays
+struct Bank {
+    LedgerEngine ledger;
+    WriteAheadLog wal;
+    PostingJournal journal;
+    DashboardSummaries summaries;
+    TransferEngine engine;
+    size_t replayed = 0;
+
+    Bank() : engine(ledger, wal, journal, summaries) {
+        open(ALICE, ALICE_USER, 1000);
+        open(BOB, BOB_USER, 500);
+        open(CAROL, BOB_USER, 0);
+    }
+
+    void open(const char* number, long userId, int64_t units) {
+        Model::Money balance;
+        assert(Model::Money::fromMajorUnits(units, balance));
+        Model::Account account(userId, Model::AccountType::CHECKING);
+        account.setAccountNumber(number);
+        account.setBalance(balance);
+        assert(ledger.openAccount(account));
+        summaries.openAccount(userId, balance);
+    }
+
+    bool start(const string& path) {
+        return wal.open(path, chrono::microseconds(0), [this](const string& record) {
+            if (engine.replay(record)) replayed++;
+        });
+    }
+
+    int64_t balanceOf(const char* number) const {
+        Model::Money balance;
+        Model::Money available;
+        assert(ledger.getBalance(number, balance, available));
+        return balance.getMinorUnits();
+    }
+
+    long idOf(const char* number) const {
+        Model::Account account;
+        assert(ledger.getAccount(number, account));
+        return account.getAccountId();
+    }
+
+    int64_t totalOf(long userId) const {
+        DashboardSummary summary;
+        assert(summaries.getSummary(userId, time(nullptr), summary));
+        return summary.totalBalanceUnits;
+    }
+};
+
+string tempPath() {
+    return "/tmp/sobs_wal_test_" + to_string(getpid()) + ".wal";
+}
+
+off_t fileSize(const string& path) {
+    struct stat info;
+    assert(stat(path.c_str(), &info) == 0);
+    return info.st_size;
+}
+
+void appendBytes(const string& path, const string& bytes) {
+    FILE* file = fopen(path.c_str(), "ab");
+    assert(file != nullptr);
+    assert(fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size());
+    fclose(file);
+}
+
+void flipLastByte(const string& path) {
+    FILE* file = fopen(path.c_str(), "r+b");
+    assert(file != nullptr);
+    assert(fseek(file, -2, SEEK_END) == 0);     // Inside the last payload, before its '\n'
+    int byte = fgetc(file);
+    assert(fseek(file, -2, SEEK_END) == 0);
+    fputc(byte ^ 0x20, file);
+    fclose(file);
+}
+
+// Every journal entry of an account, compared field by field
+void expectSameHistory(const Bank& before, const Bank& after, const char* number) {
+    vector<Model::Transaction> expected = before.journal.getTransactions(before.idOf(number));
+    vector<Model::Transaction> actual = after.journal.getTransactions(after.idOf(number));
+    assert(expected.size() == actual.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+        assert(expected[i].getAmount() == actual[i].getAmount());
+        assert(expected[i].getBalanceAfter() == actual[i].getBalanceAfter());
+        assert(expected[i].getReferenceNumber() == actual[i].getReferenceNumber());
+        assert(expected[i].getDescription() == actual[i].getDescription());
+        assert(expected[i].getTransactionDate() == actual[i].getTransactionDate());
+        assert(expected[i].getType() == actual[i].getType());
+    }
+}
+
+void testReplayRestoresBalancesAndHistory() {
+    string path = tempPath();
+    unlink(path.c_str());
+
+    Bank first;
+    assert(first.start(path));
+    assert(first.engine.execute(ALICE, BOB, Model::Money::fromMajorUnits<100>(),
+                                "Rent share", "TRF0001") == TransferOutcome::COMPLETED);
+    assert(first.engine.execute(BOB, CAROL, Model::Money::fromMajorUnits<250>(),
+                                "Savings", "TRF0002") == TransferOutcome::COMPLETED);
+    // Refused transfers are never logged
+    assert(first.engine.execute(CAROL, ALICE, Model::Money::fromMajorUnits<5000>(),
+                                "Too much", "TRF0003") == TransferOutcome::INSUFFICIENT_FUNDS);
+    first.wal.close();
+
+    Bank second;
+    assert(second.start(path));
+    assert(second.replayed == 2);
+    for (const char* number : {ALICE, BOB, CAROL}) {
+        assert(second.balanceOf(number) == first.balanceOf(number));
+        expectSameHistory(first, second, number);
+    }
+    assert(second.totalOf(ALICE_USER) == first.totalOf(ALICE_USER));
+    assert(second.totalOf(BOB_USER) == first.totalOf(BOB_USER));
+
+    // New transfers follow the replayed ones in the same log
+    assert(second.engine.execute(CAROL, ALICE, Model::Money::fromMajorUnits<50>(),
+                                 "Refund", "TRF0004") == TransferOutcome::COMPLETED);
+    second.wal.close();
+
+    Bank third;
+    assert(third.start(path));
+    assert(third.replayed == 3);
+    assert(third.balanceOf(ALICE) == second.balanceOf(ALICE));
+    assert(third.balanceOf(CAROL) == Model::Money::fromMajorUnits<200>().getMinorUnits());
+    expectSameHistory(second, third, CAROL);
+    third.wal.close();
+
+    unlink(path.c_str());
+    cout << "  replay restores balances, history and summaries" << endl;
+}
+
+void testTornTailIsDropped() {
+    string path = tempPath();
+    unlink(path.c_str());
+
+    Bank first;
+    assert(first.start(path));
+    assert(first.engine.execute(ALICE, BOB, Model::Money::fromMajorUnits<10>(),
+                                "Coffee", "TRF0101") == TransferOutcome::COMPLETED);
+    first.wal.close();
+    off_t intact = fileSize(path);
+
+    // A crash mid-write: a header promising more bytes than follow
+    appendBytes(path, string("\x40\x00\x00\x00\x12\x34\x56\x78T 17", 12));
+
+    Bank second;
+    assert(second.start(path));
+    assert(second.replayed == 1);
+    assert(fileSize(path) == intact);
+    assert(second.balanceOf(BOB) == first.balanceOf(BOB));
+    assert(second.engine.execute(BOB, ALICE, Model::Money::fromMajorUnits<5>(),
+                                 "Change", "TRF0102") == TransferOutcome::COMPLETED);
+    second.wal.close();
+
+    // The record written after the truncation reads back
+    Bank third;
+    assert(third.start(path));
+    assert(third.replayed == 2);
+    assert(third.balanceOf(ALICE) == second.balanceOf(ALICE));
+    expectSameHistory(second, third, ALICE);
+    third.wal.close();
+
+    unlink(path.c_str());
+    cout << "  torn tail is dropped" << endl;
+}
+
+void testCorruptRecordEndsReplay() {
+    string path = tempPath();
+    unlink(path.c_str());
+
+    Bank first;
+    assert(first.start(path));
+    assert(first.engine.execute(ALICE, BOB, Model::Money::fromMajorUnits<10>(),
+                                "First", "TRF0201") == TransferOutcome::COMPLETED);
+    assert(first.engine.execute(ALICE, BOB, Model::Money::fromMajorUnits<20>(),
+                                "Second", "TRF0202") == TransferOutcome::COMPLETED);
+    first.wal.close();
+
+    // A checksum mismatch in the last record: only the first survives
+    flipLastByte(path);
+
+    Bank second;
+    assert(second.start(path));
+    assert(second.replayed == 1);
+    assert(second.balanceOf(BOB) == Model::Money::fromMajorUnits<510>().getMinorUnits());
+    assert(second.journal.getTransactions(second.idOf(BOB)).size() == 1);
+    second.wal.close();
+
+    unlink(path.c_str());
+    cout << "  corrupt record ends replay" << endl;
+}
+
+void testFailedWriteStopsAppends() {
+    string path = tempPath();
+    unlink(path.c_str());
+
+    // Writes past the file size limit fail with EFBIG instead of a signal
+    struct rlimit saved;
+    assert(getrlimit(RLIMIT_FSIZE, &saved) == 0);
+    signal(SIGXFSZ, SIG_IGN);
+
+    Bank first;
+    assert(first.start(path));
+    struct rlimit none = {0, saved.rlim_max};
+    assert(setrlimit(RLIMIT_FSIZE, &none) == 0);
+
+    // Applied but never durable; after that the log refuses records
+    assert(first.engine.execute(ALICE, BOB, Model::Money::fromMajorUnits<10>(),
+                                "Lost", "TRF0301") == TransferOutcome::NOT_DURABLE);
+    assert(first.wal.append("P 10000000000001 1.00 late\n") == 0);
+    assert(first.engine.execute(ALICE, BOB, Model::Money::fromMajorUnits<20>(),
+                                "Refused", "TRF0302") == TransferOutcome::LOG_FAILED);
+    assert(first.balanceOf(BOB) == Model::Money::fromMajorUnits<510>().getMinorUnits());
+
+    // The refused transfer's journal reversal is not spending or income
+    int64_t month = Clock::localMonth(time(nullptr));
+    for (const char* number : {ALICE, BOB}) {
+        SpendingRollups::Totals totals;
+        assert(first.journal.readRollups(first.idOf(number), [&](const SpendingRollups& r) {
+            totals = r.sumMonths(month, month + 1);
+        }));
+        int64_t moved = number == ALICE ? totals.totalSpent() : totals.totalIncome();
+        assert(moved == Model::Money::fromMajorUnits<10>().getMinorUnits());
+        assert((number == ALICE ? totals.totalIncome() : totals.totalSpent()) == 0);
+    }
+    first.wal.close();
+    assert(setrlimit(RLIMIT_FSIZE, &saved) == 0);
+
+    // Nothing was written after the failed batch
+    assert(fileSize(path) == 0);
+    Bank second;
+    assert(second.start(path));
+    assert(second.replayed == 0);
+    second.wal.close();
+
+    unlink(path.c_str());
+    signal(SIGXFSZ, SIG_DFL);
+    cout << "  failed write stops further appends" << endl;
+}
+
+void testUnreplayableRecordStopsConnect() {
+    string path = tempPath();
+    unlink(path.c_str());
+
+    // A posting to an account the ledger does not have
+    WriteAheadLog wal;
+    assert(wal.open(path, chrono::microseconds(0), nullptr));
+    string record;
+    DatabaseSession::encodeRedo(record, "10000000009999", Model::Money::fromMajorUnits<5>(),
+                                "SQL update");
+    assert(wal.waitDurable(wal.append(record)));
+    wal.close();
+
+    DatabaseConnection* db = DatabaseConnection::getInstance();
+    db->configureWriteAheadLog(path, chrono::microseconds(0));
+    assert(!db->connect("localhost", 5432, "sobs_db", "sobs_user", "secret"));
+    assert(!db->isConnected());
+    assert(!db->getWriteAheadLog().isOpen());
+
+    unlink(path.c_str());
+    cout << "  unreplayable record stops connect" << endl;
+}
+
+} // namespace
+
+int main() {
+    cout << "WriteAheadLog replay tests" << endl;
+    testReplayRestoresBalancesAndHistory();
+    testTornTailIsDropped();
+    testCorruptRecordEndsReplay();
+    testFailedWriteStopsAppends();
+    testUnreplayableRecordStopsConnect();
+    cout << "All passed" << endl;
+    return 0;
+}
@@ -0,0 +1,227 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Utils: Clock.cpp
+ *
+ * Implementation of the cached clock and local time formatter
+ */
+
+#include "Clock.h"
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+
+using namespace std;
+
+namespace SOBS {
+namespace Utils {
+
+namespace {
+
+// Last formatted second, published with a sequence lock. The text is
+// stored in atomic words so concurrent readers never race on plain memory.
+struct CachedTimestamp {
+    atomic<uint32_t> sequence;
+    atomic<int64_t> second;
+    atomic<uint64_t> words[3];
+    atomic<bool> refreshing;
+
+    CachedTimestamp() : sequence(0), second(-1), refreshing(false) {
+        for (auto& word : words) {
+            word.store(0);
+        }
+    }
+};
+
+CachedTimestamp cachedTimestamp;
+
+// UTC offset valid for one whole hour, cached per thread
+struct OffsetWindow {
+    time_t start = 1;   // Empty window until first use
+    time_t end = 0;
+    long offset = 0;
+};
+
+thread_local OffsetWindow offsetWindow;
+
+long utcOffsetAt(time_t t) {
+    struct tm local;
+    localtime_r(&t, &local);
+    return local.tm_gmtoff;
+}
+
+long utcOffset(time_t t) {
+    OffsetWindow& window = offsetWindow;
+    if (t >= window.start && t < window.end) {
+        return window.offset;
+    }
+
+    time_t hourStart = t - ((t % 3600) + 3600) % 3600;
+    long offset = utcOffsetAt(t);
+    // Only cache hours with no offset change inside them
+    if (utcOffsetAt(hourStart) == offset && utcOffsetAt(hourStart + 3599) == offset) {
+        window.start = hourStart;
+        window.end = hourStart + 3600;
+        window.offset = offset;
+    }
+    return offset;
+}
+
+inline void writeDigits(char* out, int value, int width) {
+    for (int i = width - 1; i >= 0; i--) {
+        out[i] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+}
+
+// Local days since 1970-01-01 and the second within that day
+int64_t localDays(time_t t, int64_t& seconds) {
+    int64_t local = static_cast<int64_t>(t) + utcOffset(t);
+    int64_t days = local / 86400;
+    seconds = local % 86400;
+    if (seconds < 0) {
+        seconds += 86400;
+        days--;
+    }
+    return days;
+}
+
+// Days since 1970-01-01 to civil date (proleptic Gregorian)
+void civilFromDays(int64_t days, int& year, int& month, int& day) {
+    int64_t z = days + 719468;
+    int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    int64_t doe = z - era * 146097;
+    int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int64_t mp = (5 * doy + 2) / 153;
+    day = static_cast<int>(doy - (153 * mp + 2) / 5 + 1);
+    month = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+    year = static_cast<int>(yoe + era * 400 + (month <= 2 ? 1 : 0));
+}
+
+} // namespace
+
+time_t Clock::now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+    return ts.tv_sec;
+}
+
+size_t Clock::formatLocal(time_t t, char* out, char separator) {
+    int64_t seconds;
+    int64_t days = localDays(t, seconds);
+    int year;
+    int month;
+    int day;
+    civilFromDays(days, year, month, day);
+
+    writeDigits(out, year, 4);
+    out[4] = '-';
+    writeDigits(out + 5, month, 2);
+    out[7] = '-';
+    writeDigits(out + 8, day, 2);
+    out[10] = separator;
+    writeDigits(out + 11, static_cast<int>(seconds / 3600), 2);
+    out[13] = ':';
+    writeDigits(out + 14, static_cast<int>((seconds / 60) % 60), 2);
+    out[16] = ':';
+    writeDigits(out + 17, static_cast<int>(seconds % 60), 2);
+    out[TIMESTAMP_LENGTH] = '\0';
+    return TIMESTAMP_LENGTH;
+}
+
+int64_t Clock::localDay(time_t t) {
+    int64_t seconds;
+    return localDays(t, seconds);
+}
+
+int64_t Clock::localMonth(time_t t) {
+    int64_t seconds;
+    int year;
+    int month;
+    int day;
+    civilFromDays(localDays(t, seconds), year, month, day);
+    return static_cast<int64_t>(year - 1970) * 12 + (month - 1);
+}
+
+string Clock::formatLocal(time_t t, char separator) {
+    char buffer[TIMESTAMP_LENGTH + 1];
+    return string(buffer, formatLocal(t, buffer, separator));
+}
+
+bool Clock::parseLocalDate(const string& text, int dayOffset, time_t& out) {
+    if (text.size() != 10 || text[4] != '-' || text[7] != '-') return false;
+    for (size_t i = 0; i < text.size(); i++) {
+        if (i != 4 && i != 7 && (text[i] < '0' || text[i] > '9')) return false;
+    }
+    struct tm date = {};
+    date.tm_year = atoi(text.substr(0, 4).c_str()) - 1900;
+    date.tm_mon = atoi(text.substr(5, 2).c_str()) - 1;
+    date.tm_mday = atoi(text.substr(8, 2).c_str());
+    if (date.tm_year < 70 || date.tm_mon < 0 || date.tm_mon > 11 ||
+        date.tm_mday < 1 || date.tm_mday > 31) {
+        return false;
+    }
+    date.tm_mday += dayOffset;
+    date.tm_isdst = -1;
+    out = mktime(&date);
+    return out != static_cast<time_t>(-1);
+}
+
+size_t Clock::currentTimestamp(char* out) {
+    time_t current = now();
+    CachedTimestamp& cache = cachedTimestamp;
+
+    // Fast path: copy the published text if it is for this second
+    while (true) {
+        uint32_t before = cache.sequence.load(memory_order_acquire);
+        if (before & 1) {
+            break;  // Being refreshed; format locally instead of spinning
+        }
+        int64_t second = cache.second.load(memory_order_relaxed);
+        uint64_t words[3];
+        for (int i = 0; i < 3; i++) {
+            words[i] = cache.words[i].load(memory_order_relaxed);
+        }
+        atomic_thread_fence(memory_order_acquire);
+        if (cache.sequence.load(memory_order_relaxed) != before) {
+            continue;
+        }
+        if (second != static_cast<int64_t>(current)) {
+            break;
+        }
+        memcpy(out, words, TIMESTAMP_LENGTH);
+        out[TIMESTAMP_LENGTH] = '\0';
+        return TIMESTAMP_LENGTH;
+    }
+
+    // New second: format it, and let one thread publish it
+    formatLocal(current, out, 'T');
+
+    bool expected = false;
+    if (static_cast<int64_t>(current) > cache.second.load(memory_order_relaxed) &&
+        cache.refreshing.compare_exchange_strong(expected, true, memory_order_acquire)) {
+        uint64_t words[3] = {0, 0, 0};
+        memcpy(words, out, TIMESTAMP_LENGTH);
+
+        uint32_t sequence = cache.sequence.load(memory_order_relaxed);
+        cache.sequence.store(sequence + 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        for (int i = 0; i < 3; i++) {
+            cache.words[i].store(words[i], memory_order_relaxed);
+        }
+        cache.second.store(static_cast<int64_t>(current), memory_order_relaxed);
+        cache.sequence.store(sequence + 2, memory_order_release);
+
+        cache.refreshing.store(false, memory_order_release);
+    }
+    return TIMESTAMP_LENGTH;
+}
+
+string Clock::currentTimestamp() {
+    char buffer[TIMESTAMP_LENGTH + 1];
+    return string(buffer, currentTimestamp(buffer));
+}
+
+} // namespace Utils
+} // namespace SOBS
@@ -0,0 +1,67 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Utils: Clock.h
+ *
+ * Process-wide clock service for response timestamps and date formatting.
+ *
+ * - currentTimestamp(): local time as "YYYY-MM-DDTHH:MM:SS", formatted
+ *   once per second and published through a seqlock; readers never lock.
+ * - formatLocal(): thread-safe replacement for localtime() + strftime().
+ *   Each thread caches the UTC offset for the current hour, so the
+ *   glibc tz lock is taken about once per hour instead of once per call.
+ */
+
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <string>
+#include <ctime>
+#include <cstddef>
+#include <cstdint>
+
+using namespace std;
+
+namespace SOBS {
+namespace Utils {
+
+class Clock {
+public:
+    static const size_t TIMESTAMP_LENGTH = 19;  // "YYYY-MM-DDTHH:MM:SS"
+
+    /**
+     * Current wall-clock second (coarse clock, no syscall)
+     */
+    static time_t now();
+
+    /**
+     * Write the cached current local timestamp ("YYYY-MM-DDTHH:MM:SS")
+     * into 'out' (at least TIMESTAMP_LENGTH + 1 bytes). Returns the length.
+     */
+    static size_t currentTimestamp(char* out);
+    static string currentTimestamp();
+
+    /**
+     * Format 't' as local time "YYYY-MM-DD HH:MM:SS"; 'separator' goes
+     * between date and time ('T' for ISO-8601). 'out' needs at least
+     * TIMESTAMP_LENGTH + 1 bytes. Returns the length.
+     */
+    static size_t formatLocal(time_t t, char* out, char separator = ' ');
+    static string formatLocal(time_t t, char separator = ' ');
+
+    /**
+     * Local calendar day of 't' as days since 1970-01-01, and its month
+     * as months since January 1970 (same cached offset as formatLocal())
+     */
+    static int64_t localDay(time_t t);
+    static int64_t localMonth(time_t t);
+
+    /**
+     * Local midnight of "YYYY-MM-DD" plus 'dayOffset' days
+     */
+    static bool parseLocalDate(const string& text, int dayOffset, time_t& out);
+};
+
+} // namespace Utils
+} // namespace SOBS
+
+#endif // CLOCK_H
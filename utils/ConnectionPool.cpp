@@ -0,0 +1,289 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Utils: ConnectionPool.cpp
+ *
+ * Implementation of the session pool
+ */
+
+#include "ConnectionPool.h"
+#include <sstream>
+#include <iomanip>
+#include <functional>
+#include <thread>
+#include <algorithm>
+
+using namespace std;
+
+namespace SOBS {
+namespace Utils {
+
+namespace {
+
+// The session a thread used last, tried first on its next acquire()
+struct ThreadAffinity {
+    const ConnectionPool* pool = nullptr;
+    uint64_t generation = 0;
+    size_t index = 0;
+};
+
+thread_local ThreadAffinity threadAffinity;
+
+atomic<uint64_t> nextPoolGeneration(1);
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// PooledSession
+// ---------------------------------------------------------------------------
+
+PooledSession::PooledSession() : pool(nullptr), session(nullptr) {}
+
+PooledSession::PooledSession(ConnectionPool* pool, DatabaseSession* session)
+    : pool(pool), session(session) {}
+
+PooledSession::~PooledSession() {
+    release();
+}
+
+PooledSession::PooledSession(PooledSession&& other) noexcept
+    : pool(other.pool), session(other.session) {
+    other.pool = nullptr;
+    other.session = nullptr;
+}
+
+PooledSession& PooledSession::operator=(PooledSession&& other) noexcept {
+    if (this != &other) {
+        release();
+        pool = other.pool;
+        session = other.session;
+        other.pool = nullptr;
+        other.session = nullptr;
+    }
+    return *this;
+}
+
+void PooledSession::release() {
+    if (pool != nullptr && session != nullptr) {
+        pool->release(session);
+    }
+    pool = nullptr;
+    session = nullptr;
+}
+
+// ---------------------------------------------------------------------------
+// PoolStats
+// ---------------------------------------------------------------------------
+
+string PoolStats::toString() const {
+    stringstream ss;
+    ss << fixed << setprecision(3);
+    ss << "Pool: " << inUse << "/" << poolSize << " in use"
+       << " (peak " << peakInUse << ")\n"
+       << "  Checkouts: " << checkouts
+       << ", affinity hits: " << affinityHits
+       << ", waited: " << waitedCheckouts
+       << ", timeouts: " << timeouts << "\n"
+       << "  Saturation: " << saturation << "\n"
+       << "  Wait histogram (us):";
+    for (size_t i = 0; i < waitHistogramMicros.size(); i++) {
+        if (waitHistogramMicros[i] == 0) continue;
+        if (i == 0) {
+            ss << " [0]=" << waitHistogramMicros[i];
+        } else {
+            ss << " [<" << (1ULL << i) << "]=" << waitHistogramMicros[i];
+        }
+    }
+    return ss.str();
+}
+
+// ---------------------------------------------------------------------------
+// ConnectionPool
+// ---------------------------------------------------------------------------
+
+ConnectionPool::ConnectionPool()
+    : poolSize(0), poolGeneration(0), waiters(0), inUse(0), peakInUse(0),
+      checkouts(0), affinityHits(0), waitedCheckouts(0), timeouts(0) {
+    for (size_t i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        waitHistogram[i] = 0;
+    }
+}
+
+ConnectionPool::~ConnectionPool() {}
+
+void ConnectionPool::initialize(DatabaseConnection* connection, size_t size,
+                                SessionBackend backend) {
+    slots.reset(new Slot[size]);
+    for (size_t i = 0; i < size; i++) {
+        slots[i].session.reset(new DatabaseSession(static_cast<int>(i), backend, connection));
+    }
+    poolSize = size;
+    poolGeneration = nextPoolGeneration.fetch_add(1);
+}
+
+void ConnectionPool::shutdown() {
+    poolSize = 0;
+    slots.reset();
+}
+
+bool ConnectionPool::tryClaim(size_t index) {
+    bool expected = false;
+    return !slots[index].inUse.load(memory_order_relaxed) &&
+           slots[index].inUse.compare_exchange_strong(expected, true);
+}
+
+DatabaseSession* ConnectionPool::tryAcquireAny() {
+    // Start the scan at a per-thread offset so threads spread out
+    size_t start = hash<thread::id>()(this_thread::get_id()) % poolSize;
+    for (size_t n = 0; n < poolSize; n++) {
+        size_t index = (start + n) % poolSize;
+        if (tryClaim(index)) {
+            return slots[index].session.get();
+        }
+    }
+    return nullptr;
+}
+
+void ConnectionPool::recordCheckout(size_t index, chrono::microseconds waited) {
+    size_t current = inUse.fetch_add(1) + 1;
+    size_t peak = peakInUse.load();
+    while (current > peak && !peakInUse.compare_exchange_weak(peak, current)) {}
+
+    checkouts++;
+
+    uint64_t micros = static_cast<uint64_t>(waited.count());
+    size_t bucket = 0;
+    while (micros > 0 && bucket < HISTOGRAM_BUCKETS - 1) {
+        micros >>= 1;
+        bucket++;
+    }
+    waitHistogram[bucket]++;
+
+    threadAffinity.pool = this;
+    threadAffinity.generation = poolGeneration;
+    threadAffinity.index = index;
+}
+
+PooledSession ConnectionPool::acquire(chrono::milliseconds timeout) {
+    if (poolSize == 0) {
+        return PooledSession();
+    }
+
+    // Lock-free paths are only taken while nobody is queued, so
+    // newcomers cannot overtake threads that are already waiting
+    if (waiters.load() == 0) {
+        // Fast path: the session this thread used last, one CAS, no lock
+        ThreadAffinity& affinity = threadAffinity;
+        if (affinity.pool == this && affinity.generation == poolGeneration &&
+            affinity.index < poolSize && tryClaim(affinity.index)) {
+            affinityHits++;
+            recordCheckout(affinity.index, chrono::microseconds(0));
+            return PooledSession(this, slots[affinity.index].session.get());
+        }
+
+        DatabaseSession* session = tryAcquireAny();
+        if (session != nullptr) {
+            recordCheckout(static_cast<size_t>(session->getSessionId()),
+                           chrono::microseconds(0));
+            return PooledSession(this, session);
+        }
+    }
+
+    // Slow path: queue up (FIFO) and wait for a handoff, bounded by the timeout
+    auto start = chrono::steady_clock::now();
+    auto deadline = start + timeout;
+    DatabaseSession* session = nullptr;
+    bool queued = false;
+
+    unique_lock<mutex> lock(waitMutex);
+    waiters++;
+    if (waitQueue.empty()) {
+        session = tryAcquireAny();
+    }
+    if (session == nullptr) {
+        Waiter self;
+        waitQueue.push_back(&self);
+        queued = true;
+        while (self.granted == nullptr) {
+            if (self.ready.wait_until(lock, deadline) == cv_status::timeout) {
+                break;
+            }
+        }
+        if (self.granted == nullptr) {
+            waitQueue.erase(find(waitQueue.begin(), waitQueue.end(), &self));
+        }
+        session = self.granted;
+    }
+    waiters--;
+    lock.unlock();
+
+    if (queued) {
+        waitedCheckouts++;
+    }
+    if (session == nullptr) {
+        timeouts++;
+        return PooledSession();
+    }
+
+    chrono::microseconds waited = queued ?
+        chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start) :
+        chrono::microseconds(0);
+    recordCheckout(static_cast<size_t>(session->getSessionId()), waited);
+    return PooledSession(this, session);
+}
+
+void ConnectionPool::release(DatabaseSession* session) {
+    // A lease returned mid-transaction is rolled back, never leaked
+    if (session->isInTransaction()) {
+        session->rollbackTransaction();
+    }
+
+    size_t index = static_cast<size_t>(session->getSessionId());
+    inUse--;
+    slots[index].inUse.store(false);
+
+    // Hand the session straight to the longest-waiting thread. The flag
+    // is cleared first so a waiter that is still scanning can see it.
+    if (waiters.load() > 0) {
+        lock_guard<mutex> lock(waitMutex);
+        if (!waitQueue.empty() && tryClaim(index)) {
+            Waiter* next = waitQueue.front();
+            waitQueue.pop_front();
+            next->granted = session;
+            next->ready.notify_one();
+        }
+    }
+}
+
+size_t ConnectionPool::getPoolSize() const {
+    return poolSize;
+}
+
+size_t ConnectionPool::getInUse() const {
+    return inUse.load();
+}
+
+PoolStats ConnectionPool::getStats() const {
+    PoolStats stats;
+    stats.poolSize = poolSize;
+    stats.inUse = inUse.load();
+    stats.peakInUse = peakInUse.load();
+    stats.checkouts = checkouts.load();
+    stats.affinityHits = affinityHits.load();
+    stats.waitedCheckouts = waitedCheckouts.load();
+    stats.timeouts = timeouts.load();
+    stats.saturation = stats.checkouts + stats.timeouts == 0 ? 0.0 :
+        static_cast<double>(stats.waitedCheckouts) /
+        static_cast<double>(stats.checkouts + stats.timeouts);
+
+    size_t last = 0;
+    for (size_t i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        if (waitHistogram[i].load() > 0) last = i + 1;
+    }
+    for (size_t i = 0; i < last; i++) {
+        stats.waitHistogramMicros.push_back(waitHistogram[i].load());
+    }
+    return stats;
+}
+
+} // namespace Utils
+} // namespace SOBS
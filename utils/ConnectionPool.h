@@ -0,0 +1,152 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Utils: ConnectionPool.h
+ *
+ * Fixed-size pool of DatabaseSession objects.
+ *
+ * - Per-thread affinity: a thread first tries the session it used last,
+ *   with a single compare-and-swap and no lock.
+ * - Bounded wait: when every session is checked out, callers queue in
+ *   FIFO order and give up after a timeout instead of blocking forever.
+ * - Statistics: wait-time histogram, saturation and timeouts.
+ */
+
+#ifndef CONNECTIONPOOL_H
+#define CONNECTIONPOOL_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include "DatabaseSession.h"
+
+using namespace std;
+
+namespace SOBS {
+namespace Utils {
+
+class ConnectionPool;
+
+/**
+ * RAII lease on a pooled session. Returns the session to the pool
+ * when it goes out of scope. Empty if acquire() timed out.
+ */
+class PooledSession {
+private:
+    ConnectionPool* pool;
+    DatabaseSession* session;
+
+public:
+    PooledSession();
+    PooledSession(ConnectionPool* pool, DatabaseSession* session);
+    ~PooledSession();
+
+    PooledSession(PooledSession&& other) noexcept;
+    PooledSession& operator=(PooledSession&& other) noexcept;
+    PooledSession(const PooledSession&) = delete;
+    PooledSession& operator=(const PooledSession&) = delete;
+
+    DatabaseSession* operator->() const { return session; }
+    DatabaseSession* get() const { return session; }
+    explicit operator bool() const { return session != nullptr; }
+
+    /**
+     * Return the session to the pool early
+     */
+    void release();
+};
+
+struct PoolStats {
+    size_t poolSize;
+    size_t inUse;
+    size_t peakInUse;
+    uint64_t checkouts;
+    uint64_t affinityHits;       // Served by the thread's previous session
+    uint64_t waitedCheckouts;    // Had to wait because the pool was saturated
+    uint64_t timeouts;
+    double saturation;           // Share of acquire() calls that found no idle session
+    // Bucket i counts waits in [2^(i-1), 2^i) microseconds; bucket 0 is no wait
+    vector<uint64_t> waitHistogramMicros;
+
+    string toString() const;
+};
+
+class ConnectionPool {
+private:
+    static const size_t HISTOGRAM_BUCKETS = 24;
+
+    // Each slot on its own cache line: the in-use flag is hit by CAS
+    struct alignas(64) Slot {
+        atomic<bool> inUse;
+        unique_ptr<DatabaseSession> session;
+        Slot() : inUse(false) {}
+    };
+
+    unique_ptr<Slot[]> slots;
+    size_t poolSize;
+    uint64_t poolGeneration;     // Distinguishes re-initialized pools
+
+    // A thread queued for a session; release() hands one over directly
+    struct Waiter {
+        DatabaseSession* granted = nullptr;
+        condition_variable ready;
+    };
+
+    mutex waitMutex;
+    deque<Waiter*> waitQueue;
+    atomic<int> waiters;
+
+    // Statistics
+    atomic<size_t> inUse;
+    atomic<size_t> peakInUse;
+    atomic<uint64_t> checkouts;
+    atomic<uint64_t> affinityHits;
+    atomic<uint64_t> waitedCheckouts;
+    atomic<uint64_t> timeouts;
+    atomic<uint64_t> waitHistogram[HISTOGRAM_BUCKETS];
+
+    bool tryClaim(size_t index);
+    DatabaseSession* tryAcquireAny();
+    void recordCheckout(size_t index, chrono::microseconds waited);
+
+    friend class PooledSession;
+    void release(DatabaseSession* session);
+
+public:
+    ConnectionPool();
+    ~ConnectionPool();
+
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+    /**
+     * Create 'size' sessions against the given backend.
+     * Must not be called while sessions are checked out.
+     */
+    void initialize(DatabaseConnection* connection, size_t size,
+                    SessionBackend backend);
+
+    /**
+     * Drop all sessions (no session may be checked out)
+     */
+    void shutdown();
+
+    /**
+     * Check out a session, waiting at most 'timeout' for one to free up
+     */
+    PooledSession acquire(chrono::milliseconds timeout);
+
+    size_t getPoolSize() const;
+    size_t getInUse() const;
+    PoolStats getStats() const;
+};
+
+} // namespace Utils
+} // namespace SOBS
+
+#endif // CONNECTIONPOOL_H
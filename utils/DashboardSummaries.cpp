@@ -0,0 +1,172 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Utils: DashboardSummaries.cpp
+ *
+ * Implementation of the per-user dashboard summaries
+ */
+
+#include "DashboardSummaries.h"
+#include "Clock.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+namespace SOBS {
+namespace Utils {
+
+namespace {
+
+// Copy 'text' into a fixed field, cut on a UTF-8 character boundary
+void copyText(char* out, size_t capacity, const string& text) {
+    size_t length = text.size();
+    if (length >= capacity) {
+        length = capacity - 1;
+        while (length > 0 && (static_cast<unsigned char>(text[length]) & 0xC0) == 0x80) {
+            length--;
+        }
+    }
+    memcpy(out, text.data(), length);
+    out[length] = '\0';
+}
+
+} // namespace
+
+DashboardSummaries::DashboardSummaries(size_t shardCount)
+    : shardCount(shardCount == 0 ? 1 : shardCount),
+      shards(new Shard[shardCount == 0 ? 1 : shardCount]) {}
+
+DashboardSummaries::~DashboardSummaries() {}
+
+size_t DashboardSummaries::shardIndexOf(long userId) const {
+    // Avalanche so sequential IDs spread evenly over the shards
+    uint64_t hash = static_cast<uint64_t>(userId);
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return static_cast<size_t>(hash % shardCount);
+}
+
+DashboardSummaries::UserSummary* DashboardSummaries::findUser(long userId) const {
+    const Shard& shard = shards[shardIndexOf(userId)];
+    shared_lock<shared_mutex> lock(shard.lock);
+
+    auto it = shard.users.find(userId);
+    if (it == shard.users.end()) return nullptr;
+
+    // Summaries are never erased, so the pointer outlives the shard lock
+    return const_cast<UserSummary*>(&it->second);
+}
+
+DashboardSummaries::UserSummary& DashboardSummaries::findOrAddUser(long userId) {
+    UserSummary* user = findUser(userId);
+    if (user != nullptr) return *user;
+
+    Shard& shard = shards[shardIndexOf(userId)];
+    unique_lock<shared_mutex> lock(shard.lock);
+    return shard.users.try_emplace(userId).first->second;
+}
+
+// ---------------------------------------------------------------------------
+// Updates
+// ---------------------------------------------------------------------------
+
+void DashboardSummaries::openAccount(long userId, const Model::Money& balance) {
+    if (userId <= 0) return;
+    UserSummary& user = findOrAddUser(userId);
+
+    lock_guard<mutex> lock(user.lock);
+    user.totalBalanceUnits += balance.getMinorUnits();
+    user.accountCount++;
+}
+
+void DashboardSummaries::recordPosting(long userId, const Model::Money& amount,
+                                       Model::TransactionCategory category,
+                                       const string& reference, const string& description,
+                                       time_t postedAt) {
+    if (userId <= 0) return;
+    UserSummary& user = findOrAddUser(userId);
+
+    lock_guard<mutex> lock(user.lock);
+    user.totalBalanceUnits += amount.getMinorUnits();
+
+    RecentPosting& slot = user.recent[user.postingCount % DashboardSummary::RECENT_COUNT];
+    slot.amountUnits = amount.getMinorUnits();
+    slot.postedAt = postedAt;
+    slot.category = category;
+    copyText(slot.reference, RecentPosting::REFERENCE_CAPACITY, reference);
+    copyText(slot.description, RecentPosting::DESCRIPTION_CAPACITY, description);
+    user.postingCount++;
+}
+
+void DashboardSummaries::recordBalanceChange(long userId, const Model::Money& amount) {
+    if (userId <= 0) return;
+    UserSummary& user = findOrAddUser(userId);
+
+    lock_guard<mutex> lock(user.lock);
+    user.totalBalanceUnits += amount.getMinorUnits();
+}
+
+void DashboardSummaries::schedulePayment(long userId, const string& scheduleId,
+                                         const string& description,
+                                         const Model::Money& amount,
+                                         time_t dueDate, time_t now) {
+    if (userId <= 0) return;
+    UserSummary& user = findOrAddUser(userId);
+
+    DuePayment payment;
+    payment.amountUnits = amount.getMinorUnits();
+    payment.dueDate = dueDate;
+    copyText(payment.scheduleId, DuePayment::ID_CAPACITY, scheduleId);
+    copyText(payment.description, DuePayment::DESCRIPTION_CAPACITY, description);
+
+    lock_guard<mutex> lock(user.lock);
+    vector<DuePayment>& scheduled = user.scheduled;
+    int64_t today = Clock::localDay(now);
+    scheduled.erase(remove_if(scheduled.begin(), scheduled.end(),
+                              [today](const DuePayment& due) {
+                                  return Clock::localDay(due.dueDate) < today;
+                              }),
+                    scheduled.end());
+    auto position = upper_bound(scheduled.begin(), scheduled.end(), dueDate,
+                                [](time_t date, const DuePayment& due) {
+                                    return date < due.dueDate;
+                                });
+    scheduled.insert(position, payment);
+}
+
+// ---------------------------------------------------------------------------
+// Reading
+// ---------------------------------------------------------------------------
+
+bool DashboardSummaries::getSummary(long userId, time_t now, DashboardSummary& out) const {
+    out.totalBalanceUnits = 0;
+    out.accountCount = 0;
+    out.recentCount = 0;
+    out.upcomingCount = 0;
+
+    UserSummary* user = userId > 0 ? findUser(userId) : nullptr;
+    if (user == nullptr) return false;
+
+    int64_t today = Clock::localDay(now);
+    lock_guard<mutex> lock(user->lock);
+    out.totalBalanceUnits = user->totalBalanceUnits;
+    out.accountCount = user->accountCount;
+
+    // Ring buffer, newest first
+    uint64_t count = user->postingCount;
+    while (out.recentCount < DashboardSummary::RECENT_COUNT && count > 0) {
+        count--;
+        out.recent[out.recentCount++] = user->recent[count % DashboardSummary::RECENT_COUNT];
+    }
+
+    for (const DuePayment& due : user->scheduled) {
+        if (out.upcomingCount == DashboardSummary::UPCOMING_COUNT) break;
+        if (Clock::localDay(due.dueDate) < today) continue;
+        out.upcoming[out.upcomingCount++] = due;
+    }
+    return true;
+}
+
+} // namespace Utils
+} // namespace SOBS
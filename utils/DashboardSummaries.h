@@ -0,0 +1,143 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Utils: DashboardSummaries.h
+ *
+ * Materialized dashboard per user: total balance over the user's
+ * accounts, the last RECENT_COUNT postings in a fixed ring buffer and the
+ * user's scheduled payments in due-date order. Writers keep it current as
+ * accounts open, transfers post, balances change and payments are
+ * scheduled, so serving the dashboard is one fixed-size copy under the
+ * user's lock. Text is stored inline and truncated, so recording a
+ * posting does not allocate.
+ *
+ * Users are sharded by user ID; a shard's reader/writer lock only guards
+ * which users exist and each summary has its own mutex. Summaries are
+ * never erased. Updates arrive with ledger account locks held and never
+ * call back into the ledger, so the lock order is always account first.
+ *
+ * User ID 0 is the bank (e.g. the settlement account) and has no summary.
+ */
+
+#ifndef DASHBOARDSUMMARIES_H
+#define DASHBOARDSUMMARIES_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <shared_mutex>
+#include <mutex>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <ctime>
+#include "../model/Money.h"
+#include "../model/Transaction.h"
+
+using namespace std;
+
+namespace SOBS {
+namespace Utils {
+
+struct RecentPosting {
+    static const size_t REFERENCE_CAPACITY = 24;
+    static const size_t DESCRIPTION_CAPACITY = 48;
+
+    int64_t amountUnits;                        // Signed; negative is a debit
+    time_t postedAt;
+    Model::TransactionCategory category;
+    char reference[REFERENCE_CAPACITY];         // NUL-terminated, truncated
+    char description[DESCRIPTION_CAPACITY];
+};
+
+struct DuePayment {
+    static const size_t ID_CAPACITY = 24;
+    static const size_t DESCRIPTION_CAPACITY = 48;
+
+    int64_t amountUnits;
+    time_t dueDate;
+    char scheduleId[ID_CAPACITY];               // NUL-terminated, truncated
+    char description[DESCRIPTION_CAPACITY];
+};
+
+struct DashboardSummary {
+    static const size_t RECENT_COUNT = 8;
+    static const size_t UPCOMING_COUNT = 5;
+
+    int64_t totalBalanceUnits;
+    size_t accountCount;
+    RecentPosting recent[RECENT_COUNT];         // Newest first
+    size_t recentCount;
+    DuePayment upcoming[UPCOMING_COUNT];        // Soonest first, none overdue
+    size_t upcomingCount;
+};
+
+class DashboardSummaries {
+private:
+    struct UserSummary {
+        mutable mutex lock;                     // Guards everything below
+        int64_t totalBalanceUnits = 0;
+        size_t accountCount = 0;
+        RecentPosting recent[DashboardSummary::RECENT_COUNT];
+        uint64_t postingCount = 0;              // Next ring slot: postingCount % RECENT_COUNT
+        vector<DuePayment> scheduled;           // By due date
+    };
+
+    struct alignas(64) Shard {
+        mutable shared_mutex lock;
+        unordered_map<long, UserSummary> users;
+    };
+
+    size_t shardCount;
+    unique_ptr<Shard[]> shards;
+
+    size_t shardIndexOf(long userId) const;
+    UserSummary* findUser(long userId) const;
+    UserSummary& findOrAddUser(long userId);
+
+public:
+    static const size_t DEFAULT_SHARD_COUNT = 64;
+
+    explicit DashboardSummaries(size_t shardCount = DEFAULT_SHARD_COUNT);
+    ~DashboardSummaries();
+
+    DashboardSummaries(const DashboardSummaries&) = delete;
+    DashboardSummaries& operator=(const DashboardSummaries&) = delete;
+
+    /**
+     * Add a newly opened account and its balance to its owner's summary
+     */
+    void openAccount(long userId, const Model::Money& balance);
+
+    /**
+     * A posting on one of the user's accounts: moves the total balance by
+     * 'amount' and becomes the newest recent transaction
+     */
+    void recordPosting(long userId, const Model::Money& amount,
+                       Model::TransactionCategory category,
+                       const string& reference, const string& description,
+                       time_t postedAt);
+
+    /**
+     * A balance change with no history entry (SQL update, rollback, replay)
+     */
+    void recordBalanceChange(long userId, const Model::Money& amount);
+
+    /**
+     * Add a scheduled payment; overdue ones are dropped as new ones arrive
+     */
+    void schedulePayment(long userId, const string& scheduleId,
+                         const string& description, const Model::Money& amount,
+                         time_t dueDate, time_t now);
+
+    /**
+     * Copy the user's summary, with payments due before today's local
+     * midnight left out. Returns false (and an empty summary) if nothing
+     * has been recorded for the user.
+     */
+    bool getSummary(long userId, time_t now, DashboardSummary& out) const;
+};
+
+} // namespace Utils
+} // namespace SOBS
+
+#endif // DASHBOARDSUMMARIES_H
@@ -17,13 +17,23 @@ using namespace std;
 namespace SOBS {
 namespace Utils {
 
+namespace {
+
+// Session holding the calling thread's open transaction, if any
+thread_local PooledSession transactionSession;
+
+} // namespace
+
 // Initialize static members
-DatabaseConnection* DatabaseConnection::instance = nullptr;
+atomic<DatabaseConnection*> DatabaseConnection::instance(nullptr);
 mutex DatabaseConnection::mutex_;
 
 // Private constructor
 DatabaseConnection::DatabaseConnection()
-    : connected(false), port(5432), maxConnections(10), activeConnections(0) {
+    : connected(false), port(5432), maxConnections(10),
+      poolBackend(SessionBackend::EMBEDDED), acquireTimeout(500),
+      ledger(LedgerEngine::DEFAULT_SHARD_COUNT),
+      walFlushWindow(2000), transferEngine(ledger, wal, journal, summaries) {
     // Initialize connection parameters
 }
 
@@ -39,17 +49,28 @@ DatabaseConnection::~DatabaseConnection() {
  * Uses double-checked locking pattern for efficiency
  */
 DatabaseConnection* DatabaseConnection::getInstance() {
-    // First check (without lock) - fast path
-    if (instance == nullptr) {
+    // First check (without lock) - fast path, a single atomic load
+    DatabaseConnection* current = instance.load(memory_order_acquire);
+    if (current == nullptr) {
         // Lock before creating instance
         lock_guard<mutex> lock(mutex_);
         
         // Second check (with lock) - ensures only one instance
-        if (instance == nullptr) {
-            instance = new DatabaseConnection();
+        current = instance.load(memory_order_relaxed);
+        if (current == nullptr) {
+            current = new DatabaseConnection();
+            instance.store(current, memory_order_release);
         }
     }
-    return instance;
+    return current;
+}
+
+void DatabaseConnection::configurePool(int maxConnections, SessionBackend backend,
+                                       chrono::milliseconds acquireTimeout) {
+    lock_guard<mutex> lock(mutex_);
+    this->maxConnections = maxConnections > 0 ? maxConnections : 1;
+    this->poolBackend = backend;
+    this->acquireTimeout = acquireTimeout;
 }
 
 bool DatabaseConnection::connect(const string& host, int port,
@@ -69,18 +90,35 @@ bool DatabaseConnection::connect(const string& host, int port,
     
     // Build connection string
     stringstream ss;
-    ss << "postgresql://" << username << ":****@" 
+    ss << "postgresql://" << username << ":****@"
        << host << ":" << port << "/" << database;
     connectionString = ss.str();
     
     // In real implementation, would establish actual database connection
     // using libpq or similar PostgreSQL client library
     
-    // Simulate connection
+    // Recover the ledger from the write-ahead log before serving requests
+    if (!walPath.empty()) {
+        size_t unreplayed = 0;
+        bool opened = wal.open(walPath, walFlushWindow, [this, &unreplayed](const string& record) {
+            if (!replayRecord(record)) unreplayed++;
+        });
+        if (!opened) {
+            cout << "[DB] Failed to open write-ahead log: " << walPath << endl;
+            return false;
+        }
+        if (unreplayed > 0) {
+            wal.close();
+            cout << "[DB] Recovery failed: " << unreplayed
+                 << " write-ahead log record(s) could not be replayed from " << walPath << endl;
+            return false;
+        }
+    }
+    
+    pool.initialize(this, static_cast<size_t>(maxConnections), poolBackend);
     connected = true;
-    activeConnections = 1;
     
-    cout << "[DB] Connected to database: " << database 
+    cout << "[DB] Connected to database: " << database
               << " on " << host << ":" << port << endl;
     
     return true;
@@ -93,10 +131,12 @@ void DatabaseConnection::disconnect() {
         return;
     }
     
-    // In real implementation, would close database connection
-    
     connected = false;
-    activeConnections = 0;
+    transactionSession.release();
+    pool.shutdown();
+    
+    // Flush pending log records before closing
+    wal.close();
     
     cout << "[DB] Disconnected from database" << endl;
 }
@@ -105,19 +145,31 @@ bool DatabaseConnection::isConnected() const {
     return connected;
 }
 
+PooledSession DatabaseConnection::acquireSession() {
+    return acquireSession(acquireTimeout);
+}
+
+PooledSession DatabaseConnection::acquireSession(chrono::milliseconds timeout) {
+    if (!connected) {
+        return PooledSession();
+    }
+    return pool.acquire(timeout);
+}
+
 string DatabaseConnection::executeQuery(const string& query) {
     if (!connected) {
         return "{\"error\": \"Not connected to database\"}";
     }
     
-    lock_guard<mutex> lock(mutex_);
-    
-    // In real implementation, would execute SQL query
-    // For demo, return simulated result
-    
-    cout << "[DB] Executing query: " << query.substr(0, 50) << "..." << endl;
+    if (transactionSession) {
+        return transactionSession->executeQuery(query);
+    }
     
-    return "{\"status\": \"success\", \"rows\": []}";
+    PooledSession session = acquireSession();
+    if (!session) {
+        return "{\"error\": \"Timed out waiting for a database session\"}";
+    }
+    return session->executeQuery(query);
 }
 
 int DatabaseConnection::executeUpdate(const string& sql) {
@@ -125,46 +177,88 @@ int DatabaseConnection::executeUpdate(const string& sql) {
         return -1;
     }
     
-    lock_guard<mutex> lock(mutex_);
-    
-    // In real implementation, would execute SQL update
-    
-    cout << "[DB] Executing update: " << sql.substr(0, 50) << "..." << endl;
+    if (transactionSession) {
+        return transactionSession->executeUpdate(sql);
+    }
     
-    return 1;  // Number of affected rows
+    PooledSession session = acquireSession();
+    if (!session) {
+        return -1;
+    }
+    return session->executeUpdate(sql);
 }
 
 bool DatabaseConnection::beginTransaction() {
-    if (!connected) {
+    if (!connected || transactionSession) {
         return false;
     }
     
-    lock_guard<mutex> lock(mutex_);
+    PooledSession session = acquireSession();
+    if (!session || !session->beginTransaction()) {
+        return false;
+    }
     
-    cout << "[DB] Transaction started" << endl;
+    transactionSession = move(session);
     return true;
 }
 
 bool DatabaseConnection::commitTransaction() {
-    if (!connected) {
+    if (!connected || !transactionSession) {
         return false;
     }
     
-    lock_guard<mutex> lock(mutex_);
-    
-    cout << "[DB] Transaction committed" << endl;
-    return true;
+    bool committed = transactionSession->commitTransaction();
+    transactionSession.release();
+    return committed;
 }
 
 bool DatabaseConnection::rollbackTransaction() {
-    if (!connected) {
+    if (!connected || !transactionSession) {
         return false;
     }
     
+    bool rolledBack = transactionSession->rollbackTransaction();
+    transactionSession.release();
+    return rolledBack;
+}
+
+bool DatabaseConnection::replayRecord(const string& payload) {
+    stringstream lines(payload);
+    string line;
+    bool replayed = true;
+    while (getline(lines, line)) {
+        // Transfers rebuild their journal entries and summaries too
+        if (line.size() >= 2 && line[0] == 'T') {
+            if (!transferEngine.replay(line)) replayed = false;
+            continue;
+        }
+        if (line.size() < 2 || line[0] != 'P') {
+            replayed = false;
+            continue;
+        }
+        
+        stringstream fields(line.substr(2));
+        string accountNumber;
+        string amountText;
+        Model::Money amount;
+        if (!(fields >> accountNumber >> amountText) ||
+            !Model::Money::parse(amountText, amount)) {
+            replayed = false;
+            continue;
+        }
+        
+        string description;
+        getline(fields >> ws, description);
+        if (post(accountNumber, amount, description) < 0) replayed = false;
+    }
+    return replayed;
+}
+
+void DatabaseConnection::configureWriteAheadLog(const string& path,
+                                                chrono::microseconds flushWindow) {
     lock_guard<mutex> lock(mutex_);
-    
-    cout << "[DB] Transaction rolled back" << endl;
-    return true;
+    walPath = path;
+    walFlushWindow = flushWindow;
 }
 
 string DatabaseConnection::getConnectionInfo() const {
@@ -175,12 +269,121 @@ string DatabaseConnection::getConnectionInfo() const {
        << "  Database: " << database << "\n"
        << "  User: " << username << "\n"
        << "  Status: " << (connected ? "Connected" : "Disconnected") << "\n"
-       << "  Active Connections: " << activeConnections << "/" << maxConnections;
+       << "  Active Connections: " << getActiveConnections() << "/" << maxConnections;
     return ss.str();
 }
 
+LedgerEngine& DatabaseConnection::getLedger() {
+    return ledger;
+}
+
+WriteAheadLog& DatabaseConnection::getWriteAheadLog() {
+    return wal;
+}
+
+TransferEngine& DatabaseConnection::getTransferEngine() {
+    return transferEngine;
+}
+
+PostingJournal& DatabaseConnection::getJournal() {
+    return journal;
+}
+
+DashboardSummaries& DatabaseConnection::getSummaries() {
+    return summaries;
+}
+
+SessionStore& DatabaseConnection::getSessions() {
+    return sessions;
+}
+
+OtpStore& DatabaseConnection::getOtps() {
+    return otps;
+}
+
+PasswordHasher& DatabaseConnection::getPasswordHasher() {
+    return passwordHasher;
+}
+
+LoginThrottle& DatabaseConnection::getLoginThrottle() {
+    return loginThrottle;
+}
+
+void DatabaseConnection::setPasswordHash(long userId, const string& encodedHash) {
+    lock_guard<mutex> lock(credentialsMutex);
+    passwordHashes[userId] = encodedHash;
+}
+
+bool DatabaseConnection::getPasswordHash(long userId, string& encodedHash) const {
+    lock_guard<mutex> lock(credentialsMutex);
+    auto it = passwordHashes.find(userId);
+    if (it == passwordHashes.end()) {
+        return false;
+    }
+    encodedHash = it->second;
+    return true;
+}
+
+bool DatabaseConnection::savePendingTransfer(const Model::Transfer& transfer, time_t expiresAt,
+                                             time_t now) {
+    lock_guard<mutex> lock(pendingTransfersMutex);
+    if (pendingTransfers.size() >= size_t(MAX_PENDING_TRANSFERS)) {
+        for (auto it = pendingTransfers.begin(); it != pendingTransfers.end(); ) {
+            it = it->second.expiresAt <= now ? pendingTransfers.erase(it) : next(it);
+        }
+        if (pendingTransfers.size() >= size_t(MAX_PENDING_TRANSFERS)) {
+            return false;
+        }
+    }
+    pendingTransfers[transfer.getTransferRef()] = PendingTransfer{transfer, expiresAt};
+    return true;
+}
+
+bool DatabaseConnection::takePendingTransfer(const string& transferRef, time_t now,
+                                             Model::Transfer& transfer) {
+    lock_guard<mutex> lock(pendingTransfersMutex);
+    auto it = pendingTransfers.find(transferRef);
+    if (it == pendingTransfers.end()) {
+        return false;
+    }
+    bool live = it->second.expiresAt > now;
+    if (live) {
+        transfer = it->second.transfer;
+    }
+    pendingTransfers.erase(it);
+    return live;
+}
+
+bool DatabaseConnection::openAccount(const Model::Account& account) {
+    if (!ledger.openAccount(account)) {
+        return false;
+    }
+    summaries.openAccount(account.getUserId(), account.getBalance());
+    return true;
+}
+
+bool DatabaseConnection::isAccountOwner(long userId, const string& accountNumber) const {
+    Model::Account account;
+    return userId != 0 && ledger.getAccount(accountNumber, account) &&
+           account.getUserId() == userId;
+}
+
+long DatabaseConnection::post(const string& accountNumber, const Model::Money& amount,
+                              const string& description, const PostingHook& onApplied) {
+    long postingId = ledger.post(accountNumber, amount, description, onApplied);
+    Model::Account account;
+    if (postingId >= 0 && ledger.getAccount(accountNumber, account)) {
+        summaries.recordBalanceChange(account.getUserId(), amount);
+    }
+    return postingId;
+}
+
 int DatabaseConnection::getActiveConnections() const {
-    return activeConnections;
+    return static_cast<int>(pool.getInUse());
+}
+
+PoolStats DatabaseConnection::getPoolStats() const {
+    return pool.getStats();
 }
 
 bool DatabaseConnection::healthCheck() {
@@ -188,8 +391,8 @@ bool DatabaseConnection::healthCheck() {
         return false;
     }
     
-    // In real implementation, would execute "SELECT 1"
-    return true;
+    PooledSession session = acquireSession();
+    return static_cast<bool>(session);
 }
 
 } // namespace Utils
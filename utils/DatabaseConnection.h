@@ -21,6 +21,19 @@
 #include <string>
 #include <mutex>
 #include <memory>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <unordered_map>
+#include "LedgerEngine.h"
+#include "WriteAheadLog.h"
+#include "TransferEngine.h"
+#include "ConnectionPool.h"
+#include "DashboardSummaries.h"
+#include "SessionStore.h"
+#include "OtpStore.h"
+#include "PasswordHasher.h"
+#include "LoginThrottle.h"
 
 using namespace std;
 
@@ -32,6 +45,9 @@ namespace Utils {
  * to ensure only one database connection instance exists.
  * 
  * Thread-safe implementation using double-checked locking.
+ * 
+ * Statement execution is served by a pool of DatabaseSession objects;
+ * the singleton itself holds no lock on the query path.
  */
 class DatabaseConnection {
 private:
@@ -46,13 +62,14 @@ private:
     DatabaseConnection& operator=(const DatabaseConnection&) = delete;
     
     // The single instance
-    static DatabaseConnection* instance;
+    static atomic<DatabaseConnection*> instance;
     
-    // Mutex for thread safety
+    // Mutex for thread safety (instance creation and connect/disconnect only;
+    // data access is synchronized per shard inside the ledger engine)
     static mutex mutex_;
     
     // Connection state
-    bool connected;
+    atomic<bool> connected;
     string connectionString;
     string host;
     int port;
@@ -61,9 +78,55 @@ private:
     
     // Connection pool settings
     int maxConnections;
-    int activeConnections;
+    SessionBackend poolBackend;
+    chrono::milliseconds acquireTimeout;
+    ConnectionPool pool;
+    
+    // Embedded storage engine
+    LedgerEngine ledger;
+    
+    // Durability: postings are redo-logged here on commit
+    WriteAheadLog wal;
+    string walPath;
+    chrono::microseconds walFlushWindow;
+    
+    // Double-entry history of transfers and bill payments
+    PostingJournal journal;
+    
+    // Per-user dashboard, kept current on every balance change
+    DashboardSummaries summaries;
+    
+    // Login sessions by token
+    SessionStore sessions;
+    
+    // One-time passwords awaiting verification
+    OtpStore otps;
+    
+    // Password hashes by user ID; hashing and checks run on the pool
+    PasswordHasher passwordHasher;
+    mutable mutex credentialsMutex;
+    unordered_map<long, string> passwordHashes;
+    
+    // Recent failed sign-ins by email and by client address
+    LoginThrottle loginThrottle;
+    
+    // Transfers over the OTP threshold, by reference, until their code expires
+    struct PendingTransfer {
+        Model::Transfer transfer;
+        time_t expiresAt;
+    };
+    mutex pendingTransfersMutex;
+    unordered_map<string, PendingTransfer> pendingTransfers;
+    
+    // Two-account transfers over the ledger, logged to the WAL and journal
+    TransferEngine transferEngine;
+    
+    // Apply one recovered WAL record; false if any line in it does not apply
+    bool replayRecord(const string& payload);
 
 public:
+    static const size_t MAX_PENDING_TRANSFERS = size_t(1) << 16;
+    
     /**
      * Get the singleton instance
      * Thread-safe implementation using double-checked locking
@@ -71,15 +134,38 @@ public:
     static DatabaseConnection* getInstance();
     
     /**
-     * Initialize database connection
+     * Initialize database connection. Fails, with the log closed again,
+     * if a write-ahead log record cannot be replayed: serving from a
+     * ledger that differs from the log would make later replays diverge.
      */
     bool connect(const string& host, int port, 
                  const string& database,
                  const string& username,
                  const string& password);
     
+    /**
+     * Enable the write-ahead log (call before connect).
+     * Commits arriving within 'flushWindow' of each other share one fsync.
+     */
+    void configureWriteAheadLog(const string& path,
+                                chrono::microseconds flushWindow = chrono::microseconds(2000));
+    
+    /**
+     * Configure the session pool (call before connect)
+     */
+    void configurePool(int maxConnections, SessionBackend backend,
+                       chrono::milliseconds acquireTimeout = chrono::milliseconds(500));
+    
+    /**
+     * Check out a session from the pool.
+     * Empty if not connected or no session freed up within the timeout.
+     */
+    PooledSession acquireSession();
+    PooledSession acquireSession(chrono::milliseconds timeout);
+    
     /**
      * Close database connection
+     * All sessions must have been returned to the pool
      */
     void disconnect();
     
@@ -89,27 +175,107 @@ public:
     bool isConnected() const;
     
     /**
-     * Execute a query
+     * Execute a query on a pooled session
+     * (the calling thread's transaction session, if one is open)
      */
     string executeQuery(const string& query);
     
     /**
-     * Execute an update/insert/delete
+     * Execute an update/insert/delete on a pooled session
      */
     int executeUpdate(const string& sql);
     
     /**
-     * Begin a transaction
+     * Direct access to the embedded ledger engine
+     */
+    LedgerEngine& getLedger();
+    
+    /**
+     * Access to the write-ahead log (open only when configured)
+     */
+    WriteAheadLog& getWriteAheadLog();
+    
+    /**
+     * Transfer engine (lock-ordered, WAL-logged account transfers)
+     */
+    TransferEngine& getTransferEngine();
+    
+    /**
+     * Posting journal (balanced DEBIT/CREDIT history per account ID)
+     */
+    PostingJournal& getJournal();
+    
+    /**
+     * Per-user dashboard summaries
+     */
+    DashboardSummaries& getSummaries();
+    
+    /**
+     * Login sessions (token -> user, with expiry)
+     */
+    SessionStore& getSessions();
+    
+    /**
+     * One-time passwords by the login, registration or transfer they confirm
+     */
+    OtpStore& getOtps();
+    
+    /**
+     * Pool that hashes and checks passwords off the request threads
+     */
+    PasswordHasher& getPasswordHasher();
+    
+    /**
+     * Stored password hash (PasswordHasher encoding) of a user
+     */
+    void setPasswordHash(long userId, const string& encodedHash);
+    bool getPasswordHash(long userId, string& encodedHash) const;
+    
+    /**
+     * Failed sign-in limits, checked before a password is hashed
+     */
+    LoginThrottle& getLoginThrottle();
+    
+    /**
+     * Transfers waiting for OTP confirmation, by transfer reference. A
+     * saved transfer can be taken once, before 'expiresAt'. Saving fails
+     * while MAX_PENDING_TRANSFERS unexpired transfers are waiting.
+     */
+    bool savePendingTransfer(const Model::Transfer& transfer, time_t expiresAt, time_t now);
+    bool takePendingTransfer(const string& transferRef, time_t now, Model::Transfer& transfer);
+    
+    /**
+     * Register an account in the ledger and add it to its owner's summary
+     */
+    bool openAccount(const Model::Account& account);
+    
+    /**
+     * True if the ledger account exists and belongs to 'userId' (0 owns nothing)
+     */
+    bool isAccountOwner(long userId, const string& accountNumber) const;
+    
+    /**
+     * Post a signed amount to a ledger account (LedgerEngine::post, with
+     * its under-lock hook) and move its owner's dashboard balance with it
+     */
+    long post(const string& accountNumber, const Model::Money& amount,
+              const string& description, const PostingHook& onApplied = nullptr);
+    
+    /**
+     * Begin a transaction on the calling thread
+     * (binds a pooled session to the thread until commit/rollback)
      */
     bool beginTransaction();
     
     /**
      * Commit a transaction
+     * Returns once the transaction's postings are durable in the WAL
      */
     bool commitTransaction();
     
     /**
      * Rollback a transaction
+     * Reverses the postings applied since beginTransaction
      */
     bool rollbackTransaction();
     
@@ -119,10 +285,15 @@ public:
     string getConnectionInfo() const;
     
     /**
-     * Get active connection count
+     * Get active connection count (sessions checked out of the pool)
      */
     int getActiveConnections() const;
     
+    /**
+     * Pool statistics: wait-time histogram, saturation, timeouts
+     */
+    PoolStats getPoolStats() const;
+    
     /**
      * Health check
      */
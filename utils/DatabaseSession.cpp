@@ -0,0 +1,265 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Utils: DatabaseSession.cpp
+ *
+ * Implementation of a pooled database session
+ */
+
+#include "DatabaseSession.h"
+#include "DatabaseConnection.h"
+#include <sstream>
+#include <iomanip>
+#include <thread>
+#include <cctype>
+#include <cstdlib>
+#include <cstdio>
+
+using namespace std;
+
+namespace SOBS {
+namespace Utils {
+
+namespace {
+
+/**
+ * Split an SQL statement into tokens. Whitespace, commas and semicolons
+ * separate tokens; '=', '+' and '-' are tokens of their own; quotes
+ * around literals are dropped.
+ */
+vector<string> tokenizeSql(const string& sql) {
+    vector<string> tokens;
+    string current;
+    for (char c : sql) {
+        if (isspace(static_cast<unsigned char>(c)) || c == ',' || c == ';' ||
+            c == '\'' || c == '"') {
+            if (!current.empty()) tokens.push_back(current);
+            current.clear();
+        } else if (c == '=' || c == '+' || c == '-') {
+            if (!current.empty()) tokens.push_back(current);
+            current.clear();
+            tokens.push_back(string(1, c));
+        } else {
+            current += c;
+        }
+    }
+    if (!current.empty()) tokens.push_back(current);
+    return tokens;
+}
+
+bool keywordEquals(const string& token, const char* keyword) {
+    size_t i = 0;
+    for (; i < token.size() && keyword[i] != '\0'; i++) {
+        if (toupper(static_cast<unsigned char>(token[i])) != keyword[i]) return false;
+    }
+    return i == token.size() && keyword[i] == '\0';
+}
+
+bool matchesKeywords(const vector<string>& tokens, size_t start,
+                     const vector<const char*>& keywords) {
+    if (tokens.size() < start + keywords.size()) return false;
+    for (size_t i = 0; i < keywords.size(); i++) {
+        if (!keywordEquals(tokens[start + i], keywords[i])) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+DatabaseSession::DatabaseSession(int sessionId, SessionBackend backend,
+                                 DatabaseConnection* connection)
+    : sessionId(sessionId), backend(backend), connection(connection),
+      roundTripLatency(0), inTransaction(false) {}
+
+DatabaseSession::~DatabaseSession() {}
+
+void DatabaseSession::simulateRoundTrip() const {
+    if (roundTripLatency.count() > 0) {
+        this_thread::sleep_for(roundTripLatency);
+    }
+}
+
+void DatabaseSession::resetTransaction() {
+    inTransaction = false;
+    applied.clear();
+    redo.clear();
+}
+
+string DatabaseSession::executeQuery(const string& query) {
+    if (backend == SessionBackend::POSTGRES_STANDIN) {
+        simulateRoundTrip();
+        return "{\"status\": \"success\", \"rows\": []}";
+    }
+
+    // SELECT balance FROM accounts WHERE account_number = <number>
+    vector<string> tokens = tokenizeSql(query);
+    if (tokens.size() == 8 &&
+        matchesKeywords(tokens, 0, {"SELECT", "BALANCE", "FROM", "ACCOUNTS",
+                                    "WHERE", "ACCOUNT_NUMBER", "="})) {
+        Model::Money balance, availableBalance;
+        if (!connection->getLedger().getBalance(tokens[7], balance, availableBalance)) {
+            return "{\"status\": \"success\", \"rows\": []}";
+        }
+
+        stringstream ss;
+        ss << "{\"status\": \"success\", \"rows\": [{"
+           << "\"accountNumber\": \"" << tokens[7] << "\", "
+           << "\"balance\": " << balance << ", "
+           << "\"availableBalance\": " << availableBalance << "}]}";
+        return ss.str();
+    }
+
+    // Statements the embedded engine does not understand are simulated
+    return "{\"status\": \"success\", \"rows\": []}";
+}
+
+int DatabaseSession::executeUpdate(const string& sql) {
+    if (backend == SessionBackend::POSTGRES_STANDIN) {
+        simulateRoundTrip();
+        return 1;
+    }
+
+    // UPDATE accounts SET balance = balance (+|-) <amount>
+    //   WHERE account_number = <number>
+    vector<string> tokens = tokenizeSql(sql);
+    if (tokens.size() == 12 &&
+        matchesKeywords(tokens, 0, {"UPDATE", "ACCOUNTS", "SET", "BALANCE",
+                                    "=", "BALANCE"}) &&
+        (tokens[6] == "+" || tokens[6] == "-") &&
+        matchesKeywords(tokens, 8, {"WHERE", "ACCOUNT_NUMBER", "="})) {
+        Model::Money amount;
+        if (!Model::Money::parse(tokens[7], amount) || !amount.isPositive()) {
+            return 0;
+        }
+        if (tokens[6] == "-" && !amount.negate()) return 0;
+
+        const string& accountNumber = tokens[11];
+        WriteAheadLog& wal = connection->getWriteAheadLog();
+        if (inTransaction || !wal.isOpen()) {
+            if (connection->post(accountNumber, amount, "SQL update") < 0) {
+                return 0;
+            }
+            if (inTransaction) {
+                applied.emplace_back(accountNumber, amount);
+                encodeRedo(redo, accountNumber, amount, "SQL update");
+            }
+            return 1;
+        }
+
+        // Auto-commit: log under the account lock, so concurrent updates
+        // to one account are logged in the order they apply
+        uint64_t lsn = 0;
+        long postingId = connection->post(accountNumber, amount, "SQL update",
+            [&](const Model::Account&) {
+                string record;
+                encodeRedo(record, accountNumber, amount, "SQL update");
+                lsn = wal.append(record);
+                return lsn != 0;
+            });
+        if (postingId < 0) return 0;
+        if (!wal.waitDurable(lsn)) {
+            // The log has failed and takes no more records; undo the
+            // posting so memory matches the 0 the caller sees
+            Model::Money reversal = amount;
+            reversal.negate();
+            connection->post(accountNumber, reversal, "Rollback");
+            return 0;
+        }
+        return 1;
+    }
+
+    // Statements the embedded engine does not understand are simulated
+    return 1;  // Number of affected rows
+}
+
+bool DatabaseSession::beginTransaction() {
+    if (inTransaction) {
+        return false;  // Nested transactions are not supported
+    }
+
+    if (backend == SessionBackend::POSTGRES_STANDIN) {
+        simulateRoundTrip();
+    }
+
+    resetTransaction();
+    inTransaction = true;
+    return true;
+}
+
+bool DatabaseSession::commitTransaction() {
+    if (!inTransaction) {
+        return false;
+    }
+
+    if (backend == SessionBackend::POSTGRES_STANDIN) {
+        simulateRoundTrip();
+        resetTransaction();
+        return true;
+    }
+
+    // The postings go to the log as one record, so replay applies the
+    // transaction whole or not at all
+    bool durable = true;
+    WriteAheadLog& wal = connection->getWriteAheadLog();
+    if (!redo.empty() && wal.isOpen()) {
+        uint64_t lsn = wal.append(redo);
+        durable = lsn != 0 && wal.waitDurable(lsn);
+    }
+    if (!durable) {
+        undoApplied();
+    }
+
+    resetTransaction();
+    return durable;
+}
+
+bool DatabaseSession::rollbackTransaction() {
+    if (!inTransaction) {
+        return false;
+    }
+
+    if (backend == SessionBackend::POSTGRES_STANDIN) {
+        simulateRoundTrip();
+    }
+
+    // Nothing was logged yet, so no WAL record
+    bool reversed = undoApplied();
+    resetTransaction();
+    return reversed;
+}
+
+bool DatabaseSession::undoApplied() {
+    bool reversed = true;
+    for (auto it = applied.rbegin(); it != applied.rend(); ++it) {
+        Model::Money reversal = it->second;
+        if (!reversal.negate() || connection->post(it->first, reversal, "Rollback") < 0) {
+            reversed = false;
+        }
+    }
+    return reversed;
+}
+
+bool DatabaseSession::isInTransaction() const { return inTransaction; }
+int DatabaseSession::getSessionId() const { return sessionId; }
+SessionBackend DatabaseSession::getBackend() const { return backend; }
+
+void DatabaseSession::setRoundTripLatency(chrono::microseconds latency) {
+    roundTripLatency = latency;
+}
+
+void DatabaseSession::encodeRedo(string& out, const string& accountNumber,
+                                 const Model::Money& amount, const string& description) {
+    char amountText[Model::Money::MAX_TEXT_LENGTH];
+    size_t amountLength = amount.format(amountText);
+    out += "P ";
+    out += accountNumber;
+    out += ' ';
+    out.append(amountText, amountLength);
+    out += ' ';
+    for (char c : description) {
+        out += (c == '\n' ? ' ' : c);
+    }
+    out += '\n';
+}
+
+} // namespace Utils
+} // namespace SOBS
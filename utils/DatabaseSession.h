@@ -0,0 +1,106 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Utils: DatabaseSession.h
+ *
+ * One pooled database session. Sessions are handed out by the
+ * ConnectionPool and carry their own transaction state, so callers
+ * holding different sessions never share a lock or a transaction.
+ */
+
+#ifndef DATABASESESSION_H
+#define DATABASESESSION_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <chrono>
+#include "../model/Money.h"
+
+using namespace std;
+
+namespace SOBS {
+namespace Utils {
+
+class DatabaseConnection;
+
+enum class SessionBackend {
+    EMBEDDED,           // Statements run against the in-process ledger engine
+    POSTGRES_STANDIN    // Simulated remote PostgreSQL server (canned results)
+};
+
+class DatabaseSession {
+private:
+    int sessionId;
+    SessionBackend backend;
+    DatabaseConnection* connection;
+
+    // Simulated network round trip for the PostgreSQL stand-in
+    chrono::microseconds roundTripLatency;
+
+    // Transaction state
+    bool inTransaction;
+    vector<pair<string, Model::Money>> applied;  // account, amount
+    string redo;                           // encoded postings for the WAL
+
+    void simulateRoundTrip() const;
+    void resetTransaction();
+    bool undoApplied();                    // Reverse 'applied', newest first
+
+public:
+    DatabaseSession(int sessionId, SessionBackend backend,
+                    DatabaseConnection* connection);
+    ~DatabaseSession();
+
+    DatabaseSession(const DatabaseSession&) = delete;
+    DatabaseSession& operator=(const DatabaseSession&) = delete;
+
+    /**
+     * Execute a query
+     * Supports: SELECT balance FROM accounts WHERE account_number = '...'
+     */
+    string executeQuery(const string& query);
+
+    /**
+     * Execute an update/insert/delete
+     * Supports: UPDATE accounts SET balance = balance (+|-) <amount>
+     *           WHERE account_number = '...'
+     * Outside a transaction the posting is logged under the account lock
+     * and undone if it cannot be made durable (0 rows)
+     */
+    int executeUpdate(const string& sql);
+
+    /**
+     * Begin a transaction on this session
+     */
+    bool beginTransaction();
+
+    /**
+     * Commit a transaction
+     * Returns once the transaction's postings are durable in the WAL;
+     * if they cannot be logged they are undone and false is returned
+     */
+    bool commitTransaction();
+
+    /**
+     * Rollback a transaction
+     * Reverses the postings applied since beginTransaction
+     */
+    bool rollbackTransaction();
+
+    bool isInTransaction() const;
+    int getSessionId() const;
+    SessionBackend getBackend() const;
+    void setRoundTripLatency(chrono::microseconds latency);
+
+    /**
+     * Encode one posting as a WAL redo line
+     * Format: "P <account> <amount> <description>"
+     */
+    static void encodeRedo(string& out, const string& accountNumber,
+                           const Model::Money& amount, const string& description);
+};
+
+} // namespace Utils
+} // namespace SOBS
+
+#endif // DATABASESESSION_H
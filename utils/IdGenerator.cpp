@@ -0,0 +1,251 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Utils: IdGenerator.cpp
+ *
+ * Implementation of the Snowflake-style ID service
+ */
+
+#include "IdGenerator.h"
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+using namespace std;
+
+namespace SOBS {
+namespace Utils {
+
+namespace {
+
+const int SEQUENCE_SHIFT = 0;
+const int THREAD_SHIFT = IdGenerator::SEQUENCE_BITS;
+const int NODE_SHIFT = THREAD_SHIFT + IdGenerator::THREAD_BITS;
+const int TIME_SHIFT = NODE_SHIFT + IdGenerator::NODE_BITS;
+const uint32_t MAX_SEQUENCE = (1u << IdGenerator::SEQUENCE_BITS) - 1;
+const int SHARED_SLOT = IdGenerator::MAX_THREAD_SLOTS;
+const int64_t MAX_LEAD_MILLIS = 1000;  // How far borrowing may run ahead of the clock
+
+// 14-digit numbers: seconds since the epoch (30 bits) | node | sequence
+const int NUMBER_SEQUENCE_BITS = 11;
+const uint64_t NUMBER_SEQUENCE_MASK = (1u << NUMBER_SEQUENCE_BITS) - 1;
+const int64_t NUMBER_BASE = 10000000000000LL;
+
+atomic<int> nodeId(-1);
+
+// Thread slots in use (bit per slot) and the last millisecond each
+// released slot used, so a thread that picks it up never repeats an id.
+atomic<uint64_t> slotMask(0);
+atomic<int64_t> slotLastMillis[IdGenerator::MAX_THREAD_SLOTS + 1];
+
+// Threads beyond MAX_THREAD_SLOTS share the last slot under a mutex
+mutex sharedMutex;
+int64_t sharedLastMillis = -1;
+uint32_t sharedSequence = 0;
+
+atomic<uint64_t> numberState(0);
+
+int64_t nowMillis() {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000 -
+           IdGenerator::EPOCH_MILLIS;
+}
+
+int resolveNodeId() {
+    int current = nodeId.load(memory_order_relaxed);
+    if (current >= 0) {
+        return current;
+    }
+    int fromEnv = 0;
+    const char* value = getenv("SOBS_NODE_ID");
+    if (value != nullptr) {
+        fromEnv = atoi(value);
+        if (fromEnv < 0 || fromEnv > IdGenerator::MAX_NODE_ID) {
+            fromEnv = 0;
+        }
+    }
+    nodeId.compare_exchange_strong(current, fromEnv);
+    return nodeId.load(memory_order_relaxed);
+}
+
+// Advance (lastMillis, sequence) to the next free position
+inline void advance(int64_t& lastMillis, uint32_t& sequence) {
+    int64_t now = nowMillis();
+    if (now > lastMillis) {
+        lastMillis = now;
+        sequence = 0;
+    } else if (sequence < MAX_SEQUENCE) {
+        sequence++;
+    } else {
+        // Sequence exhausted: borrow the next millisecond, but never run
+        // more than MAX_LEAD_MILLIS ahead of the wall clock
+        lastMillis++;
+        sequence = 0;
+        while (lastMillis - now > MAX_LEAD_MILLIS) {
+            this_thread::yield();
+            now = nowMillis();
+        }
+    }
+}
+
+inline int64_t compose(int64_t millis, int node, int slot, uint32_t sequence) {
+    return (millis << TIME_SHIFT) |
+           (static_cast<int64_t>(node) << NODE_SHIFT) |
+           (static_cast<int64_t>(slot) << THREAD_SHIFT) |
+           (static_cast<int64_t>(sequence) << SEQUENCE_SHIFT);
+}
+
+struct ThreadState {
+    int slot;
+    int node;
+    int64_t lastMillis;
+    uint32_t sequence;
+
+    ThreadState() : slot(-1), node(0), lastMillis(-1), sequence(0) {}
+
+    ~ThreadState() {
+        if (slot >= 0 && slot != SHARED_SLOT) {
+            slotLastMillis[slot].store(lastMillis, memory_order_relaxed);
+            slotMask.fetch_and(~(1ULL << slot), memory_order_release);
+        }
+    }
+
+    void claimSlot() {
+        node = resolveNodeId();
+        uint64_t mask = slotMask.load(memory_order_relaxed);
+        while (true) {
+            uint64_t free = ~mask & ((1ULL << SHARED_SLOT) - 1);
+            if (free == 0) {
+                slot = SHARED_SLOT;
+                return;
+            }
+            int candidate = __builtin_ctzll(free);
+            if (slotMask.compare_exchange_weak(mask, mask | (1ULL << candidate),
+                                               memory_order_acquire)) {
+                slot = candidate;
+                break;
+            }
+        }
+        // Resume after the previous owner of this slot
+        lastMillis = slotLastMillis[slot].load(memory_order_relaxed);
+        sequence = MAX_SEQUENCE;
+    }
+};
+
+thread_local ThreadState threadState;
+
+inline void writeDigits(char* out, uint64_t value, size_t width) {
+    for (size_t i = width; i > 0; i--) {
+        out[i - 1] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// IDs
+// ---------------------------------------------------------------------------
+
+int64_t IdGenerator::next() {
+    ThreadState& state = threadState;
+    if (state.slot < 0) {
+        state.claimSlot();
+    }
+    if (state.slot == SHARED_SLOT) {
+        lock_guard<mutex> lock(sharedMutex);
+        advance(sharedLastMillis, sharedSequence);
+        return compose(sharedLastMillis, state.node, SHARED_SLOT, sharedSequence);
+    }
+    advance(state.lastMillis, state.sequence);
+    return compose(state.lastMillis, state.node, state.slot, state.sequence);
+}
+
+size_t IdGenerator::nextRef(const char* prefix, char* out) {
+    return formatRef(prefix, next(), out);
+}
+
+string IdGenerator::nextRef(const char* prefix) {
+    return formatRef(prefix, next());
+}
+
+size_t IdGenerator::formatRef(const char* prefix, int64_t id, char* out) {
+    size_t prefixLength = strlen(prefix);
+    memcpy(out, prefix, prefixLength);
+    writeDigits(out + prefixLength, static_cast<uint64_t>(id), REF_DIGITS);
+    out[prefixLength + REF_DIGITS] = '\0';
+    return prefixLength + REF_DIGITS;
+}
+
+string IdGenerator::formatRef(const char* prefix, int64_t id) {
+    char buffer[32 + REF_DIGITS];
+    if (strlen(prefix) >= 32) {
+        return string(prefix) + to_string(id);
+    }
+    return string(buffer, formatRef(prefix, id, buffer));
+}
+
+string IdGenerator::nextNumber() {
+    uint64_t seconds = static_cast<uint64_t>(nowMillis() / 1000);
+    uint64_t current = numberState.load(memory_order_relaxed);
+    uint64_t updated;
+    do {
+        uint64_t lastSeconds = current >> NUMBER_SEQUENCE_BITS;
+        uint64_t sequence = current & NUMBER_SEQUENCE_MASK;
+        if (seconds > lastSeconds) {
+            updated = seconds << NUMBER_SEQUENCE_BITS;
+        } else if (sequence < NUMBER_SEQUENCE_MASK) {
+            updated = current + 1;
+        } else {
+            updated = (lastSeconds + 1) << NUMBER_SEQUENCE_BITS;
+        }
+    } while (!numberState.compare_exchange_weak(current, updated, memory_order_relaxed));
+
+    uint64_t lastSeconds = updated >> NUMBER_SEQUENCE_BITS;
+    uint64_t sequence = updated & NUMBER_SEQUENCE_MASK;
+    uint64_t value = (lastSeconds << (NODE_BITS + NUMBER_SEQUENCE_BITS)) |
+                     (static_cast<uint64_t>(resolveNodeId()) << NUMBER_SEQUENCE_BITS) |
+                     sequence;
+
+    char buffer[NUMBER_DIGITS + 1];
+    writeDigits(buffer, static_cast<uint64_t>(NUMBER_BASE) + value, NUMBER_DIGITS);
+    return string(buffer, NUMBER_DIGITS);
+}
+
+// ---------------------------------------------------------------------------
+// Node id and decoding
+// ---------------------------------------------------------------------------
+
+bool IdGenerator::setNodeId(int id) {
+    if (id < 0 || id > MAX_NODE_ID) {
+        return false;
+    }
+    nodeId.store(id);
+    return true;
+}
+
+int IdGenerator::getNodeId() {
+    return resolveNodeId();
+}
+
+int64_t IdGenerator::timestampMillis(int64_t id) {
+    return (id >> TIME_SHIFT) + EPOCH_MILLIS;
+}
+
+int IdGenerator::nodeOf(int64_t id) {
+    return static_cast<int>((id >> NODE_SHIFT) & MAX_NODE_ID);
+}
+
+int IdGenerator::threadSlotOf(int64_t id) {
+    return static_cast<int>((id >> THREAD_SHIFT) & ((1 << THREAD_BITS) - 1));
+}
+
+int IdGenerator::sequenceOf(int64_t id) {
+    return static_cast<int>(id & MAX_SEQUENCE);
+}
+
+} // namespace Utils
+} // namespace SOBS
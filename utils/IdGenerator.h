@@ -0,0 +1,85 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Utils: IdGenerator.h
+ *
+ * Process-wide, collision-free, time-ordered ID service (Snowflake layout).
+ *
+ * - next(): 63-bit id = milliseconds since 2024-01-01 (41 bits)
+ *   | node (5 bits) | thread slot (6 bits) | sequence (11 bits).
+ *   State is thread-local: no lock, no atomic and no syscall per id.
+ *   When a thread uses up a millisecond's 2048 ids it borrows the next
+ *   millisecond instead of waiting; only a sustained rate above ~2M ids
+ *   per second per thread, held for a full second, makes it wait.
+ * - nextRef(): "TXN" + 19 zero-padded digits; refs sort in creation order.
+ * - nextNumber(): 14-digit number (account numbers, customer IDs) from
+ *   seconds | node | sequence, drawn from one shared atomic.
+ *
+ * The node id comes from SOBS_NODE_ID (0-31) or setNodeId(); each
+ * process that mints IDs concurrently needs its own node id.
+ */
+
+#ifndef IDGENERATOR_H
+#define IDGENERATOR_H
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+using namespace std;
+
+namespace SOBS {
+namespace Utils {
+
+class IdGenerator {
+public:
+    static const int NODE_BITS = 5;
+    static const int THREAD_BITS = 6;
+    static const int SEQUENCE_BITS = 11;
+    static const int MAX_NODE_ID = (1 << NODE_BITS) - 1;
+    static const int MAX_THREAD_SLOTS = (1 << THREAD_BITS) - 1;  // Last slot is shared
+    static const int64_t EPOCH_MILLIS = 1704067200000LL;          // 2024-01-01T00:00:00Z
+
+    static const size_t REF_DIGITS = 19;
+    static const size_t NUMBER_DIGITS = 14;
+
+    /**
+     * Next unique id; ids from one thread are strictly increasing
+     */
+    static int64_t next();
+
+    /**
+     * Prefix + next() as 19 zero-padded digits, e.g. "TRF0000123456789012345".
+     * 'out' needs strlen(prefix) + REF_DIGITS + 1 bytes. Returns the length.
+     */
+    static size_t nextRef(const char* prefix, char* out);
+    static string nextRef(const char* prefix);
+
+    /**
+     * Format an existing id the way nextRef() does
+     */
+    static size_t formatRef(const char* prefix, int64_t id, char* out);
+    static string formatRef(const char* prefix, int64_t id);
+
+    /**
+     * Unique 14-digit decimal number (first digit 1-8), for identifiers
+     * with a fixed 14-digit format such as account numbers
+     */
+    static string nextNumber();
+
+    /**
+     * Node id for this process (0-31). Call before the first id is minted.
+     */
+    static bool setNodeId(int nodeId);
+    static int getNodeId();
+
+    // Decode an id produced by next()
+    static int64_t timestampMillis(int64_t id);   // Unix epoch milliseconds
+    static int nodeOf(int64_t id);
+    static int threadSlotOf(int64_t id);
+    static int sequenceOf(int64_t id);
+};
+
+} // namespace Utils
+} // namespace SOBS
+
+#endif // IDGENERATOR_H
@@ -0,0 +1,363 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Utils: JsonValue.cpp
+ *
+ * Recursive-descent JSON parser
+ */
+
+#include "JsonValue.h"
+#include <cstdlib>
+#include <cctype>
+
+using namespace std;
+
+namespace SOBS {
+namespace Utils {
+
+namespace {
+
+const size_t MAX_DEPTH = 64;
+
+class Parser {
+private:
+    const string& input;
+    size_t pos;
+
+    void skipWhitespace() {
+        while (pos < input.size() &&
+               (input[pos] == ' ' || input[pos] == '\t' ||
+                input[pos] == '\n' || input[pos] == '\r')) {
+            pos++;
+        }
+    }
+
+    bool consume(const char* literal) {
+        size_t start = pos;
+        for (; *literal != '\0'; literal++, pos++) {
+            if (pos >= input.size() || input[pos] != *literal) {
+                pos = start;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static void appendUtf8(string& out, unsigned int codepoint) {
+        if (codepoint < 0x80) {
+            out += static_cast<char>(codepoint);
+        } else if (codepoint < 0x800) {
+            out += static_cast<char>(0xC0 | (codepoint >> 6));
+            out += static_cast<char>(0x80 | (codepoint & 0x3F));
+        } else if (codepoint < 0x10000) {
+            out += static_cast<char>(0xE0 | (codepoint >> 12));
+            out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codepoint & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (codepoint >> 18));
+            out += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codepoint & 0x3F));
+        }
+    }
+
+    bool parseHex4(unsigned int& value) {
+        if (pos + 4 > input.size()) return false;
+        value = 0;
+        for (int i = 0; i < 4; i++) {
+            char c = input[pos++];
+            value <<= 4;
+            if (c >= '0' && c <= '9') value |= static_cast<unsigned int>(c - '0');
+            else if (c >= 'a' && c <= 'f') value |= static_cast<unsigned int>(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F') value |= static_cast<unsigned int>(c - 'A' + 10);
+            else return false;
+        }
+        return true;
+    }
+
+    bool parseString(string& out) {
+        if (pos >= input.size() || input[pos] != '"') return false;
+        pos++;
+        while (pos < input.size()) {
+            char c = input[pos++];
+            if (c == '"') return true;
+            if (static_cast<unsigned char>(c) < 0x20) return false;
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos >= input.size()) return false;
+            char escape = input[pos++];
+            switch (escape) {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    unsigned int codepoint;
+                    if (!parseHex4(codepoint)) return false;
+                    if (codepoint >= 0xD800 && codepoint <= 0xDBFF) {
+                        unsigned int low;
+                        if (!consume("\\u") || !parseHex4(low) ||
+                            low < 0xDC00 || low > 0xDFFF) {
+                            return false;
+                        }
+                        codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    appendUtf8(out, codepoint);
+                    break;
+                }
+                default:
+                    return false;
+            }
+        }
+        return false;  // Unterminated string
+    }
+
+    bool parseNumber(JsonValue& out) {
+        size_t start = pos;
+        if (pos < input.size() && input[pos] == '-') pos++;
+        if (pos >= input.size() || !isdigit(static_cast<unsigned char>(input[pos]))) return false;
+        while (pos < input.size() && isdigit(static_cast<unsigned char>(input[pos]))) pos++;
+        if (pos < input.size() && input[pos] == '.') {
+            pos++;
+            if (pos >= input.size() || !isdigit(static_cast<unsigned char>(input[pos]))) return false;
+            while (pos < input.size() && isdigit(static_cast<unsigned char>(input[pos]))) pos++;
+        }
+        if (pos < input.size() && (input[pos] == 'e' || input[pos] == 'E')) {
+            pos++;
+            if (pos < input.size() && (input[pos] == '+' || input[pos] == '-')) pos++;
+            if (pos >= input.size() || !isdigit(static_cast<unsigned char>(input[pos]))) return false;
+            while (pos < input.size() && isdigit(static_cast<unsigned char>(input[pos]))) pos++;
+        }
+        out = JsonValue::makeNumber(input.substr(start, pos - start));
+        return true;
+    }
+
+public:
+    explicit Parser(const string& input) : input(input), pos(0) {}
+
+    bool parseValue(JsonValue& out, size_t depth) {
+        if (depth > MAX_DEPTH) return false;
+        skipWhitespace();
+        if (pos >= input.size()) return false;
+
+        char c = input[pos];
+        if (c == '{') {
+            pos++;
+            out = JsonValue::makeObject();
+            skipWhitespace();
+            if (pos < input.size() && input[pos] == '}') {
+                pos++;
+                return true;
+            }
+            while (true) {
+                skipWhitespace();
+                string key;
+                if (!parseString(key)) return false;
+                skipWhitespace();
+                if (pos >= input.size() || input[pos] != ':') return false;
+                pos++;
+                JsonValue value;
+                if (!parseValue(value, depth + 1)) return false;
+                out.set(key, value);
+                skipWhitespace();
+                if (pos < input.size() && input[pos] == ',') { pos++; continue; }
+                if (pos < input.size() && input[pos] == '}') { pos++; return true; }
+                return false;
+            }
+        }
+        if (c == '[') {
+            pos++;
+            out = JsonValue::makeArray();
+            skipWhitespace();
+            if (pos < input.size() && input[pos] == ']') {
+                pos++;
+                return true;
+            }
+            while (true) {
+                JsonValue element;
+                if (!parseValue(element, depth + 1)) return false;
+                out.append(element);
+                skipWhitespace();
+                if (pos < input.size() && input[pos] == ',') { pos++; continue; }
+                if (pos < input.size() && input[pos] == ']') { pos++; return true; }
+                return false;
+            }
+        }
+        if (c == '"') {
+            string value;
+            if (!parseString(value)) return false;
+            out = JsonValue::makeString(value);
+            return true;
+        }
+        if (consume("true")) { out = JsonValue::makeBool(true); return true; }
+        if (consume("false")) { out = JsonValue::makeBool(false); return true; }
+        if (consume("null")) { out = JsonValue::makeNull(); return true; }
+        return parseNumber(out);
+    }
+
+    bool atEnd() {
+        skipWhitespace();
+        return pos == input.size();
+    }
+};
+
+const JsonValue& nullValue() {
+    static const JsonValue value;
+    return value;
+}
+
+} // namespace
+
+JsonValue::JsonValue() : type(JsonType::NUL), boolValue(false) {}
+
+bool JsonValue::parse(const string& json, JsonValue& out) {
+    Parser parser(json);
+    JsonValue value;
+    if (!parser.parseValue(value, 0) || !parser.atEnd()) {
+        return false;
+    }
+    out = move(value);
+    return true;
+}
+
+string JsonValue::quote(const string& value) {
+    static const char* hex = "0123456789abcdef";
+    string result;
+    result.reserve(value.size() + 2);
+    result += '"';
+    for (char c : value) {
+        switch (c) {
+            case '"': result += "\\\""; break;
+            case '\\': result += "\\\\"; break;
+            case '\n': result += "\\n"; break;
+            case '\r': result += "\\r"; break;
+            case '\t': result += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    result += "\\u00";
+                    result += hex[(c >> 4) & 0x0F];
+                    result += hex[c & 0x0F];
+                } else {
+                    result += c;
+                }
+        }
+    }
+    result += '"';
+    return result;
+}
+
+JsonType JsonValue::getType() const { return type; }
+bool JsonValue::isNull() const { return type == JsonType::NUL; }
+bool JsonValue::isObject() const { return type == JsonType::OBJECT; }
+bool JsonValue::isArray() const { return type == JsonType::ARRAY; }
+
+bool JsonValue::isNumeric() const {
+    if (type == JsonType::NUMBER) return true;
+    if (type != JsonType::STRING || text.empty()) return false;
+    char* end = nullptr;
+    strtod(text.c_str(), &end);
+    return *end == '\0';
+}
+
+bool JsonValue::asBool(bool fallback) const {
+    return type == JsonType::BOOLEAN ? boolValue : fallback;
+}
+
+double JsonValue::asNumber(double fallback) const {
+    return isNumeric() ? strtod(text.c_str(), nullptr) : fallback;
+}
+
+string JsonValue::asString(const string& fallback) const {
+    if (type == JsonType::STRING || type == JsonType::NUMBER) return text;
+    if (type == JsonType::BOOLEAN) return boolValue ? "true" : "false";
+    return fallback;
+}
+
+const string& JsonValue::getText() const { return text; }
+const vector<JsonValue>& JsonValue::getElements() const { return elements; }
+const vector<pair<string, JsonValue>>& JsonValue::getMembers() const { return members; }
+
+bool JsonValue::has(const string& key) const {
+    for (const auto& member : members) {
+        if (member.first == key) return true;
+    }
+    return false;
+}
+
+const JsonValue& JsonValue::get(const string& key) const {
+    for (const auto& member : members) {
+        if (member.first == key) return member.second;
+    }
+    return nullValue();
+}
+
+string JsonValue::getString(const string& key, const string& fallback) const {
+    return get(key).asString(fallback);
+}
+
+double JsonValue::getNumber(const string& key, double fallback) const {
+    return get(key).asNumber(fallback);
+}
+
+bool JsonValue::getBool(const string& key, bool fallback) const {
+    return get(key).asBool(fallback);
+}
+
+JsonValue JsonValue::makeNull() {
+    return JsonValue();
+}
+
+JsonValue JsonValue::makeBool(bool value) {
+    JsonValue v;
+    v.type = JsonType::BOOLEAN;
+    v.boolValue = value;
+    return v;
+}
+
+JsonValue JsonValue::makeNumber(const string& literal) {
+    JsonValue v;
+    v.type = JsonType::NUMBER;
+    v.text = literal;
+    return v;
+}
+
+JsonValue JsonValue::makeString(const string& value) {
+    JsonValue v;
+    v.type = JsonType::STRING;
+    v.text = value;
+    return v;
+}
+
+JsonValue JsonValue::makeArray() {
+    JsonValue v;
+    v.type = JsonType::ARRAY;
+    return v;
+}
+
+JsonValue JsonValue::makeObject() {
+    JsonValue v;
+    v.type = JsonType::OBJECT;
+    return v;
+}
+
+void JsonValue::append(const JsonValue& element) {
+    elements.push_back(element);
+}
+
+void JsonValue::set(const string& key, const JsonValue& value) {
+    for (auto& member : members) {
+        if (member.first == key) {
+            member.second = value;
+            return;
+        }
+    }
+    members.emplace_back(key, value);
+}
+
+} // namespace Utils
+} // namespace SOBS
@@ -0,0 +1,93 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Utils: JsonValue.h
+ *
+ * Minimal JSON document model and parser for request bodies
+ * (HTTP API and batch mode input).
+ */
+
+#ifndef JSONVALUE_H
+#define JSONVALUE_H
+
+#include <string>
+#include <vector>
+#include <utility>
+
+using namespace std;
+
+namespace SOBS {
+namespace Utils {
+
+enum class JsonType {
+    NUL,
+    BOOLEAN,
+    NUMBER,
+    STRING,
+    ARRAY,
+    OBJECT
+};
+
+class JsonValue {
+private:
+    JsonType type;
+    bool boolValue;
+    string text;                            // String value, or number literal
+    vector<JsonValue> elements;             // Array elements
+    vector<pair<string, JsonValue>> members; // Object members, in order
+
+public:
+    JsonValue();
+
+    /**
+     * Parse a complete JSON document. Returns false on malformed input.
+     */
+    static bool parse(const string& json, JsonValue& out);
+
+    /**
+     * Quote and escape a string as a JSON string literal
+     */
+    static string quote(const string& value);
+
+    JsonType getType() const;
+    bool isNull() const;
+    bool isObject() const;
+    bool isArray() const;
+    bool isNumeric() const;  // A number, or a string holding one
+
+    // Scalar access
+    bool asBool(bool fallback = false) const;
+    double asNumber(double fallback = 0.0) const;
+    string asString(const string& fallback = "") const;
+
+    /**
+     * Raw text of a number or string value (numbers keep their literal
+     * form, e.g. "1500.50", so amounts can be parsed without rounding)
+     */
+    const string& getText() const;
+
+    // Array access
+    const vector<JsonValue>& getElements() const;
+
+    // Object access
+    const vector<pair<string, JsonValue>>& getMembers() const;
+    bool has(const string& key) const;
+    const JsonValue& get(const string& key) const;  // Null value if missing
+    string getString(const string& key, const string& fallback = "") const;
+    double getNumber(const string& key, double fallback = 0.0) const;
+    bool getBool(const string& key, bool fallback = false) const;
+
+    // Building (used by the parser)
+    static JsonValue makeNull();
+    static JsonValue makeBool(bool value);
+    static JsonValue makeNumber(const string& literal);
+    static JsonValue makeString(const string& value);
+    static JsonValue makeArray();
+    static JsonValue makeObject();
+    void append(const JsonValue& element);
+    void set(const string& key, const JsonValue& value);
+};
+
+} // namespace Utils
+} // namespace SOBS
+
+#endif // JSONVALUE_H
@@ -0,0 +1,443 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Utils: LedgerEngine.cpp
+ *
+ * Implementation of the sharded in-memory ledger
+ */
+
+#include "LedgerEngine.h"
+#include "IdGenerator.h"
+#include "Clock.h"
+#include <algorithm>
+#include <cstdint>
+
+using namespace std;
+
+namespace SOBS {
+namespace Utils {
+
+LedgerEngine::LedgerEngine(size_t shardCount)
+    : shardCount(shardCount == 0 ? 1 : shardCount),
+      shards(new Shard[shardCount == 0 ? 1 : shardCount]),
+      nextAccountId(1) {}
+
+LedgerEngine::~LedgerEngine() {}
+
+size_t LedgerEngine::shardIndexOf(const string& accountNumber) const {
+    // FNV-1a over the account number, then a final avalanche step so
+    // sequential account numbers spread evenly over the shards
+    uint64_t hash = 1469598103934665603ULL;
+    for (char c : accountNumber) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return static_cast<size_t>(hash % shardCount);
+}
+
+LedgerEngine::Shard& LedgerEngine::shardFor(const string& accountNumber) {
+    return shards[shardIndexOf(accountNumber)];
+}
+
+const LedgerEngine::Shard& LedgerEngine::shardFor(const string& accountNumber) const {
+    return shards[shardIndexOf(accountNumber)];
+}
+
+LedgerEngine::AccountRecord* LedgerEngine::findRecord(const string& accountNumber) const {
+    const Shard& shard = shardFor(accountNumber);
+    shared_lock<shared_mutex> lock(shard.lock);
+
+    auto it = shard.accounts.find(accountNumber);
+    if (it == shard.accounts.end()) return nullptr;
+
+    // Records are never erased and map nodes never move,
+    // so the pointer stays valid after the shard lock is dropped
+    return const_cast<AccountRecord*>(&it->second);
+}
+
+LedgerEngine::HotBalance::HotBalance(size_t subBalanceCount, const Model::Account& account)
+    : balance(subBalanceCount, account.getBalance()),
+      slots(new PostingSlot[balance.getSubBalanceCount()]),
+      identity(account) {}
+
+long LedgerEngine::appendPosting(AccountRecord& record, const Model::Money& amount,
+                                 const string& description, time_t now) {
+    Posting posting;
+    posting.postingId = static_cast<long>(IdGenerator::next());
+    posting.amount = amount;
+    posting.postedAt = now;
+    posting.description = description;
+
+    long postingId = posting.postingId;
+    HotBalance* hot = record.hot.load(memory_order_acquire);
+    if (hot == nullptr) {
+        posting.balanceAfter = record.account.getBalance();
+        record.postings.push_back(move(posting));
+        return postingId;
+    }
+
+    posting.balanceAfter = hot->balance.total();
+    PostingSlot& slot = hot->slots[hot->balance.slotOfCurrentThread()];
+    lock_guard<mutex> lock(slot.lock);
+    slot.postings.push_back(move(posting));
+    return postingId;
+}
+
+void LedgerEngine::syncBalance(AccountRecord& record) {
+    HotBalance* hot = record.hot.load(memory_order_acquire);
+    if (hot != nullptr) {
+        record.account.setBalance(hot->balance.total());
+    }
+}
+
+bool LedgerEngine::applyAmount(AccountRecord& record, const Model::Money& amount) {
+    HotBalance* hot = record.hot.load(memory_order_acquire);
+    if (hot == nullptr) {
+        return record.account.updateBalance(amount);
+    }
+    bool applied;
+    if (amount.isNegative()) {
+        Model::Money debit = amount;
+        applied = debit.negate() && hot->balance.debit(debit);
+    } else {
+        applied = hot->balance.credit(amount);
+    }
+    syncBalance(record);
+    return applied;
+}
+
+void LedgerEngine::undoDebit(AccountRecord& record, const Model::Money& amount,
+                             const Model::Money& balance, const Model::Money& available) {
+    HotBalance* hot = record.hot.load(memory_order_acquire);
+    if (hot != nullptr) {
+        hot->balance.revertDebit(amount);
+        syncBalance(record);
+        return;
+    }
+    record.account.setBalance(balance);
+    record.account.setAvailableBalance(available);
+}
+
+bool LedgerEngine::openAccount(const Model::Account& account) {
+    Shard& shard = shardFor(account.getAccountNumber());
+    unique_lock<shared_mutex> lock(shard.lock);
+
+    auto inserted = shard.accounts.try_emplace(account.getAccountNumber());
+    if (!inserted.second) {
+        return false;  // Already registered
+    }
+
+    AccountRecord& record = inserted.first->second;
+    record.account = account;
+    if (record.account.getAccountId() == 0) {
+        record.account.setAccountId(nextAccountId.fetch_add(1));
+    }
+    return true;
+}
+
+bool LedgerEngine::hasAccount(const string& accountNumber) const {
+    return findRecord(accountNumber) != nullptr;
+}
+
+bool LedgerEngine::getAccount(const string& accountNumber,
+                              Model::Account& out) const {
+    AccountRecord* record = findRecord(accountNumber);
+    if (record == nullptr) return false;
+
+    lock_guard<mutex> lock(record->lock);
+    syncBalance(*record);
+    out = record->account;
+    return true;
+}
+
+bool LedgerEngine::getBalance(const string& accountNumber,
+                              Model::Money& balance, Model::Money& availableBalance) const {
+    AccountRecord* record = findRecord(accountNumber);
+    if (record == nullptr) return false;
+
+    lock_guard<mutex> lock(record->lock);
+    syncBalance(*record);
+    balance = record->account.getBalance();
+    availableBalance = record->account.getAvailableBalance();
+    return true;
+}
+
+long LedgerEngine::post(const string& accountNumber, const Model::Money& amount,
+                        const string& description, const PostingHook& onApplied) {
+    AccountRecord* record = findRecord(accountNumber);
+    if (record == nullptr) return -1;
+
+    // Credits to a sharded account skip the account lock
+    HotBalance* hot = record->hot.load(memory_order_acquire);
+    if (hot != nullptr && !amount.isNegative() && !onApplied) {
+        if (!hot->balance.credit(amount)) return -1;
+        return appendPosting(*record, amount, description, Clock::now());
+    }
+
+    lock_guard<mutex> lock(record->lock);
+    const Model::Money balance = record->account.getBalance();
+    const Model::Money available = record->account.getAvailableBalance();
+    if (!applyAmount(*record, amount)) {
+        return -1;  // Insufficient funds
+    }
+    if (onApplied && !onApplied(record->account)) {
+        // Sharding takes the account lock, so 'hot' is current here
+        hot = record->hot.load(memory_order_acquire);
+        if (amount.isNegative()) {
+            Model::Money debit = amount;
+            debit.negate();     // applyAmount() refused amounts that cannot be negated
+            undoDebit(*record, debit, balance, available);
+        } else if (hot != nullptr) {
+            hot->balance.revertCredit(amount);
+            syncBalance(*record);
+        } else {
+            record->account.setBalance(balance);
+            record->account.setAvailableBalance(available);
+        }
+        return -1;
+    }
+
+    return appendPosting(*record, amount, description, Clock::now());
+}
+
+TransferOutcome LedgerEngine::applyTransfer(AccountRecord& sender, AccountRecord& recipient,
+                                            const Model::Money& amount,
+                                            const string& description,
+                                            const TransferHook& onApplied, time_t now) {
+    syncBalance(sender);
+    Model::Account& from = sender.account;
+    Model::Account& to = recipient.account;
+    if (!from.canTransfer(amount)) {
+        if (!from.isActive()) return TransferOutcome::SENDER_INACTIVE;
+        if (amount > from.getAvailableBalance()) return TransferOutcome::INSUFFICIENT_FUNDS;
+        return TransferOutcome::DAILY_LIMIT_EXCEEDED;
+    }
+    if (!to.isActive()) return TransferOutcome::RECIPIENT_INACTIVE;
+
+    Model::Money debit = amount;
+    if (!debit.negate()) return TransferOutcome::INVALID_AMOUNT;
+
+    // Either leg can still fail (recipient overflow, a sharded sender's
+    // borrow coming up short); every undo restores the earlier values
+    // exactly, so undoing cannot fail
+    const Model::Money fromBalance = from.getBalance();
+    const Model::Money fromAvailable = from.getAvailableBalance();
+    const Model::Money toBalance = to.getBalance();
+    const Model::Money toAvailable = to.getAvailableBalance();
+    if (!to.updateBalance(amount)) return TransferOutcome::BALANCE_OVERFLOW;
+    if (!applyAmount(sender, debit)) {
+        to.setBalance(toBalance);
+        to.setAvailableBalance(toAvailable);
+        return TransferOutcome::INSUFFICIENT_FUNDS;
+    }
+    if (onApplied && !onApplied(from, to)) {
+        undoDebit(sender, amount, fromBalance, fromAvailable);
+        to.setBalance(toBalance);
+        to.setAvailableBalance(toAvailable);
+        return TransferOutcome::LOG_FAILED;
+    }
+    from.recordDailyTransfer(amount);
+
+    appendPosting(sender, debit, description, now);
+    appendPosting(recipient, amount, description, now);
+    return TransferOutcome::COMPLETED;
+}
+
+TransferOutcome LedgerEngine::applyTransferToHot(AccountRecord& sender, AccountRecord& recipient,
+                                                 const Model::Money& amount,
+                                                 const string& description,
+                                                 const TransferHook& onApplied, time_t now) {
+    HotBalance& hot = *recipient.hot.load(memory_order_acquire);
+    syncBalance(sender);
+
+    Model::Account& from = sender.account;
+    if (!from.canTransfer(amount)) {
+        if (!from.isActive()) return TransferOutcome::SENDER_INACTIVE;
+        if (amount > from.getAvailableBalance()) return TransferOutcome::INSUFFICIENT_FUNDS;
+        return TransferOutcome::DAILY_LIMIT_EXCEEDED;
+    }
+    if (!hot.identity.isActive()) return TransferOutcome::RECIPIENT_INACTIVE;
+
+    Model::Money debit = amount;
+    if (!debit.negate()) return TransferOutcome::INVALID_AMOUNT;
+
+    // The credit lands on this thread's sub-balance; undoing either leg
+    // cannot fail
+    const Model::Money fromBalance = from.getBalance();
+    const Model::Money fromAvailable = from.getAvailableBalance();
+    if (!hot.balance.credit(amount)) return TransferOutcome::BALANCE_OVERFLOW;
+    if (!applyAmount(sender, debit)) {
+        hot.balance.revertCredit(amount);
+        return TransferOutcome::INSUFFICIENT_FUNDS;
+    }
+    if (onApplied) {
+        Model::Account to = hot.identity;
+        to.setBalance(hot.balance.total());
+        if (!onApplied(from, to)) {
+            undoDebit(sender, amount, fromBalance, fromAvailable);
+            hot.balance.revertCredit(amount);
+            return TransferOutcome::LOG_FAILED;
+        }
+    }
+    from.recordDailyTransfer(amount);
+
+    appendPosting(sender, debit, description, now);
+    appendPosting(recipient, amount, description, now);
+    return TransferOutcome::COMPLETED;
+}
+
+TransferOutcome LedgerEngine::transfer(const string& senderAccountNumber,
+                                       const string& recipientAccountNumber,
+                                       const Model::Money& amount,
+                                       const string& description,
+                                       const TransferHook& onApplied, time_t postedAt) {
+    if (!amount.isPositive()) return TransferOutcome::INVALID_AMOUNT;
+    if (senderAccountNumber == recipientAccountNumber) return TransferOutcome::SAME_ACCOUNT;
+
+    AccountRecord* sender = findRecord(senderAccountNumber);
+    if (sender == nullptr) return TransferOutcome::SENDER_NOT_FOUND;
+    AccountRecord* recipient = findRecord(recipientAccountNumber);
+    if (recipient == nullptr) return TransferOutcome::RECIPIENT_NOT_FOUND;
+    time_t now = postedAt != 0 ? postedAt : Clock::now();
+
+    // Sharded recipient: only the sender is locked
+    if (recipient->hot.load(memory_order_acquire) != nullptr) {
+        lock_guard<mutex> lock(sender->lock);
+        return applyTransferToHot(*sender, *recipient, amount, description, onApplied, now);
+    }
+
+    // Canonical order: the lower account number is always locked first
+    bool senderFirst = senderAccountNumber < recipientAccountNumber;
+    unique_lock<mutex> firstLock((senderFirst ? sender : recipient)->lock);
+    unique_lock<mutex> secondLock((senderFirst ? recipient : sender)->lock);
+
+    // Sharded while we waited for its lock
+    if (recipient->hot.load(memory_order_acquire) != nullptr) {
+        return applyTransferToHot(*sender, *recipient, amount, description, onApplied, now);
+    }
+    return applyTransfer(*sender, *recipient, amount, description, onApplied, now);
+}
+
+size_t LedgerEngine::transferBatch(const string& senderAccountNumber,
+                                   const vector<TransferInstruction>& instructions,
+                                   vector<TransferOutcome>& outcomes,
+                                   const BatchTransferHook& onApplied, time_t postedAt) {
+    outcomes.assign(instructions.size(), TransferOutcome::SENDER_NOT_FOUND);
+    AccountRecord* sender = findRecord(senderAccountNumber);
+    if (sender == nullptr) return 0;
+    time_t now = postedAt != 0 ? postedAt : Clock::now();
+
+    size_t completed = 0;
+    unique_lock<mutex> senderLock(sender->lock);
+    for (size_t i = 0; i < instructions.size(); i++) {
+        const TransferInstruction& instruction = instructions[i];
+        const string& recipientNumber = instruction.recipientAccountNumber;
+
+        TransferOutcome& outcome = outcomes[i];
+        if (!instruction.amount.isPositive()) {
+            outcome = TransferOutcome::INVALID_AMOUNT;
+            continue;
+        }
+        if (recipientNumber == senderAccountNumber) {
+            outcome = TransferOutcome::SAME_ACCOUNT;
+            continue;
+        }
+        AccountRecord* recipient = findRecord(recipientNumber);
+        if (recipient == nullptr) {
+            outcome = TransferOutcome::RECIPIENT_NOT_FOUND;
+            continue;
+        }
+
+        TransferHook itemHook;
+        if (onApplied) {
+            itemHook = [&onApplied, i](const Model::Account& from, const Model::Account& to) {
+                return onApplied(i, from, to);
+            };
+        }
+
+        unique_lock<mutex> recipientLock;
+        if (recipient->hot.load(memory_order_acquire) == nullptr) {
+            if (senderAccountNumber < recipientNumber) {
+                recipientLock = unique_lock<mutex>(recipient->lock);
+            } else {
+                // Lower-numbered recipient: taking it while holding the sender
+                // would invert the lock order, so only try; on contention
+                // re-acquire both in canonical order
+                recipientLock = unique_lock<mutex>(recipient->lock, try_to_lock);
+                if (!recipientLock.owns_lock()) {
+                    senderLock.unlock();
+                    recipientLock.lock();
+                    senderLock.lock();
+                }
+            }
+        }
+
+        if (recipient->hot.load(memory_order_acquire) != nullptr) {
+            outcome = applyTransferToHot(*sender, *recipient, instruction.amount,
+                                         instruction.description, itemHook, now);
+        } else {
+            outcome = applyTransfer(*sender, *recipient, instruction.amount,
+                                    instruction.description, itemHook, now);
+        }
+        if (outcome == TransferOutcome::COMPLETED) completed++;
+    }
+    return completed;
+}
+
+bool LedgerEngine::shardBalance(const string& accountNumber, size_t subBalanceCount,
+                                const function<void(const Model::Account&)>& onSharded) {
+    AccountRecord* record = findRecord(accountNumber);
+    if (record == nullptr) return false;
+
+    lock_guard<mutex> lock(record->lock);
+    if (record->hot.load(memory_order_relaxed) != nullptr) return false;
+
+    if (onSharded) onSharded(record->account);
+    record->hot.store(new HotBalance(subBalanceCount, record->account), memory_order_release);
+    return true;
+}
+
+bool LedgerEngine::isBalanceSharded(const string& accountNumber) const {
+    AccountRecord* record = findRecord(accountNumber);
+    return record != nullptr && record->hot.load(memory_order_acquire) != nullptr;
+}
+
+vector<Posting> LedgerEngine::getPostings(const string& accountNumber) const {
+    AccountRecord* record = findRecord(accountNumber);
+    if (record == nullptr) return vector<Posting>();
+
+    lock_guard<mutex> lock(record->lock);
+    vector<Posting> postings = record->postings;
+
+    HotBalance* hot = record->hot.load(memory_order_acquire);
+    if (hot != nullptr) {
+        size_t sharded = postings.size();
+        for (size_t i = 0; i < hot->balance.getSubBalanceCount(); i++) {
+            lock_guard<mutex> slotLock(hot->slots[i].lock);
+            postings.insert(postings.end(), hot->slots[i].postings.begin(),
+                            hot->slots[i].postings.end());
+        }
+        // Posting IDs are time-ordered: merge the slots by ID
+        sort(postings.begin() + static_cast<ptrdiff_t>(sharded), postings.end(),
+             [](const Posting& a, const Posting& b) { return a.postingId < b.postingId; });
+    }
+    return postings;
+}
+
+size_t LedgerEngine::getAccountCount() const {
+    size_t total = 0;
+    for (size_t i = 0; i < shardCount; i++) {
+        shared_lock<shared_mutex> lock(shards[i].lock);
+        total += shards[i].accounts.size();
+    }
+    return total;
+}
+
+size_t LedgerEngine::getShardCount() const {
+    return shardCount;
+}
+
+} // namespace Utils
+} // namespace SOBS
@@ -0,0 +1,271 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Utils: LedgerEngine.h
+ *
+ * Embedded in-memory ledger used as the storage engine
+ * behind DatabaseConnection.
+ *
+ * Accounts and their postings are partitioned into shards by
+ * account number. A shard's reader/writer lock only guards which
+ * accounts exist; each account's balance and postings sit behind the
+ * account's own mutex. Records are never erased, so once looked up an
+ * account can be locked without holding its shard.
+ *
+ * transfer() locks sender and recipient in ascending account-number
+ * order, so two-account operations never deadlock and transfers on
+ * disjoint accounts never wait on each other.
+ *
+ * High-fan-in accounts can have their balance split into sub-balances
+ * (shardBalance). Credits to such an account take no account lock: they
+ * land on the crediting thread's sub-balance and posting slot. Debits
+ * still run under the account lock and borrow across sub-balances.
+ */
+
+#ifndef LEDGERENGINE_H
+#define LEDGERENGINE_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <shared_mutex>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <functional>
+#include <ctime>
+#include "../model/Account.h"
+#include "ShardedBalance.h"
+
+using namespace std;
+
+namespace SOBS {
+namespace Utils {
+
+/**
+ * A single balance movement on one account.
+ * Positive amounts are credits, negative amounts are debits.
+ */
+struct Posting {
+    long postingId;                 // Time-ordered, from IdGenerator
+    Model::Money amount;
+    Model::Money balanceAfter;
+    time_t postedAt;
+    string description;
+};
+
+enum class TransferOutcome {
+    COMPLETED,
+    INVALID_AMOUNT,
+    SAME_ACCOUNT,
+    SENDER_NOT_FOUND,
+    RECIPIENT_NOT_FOUND,
+    SENDER_INACTIVE,
+    RECIPIENT_INACTIVE,
+    INSUFFICIENT_FUNDS,
+    DAILY_LIMIT_EXCEEDED,
+    BALANCE_OVERFLOW,
+    LOG_FAILED,
+    NOT_DURABLE         // Applied, but the write-ahead log could not be synced
+};
+
+/**
+ * One line of a batch from a single sender
+ */
+struct TransferInstruction {
+    string recipientAccountNumber;
+    Model::Money amount;
+    string description;
+};
+
+// Called with both accounts locked once a transfer's balances have moved
+typedef function<bool(const Model::Account& sender,
+                      const Model::Account& recipient)> TransferHook;
+// Same, with the index of the batch line
+typedef function<bool(size_t index, const Model::Account& sender,
+                      const Model::Account& recipient)> BatchTransferHook;
+// Called with the account locked once a posting's amount has applied
+typedef function<bool(const Model::Account& account)> PostingHook;
+
+class LedgerEngine {
+private:
+    // Postings of a sharded account, one slot per sub-balance
+    struct alignas(64) PostingSlot {
+        mutex lock;
+        vector<Posting> postings;
+    };
+
+    struct HotBalance {
+        ShardedBalance balance;
+        unique_ptr<PostingSlot[]> slots;
+        Model::Account identity;    // Snapshot taken when sharded; never changes
+
+        HotBalance(size_t subBalanceCount, const Model::Account& account);
+    };
+
+    struct AccountRecord {
+        mutable mutex lock;         // Guards account and postings
+        Model::Account account;     // Balance is a cache when 'hot' is set
+        vector<Posting> postings;   // Postings made before sharding
+        atomic<HotBalance*> hot;    // Set once by shardBalance(), never cleared
+
+        AccountRecord() : hot(nullptr) {}
+        ~AccountRecord() { delete hot.load(); }
+    };
+
+    // Each shard sits on its own cache line so that shard locks
+    // taken by different cores do not false-share.
+    struct alignas(64) Shard {
+        mutable shared_mutex lock;
+        unordered_map<string, AccountRecord> accounts;
+    };
+
+    size_t shardCount;
+    unique_ptr<Shard[]> shards;
+    atomic<long> nextAccountId;
+
+    Shard& shardFor(const string& accountNumber);
+    const Shard& shardFor(const string& accountNumber) const;
+
+    // Look up a record under a shared shard lock; nullptr if absent
+    AccountRecord* findRecord(const string& accountNumber) const;
+
+    // Record a posting (caller holds record.lock unless the account is
+    // sharded); returns the posting ID
+    static long appendPosting(AccountRecord& record, const Model::Money& amount,
+                              const string& description, time_t now);
+
+    // Copy a sharded balance into record.account (caller holds record.lock)
+    static void syncBalance(AccountRecord& record);
+
+    // Apply a signed amount to a locked record, sharded or not
+    static bool applyAmount(AccountRecord& record, const Model::Money& amount);
+
+    // Undo a debit made by applyAmount; 'balance' and 'available' are the
+    // account's values from before it (caller holds record.lock)
+    static void undoDebit(AccountRecord& record, const Model::Money& amount,
+                          const Model::Money& balance, const Model::Money& available);
+
+    // Check and apply one transfer, posted at 'now'; caller holds both
+    // account locks
+    static TransferOutcome applyTransfer(AccountRecord& sender, AccountRecord& recipient,
+                                         const Model::Money& amount,
+                                         const string& description,
+                                         const TransferHook& onApplied, time_t now);
+
+    // Same for a sharded recipient; caller holds the sender lock only
+    static TransferOutcome applyTransferToHot(AccountRecord& sender, AccountRecord& recipient,
+                                              const Model::Money& amount,
+                                              const string& description,
+                                              const TransferHook& onApplied, time_t now);
+
+public:
+    static const size_t DEFAULT_SHARD_COUNT = 64;
+
+    explicit LedgerEngine(size_t shardCount = DEFAULT_SHARD_COUNT);
+    ~LedgerEngine();
+
+    LedgerEngine(const LedgerEngine&) = delete;
+    LedgerEngine& operator=(const LedgerEngine&) = delete;
+
+    /**
+     * Register an account. Assigns an account ID if the account has none.
+     * Returns false if the account number is already registered.
+     */
+    bool openAccount(const Model::Account& account);
+
+    /**
+     * Check whether an account number is registered
+     */
+    bool hasAccount(const string& accountNumber) const;
+
+    /**
+     * Copy the current account state into 'out'
+     */
+    bool getAccount(const string& accountNumber, Model::Account& out) const;
+
+    /**
+     * Read balance and available balance under the account lock
+     */
+    bool getBalance(const string& accountNumber,
+                    Model::Money& balance, Model::Money& availableBalance) const;
+
+    /**
+     * Apply a signed amount to an account and record the posting.
+     * Returns the posting ID, or -1 if the account does not exist
+     * or the posting would overdraw it.
+     *
+     * 'onApplied' runs under the account lock after the amount applies
+     * (credits to a sharded account then take the lock too), so log
+     * records follow apply order; if it returns false the amount is
+     * undone and -1 returned.
+     */
+    long post(const string& accountNumber, const Model::Money& amount,
+              const string& description, const PostingHook& onApplied = nullptr);
+
+    /**
+     * Move 'amount' from one account to another as a single step: both
+     * accounts are locked (in account-number order), the sender must pass
+     * Account::canTransfer, then both legs and their postings are applied
+     * before either lock is released. Nothing changes unless COMPLETED.
+     *
+     * 'onApplied' runs after the balances move, with both accounts still
+     * locked, so log and journal records are appended in the order
+     * transfers apply. It sees both accounts as updated; if it returns
+     * false both legs are undone and LOG_FAILED is returned.
+     *
+     * Postings are stamped 'postedAt' (0 = now); log replay passes the
+     * original time.
+     */
+    TransferOutcome transfer(const string& senderAccountNumber,
+                             const string& recipientAccountNumber,
+                             const Model::Money& amount, const string& description,
+                             const TransferHook& onApplied = nullptr, time_t postedAt = 0);
+
+    /**
+     * Apply many transfers from one sender, locking the sender once.
+     * Each line is checked and applied as transfer() would, in order;
+     * 'outcomes' gets one entry per line. A recipient numbered below the
+     * sender is try-locked, and on contention both locks are re-taken in
+     * canonical order. Returns the number of COMPLETED lines.
+     */
+    size_t transferBatch(const string& senderAccountNumber,
+                         const vector<TransferInstruction>& instructions,
+                         vector<TransferOutcome>& outcomes,
+                         const BatchTransferHook& onApplied = nullptr, time_t postedAt = 0);
+
+    /**
+     * Split an account's balance into 'subBalanceCount' sub-balances
+     * (for accounts receiving many concurrent credits). Returns false if
+     * the account does not exist or is already sharded. Postings made
+     * afterwards report the aggregate balance seen right after them as
+     * balanceAfter; concurrent credits may interleave. 'onSharded' sees
+     * the account, with its exact balance, under the account lock just
+     * before lock-free credits can start.
+     */
+    bool shardBalance(const string& accountNumber, size_t subBalanceCount,
+                      const function<void(const Model::Account&)>& onSharded = nullptr);
+
+    bool isBalanceSharded(const string& accountNumber) const;
+
+    /**
+     * Get all postings of an account in posting order
+     */
+    vector<Posting> getPostings(const string& accountNumber) const;
+
+    /**
+     * Number of registered accounts across all shards
+     */
+    size_t getAccountCount() const;
+
+    size_t getShardCount() const;
+
+    /**
+     * Shard an account number maps to
+     */
+    size_t shardIndexOf(const string& accountNumber) const;
+};
+
+} // namespace Utils
+} // namespace SOBS
+
+#endif // LEDGERENGINE_H
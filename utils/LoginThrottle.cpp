@@ -0,0 +1,201 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Utils: LoginThrottle.cpp
+ *
+ * Implementation of the failed sign-in counters
+ */
+
+#include "LoginThrottle.h"
+#include <sys/random.h>
+#include <chrono>
+#include <cctype>
+
+using namespace std;
+
+namespace SOBS {
+namespace Utils {
+
+namespace {
+
+const char ACCOUNT_KIND = 'e';
+const char ADDRESS_KIND = 'a';
+const uint32_t COUNT_LIMIT = 0xffff;            // Counts saturate here
+
+size_t roundUpToPowerOfTwo(size_t n) {
+    size_t power = 1;
+    while (power < n) power <<= 1;
+    return power;
+}
+
+uint64_t pack(uint32_t window, uint32_t current, uint32_t previous) {
+    return static_cast<uint64_t>(window) << 32 | current << 16 | previous;
+}
+
+// Failures over the last WINDOW_SECONDS: the current window's count plus
+// the part of the previous window's count still inside the sliding window
+uint32_t estimate(uint64_t counts, uint32_t nowSeconds) {
+    uint32_t window = nowSeconds / LoginThrottle::WINDOW_SECONDS;
+    uint32_t remaining = LoginThrottle::WINDOW_SECONDS - nowSeconds % LoginThrottle::WINDOW_SECONDS;
+    uint32_t stored = static_cast<uint32_t>(counts >> 32);
+    uint32_t current = static_cast<uint32_t>(counts >> 16) & COUNT_LIMIT;
+    uint32_t previous = static_cast<uint32_t>(counts) & COUNT_LIMIT;
+
+    if (stored == window) {
+        return current + static_cast<uint32_t>(
+            static_cast<uint64_t>(previous) * remaining / LoginThrottle::WINDOW_SECONDS);
+    }
+    if (stored + 1 == window) {
+        return static_cast<uint32_t>(
+            static_cast<uint64_t>(current) * remaining / LoginThrottle::WINDOW_SECONDS);
+    }
+    return 0;
+}
+
+} // namespace
+
+LoginThrottle::LoginThrottle(size_t capacity, uint32_t maxAccountFailures,
+                             uint32_t maxAddressFailures)
+    : hashSeed(0), maxAccountFailures(maxAccountFailures),
+      maxAddressFailures(maxAddressFailures) {
+    size_t bucketCount = roundUpToPowerOfTwo(capacity < PROBE_LIMIT ? size_t(PROBE_LIMIT) : capacity);
+    bucketMask = bucketCount - 1;
+    buckets.reset(new Bucket[bucketCount]());
+
+    if (getrandom(&hashSeed, sizeof(hashSeed), 0) != static_cast<ssize_t>(sizeof(hashSeed))) {
+        hashSeed = static_cast<uint64_t>(
+            chrono::steady_clock::now().time_since_epoch().count());
+    }
+}
+
+LoginThrottle::~LoginThrottle() {}
+
+uint64_t LoginThrottle::tagOf(char kind, const string& identity) const {
+    // Emails compare case-insensitively, so "A@x.com" shares "a@x.com"'s count
+    uint64_t hash = (hashSeed ^ static_cast<uint64_t>(kind)) * 0x9e3779b97f4a7c15ULL;
+    for (char c : identity) {
+        unsigned char byte = static_cast<unsigned char>(c);
+        if (kind == ACCOUNT_KIND) byte = static_cast<unsigned char>(tolower(byte));
+        hash = (hash ^ byte) * 0x100000001b3ULL;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return hash | 1;                            // 0 marks a free bucket
+}
+
+// ---------------------------------------------------------------------------
+// Buckets
+// ---------------------------------------------------------------------------
+
+LoginThrottle::Bucket* LoginThrottle::find(uint64_t tag) const {
+    // Buckets are never freed, so a free one ends the probe sequence
+    for (size_t i = 0; i < PROBE_LIMIT; i++) {
+        Bucket& bucket = buckets[(tag + i) & bucketMask];
+        uint64_t stored = bucket.tag.load(memory_order_acquire);
+        if (stored == tag) return &bucket;
+        if (stored == 0) return nullptr;
+    }
+    return nullptr;
+}
+
+LoginThrottle::Bucket* LoginThrottle::claim(uint64_t tag, uint32_t nowSeconds) {
+    Bucket* victim = nullptr;
+    uint64_t victimTag = 0;
+    uint32_t victimCount = UINT32_MAX;
+
+    for (size_t i = 0; i < PROBE_LIMIT; i++) {
+        Bucket& bucket = buckets[(tag + i) & bucketMask];
+        uint64_t stored = bucket.tag.load(memory_order_acquire);
+        if (stored == 0 && bucket.tag.compare_exchange_strong(
+                stored, tag, memory_order_acq_rel, memory_order_acquire)) {
+            return &bucket;
+        }
+        if (stored == tag) return &bucket;      // Ours, or claimed by a racing add()
+
+        uint32_t count = estimate(bucket.counts.load(memory_order_relaxed), nowSeconds);
+        if (count < victimCount) {
+            victim = &bucket;
+            victimTag = stored;
+            victimCount = count;
+        }
+    }
+
+    // Probe sequence full: take over the least-used bucket
+    if (!victim->tag.compare_exchange_strong(victimTag, tag, memory_order_acq_rel,
+                                             memory_order_acquire)) {
+        return victimTag == tag ? victim : nullptr;
+    }
+    victim->counts.store(0, memory_order_relaxed);
+    return victim;
+}
+
+uint32_t LoginThrottle::failures(uint64_t tag, uint32_t nowSeconds) const {
+    const Bucket* bucket = find(tag);
+    return bucket == nullptr ? 0 : estimate(bucket->counts.load(memory_order_relaxed), nowSeconds);
+}
+
+void LoginThrottle::add(uint64_t tag, uint32_t nowSeconds) {
+    Bucket* bucket = claim(tag, nowSeconds);
+    if (bucket == nullptr) return;              // Lost a takeover race; skip this one
+
+    uint32_t window = nowSeconds / WINDOW_SECONDS;
+    uint64_t counts = bucket->counts.load(memory_order_relaxed);
+    while (true) {
+        uint32_t stored = static_cast<uint32_t>(counts >> 32);
+        uint32_t current = static_cast<uint32_t>(counts >> 16) & COUNT_LIMIT;
+        uint64_t updated;
+        if (stored == window) {
+            if (current == COUNT_LIMIT) return; // Saturated: nothing to write
+            updated = counts + (1u << 16);
+        } else if (stored + 1 == window) {
+            updated = pack(window, 1, current);
+        } else {
+            updated = pack(window, 1, 0);
+        }
+        if (bucket->counts.compare_exchange_weak(counts, updated, memory_order_relaxed)) {
+            return;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Sign-in attempts
+// ---------------------------------------------------------------------------
+
+bool LoginThrottle::admit(const string& email, const string& address, time_t now) {
+    uint32_t nowSeconds = static_cast<uint32_t>(now);
+    uint64_t addressTag = address.empty() ? 0 : tagOf(ADDRESS_KIND, address);
+
+    bool refused = (addressTag != 0 && failures(addressTag, nowSeconds) >= maxAddressFailures) ||
+                   failures(tagOf(ACCOUNT_KIND, email), nowSeconds) >= maxAccountFailures;
+    if (refused && addressTag != 0) {
+        add(addressTag, nowSeconds);
+    }
+    return !refused;
+}
+
+void LoginThrottle::recordFailure(const string& email, const string& address, time_t now) {
+    uint32_t nowSeconds = static_cast<uint32_t>(now);
+    add(tagOf(ACCOUNT_KIND, email), nowSeconds);
+    if (!address.empty()) {
+        add(tagOf(ADDRESS_KIND, address), nowSeconds);
+    }
+}
+
+void LoginThrottle::recordSuccess(const string& email) {
+    Bucket* bucket = find(tagOf(ACCOUNT_KIND, email));
+    if (bucket != nullptr) {
+        bucket->counts.store(0, memory_order_relaxed);
+    }
+}
+
+uint32_t LoginThrottle::getAccountFailures(const string& email, time_t now) const {
+    return failures(tagOf(ACCOUNT_KIND, email), static_cast<uint32_t>(now));
+}
+
+uint32_t LoginThrottle::getAddressFailures(const string& address, time_t now) const {
+    return failures(tagOf(ADDRESS_KIND, address), static_cast<uint32_t>(now));
+}
+
+} // namespace Utils
+} // namespace SOBS
@@ -0,0 +1,101 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Utils: LoginThrottle.h
+ *
+ * Failed sign-ins over a sliding window, per account (email) and per
+ * client address, checked before any password hashing is queued.
+ *
+ * - Buckets: one fixed-size table of 16-byte buckets, each an identity
+ *   tag (seeded 64-bit hash, 0 = free) and a packed word holding the
+ *   window index and the failure counts of that window and the one
+ *   before it. The count over the last WINDOW_SECONDS is estimated as
+ *   current + previous * (unexpired share of the previous window).
+ * - Lock-free: counts change by compare-and-swap on the packed word and
+ *   buckets are claimed by compare-and-swap on the tag. A saturated
+ *   count is no longer written, so a burst from one source only reads.
+ * - Fixed size: an identity probes at most PROBE_LIMIT buckets. When
+ *   none is free it takes over the one with the lowest count, idle ones
+ *   first, so memory never grows with the number of identities seen.
+ *
+ * Counts are approximate under races (a takeover can lose or gain a
+ * few increments); limits are meant to stop bursts, not count exactly.
+ */
+
+#ifndef LOGINTHROTTLE_H
+#define LOGINTHROTTLE_H
+
+#include <string>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <ctime>
+
+using namespace std;
+
+namespace SOBS {
+namespace Utils {
+
+class LoginThrottle {
+public:
+    static const uint32_t WINDOW_SECONDS = 15 * 60;
+    static const uint32_t MAX_ACCOUNT_FAILURES = 5;      // Per email per window
+    static const uint32_t MAX_ADDRESS_FAILURES = 100;    // Per client address per window
+    static const size_t DEFAULT_CAPACITY = 1 << 20;
+    static const size_t PROBE_LIMIT = 8;
+
+private:
+    struct Bucket {
+        atomic<uint64_t> tag;
+        atomic<uint64_t> counts;    // window:32 | current:16 | previous:16
+    };
+
+    unique_ptr<Bucket[]> buckets;
+    size_t bucketMask;
+    uint64_t hashSeed;
+    uint32_t maxAccountFailures;
+    uint32_t maxAddressFailures;
+
+    uint64_t tagOf(char kind, const string& identity) const;
+    Bucket* find(uint64_t tag) const;
+    Bucket* claim(uint64_t tag, uint32_t nowSeconds);
+    uint32_t failures(uint64_t tag, uint32_t nowSeconds) const;
+    void add(uint64_t tag, uint32_t nowSeconds);
+
+public:
+    explicit LoginThrottle(size_t capacity = DEFAULT_CAPACITY,
+                           uint32_t maxAccountFailures = MAX_ACCOUNT_FAILURES,
+                           uint32_t maxAddressFailures = MAX_ADDRESS_FAILURES);
+    ~LoginThrottle();
+
+    LoginThrottle(const LoginThrottle&) = delete;
+    LoginThrottle& operator=(const LoginThrottle&) = delete;
+
+    /**
+     * False if the email or the address is over its limit; a refused
+     * attempt counts against the address, so a source that keeps trying
+     * stays refused. An empty address is not tracked.
+     */
+    bool admit(const string& email, const string& address, time_t now);
+
+    /**
+     * Count a wrong password (or unknown email) against both
+     */
+    void recordFailure(const string& email, const string& address, time_t now);
+
+    /**
+     * Clear the email's count after a successful sign-in
+     */
+    void recordSuccess(const string& email);
+
+    /**
+     * Estimated failures over the last window
+     */
+    uint32_t getAccountFailures(const string& email, time_t now) const;
+    uint32_t getAddressFailures(const string& address, time_t now) const;
+};
+
+} // namespace Utils
+} // namespace SOBS
+
+#endif // LOGINTHROTTLE_H
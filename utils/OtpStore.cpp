@@ -0,0 +1,220 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Utils: OtpStore.cpp
+ *
+ * Implementation of the one-time password store
+ */
+
+#include "OtpStore.h"
+#include <sys/random.h>
+#include <chrono>
+#include <cstring>
+
+using namespace std;
+
+namespace SOBS {
+namespace Utils {
+
+namespace {
+
+const uint32_t CODE_SPACE = 1000000;            // 10^CODE_LENGTH
+
+bool randomBytes(void* out, size_t length) {
+    return getrandom(out, length, 0) == static_cast<ssize_t>(length);
+}
+
+size_t roundUpToPowerOfTwo(size_t n) {
+    size_t power = 1;
+    while (power < n) power <<= 1;
+    return power;
+}
+
+// Uniform in [0, CODE_SPACE): values past the last whole multiple of
+// CODE_SPACE are redrawn
+bool randomCode(uint32_t& code) {
+    const uint32_t limit = UINT32_MAX - UINT32_MAX % CODE_SPACE;
+    uint32_t value;
+    do {
+        if (!randomBytes(&value, sizeof(value))) return false;
+    } while (value >= limit);
+    code = value % CODE_SPACE;
+    return true;
+}
+
+// Submitted digits as a number, with 'invalid' set for anything but
+// CODE_LENGTH decimal digits. Every position is read either way.
+uint32_t parseCode(const string& text, uint32_t& invalid) {
+    uint32_t value = 0;
+    invalid = text.size() != OtpStore::CODE_LENGTH;
+    for (size_t i = 0; i < OtpStore::CODE_LENGTH; i++) {
+        uint32_t digit = static_cast<unsigned char>(i < text.size() ? text[i] : '0') - '0';
+        invalid |= digit > 9;
+        value = value * 10 + digit;
+    }
+    return value;
+}
+
+// Key as stored: NUL-padded to KEY_LENGTH. A leading NUL would read as
+// an empty slot, so such keys are refused along with oversized ones.
+bool padKey(const string& key, char* padded) {
+    if (key.empty() || key[0] == '\0' || key.size() > OtpStore::KEY_LENGTH) return false;
+    memset(padded, 0, OtpStore::KEY_LENGTH);
+    memcpy(padded, key.data(), key.size());
+    return true;
+}
+
+} // namespace
+
+OtpStore::OtpStore(size_t capacity, size_t shardCount)
+    : shardMask(roundUpToPowerOfTwo(shardCount == 0 ? 1 : shardCount) - 1), hashSeed(0) {
+    // At least 8 slots per shard, so the sweep threshold leaves a free slot
+    size_t slotCount = roundUpToPowerOfTwo((capacity + shardMask) / (shardMask + 1));
+    if (slotCount < 8) slotCount = 8;
+    slotMask = slotCount - 1;
+    maxUsed = slotCount - slotCount / 8;
+
+    if (!randomBytes(&hashSeed, sizeof(hashSeed))) {
+        hashSeed = static_cast<uint64_t>(
+            chrono::steady_clock::now().time_since_epoch().count());
+    }
+    shards.reset(new Shard[shardMask + 1]);
+    for (size_t i = 0; i <= shardMask; i++) {
+        shards[i].slots.reset(new Entry[slotCount]());
+    }
+}
+
+OtpStore::~OtpStore() {}
+
+uint64_t OtpStore::hashOf(const char* key) const {
+    uint64_t hash = hashSeed;
+    for (size_t offset = 0; offset < KEY_LENGTH; offset += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, key + offset, sizeof(word));
+        hash = (hash ^ word) * 0x9e3779b97f4a7c15ULL;
+        hash ^= hash >> 32;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+// ---------------------------------------------------------------------------
+// Table (shard lock held)
+// ---------------------------------------------------------------------------
+
+size_t OtpStore::find(const Shard& shard, const char* key, uint64_t hash) const {
+    // Slot holding 'key', or the empty slot that ends its probe sequence
+    size_t slot = static_cast<size_t>(hash) & slotMask;
+    while (shard.slots[slot].key[0] != '\0' &&
+           memcmp(shard.slots[slot].key, key, KEY_LENGTH) != 0) {
+        slot = (slot + 1) & slotMask;
+    }
+    return slot;
+}
+
+void OtpStore::erase(Shard& shard, size_t slot) {
+    // Pull later entries of the cluster back so no probe sequence breaks
+    size_t hole = slot;
+    size_t next = slot;
+    while (true) {
+        next = (next + 1) & slotMask;
+        const Entry& entry = shard.slots[next];
+        if (entry.key[0] == '\0') break;
+
+        size_t home = static_cast<size_t>(hashOf(entry.key)) & slotMask;
+        if (((next - home) & slotMask) >= ((next - hole) & slotMask)) {
+            shard.slots[hole] = entry;
+            hole = next;
+        }
+    }
+    shard.slots[hole] = Entry();
+    shard.used--;
+}
+
+void OtpStore::sweep(Shard& shard, uint32_t now) {
+    for (size_t slot = 0; slot <= slotMask; slot++) {
+        // erase() may move another expired entry into this slot
+        while (shard.slots[slot].key[0] != '\0' && shard.slots[slot].expiresAt <= now) {
+            erase(shard, slot);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Codes
+// ---------------------------------------------------------------------------
+
+bool OtpStore::issue(const string& key, long userId, time_t now, string& code) {
+    char padded[KEY_LENGTH];
+    if (!padKey(key, padded)) return false;
+
+    uint32_t value;
+    if (!randomCode(value)) return false;
+
+    uint64_t hash = hashOf(padded);
+    Shard& shard = shards[(hash >> 32) & shardMask];
+    uint32_t nowSeconds = static_cast<uint32_t>(now);
+    {
+        lock_guard<mutex> lock(shard.lock);
+        size_t slot = find(shard, padded, hash);
+        if (shard.slots[slot].key[0] == '\0') {
+            if (shard.used >= maxUsed && shard.sweptAt != nowSeconds) {
+                sweep(shard, nowSeconds);
+                shard.sweptAt = nowSeconds;
+                slot = find(shard, padded, hash);   // The sweep may have moved entries
+            }
+            if (shard.used >= maxUsed) return false;
+            memcpy(shard.slots[slot].key, padded, KEY_LENGTH);
+            shard.used++;
+        }
+        Entry& entry = shard.slots[slot];
+        entry.expiresAt = nowSeconds + TTL_SECONDS;
+        entry.code = value;
+        entry.attempts = 0;
+        entry.userId = userId;
+    }
+
+    code.assign(CODE_LENGTH, '0');
+    for (size_t i = CODE_LENGTH; i > 0; i--) {
+        code[i - 1] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+    return true;
+}
+
+OtpOutcome OtpStore::verify(const string& key, const string& code, time_t now,
+                            long& userId) {
+    char padded[KEY_LENGTH];
+    if (!padKey(key, padded)) return OtpOutcome::EXPIRED;
+
+    uint32_t invalid;
+    uint32_t given = parseCode(code, invalid);
+
+    uint64_t hash = hashOf(padded);
+    Shard& shard = shards[(hash >> 32) & shardMask];
+    lock_guard<mutex> lock(shard.lock);
+
+    size_t slot = find(shard, padded, hash);
+    Entry& entry = shard.slots[slot];
+    if (entry.key[0] == '\0') return OtpOutcome::EXPIRED;
+    if (entry.expiresAt <= static_cast<uint32_t>(now)) {
+        erase(shard, slot);
+        return OtpOutcome::EXPIRED;
+    }
+
+    // One comparison of the whole code, whichever digits differ
+    if (((given ^ entry.code) | invalid) == 0) {
+        userId = static_cast<long>(entry.userId);
+        erase(shard, slot);
+        return OtpOutcome::VERIFIED;
+    }
+    if (++entry.attempts >= MAX_ATTEMPTS) {
+        erase(shard, slot);
+        return OtpOutcome::LOCKED;
+    }
+    return OtpOutcome::MISMATCH;
+}
+
+} // namespace Utils
+} // namespace SOBS
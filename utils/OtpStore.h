@@ -0,0 +1,114 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Utils: OtpStore.h
+ *
+ * One-time passwords waiting to be verified, keyed by the ID they confirm
+ * behind a purpose prefix ("login:" + pending login ID, "register:" +
+ * customer ID, "transfer:" + transfer reference), so a code only ever
+ * confirms what it was issued for. Each code also records the user it
+ * was issued to, which verify() hands back.
+ *
+ * Codes are six random digits (getrandom()) that expire TTL_SECONDS after
+ * they are issued and are consumed by a successful verify(). MAX_ATTEMPTS
+ * wrong guesses discard the code, so the caller has to issue a new one.
+ * The submitted code is compared without branching on its digits.
+ *
+ * Storage is fixed at construction: each shard is an open-addressing
+ * table (linear probing, backward-shift deletion) of 48-byte entries
+ * that hold the key inline, so issuing a code never allocates. A shard's
+ * mutex covers its whole table, which keeps attempt counting exact under
+ * concurrent guesses. Expired codes are removed when they are found and,
+ * once a shard is 7/8 full, by a sweep of that shard (at most once a
+ * second; a full shard of live codes refuses new keys until some expire).
+ */
+
+#ifndef OTPSTORE_H
+#define OTPSTORE_H
+
+#include <string>
+#include <mutex>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <ctime>
+
+using namespace std;
+
+namespace SOBS {
+namespace Utils {
+
+enum class OtpOutcome {
+    VERIFIED,
+    MISMATCH,           // Wrong code; attempts remain
+    LOCKED,             // Wrong code and no attempts left; the code is gone
+    EXPIRED             // No live code: never issued, expired or already used
+};
+
+class OtpStore {
+public:
+    static const size_t KEY_LENGTH = 32;        // Longest key accepted, prefix included
+    static const size_t CODE_LENGTH = 6;
+    static const int TTL_SECONDS = 5 * 60;
+    static const uint32_t MAX_ATTEMPTS = 3;
+
+private:
+    struct Entry {
+        char key[KEY_LENGTH];                   // NUL-padded; empty slot if key[0] == 0
+        uint32_t expiresAt;                     // Unix seconds
+        uint32_t code : 24;
+        uint32_t attempts : 8;                  // Wrong guesses so far
+        int64_t userId;                         // Who the code was issued to
+    };
+
+    struct alignas(64) Shard {
+        mutex lock;
+        unique_ptr<Entry[]> slots;
+        size_t used = 0;
+        uint32_t sweptAt = 0;                   // Codes only expire on whole seconds
+    };
+
+    size_t shardMask;
+    size_t slotMask;                            // Slots per shard - 1
+    size_t maxUsed;                             // Sweep threshold per shard
+    uint64_t hashSeed;
+    unique_ptr<Shard[]> shards;
+
+    uint64_t hashOf(const char* key) const;
+    size_t find(const Shard& shard, const char* key, uint64_t hash) const;
+    void erase(Shard& shard, size_t slot);
+    void sweep(Shard& shard, uint32_t now);
+
+public:
+    static const size_t DEFAULT_CAPACITY = size_t(1) << 20;    // 48 MB
+    static const size_t DEFAULT_SHARD_COUNT = 64;
+
+    /**
+     * Room for about 7/8 of 'capacity' live codes; both counts are
+     * rounded up to powers of two
+     */
+    explicit OtpStore(size_t capacity = DEFAULT_CAPACITY,
+                      size_t shardCount = DEFAULT_SHARD_COUNT);
+    ~OtpStore();
+
+    OtpStore(const OtpStore&) = delete;
+    OtpStore& operator=(const OtpStore&) = delete;
+
+    /**
+     * Draw a new code for 'key', issued to 'userId', replacing any
+     * earlier one (and its attempt count). Returns false if the key is empty or longer than
+     * KEY_LENGTH, no random code could be drawn, or the key's shard is
+     * full of live codes.
+     */
+    bool issue(const string& key, long userId, time_t now, string& code);
+
+    /**
+     * Check 'code' against the key's live code; on VERIFIED, 'userId' is
+     * the user the code was issued to
+     */
+    OtpOutcome verify(const string& key, const string& code, time_t now, long& userId);
+};
+
+} // namespace Utils
+} // namespace SOBS
+
+#endif // OTPSTORE_H
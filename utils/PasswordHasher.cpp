@@ -0,0 +1,283 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Utils: PasswordHasher.cpp
+ *
+ * Implementation of the password hashing pool
+ */
+
+#include "PasswordHasher.h"
+#include <sys/random.h>
+#include <memory>
+#include <cstdio>
+
+using namespace std;
+
+namespace SOBS {
+namespace Utils {
+
+const ScryptParams PasswordHasher::DEFAULT_PARAMS = {14, 8, 1};
+
+namespace {
+
+const char HEX_DIGITS[] = "0123456789abcdef";
+const string HASH_PREFIX = "$scrypt$";
+const size_t MAX_STORED_BYTES = 64;            // Longest salt or key accepted
+
+bool randomBytes(void* out, size_t length) {
+    return getrandom(out, length, 0) == static_cast<ssize_t>(length);
+}
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+void appendHex(string& out, const uint8_t* bytes, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        out += HEX_DIGITS[bytes[i] >> 4];
+        out += HEX_DIGITS[bytes[i] & 0xf];
+    }
+}
+
+bool parseHex(const string& text, vector<uint8_t>& out) {
+    if (text.empty() || text.size() % 2 != 0 || text.size() / 2 > MAX_STORED_BYTES) {
+        return false;
+    }
+    out.resize(text.size() / 2);
+    for (size_t i = 0; i < out.size(); i++) {
+        int high = hexValue(text[2 * i]);
+        int low = hexValue(text[2 * i + 1]);
+        if (high < 0 || low < 0) return false;
+        out[i] = static_cast<uint8_t>(high << 4 | low);
+    }
+    return true;
+}
+
+string encodeHash(const ScryptParams& params, const uint8_t* salt, size_t saltLength,
+                  const uint8_t* key, size_t keyLength) {
+    char header[64];
+    snprintf(header, sizeof(header), "ln=%u,r=%u,p=%u$", params.logN, params.r, params.p);
+    string encoded = HASH_PREFIX + header;
+    appendHex(encoded, salt, saltLength);
+    encoded += '$';
+    appendHex(encoded, key, keyLength);
+    return encoded;
+}
+
+bool decodeHash(const string& encoded, ScryptParams& params,
+                vector<uint8_t>& salt, vector<uint8_t>& key) {
+    if (encoded.compare(0, HASH_PREFIX.size(), HASH_PREFIX) != 0) return false;
+
+    int consumed = 0;
+    if (sscanf(encoded.c_str() + HASH_PREFIX.size(), "ln=%u,r=%u,p=%u$%n",
+               &params.logN, &params.r, &params.p, &consumed) != 3 || consumed == 0) {
+        return false;
+    }
+    if (!Scrypt::validParams(params)) return false;
+
+    size_t saltStart = HASH_PREFIX.size() + consumed;
+    size_t separator = encoded.find('$', saltStart);
+    if (separator == string::npos) return false;
+    return parseHex(encoded.substr(saltStart, separator - saltStart), salt) &&
+           parseHex(encoded.substr(separator + 1), key) &&
+           key.size() >= 16;
+}
+
+// Equal-length comparison that reads every byte
+bool constantTimeEquals(const uint8_t* a, const uint8_t* b, size_t length) {
+    uint8_t difference = 0;
+    for (size_t i = 0; i < length; i++) {
+        difference |= a[i] ^ b[i];
+    }
+    return difference == 0;
+}
+
+bool keyMatches(const string& password, const ScryptParams& params,
+                const vector<uint8_t>& salt, const vector<uint8_t>& expected) {
+    uint8_t key[MAX_STORED_BYTES];
+    return Scrypt::derive(password, salt.data(), salt.size(), params, key, expected.size()) &&
+           constantTimeEquals(key, expected.data(), expected.size());
+}
+
+} // namespace
+
+PasswordHasher::PasswordHasher(size_t workerCount, size_t queueCapacity,
+                               size_t memoryBudget, const ScryptParams& params)
+    : queueCapacity(queueCapacity), memoryBudget(memoryBudget), memoryInUse(0),
+      params(params), stopping(false) {
+    if (workerCount == 0) {
+        workerCount = thread::hardware_concurrency() / 2;
+        if (workerCount == 0) workerCount = 1;
+    }
+    for (size_t i = 0; i < workerCount; i++) {
+        workers.emplace_back(&PasswordHasher::workerLoop, this);
+    }
+}
+
+PasswordHasher::~PasswordHasher() {
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    jobReady.notify_all();
+    for (thread& worker : workers) {
+        worker.join();
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Queue
+// ---------------------------------------------------------------------------
+
+bool PasswordHasher::submit(Job&& job) {
+    {
+        lock_guard<mutex> guard(lock);
+        if (stopping || jobs.size() >= queueCapacity) return false;
+        jobs.push_back(move(job));
+    }
+    jobReady.notify_one();
+    return true;
+}
+
+bool PasswordHasher::submitHash(const string& password, HashCallback done) {
+    Job job;
+    job.password = password;
+    job.hashDone = move(done);
+    return submit(move(job));
+}
+
+bool PasswordHasher::submitVerify(const string& password, const string& encodedHash,
+                                  VerifyCallback done) {
+    Job job;
+    job.password = password;
+    job.encodedHash = encodedHash;
+    job.verifyDone = move(done);
+    return submit(move(job));
+}
+
+future<string> PasswordHasher::hash(const string& password) {
+    auto result = make_shared<promise<string>>();
+    future<string> hashed = result->get_future();
+    if (!submitHash(password, [result](bool ok, const string& encodedHash) {
+            result->set_value(ok ? encodedHash : string());
+        })) {
+        result->set_value(string());
+    }
+    return hashed;
+}
+
+future<bool> PasswordHasher::verify(const string& password, const string& encodedHash) {
+    auto result = make_shared<promise<bool>>();
+    future<bool> matched = result->get_future();
+    if (!submitVerify(password, encodedHash, [result](bool ok) {
+            result->set_value(ok);
+        })) {
+        result->set_value(false);
+    }
+    return matched;
+}
+
+// ---------------------------------------------------------------------------
+// Workers
+// ---------------------------------------------------------------------------
+
+void PasswordHasher::workerLoop() {
+    while (true) {
+        Job job;
+        {
+            unique_lock<mutex> guard(lock);
+            jobReady.wait(guard, [this] { return stopping || !jobs.empty(); });
+            if (jobs.empty()) {
+                return;  // Stopping, and the queue is drained
+            }
+            job = move(jobs.front());
+            jobs.pop_front();
+        }
+        run(job);
+    }
+}
+
+void PasswordHasher::run(Job& job) {
+    bool verifying = static_cast<bool>(job.verifyDone);
+    ScryptParams jobParams;
+    vector<uint8_t> salt;
+    vector<uint8_t> expected;
+    if (verifying && !decodeHash(job.encodedHash, jobParams, salt, expected)) {
+        job.verifyDone(false);
+        return;
+    }
+
+    // Reserve this derivation's memory; new hashes use the current cost
+    size_t needed;
+    {
+        unique_lock<mutex> guard(lock);
+        if (!verifying) jobParams = params;
+        needed = Scrypt::memoryBytes(jobParams);
+        if (needed > memoryBudget) {
+            guard.unlock();
+            if (verifying) job.verifyDone(false);
+            else job.hashDone(false, string());
+            return;
+        }
+        memoryFreed.wait(guard, [&] { return memoryInUse + needed <= memoryBudget; });
+        memoryInUse += needed;
+    }
+
+    bool ok;
+    string encoded;
+    if (verifying) {
+        ok = keyMatches(job.password, jobParams, salt, expected);
+    } else {
+        uint8_t newSalt[SALT_LENGTH];
+        uint8_t key[KEY_LENGTH];
+        ok = randomBytes(newSalt, sizeof(newSalt)) &&
+             Scrypt::derive(job.password, newSalt, sizeof(newSalt), jobParams, key, sizeof(key));
+        if (ok) {
+            encoded = encodeHash(jobParams, newSalt, sizeof(newSalt), key, sizeof(key));
+        }
+    }
+
+    {
+        lock_guard<mutex> guard(lock);
+        memoryInUse -= needed;
+    }
+    memoryFreed.notify_all();
+
+    if (verifying) job.verifyDone(ok);
+    else job.hashDone(ok, encoded);
+}
+
+// ---------------------------------------------------------------------------
+// Settings
+// ---------------------------------------------------------------------------
+
+bool PasswordHasher::verifyNow(const string& password, const string& encodedHash) {
+    ScryptParams hashParams;
+    vector<uint8_t> salt;
+    vector<uint8_t> expected;
+    return decodeHash(encodedHash, hashParams, salt, expected) &&
+           keyMatches(password, hashParams, salt, expected);
+}
+
+bool PasswordHasher::setParams(const ScryptParams& newParams) {
+    if (!Scrypt::validParams(newParams)) return false;
+    lock_guard<mutex> guard(lock);
+    if (Scrypt::memoryBytes(newParams) > memoryBudget) return false;
+    params = newParams;
+    return true;
+}
+
+ScryptParams PasswordHasher::getParams() const {
+    lock_guard<mutex> guard(lock);
+    return params;
+}
+
+size_t PasswordHasher::getQueuedCount() const {
+    lock_guard<mutex> guard(lock);
+    return jobs.size();
+}
+
+} // namespace Utils
+} // namespace SOBS
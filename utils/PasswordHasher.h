@@ -0,0 +1,132 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Utils: PasswordHasher.h
+ *
+ * Password hashing off the request threads. A scrypt derivation costs
+ * tens of milliseconds and megabytes, so hashes and checks are queued to
+ * a small pool of their own threads and completed through a callback
+ * (or a future); request threads hand the job over and move on.
+ *
+ * - Bounded: at most queueCapacity jobs wait. submitHash()/submitVerify()
+ *   return false when the queue is full, so a login burst is refused
+ *   rather than queued without limit.
+ * - Memory budget: a job reserves Scrypt::memoryBytes() of its
+ *   parameters from the pool's budget before it runs, so at most
+ *   budget / per-job memory derivations run at once. A job that could
+ *   never fit fails straight away.
+ * - Cost: new hashes use the current parameters (setParams()); each hash
+ *   records its own, so raising the cost keeps old hashes verifiable.
+ *
+ * Encoded hash: "$scrypt$ln=<logN>,r=<r>,p=<p>$<salt hex>$<key hex>".
+ * Callbacks run on the pool thread that finished the job.
+ */
+
+#ifndef PASSWORDHASHER_H
+#define PASSWORDHASHER_H
+
+#include <string>
+#include <deque>
+#include <vector>
+#include <functional>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include <cstddef>
+#include "Scrypt.h"
+
+using namespace std;
+
+namespace SOBS {
+namespace Utils {
+
+class PasswordHasher {
+public:
+    typedef function<void(bool ok, const string& encodedHash)> HashCallback;
+    typedef function<void(bool matched)> VerifyCallback;
+
+    static const size_t SALT_LENGTH = 16;
+    static const size_t KEY_LENGTH = 32;
+    static const size_t DEFAULT_QUEUE_CAPACITY = 256;
+    static const size_t DEFAULT_MEMORY_BUDGET = 64 * 1024 * 1024;
+    static const ScryptParams DEFAULT_PARAMS;  // ln=14, r=8, p=1: 16 MB per hash
+
+private:
+    struct Job {
+        string password;
+        string encodedHash;                     // Empty for a new hash
+        HashCallback hashDone;
+        VerifyCallback verifyDone;
+    };
+
+    mutable mutex lock;                         // Guards everything below
+    condition_variable jobReady;
+    condition_variable memoryFreed;
+    deque<Job> jobs;
+    size_t queueCapacity;
+    size_t memoryBudget;
+    size_t memoryInUse;
+    ScryptParams params;
+    bool stopping;
+    vector<thread> workers;
+
+    bool submit(Job&& job);
+    void workerLoop();
+    void run(Job& job);
+
+public:
+    /**
+     * workerCount 0 uses half the cores (at least one)
+     */
+    explicit PasswordHasher(size_t workerCount = 0,
+                            size_t queueCapacity = DEFAULT_QUEUE_CAPACITY,
+                            size_t memoryBudget = DEFAULT_MEMORY_BUDGET,
+                            const ScryptParams& params = DEFAULT_PARAMS);
+
+    /**
+     * Runs the jobs already queued, then stops the workers
+     */
+    ~PasswordHasher();
+
+    PasswordHasher(const PasswordHasher&) = delete;
+    PasswordHasher& operator=(const PasswordHasher&) = delete;
+
+    /**
+     * Queue a new hash of 'password'; 'done' gets the encoded hash.
+     * Returns false (and never calls 'done') if the queue is full.
+     */
+    bool submitHash(const string& password, HashCallback done);
+
+    /**
+     * Queue a check of 'password' against an encoded hash; a malformed
+     * hash does not match. Returns false (and never calls 'done') if the
+     * queue is full.
+     */
+    bool submitVerify(const string& password, const string& encodedHash, VerifyCallback done);
+
+    /**
+     * Future forms; an empty hash / false if the queue was full
+     */
+    future<string> hash(const string& password);
+    future<bool> verify(const string& password, const string& encodedHash);
+
+    /**
+     * Check on the calling thread, outside the pool and its budget
+     */
+    static bool verifyNow(const string& password, const string& encodedHash);
+
+    /**
+     * Cost of hashes created from now on; false if out of range or
+     * larger than the memory budget
+     */
+    bool setParams(const ScryptParams& params);
+    ScryptParams getParams() const;
+
+    size_t getQueuedCount() const;
+};
+
+} // namespace Utils
+} // namespace SOBS
+
+#endif // PASSWORDHASHER_H
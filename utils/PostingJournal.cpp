@@ -0,0 +1,652 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Utils: PostingJournal.cpp
+ *
+ * Implementation of the double-entry posting journal
+ */
+
+#include "PostingJournal.h"
+#include "IdGenerator.h"
+#include "Clock.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <iterator>
+
+using namespace std;
+
+namespace SOBS {
+namespace Utils {
+
+namespace {
+
+// Amount index key: CREDIT_KEY for credits, or'ed with the decade (0-19)
+const uint8_t CREDIT_KEY = 0x20;
+
+uint64_t magnitude(int64_t units) {
+    return units < 0 ? 0 - static_cast<uint64_t>(units) : static_cast<uint64_t>(units);
+}
+
+// Number of decimal digits of the magnitude (0 for zero)
+int decadeOf(uint64_t units) {
+    int decade = 0;
+    while (units > 0) {
+        units /= 10;
+        decade++;
+    }
+    return decade;
+}
+
+uint8_t amountKey(int64_t units) {
+    return static_cast<uint8_t>((units < 0 ? 0 : CREDIT_KEY) | decadeOf(magnitude(units)));
+}
+
+// Number of positions in [lo, hi)
+size_t countBetween(const vector<uint32_t>& positions, size_t lo, size_t hi) {
+    auto first = lower_bound(positions.begin(), positions.end(), lo);
+    auto last = lower_bound(first, positions.end(), hi);
+    return static_cast<size_t>(last - first);
+}
+
+// Words of a description: runs of ASCII letters and digits (lowercased)
+// or non-ASCII bytes, so UTF-8 text such as Arabic names stays whole
+template<typename F>
+void forEachWord(const string& text, F&& visit) {
+    string word;
+    for (size_t i = 0; i <= text.size(); i++) {
+        unsigned char c = i < text.size() ? static_cast<unsigned char>(text[i]) : ' ';
+        if (isalnum(c) || c >= 0x80) {
+            word += static_cast<char>(c < 0x80 ? tolower(c) : c);
+        } else if (!word.empty()) {
+            visit(word);
+            word.clear();
+        }
+    }
+}
+
+// Positions in [lo, hi) of 'positions', appended to 'out'
+void appendBetween(const vector<uint32_t>& positions, size_t lo, size_t hi,
+                   vector<uint32_t>& out) {
+    auto first = lower_bound(positions.begin(), positions.end(), lo);
+    auto last = lower_bound(first, positions.end(), hi);
+    out.insert(out.end(), first, last);
+}
+
+const size_t FILTER_BLOCK = 256;
+
+/**
+ * HistoryQuery reduced to integer compares. The accepted signed amounts
+ * are a credit range and a debit range, each tested with one unsigned
+ * compare: units - lo < span (span 0 accepts nothing). Block evaluation
+ * has no branches.
+ */
+struct CompiledFilter {
+    uint64_t creditLo;
+    uint64_t creditSpan;
+    uint64_t debitLo;
+    uint64_t debitSpan;
+    bool anyCategory;
+    uint8_t category;
+
+    CompiledFilter(const HistoryQuery& query, uint64_t minSize, uint64_t maxSize)
+        : creditLo(minSize), creditSpan(0), debitLo(0), debitSpan(0),
+          anyCategory(query.anyCategory), category(static_cast<uint8_t>(query.category)) {
+        if (query.credits) {
+            creditSpan = maxSize - minSize + 1;
+        }
+        // Zero counts as a credit
+        uint64_t debitMin = minSize > 0 ? minSize : 1;
+        if (query.debits && maxSize >= debitMin) {
+            debitLo = 0 - maxSize;
+            debitSpan = maxSize - debitMin + 1;
+        }
+    }
+
+    static uint64_t inRange(int64_t units, uint64_t lo, uint64_t span) {
+        return static_cast<uint64_t>(units) - lo < span;
+    }
+
+    bool matches(int64_t units, uint8_t rowCategory) const {
+        return (inRange(units, creditLo, creditSpan) | inRange(units, debitLo, debitSpan)) &&
+               (anyCategory || rowCategory == category);
+    }
+
+    void matchBlock(const int64_t* __restrict units, const uint8_t* __restrict rowCategories,
+                    size_t count, uint8_t* __restrict flags) const {
+        for (size_t i = 0; i < count; i++) {
+            flags[i] = static_cast<uint8_t>(inRange(units[i], creditLo, creditSpan) |
+                                            inRange(units[i], debitLo, debitSpan));
+        }
+        if (!anyCategory) {
+            for (size_t i = 0; i < count; i++) {
+                flags[i] &= static_cast<uint8_t>(rowCategories[i] == category);
+            }
+        }
+    }
+};
+
+} // namespace
+
+PostingJournal::PostingJournal(size_t shardCount)
+    : shardCount(shardCount == 0 ? 1 : shardCount),
+      shards(new Shard[shardCount == 0 ? 1 : shardCount]) {}
+
+PostingJournal::~PostingJournal() {}
+
+size_t PostingJournal::shardIndexOf(long accountId) const {
+    // Avalanche so sequential IDs spread evenly over the shards
+    uint64_t hash = static_cast<uint64_t>(accountId);
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return static_cast<size_t>(hash % shardCount);
+}
+
+PostingJournal::AccountJournal* PostingJournal::findAccount(long accountId) const {
+    const Shard& shard = shards[shardIndexOf(accountId)];
+    shared_lock<shared_mutex> lock(shard.lock);
+
+    auto it = shard.accounts.find(accountId);
+    if (it == shard.accounts.end()) return nullptr;
+
+    // Journals are never erased, so the pointer outlives the shard lock
+    return const_cast<AccountJournal*>(&it->second);
+}
+
+// ---------------------------------------------------------------------------
+// Accounts
+// ---------------------------------------------------------------------------
+
+bool PostingJournal::openAccount(long accountId, const Model::Money& openingBalance) {
+    Shard& shard = shards[shardIndexOf(accountId)];
+    unique_lock<shared_mutex> lock(shard.lock);
+
+    auto inserted = shard.accounts.try_emplace(accountId);
+    if (!inserted.second) {
+        return false;  // Already open
+    }
+    inserted.first->second.balance = openingBalance;
+    return true;
+}
+
+bool PostingJournal::hasAccount(long accountId) const {
+    return findAccount(accountId) != nullptr;
+}
+
+// ---------------------------------------------------------------------------
+// Secondary indexes
+// ---------------------------------------------------------------------------
+
+void PostingJournal::index(vector<PostingList>& lists, uint8_t key, uint32_t position) {
+    for (PostingList& list : lists) {
+        if (list.key == key) {
+            list.positions.push_back(position);
+            return;
+        }
+    }
+    lists.push_back(PostingList{key, vector<uint32_t>(1, position)});
+}
+
+const PostingJournal::PostingList* PostingJournal::findList(const vector<PostingList>& lists,
+                                                            uint8_t key) {
+    for (const PostingList& list : lists) {
+        if (list.key == key) return &list;
+    }
+    return nullptr;
+}
+
+void PostingJournal::indexWords(AccountJournal& account, const string& description,
+                                uint32_t position) {
+    forEachWord(description, [&](const string& word) {
+        auto it = account.words.find(word);
+        if (it == account.words.end()) {
+            it = account.words.emplace(word, vector<uint32_t>()).first;
+        }
+        // A word repeated in one description is indexed once
+        if (it->second.empty() || it->second.back() != position) {
+            it->second.push_back(position);
+        }
+    });
+}
+
+bool PostingJournal::matchWords(const AccountJournal& account, const string& term,
+                                size_t lo, size_t hi, vector<uint32_t>& positions) {
+    positions.clear();
+    vector<string> prefixes;
+    forEachWord(term, [&prefixes](const string& prefix) { prefixes.push_back(prefix); });
+    if (prefixes.empty()) return false;
+    if (lo >= hi) return true;
+
+    auto firstWord = [&account](const string& prefix) {
+        return account.words.lower_bound(prefix);
+    };
+    auto hasPrefix = [&account](map<string, vector<uint32_t>, less<>>::const_iterator it,
+                                const string& prefix) {
+        return it != account.words.end() && it->first.compare(0, prefix.size(), prefix) == 0;
+    };
+
+    for (const string& prefix : prefixes) {
+        if (!hasPrefix(firstWord(prefix), prefix)) return true;  // No word starts with it
+    }
+
+    // One prefix of one word: its list is the answer
+    auto it = firstWord(prefixes[0]);
+    if (prefixes.size() == 1 && !hasPrefix(next(it), prefixes[0])) {
+        appendBetween(it->second, lo, hi, positions);
+        return true;
+    }
+
+    // Otherwise OR the lists of each prefix into a bitmap over [lo, hi)
+    // and AND the prefixes' bitmaps together
+    size_t wordCount = (hi - lo + 63) / 64;
+    vector<uint64_t> matched;
+    vector<uint64_t> bits;
+    for (size_t p = 0; p < prefixes.size(); p++) {
+        bits.assign(wordCount, 0);
+        for (it = firstWord(prefixes[p]); hasPrefix(it, prefixes[p]); ++it) {
+            const vector<uint32_t>& list = it->second;
+            for (auto pos = lower_bound(list.begin(), list.end(), lo);
+                 pos != list.end() && *pos < hi; ++pos) {
+                size_t offset = *pos - lo;
+                bits[offset / 64] |= uint64_t(1) << (offset % 64);
+            }
+        }
+        if (p == 0) {
+            matched.swap(bits);
+        } else {
+            for (size_t w = 0; w < wordCount; w++) {
+                matched[w] &= bits[w];
+            }
+        }
+    }
+
+    for (size_t w = 0; w < wordCount; w++) {
+        for (uint64_t word = matched[w]; word != 0; word &= word - 1) {
+            positions.push_back(static_cast<uint32_t>(lo + w * 64 + __builtin_ctzll(word)));
+        }
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Appending
+// ---------------------------------------------------------------------------
+
+int64_t PostingJournal::append(const JournalLeg* legs, size_t count,
+                               Model::TransactionCategory category,
+                               const string& reference, const string& description,
+                               time_t postedAt, bool reversal) {
+    if (count < 2 || count > MAX_LEGS) return 0;
+
+    // Debits must equal credits, and every leg must read back as a
+    // positive DEBIT or CREDIT amount
+    Model::Money amounts[MAX_LEGS];
+    for (size_t i = 0; i < count; i++) {
+        amounts[i] = legs[i].amount;
+        Model::Money magnitude = legs[i].amount;
+        if (!magnitude.negate()) return 0;
+    }
+    Model::Money total;
+    if (!Model::Money::sum(amounts, count, total) || !total.isZero()) return 0;
+
+    // Resolve accounts and lock them in ascending ID order
+    size_t order[MAX_LEGS];
+    AccountJournal* accounts[MAX_LEGS];
+    for (size_t i = 0; i < count; i++) {
+        order[i] = i;
+        accounts[i] = findAccount(legs[i].accountId);
+        if (accounts[i] == nullptr) return 0;
+    }
+    sort(order, order + count, [legs](size_t a, size_t b) {
+        return legs[a].accountId < legs[b].accountId;
+    });
+    for (size_t i = 1; i < count; i++) {
+        if (legs[order[i]].accountId == legs[order[i - 1]].accountId) return 0;
+    }
+
+    unique_lock<mutex> locks[MAX_LEGS];
+    for (size_t i = 0; i < count; i++) {
+        locks[i] = unique_lock<mutex>(accounts[order[i]]->lock);
+    }
+
+    // Compute every running balance before touching any account
+    Model::Money balances[MAX_LEGS];
+    for (size_t i = 0; i < count; i++) {
+        balances[i] = accounts[i]->balance;
+        if (!balances[i].add(legs[i].amount)) return 0;
+    }
+
+    int64_t groupId = IdGenerator::next();
+    time_t now = postedAt != 0 ? postedAt : Clock::now();
+    for (size_t i = 0; i < count; i++) {
+        AccountJournal& account = *accounts[i];
+
+        // The wall clock can step back; an account's times never do, so
+        // date ranges can binary-search timeColumn
+        time_t stampedAt = now;
+        if (!account.timeColumn.empty() && account.timeColumn.back() > stampedAt) {
+            stampedAt = account.timeColumn.back();
+        }
+
+        JournalEntry entry;
+        entry.entryId = IdGenerator::next();
+        entry.groupId = groupId;
+        entry.accountId = legs[i].accountId;
+        entry.amount = legs[i].amount;
+        entry.balanceAfter = balances[i];
+        entry.postedAt = stampedAt;
+        entry.category = category;
+
+        uint32_t position = static_cast<uint32_t>(account.entries.size());
+        account.balance = balances[i];
+        account.entries.push_back(entry);
+        account.texts.push_back(EntryText{reference, description});
+        account.amountColumn.push_back(entry.amount.getMinorUnits());
+        account.timeColumn.push_back(stampedAt);
+        account.categoryColumn.push_back(static_cast<uint8_t>(category));
+        index(account.byCategory, static_cast<uint8_t>(category), position);
+        index(account.byAmount, amountKey(entry.amount.getMinorUnits()), position);
+        indexWords(account, description, position);
+        if (reversal) {
+            account.rollups.cancel(stampedAt, category, entry.amount.getMinorUnits());
+        } else {
+            account.rollups.add(stampedAt, category, entry.amount.getMinorUnits());
+        }
+    }
+    return groupId;
+}
+
+// ---------------------------------------------------------------------------
+// Reading
+// ---------------------------------------------------------------------------
+
+bool PostingJournal::getBalance(long accountId, Model::Money& balance) const {
+    AccountJournal* account = findAccount(accountId);
+    if (account == nullptr) return false;
+
+    lock_guard<mutex> lock(account->lock);
+    balance = account->balance;
+    return true;
+}
+
+bool PostingJournal::getBalanceAt(long accountId, time_t at, Model::Money& balance) const {
+    AccountJournal* account = findAccount(accountId);
+    if (account == nullptr) return false;
+
+    lock_guard<mutex> lock(account->lock);
+    const vector<time_t>& times = account->timeColumn;
+    size_t before = static_cast<size_t>(lower_bound(times.begin(), times.end(), at) -
+                                        times.begin());
+    if (before > 0) {
+        balance = account->entries[before - 1].balanceAfter;
+    } else if (!account->entries.empty()) {
+        // The opening balance: undo the first entry
+        balance = account->entries[0].balanceAfter;
+        balance.subtract(account->entries[0].amount);
+    } else {
+        balance = account->balance;
+    }
+    return true;
+}
+
+vector<JournalEntry> PostingJournal::getEntries(long accountId) const {
+    AccountJournal* account = findAccount(accountId);
+    if (account == nullptr) return vector<JournalEntry>();
+
+    lock_guard<mutex> lock(account->lock);
+    return account->entries;
+}
+
+vector<Model::Transaction> PostingJournal::getTransactions(long accountId) const {
+    vector<Model::Transaction> transactions;
+    AccountJournal* account = findAccount(accountId);
+    if (account == nullptr) return transactions;
+
+    vector<JournalEntry> entries;
+    vector<EntryText> texts;
+    {
+        lock_guard<mutex> lock(account->lock);
+        entries = account->entries;
+        texts = account->texts;
+    }
+
+    transactions.reserve(entries.size());
+    for (size_t i = 0; i < entries.size(); i++) {
+        const JournalEntry& entry = entries[i];
+        bool debit = entry.amount.isNegative();
+        Model::Money magnitude = entry.amount;
+        if (debit) magnitude.negate();      // append() refuses unnegatable legs
+
+        transactions.emplace_back(accountId,
+                                  debit ? Model::TransactionType::DEBIT :
+                                          Model::TransactionType::CREDIT,
+                                  magnitude, texts[i].description);
+        Model::Transaction& transaction = transactions.back();
+        transaction.setTransactionId(static_cast<long>(entry.entryId));
+        transaction.setTransactionRef(IdGenerator::formatRef("TXN", entry.entryId));
+        transaction.setCategory(entry.category);
+        transaction.setStatus(Model::TransactionStatus::COMPLETED);
+        transaction.setReferenceNumber(texts[i].reference);
+        transaction.setBalanceAfter(entry.balanceAfter);
+        transaction.setTransactionDate(entry.postedAt);
+    }
+    return transactions;
+}
+
+bool PostingJournal::queryHistory(long accountId, const HistoryQuery& query,
+                                  HistoryPage& page) const {
+    page.rows.clear();
+    page.hasMore = false;
+    page.nextCursor = HistoryQuery::NO_CURSOR;
+
+    AccountJournal* account = findAccount(accountId);
+    if (account == nullptr) return false;
+    uint64_t minSize = query.minUnits > 0 ? static_cast<uint64_t>(query.minUnits) : 0;
+    uint64_t maxSize = query.maxUnits > 0 ? static_cast<uint64_t>(query.maxUnits) : 0;
+    if (query.limit == 0 || (!query.debits && !query.credits) || minSize > maxSize) {
+        return true;
+    }
+
+    lock_guard<mutex> lock(account->lock);
+    const vector<JournalEntry>& entries = account->entries;
+    const vector<time_t>& times = account->timeColumn;
+
+    // Candidate positions are [lo, hi), newest first
+    size_t lo = 0;
+    size_t hi = entries.size();
+    if (query.from > 0) {
+        lo = static_cast<size_t>(lower_bound(times.begin(), times.end(), query.from) -
+                                 times.begin());
+    }
+    if (query.to > 0) {
+        hi = static_cast<size_t>(lower_bound(times.begin(), times.end(), query.to) -
+                                 times.begin());
+    }
+    if (query.before < hi) hi = query.before;
+    if (lo >= hi) return true;
+
+    // Read the smallest source: the range itself, the category list, the
+    // amount lists of the matching directions and decades or the entries
+    // matching the search term
+    vector<const vector<uint32_t>*> lists;
+    bool useLists = false;
+    size_t best = hi - lo;
+
+    if (!query.anyCategory) {
+        const PostingList* list = findList(account->byCategory,
+                                           static_cast<uint8_t>(query.category));
+        if (list == nullptr) return true;
+        size_t count = countBetween(list->positions, lo, hi);
+        if (count <= best) {
+            lists.assign(1, &list->positions);
+            useLists = true;
+            best = count;
+        }
+    }
+    if (minSize > 0 || query.maxUnits < INT64_MAX || !query.debits || !query.credits) {
+        int firstDecade = decadeOf(minSize);
+        int lastDecade = decadeOf(maxSize);
+        vector<const vector<uint32_t>*> amountLists;
+        size_t count = 0;
+        for (const PostingList& list : account->byAmount) {
+            bool credit = (list.key & CREDIT_KEY) != 0;
+            int decade = list.key & (CREDIT_KEY - 1);
+            if ((credit ? query.credits : query.debits) &&
+                decade >= firstDecade && decade <= lastDecade) {
+                amountLists.push_back(&list.positions);
+                count += countBetween(list.positions, lo, hi);
+            }
+        }
+        if (count < best) {
+            lists.swap(amountLists);
+            useLists = true;
+            best = count;
+        }
+    }
+
+    // Entries whose descriptions match the search term, ascending
+    vector<uint32_t> textMatches;
+    bool searching = matchWords(*account, query.searchTerm, lo, hi, textMatches);
+    if (searching && textMatches.size() < best) {
+        lists.assign(1, &textMatches);
+        useLists = true;
+        best = textMatches.size();
+    }
+    if (best == 0) return true;
+
+    CompiledFilter filter(query, minSize, maxSize);
+    const int64_t* amounts = account->amountColumn.data();
+    const uint8_t* categories = account->categoryColumn.data();
+
+    // Rows passing the compiled filter still need the text match; returns
+    // false once the page is full
+    auto offer = [&](size_t position) {
+        if (searching && !binary_search(textMatches.begin(), textMatches.end(),
+                                        static_cast<uint32_t>(position))) {
+            return true;
+        }
+        const EntryText& text = account->texts[position];
+        if (page.rows.size() == query.limit) {
+            page.hasMore = true;
+            page.nextCursor = page.rows.back().position;
+            return false;
+        }
+        page.rows.push_back(HistoryRow{position, entries[position],
+                                       text.reference, text.description});
+        return true;
+    };
+
+    if (!useLists) {
+        // Filter whole blocks of the columns, newest block first
+        uint8_t flags[FILTER_BLOCK];
+        size_t blockEnd = hi;
+        while (blockEnd > lo) {
+            size_t blockStart = blockEnd - lo > FILTER_BLOCK ? blockEnd - FILTER_BLOCK : lo;
+            size_t count = blockEnd - blockStart;
+            filter.matchBlock(amounts + blockStart, categories + blockStart, count, flags);
+            for (size_t i = count; i-- > 0;) {
+                if (i >= 7) {
+                    // Skip eight rejected rows at a time
+                    uint64_t word;
+                    memcpy(&word, flags + i - 7, sizeof(word));
+                    if (word == 0) {
+                        i -= 7;
+                        continue;
+                    }
+                }
+                if (flags[i] && !offer(blockStart + i)) return true;
+            }
+            blockEnd = blockStart;
+        }
+        return true;
+    }
+
+    // Cursor into each list: one past the newest candidate
+    vector<size_t> next(lists.size());
+    for (size_t i = 0; i < lists.size(); i++) {
+        next[i] = static_cast<size_t>(lower_bound(lists[i]->begin(), lists[i]->end(), hi) -
+                                      lists[i]->begin());
+    }
+
+    while (true) {
+        size_t newest = lists.size();
+        for (size_t i = 0; i < lists.size(); i++) {
+            if (next[i] > 0 && (*lists[i])[next[i] - 1] >= lo &&
+                (newest == lists.size() ||
+                 (*lists[i])[next[i] - 1] > (*lists[newest])[next[newest] - 1])) {
+                newest = i;
+            }
+        }
+        if (newest == lists.size()) return true;
+
+        size_t position = (*lists[newest])[--next[newest]];
+        if (filter.matches(amounts[position], categories[position]) && !offer(position)) {
+            return true;
+        }
+    }
+}
+
+bool PostingJournal::scan(long accountId, time_t from, time_t to,
+                          const EntryVisitor& visitor) const {
+    AccountJournal* account = findAccount(accountId);
+    if (account == nullptr) return false;
+
+    // Chunk buffers are reused, so string capacity is only grown once
+    vector<JournalEntry> entries;
+    vector<EntryText> texts(SCAN_CHUNK);
+    entries.reserve(SCAN_CHUNK);
+
+    size_t next;
+    {
+        // Entries are appended in posting order, so postedAt never decreases
+        lock_guard<mutex> lock(account->lock);
+        const vector<time_t>& times = account->timeColumn;
+        next = static_cast<size_t>(lower_bound(times.begin(), times.end(), from) -
+                                   times.begin());
+    }
+
+    while (true) {
+        entries.clear();
+        {
+            lock_guard<mutex> lock(account->lock);
+            size_t end = min(account->entries.size(), next + SCAN_CHUNK);
+            for (size_t i = next; i < end && account->entries[i].postedAt < to; i++) {
+                texts[entries.size()].reference = account->texts[i].reference;
+                texts[entries.size()].description = account->texts[i].description;
+                entries.push_back(account->entries[i]);
+            }
+        }
+        if (entries.empty()) return true;
+
+        for (size_t i = 0; i < entries.size(); i++) {
+            if (!visitor(entries[i], texts[i].reference, texts[i].description)) return true;
+        }
+        if (entries.size() < SCAN_CHUNK) return true;
+        next += SCAN_CHUNK;
+    }
+}
+
+bool PostingJournal::readRollups(long accountId,
+                                 const function<void(const SpendingRollups&)>& reader) const {
+    AccountJournal* account = findAccount(accountId);
+    if (account == nullptr) return false;
+
+    lock_guard<mutex> lock(account->lock);
+    reader(account->rollups);
+    return true;
+}
+
+size_t PostingJournal::getEntryCount() const {
+    size_t total = 0;
+    for (size_t i = 0; i < shardCount; i++) {
+        shared_lock<shared_mutex> shardLock(shards[i].lock);
+        for (const auto& account : shards[i].accounts) {
+            lock_guard<mutex> lock(account.second.lock);
+            total += account.second.entries.size();
+        }
+    }
+    return total;
+}
+
+} // namespace Utils
+} // namespace SOBS
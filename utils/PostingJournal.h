@@ -0,0 +1,254 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Utils: PostingJournal.h
+ *
+ * Append-only double-entry journal behind Transaction history.
+ *
+ * Every transfer or bill payment is appended as one group of legs whose
+ * amounts sum to zero (debits == credits); unbalanced groups are refused.
+ * Each account keeps its entries in one contiguous vector in posting
+ * order, with the running balance stored on every entry and posting
+ * times that never decrease (a clock step back reuses the last time), so reading an
+ * account's history is a sequential scan of a single array. Entry text
+ * (reference, description) sits in a parallel vector that balance scans
+ * never touch.
+ *
+ * Accounts are sharded by account ID; a shard's reader/writer lock only
+ * guards which accounts exist and each account has its own mutex. A group
+ * locks its accounts in ascending ID order.
+ *
+ * Each account also keeps secondary indexes: ascending position lists
+ * per category and per (direction, amount decade). queryHistory() pages
+ * newest-first with a keyset cursor (the position of the last row
+ * returned), reading whichever index or date range is smallest, so a
+ * later page costs the same as the first. Amount, time and category are
+ * also kept as columns; the query's filter is compiled once into integer
+ * range checks that run over those columns a block at a time.
+ *
+ * Descriptions are indexed as they are appended: a sorted map from each
+ * lowercased word to its positions. A search term matches entries that
+ * have, for every word of the term, a word starting with it ("netf"
+ * finds "Netflix", "mohamed ali" finds "Transfer to Mohamed Ali").
+ *
+ * scan() walks a date range of one account in chunks of SCAN_CHUNK
+ * entries, copying each chunk under the account lock and visiting it
+ * with the lock released, so statement generation needs constant memory
+ * and never holds up postings for long.
+ */
+
+#ifndef POSTINGJOURNAL_H
+#define POSTINGJOURNAL_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <map>
+#include <shared_mutex>
+#include <mutex>
+#include <memory>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+#include <climits>
+#include <ctime>
+#include "../model/Money.h"
+#include "../model/Transaction.h"
+#include "SpendingRollups.h"
+
+using namespace std;
+
+namespace SOBS {
+namespace Utils {
+
+/**
+ * One leg of a journal group, as seen from the account:
+ * negative amounts are debits, positive amounts are credits.
+ */
+struct JournalLeg {
+    long accountId;
+    Model::Money amount;
+};
+
+/**
+ * A journal entry as stored
+ */
+struct JournalEntry {
+    int64_t entryId;                    // Time-ordered, from IdGenerator
+    int64_t groupId;                    // Shared by every leg of one group
+    long accountId;
+    Model::Money amount;                // Signed, as in JournalLeg
+    Model::Money balanceAfter;          // Running balance of the account
+    time_t postedAt;
+    Model::TransactionCategory category;
+};
+
+/**
+ * Filter and cursor for PostingJournal::queryHistory(). Amount bounds
+ * apply to the magnitude of the entry, in minor units.
+ */
+struct HistoryQuery {
+    static const size_t NO_CURSOR = SIZE_MAX;
+
+    time_t from = 0;                    // Inclusive
+    time_t to = 0;                      // Exclusive; 0 for no upper bound
+    bool debits = true;
+    bool credits = true;
+    bool anyCategory = true;
+    Model::TransactionCategory category = Model::TransactionCategory::TRANSFER;
+    int64_t minUnits = 0;
+    int64_t maxUnits = INT64_MAX;
+    string searchTerm;                  // Description word prefixes, all must match
+    size_t before = NO_CURSOR;          // Only entries at positions below this
+    size_t limit = 20;
+};
+
+struct HistoryRow {
+    size_t position;                    // In the account's journal
+    JournalEntry entry;
+    string reference;
+    string description;
+};
+
+struct HistoryPage {
+    vector<HistoryRow> rows;            // Newest first
+    bool hasMore;
+    size_t nextCursor;                  // 'before' for the next page, if hasMore
+};
+
+class PostingJournal {
+private:
+    struct EntryText {
+        string reference;               // e.g. the TRF/BILL ref of the group
+        string description;
+    };
+
+    // Positions of one index key, ascending
+    struct PostingList {
+        uint8_t key;
+        vector<uint32_t> positions;
+    };
+
+    struct AccountJournal {
+        mutable mutex lock;             // Guards everything below
+        Model::Money balance;
+        vector<JournalEntry> entries;
+        vector<EntryText> texts;        // Parallel to entries
+        vector<int64_t> amountColumn;   // Columns of entries for filtering:
+        vector<time_t> timeColumn;      // amount in minor units, postedAt
+        vector<uint8_t> categoryColumn; // and category
+        vector<PostingList> byCategory; // Only keys in use, a handful each
+        vector<PostingList> byAmount;   // Key: direction and amount decade
+        map<string, vector<uint32_t>, less<>> words;  // Description word -> positions
+        SpendingRollups rollups;        // Per-day / per-month category totals
+    };
+
+    struct alignas(64) Shard {
+        mutable shared_mutex lock;
+        unordered_map<long, AccountJournal> accounts;
+    };
+
+    size_t shardCount;
+    unique_ptr<Shard[]> shards;
+
+    size_t shardIndexOf(long accountId) const;
+    AccountJournal* findAccount(long accountId) const;
+
+    static void index(vector<PostingList>& lists, uint8_t key, uint32_t position);
+    static const PostingList* findList(const vector<PostingList>& lists, uint8_t key);
+    static void indexWords(AccountJournal& account, const string& description,
+                           uint32_t position);
+    static bool matchWords(const AccountJournal& account, const string& term,
+                           size_t lo, size_t hi, vector<uint32_t>& positions);
+
+public:
+    static const size_t DEFAULT_SHARD_COUNT = 64;
+    static const size_t MAX_LEGS = 16;
+    static const size_t SCAN_CHUNK = 256;
+
+    /**
+     * Called by scan() for each entry with the group's reference and
+     * description; returning false stops the scan
+     */
+    typedef function<bool(const JournalEntry& entry, const string& reference,
+                          const string& description)> EntryVisitor;
+
+    explicit PostingJournal(size_t shardCount = DEFAULT_SHARD_COUNT);
+    ~PostingJournal();
+
+    PostingJournal(const PostingJournal&) = delete;
+    PostingJournal& operator=(const PostingJournal&) = delete;
+
+    /**
+     * Start an account's journal at 'openingBalance'.
+     * Returns false if the account already has a journal.
+     */
+    bool openAccount(long accountId, const Model::Money& openingBalance);
+
+    bool hasAccount(long accountId) const;
+
+    /**
+     * Append a balanced group of 2..MAX_LEGS legs on distinct, opened
+     * accounts, posted at 'postedAt' (0 = now). Returns the group ID, or 0
+     * if the legs do not sum to zero, an account is unknown or a running
+     * balance would overflow. A reversal group takes the group it undoes
+     * back out of the spending rollups instead of counting as new
+     * spending and income.
+     */
+    int64_t append(const JournalLeg* legs, size_t count,
+                   Model::TransactionCategory category,
+                   const string& reference, const string& description,
+                   time_t postedAt = 0, bool reversal = false);
+
+    /**
+     * Current journal balance of an account
+     */
+    bool getBalance(long accountId, Model::Money& balance) const;
+
+    /**
+     * Balance of an account just before 'at': after every entry posted
+     * earlier, or the opening balance if there is none
+     */
+    bool getBalanceAt(long accountId, time_t at, Model::Money& balance) const;
+
+    /**
+     * Copy of an account's entries in posting order
+     */
+    vector<JournalEntry> getEntries(long accountId) const;
+
+    /**
+     * An account's history as DEBIT/CREDIT transactions in posting order.
+     * The reference number of each transaction is the group's reference,
+     * so both sides of a transfer carry the transfer ref.
+     */
+    vector<Model::Transaction> getTransactions(long accountId) const;
+
+    /**
+     * One page of an account's entries matching 'query', newest first.
+     * Returns false if the account has no journal.
+     */
+    bool queryHistory(long accountId, const HistoryQuery& query, HistoryPage& page) const;
+
+    /**
+     * Visit an account's entries posted in [from, to) in posting order.
+     * Returns false if the account has no journal.
+     */
+    bool scan(long accountId, time_t from, time_t to, const EntryVisitor& visitor) const;
+
+    /**
+     * Run 'reader' on an account's spending rollups under the account
+     * lock, so it must not call back into the journal. Returns false if
+     * the account has no journal.
+     */
+    bool readRollups(long accountId,
+                     const function<void(const SpendingRollups&)>& reader) const;
+
+    /**
+     * Number of entries across all accounts
+     */
+    size_t getEntryCount() const;
+};
+
+} // namespace Utils
+} // namespace SOBS
+
+#endif // POSTINGJOURNAL_H
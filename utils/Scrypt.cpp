@@ -0,0 +1,307 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Utils: Scrypt.cpp
+ *
+ * Implementation of scrypt (RFC 7914) with its SHA-256, HMAC and PBKDF2
+ * building blocks (FIPS 180-4, RFC 2104, RFC 8018)
+ */
+
+#include "Scrypt.h"
+#include <vector>
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+namespace SOBS {
+namespace Utils {
+
+namespace {
+
+// ---------------------------------------------------------------------------
+// SHA-256
+// ---------------------------------------------------------------------------
+
+const uint32_t SHA256_ROUND_CONSTANTS[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+inline uint32_t rotateRight(uint32_t value, int bits) {
+    return (value >> bits) | (value << (32 - bits));
+}
+
+inline uint32_t rotateLeft(uint32_t value, int bits) {
+    return (value << bits) | (value >> (32 - bits));
+}
+
+inline uint32_t loadBigEndian(const uint8_t* in) {
+    return (uint32_t(in[0]) << 24) | (uint32_t(in[1]) << 16) |
+           (uint32_t(in[2]) << 8) | uint32_t(in[3]);
+}
+
+inline void storeBigEndian(uint8_t* out, uint32_t value) {
+    out[0] = static_cast<uint8_t>(value >> 24);
+    out[1] = static_cast<uint8_t>(value >> 16);
+    out[2] = static_cast<uint8_t>(value >> 8);
+    out[3] = static_cast<uint8_t>(value);
+}
+
+inline uint32_t loadLittleEndian(const uint8_t* in) {
+    return uint32_t(in[0]) | (uint32_t(in[1]) << 8) |
+           (uint32_t(in[2]) << 16) | (uint32_t(in[3]) << 24);
+}
+
+inline void storeLittleEndian(uint8_t* out, uint32_t value) {
+    out[0] = static_cast<uint8_t>(value);
+    out[1] = static_cast<uint8_t>(value >> 8);
+    out[2] = static_cast<uint8_t>(value >> 16);
+    out[3] = static_cast<uint8_t>(value >> 24);
+}
+
+class Sha256 {
+private:
+    uint32_t state[8];
+    uint8_t block[64];
+    size_t blockUsed;
+    uint64_t totalBytes;
+
+    void compress(const uint8_t* data) {
+        uint32_t w[64];
+        for (int i = 0; i < 16; i++) {
+            w[i] = loadBigEndian(data + 4 * i);
+        }
+        for (int i = 16; i < 64; i++) {
+            uint32_t s0 = rotateRight(w[i - 15], 7) ^ rotateRight(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = rotateRight(w[i - 2], 17) ^ rotateRight(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int i = 0; i < 64; i++) {
+            uint32_t s1 = rotateRight(e, 6) ^ rotateRight(e, 11) ^ rotateRight(e, 25);
+            uint32_t choice = (e & f) ^ (~e & g);
+            uint32_t t1 = h + s1 + choice + SHA256_ROUND_CONSTANTS[i] + w[i];
+            uint32_t s0 = rotateRight(a, 2) ^ rotateRight(a, 13) ^ rotateRight(a, 22);
+            uint32_t majority = (a & b) ^ (a & c) ^ (b & c);
+            uint32_t t2 = s0 + majority;
+            h = g; g = f; f = e; e = d + t1;
+            d = c; c = b; b = a; a = t1 + t2;
+        }
+        state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+        state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+    }
+
+public:
+    static const size_t DIGEST_LENGTH = 32;
+    static const size_t BLOCK_LENGTH = 64;
+
+    Sha256() : state{0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                     0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19},
+               block(), blockUsed(0), totalBytes(0) {}
+
+    void update(const uint8_t* data, size_t length) {
+        totalBytes += length;
+        if (blockUsed > 0) {
+            size_t take = min(length, BLOCK_LENGTH - blockUsed);
+            memcpy(block + blockUsed, data, take);
+            blockUsed += take;
+            data += take;
+            length -= take;
+            if (blockUsed < BLOCK_LENGTH) return;
+            compress(block);
+            blockUsed = 0;
+        }
+        for (; length >= BLOCK_LENGTH; data += BLOCK_LENGTH, length -= BLOCK_LENGTH) {
+            compress(data);
+        }
+        memcpy(block, data, length);
+        blockUsed = length;
+    }
+
+    void finish(uint8_t* digest) {
+        uint64_t totalBits = totalBytes * 8;
+        uint8_t padding[BLOCK_LENGTH * 2] = {0x80};
+        size_t padLength = (blockUsed < 56 ? 56 : 120) - blockUsed;
+        for (int i = 0; i < 8; i++) {
+            padding[padLength + i] = static_cast<uint8_t>(totalBits >> (56 - 8 * i));
+        }
+        update(padding, padLength + 8);
+        for (int i = 0; i < 8; i++) {
+            storeBigEndian(digest + 4 * i, state[i]);
+        }
+    }
+};
+
+// HMAC-SHA256 with the key's inner and outer states computed once
+class HmacSha256 {
+private:
+    Sha256 inner;
+    Sha256 outer;
+
+public:
+    explicit HmacSha256(const string& key) {
+        uint8_t keyBlock[Sha256::BLOCK_LENGTH] = {};
+        if (key.size() > Sha256::BLOCK_LENGTH) {
+            Sha256 keyHash;
+            keyHash.update(reinterpret_cast<const uint8_t*>(key.data()), key.size());
+            keyHash.finish(keyBlock);
+        } else {
+            memcpy(keyBlock, key.data(), key.size());
+        }
+
+        uint8_t pad[Sha256::BLOCK_LENGTH];
+        for (size_t i = 0; i < Sha256::BLOCK_LENGTH; i++) pad[i] = keyBlock[i] ^ 0x36;
+        inner.update(pad, sizeof(pad));
+        for (size_t i = 0; i < Sha256::BLOCK_LENGTH; i++) pad[i] = keyBlock[i] ^ 0x5c;
+        outer.update(pad, sizeof(pad));
+    }
+
+    // MAC of message || suffix
+    void mac(const uint8_t* message, size_t length, const uint8_t* suffix, size_t suffixLength,
+             uint8_t* out) const {
+        Sha256 innerHash = inner;
+        innerHash.update(message, length);
+        innerHash.update(suffix, suffixLength);
+        uint8_t innerDigest[Sha256::DIGEST_LENGTH];
+        innerHash.finish(innerDigest);
+
+        Sha256 outerHash = outer;
+        outerHash.update(innerDigest, sizeof(innerDigest));
+        outerHash.finish(out);
+    }
+};
+
+// PBKDF2-HMAC-SHA256 with one iteration, as scrypt uses it
+void pbkdf2(const HmacSha256& hmac, const uint8_t* salt, size_t saltLength,
+            uint8_t* out, size_t outLength) {
+    uint8_t blockIndex[4];
+    uint8_t digest[Sha256::DIGEST_LENGTH];
+    for (uint32_t i = 1; outLength > 0; i++) {
+        storeBigEndian(blockIndex, i);
+        hmac.mac(salt, saltLength, blockIndex, sizeof(blockIndex), digest);
+        size_t take = min(outLength, sizeof(digest));
+        memcpy(out, digest, take);
+        out += take;
+        outLength -= take;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// ROMix
+// ---------------------------------------------------------------------------
+
+// Salsa20/8 core on 16 words, in place
+void salsa208(uint32_t* block) {
+    uint32_t x[16];
+    memcpy(x, block, sizeof(x));
+    for (int round = 0; round < 8; round += 2) {
+        // Columns
+        x[ 4] ^= rotateLeft(x[ 0] + x[12],  7);  x[ 8] ^= rotateLeft(x[ 4] + x[ 0],  9);
+        x[12] ^= rotateLeft(x[ 8] + x[ 4], 13);  x[ 0] ^= rotateLeft(x[12] + x[ 8], 18);
+        x[ 9] ^= rotateLeft(x[ 5] + x[ 1],  7);  x[13] ^= rotateLeft(x[ 9] + x[ 5],  9);
+        x[ 1] ^= rotateLeft(x[13] + x[ 9], 13);  x[ 5] ^= rotateLeft(x[ 1] + x[13], 18);
+        x[14] ^= rotateLeft(x[10] + x[ 6],  7);  x[ 2] ^= rotateLeft(x[14] + x[10],  9);
+        x[ 6] ^= rotateLeft(x[ 2] + x[14], 13);  x[10] ^= rotateLeft(x[ 6] + x[ 2], 18);
+        x[ 3] ^= rotateLeft(x[15] + x[11],  7);  x[ 7] ^= rotateLeft(x[ 3] + x[15],  9);
+        x[11] ^= rotateLeft(x[ 7] + x[ 3], 13);  x[15] ^= rotateLeft(x[11] + x[ 7], 18);
+        // Rows
+        x[ 1] ^= rotateLeft(x[ 0] + x[ 3],  7);  x[ 2] ^= rotateLeft(x[ 1] + x[ 0],  9);
+        x[ 3] ^= rotateLeft(x[ 2] + x[ 1], 13);  x[ 0] ^= rotateLeft(x[ 3] + x[ 2], 18);
+        x[ 6] ^= rotateLeft(x[ 5] + x[ 4],  7);  x[ 7] ^= rotateLeft(x[ 6] + x[ 5],  9);
+        x[ 4] ^= rotateLeft(x[ 7] + x[ 6], 13);  x[ 5] ^= rotateLeft(x[ 4] + x[ 7], 18);
+        x[11] ^= rotateLeft(x[10] + x[ 9],  7);  x[ 8] ^= rotateLeft(x[11] + x[10],  9);
+        x[ 9] ^= rotateLeft(x[ 8] + x[11], 13);  x[10] ^= rotateLeft(x[ 9] + x[ 8], 18);
+        x[12] ^= rotateLeft(x[15] + x[14],  7);  x[13] ^= rotateLeft(x[12] + x[15],  9);
+        x[14] ^= rotateLeft(x[13] + x[12], 13);  x[15] ^= rotateLeft(x[14] + x[13], 18);
+    }
+    for (int i = 0; i < 16; i++) {
+        block[i] += x[i];
+    }
+}
+
+// BlockMix over 2r 64-byte blocks: 'in' -> 'out', even outputs first
+void blockMix(const uint32_t* in, uint32_t* out, uint32_t r) {
+    uint32_t x[16];
+    memcpy(x, in + (2 * r - 1) * 16, sizeof(x));
+    for (uint32_t i = 0; i < 2 * r; i++) {
+        for (int k = 0; k < 16; k++) x[k] ^= in[i * 16 + k];
+        salsa208(x);
+        memcpy(out + ((i & 1) * r + i / 2) * 16, x, sizeof(x));
+    }
+}
+
+// ROMix on one lane of 128 * r bytes; 'table' holds N lanes, 'work' two
+void roMix(uint8_t* lane, uint32_t r, uint32_t n, uint32_t* table, uint32_t* work) {
+    const size_t words = 32 * size_t(r);
+    uint32_t* x = work;
+    uint32_t* y = work + words;
+    for (size_t i = 0; i < words; i++) {
+        x[i] = loadLittleEndian(lane + 4 * i);
+    }
+
+    for (uint32_t i = 0; i < n; i++) {
+        memcpy(table + i * words, x, words * sizeof(uint32_t));
+        blockMix(x, y, r);
+        swap(x, y);
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        // Integerify: first word of the last 64-byte block (N <= 2^32)
+        const uint32_t* entry = table + (x[(2 * r - 1) * 16] & (n - 1)) * words;
+        for (size_t k = 0; k < words; k++) x[k] ^= entry[k];
+        blockMix(x, y, r);
+        swap(x, y);
+    }
+
+    for (size_t i = 0; i < words; i++) {
+        storeLittleEndian(lane + 4 * i, x[i]);
+    }
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// scrypt
+// ---------------------------------------------------------------------------
+
+bool Scrypt::validParams(const ScryptParams& params) {
+    return params.logN >= 1 && params.logN <= MAX_LOG_N &&
+           params.r >= 1 && params.r <= MAX_R &&
+           params.p >= 1 && params.p <= MAX_P;
+}
+
+size_t Scrypt::memoryBytes(const ScryptParams& params) {
+    size_t laneBytes = 128 * size_t(params.r);
+    return (size_t(1) << params.logN) * laneBytes + 2 * laneBytes + params.p * laneBytes;
+}
+
+bool Scrypt::derive(const string& password, const uint8_t* salt, size_t saltLength,
+                    const ScryptParams& params, uint8_t* out, size_t outLength) {
+    if (!validParams(params) || outLength == 0) return false;
+
+    const uint32_t n = uint32_t(1) << params.logN;
+    const size_t laneBytes = 128 * size_t(params.r);
+    HmacSha256 hmac(password);
+
+    vector<uint8_t> lanes(params.p * laneBytes);
+    pbkdf2(hmac, salt, saltLength, lanes.data(), lanes.size());
+
+    vector<uint32_t> table(size_t(n) * laneBytes / 4);
+    vector<uint32_t> work(2 * laneBytes / 4);
+    for (uint32_t lane = 0; lane < params.p; lane++) {
+        roMix(lanes.data() + lane * laneBytes, params.r, n, table.data(), work.data());
+    }
+
+    pbkdf2(hmac, lanes.data(), lanes.size(), out, outLength);
+    return true;
+}
+
+} // namespace Utils
+} // namespace SOBS
@@ -0,0 +1,60 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Utils: Scrypt.h
+ *
+ * scrypt password-based key derivation (RFC 7914): PBKDF2-HMAC-SHA256
+ * around ROMix, whose table of N blocks of 128 * r bytes makes every
+ * guess cost memory as well as time. The p lanes run one after another,
+ * so a derivation holds one table at a time.
+ *
+ * Pure function, no shared state; PasswordHasher runs it off the request
+ * threads.
+ */
+
+#ifndef SCRYPT_H
+#define SCRYPT_H
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+using namespace std;
+
+namespace SOBS {
+namespace Utils {
+
+struct ScryptParams {
+    uint32_t logN;      // Cost: N = 2^logN table entries
+    uint32_t r;         // Block size: 128 * r bytes
+    uint32_t p;         // Lanes
+};
+
+class Scrypt {
+public:
+    // Largest accepted values; beyond them a stored hash is treated as corrupt
+    static const uint32_t MAX_LOG_N = 24;
+    static const uint32_t MAX_R = 32;
+    static const uint32_t MAX_P = 16;
+
+    /**
+     * Parameters within the limits above
+     */
+    static bool validParams(const ScryptParams& params);
+
+    /**
+     * Memory one derivation allocates with these parameters
+     */
+    static size_t memoryBytes(const ScryptParams& params);
+
+    /**
+     * Derive 'outLength' bytes into 'out'. Returns false for invalid
+     * parameters or an output longer than PBKDF2 allows.
+     */
+    static bool derive(const string& password, const uint8_t* salt, size_t saltLength,
+                       const ScryptParams& params, uint8_t* out, size_t outLength);
+};
+
+} // namespace Utils
+} // namespace SOBS
+
+#endif // SCRYPT_H
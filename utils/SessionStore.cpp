@@ -0,0 +1,463 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Utils: SessionStore.cpp
+ *
+ * Implementation of the session store
+ */
+
+#include "SessionStore.h"
+#include <sys/random.h>
+#include <algorithm>
+#include <chrono>
+
+using namespace std;
+
+namespace SOBS {
+namespace Utils {
+
+namespace {
+
+const char HEX_DIGITS[] = "0123456789abcdef";
+
+bool randomBytes(void* out, size_t length) {
+    return getrandom(out, length, 0) == static_cast<ssize_t>(length);
+}
+
+size_t roundUpToPowerOfTwo(size_t n) {
+    size_t power = 1;
+    while (power < n) power <<= 1;
+    return power;
+}
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Bucket sequence counter around a chain change
+uint32_t beginWrite(atomic<uint32_t>& sequence) {
+    uint32_t value = sequence.load(memory_order_relaxed);
+    sequence.store(value + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    return value;
+}
+
+void endWrite(atomic<uint32_t>& sequence, uint32_t value) {
+    sequence.store(value + 2, memory_order_release);
+}
+
+} // namespace
+
+SessionStore::Session::Session()
+    : userId(0), expiresAt(0), next(NONE),
+      userPrev(NONE), userNext(NONE), wheelPrev(NONE), wheelNext(NONE), wheelSlot(0) {
+    key[0].store(0, memory_order_relaxed);
+    key[1].store(0, memory_order_relaxed);
+}
+
+SessionStore::Shard::Shard()
+    : nextIndex(1), freeHead(NONE), sessionCount(0), wheelCounts(), wheelTime(0) {
+    for (size_t i = 0; i < MAX_CHUNKS; i++) {
+        chunks[i].store(nullptr, memory_order_relaxed);
+    }
+    for (size_t i = 0; i < WHEEL_LEVELS * WHEEL_SIZE; i++) {
+        wheel[i] = NONE;
+    }
+}
+
+SessionStore::Shard::~Shard() {
+    for (size_t i = 0; i < MAX_CHUNKS; i++) {
+        delete[] chunks[i].load(memory_order_relaxed);
+    }
+}
+
+SessionStore::SessionStore(size_t shardCount, size_t bucketsPerShard)
+    : shardMask(roundUpToPowerOfTwo(shardCount == 0 ? 1 : shardCount) - 1),
+      bucketMask(roundUpToPowerOfTwo(bucketsPerShard == 0 ? 1 : bucketsPerShard) - 1),
+      hashSeed(0), shards(new Shard[shardMask + 1]) {
+    if (!randomBytes(&hashSeed, sizeof(hashSeed))) {
+        hashSeed = static_cast<uint64_t>(
+            chrono::steady_clock::now().time_since_epoch().count());
+    }
+    for (size_t i = 0; i <= shardMask; i++) {
+        shards[i].buckets.reset(new Bucket[bucketMask + 1]);
+        for (size_t b = 0; b <= bucketMask; b++) {
+            shards[i].buckets[b].sequence.store(0, memory_order_relaxed);
+            shards[i].buckets[b].head.store(NONE, memory_order_relaxed);
+        }
+    }
+}
+
+SessionStore::~SessionStore() {}
+
+size_t SessionStore::shardIndexOf(long userId) const {
+    // Avalanche so sequential IDs spread evenly over the shards
+    uint64_t hash = static_cast<uint64_t>(userId);
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return static_cast<size_t>(hash & shardMask);
+}
+
+size_t SessionStore::bucketIndexOf(uint64_t key0) const {
+    // Seeded so that chosen tokens cannot all land in one bucket
+    uint64_t hash = (key0 ^ hashSeed) * 0x9e3779b97f4a7c15ULL;
+    hash ^= hash >> 32;
+    return static_cast<size_t>(hash & bucketMask);
+}
+
+SessionStore::Session& SessionStore::record(const Shard& shard, uint32_t index) {
+    Session* chunk = shard.chunks[index >> CHUNK_BITS].load(memory_order_acquire);
+    return chunk[index & ((size_t(1) << CHUNK_BITS) - 1)];
+}
+
+// ---------------------------------------------------------------------------
+// Tokens
+// ---------------------------------------------------------------------------
+
+bool SessionStore::parseToken(const string& token, uint64_t& key0, uint64_t& key1) {
+    if (token.size() != TOKEN_LENGTH) return false;
+    uint64_t words[2] = {0, 0};
+    for (size_t i = 0; i < TOKEN_LENGTH; i++) {
+        int digit = hexValue(token[i]);
+        if (digit < 0) return false;
+        words[i / 16] = (words[i / 16] << 4) | static_cast<uint64_t>(digit);
+    }
+    key0 = words[0];
+    key1 = words[1];
+    return true;
+}
+
+string SessionStore::formatToken(uint64_t key0, uint64_t key1) {
+    string token(TOKEN_LENGTH, '0');
+    const uint64_t words[2] = {key0, key1};
+    for (size_t i = 0; i < TOKEN_LENGTH; i++) {
+        token[i] = HEX_DIGITS[(words[i / 16] >> (60 - 4 * (i % 16))) & 0xf];
+    }
+    return token;
+}
+
+// ---------------------------------------------------------------------------
+// Records (shard lock held)
+// ---------------------------------------------------------------------------
+
+uint32_t SessionStore::allocate(Shard& shard) {
+    if (shard.freeHead != NONE) {
+        uint32_t index = shard.freeHead;
+        shard.freeHead = record(shard, index).next.load(memory_order_relaxed);
+        return index;
+    }
+
+    size_t chunk = shard.nextIndex >> CHUNK_BITS;
+    if (chunk >= MAX_CHUNKS) return NONE;
+    if (shard.chunks[chunk].load(memory_order_relaxed) == nullptr) {
+        shard.chunks[chunk].store(new Session[size_t(1) << CHUNK_BITS], memory_order_release);
+    }
+    return shard.nextIndex++;
+}
+
+uint32_t SessionStore::find(Shard& shard, uint64_t key0, uint64_t key1) const {
+    uint32_t index = shard.buckets[bucketIndexOf(key0)].head.load(memory_order_relaxed);
+    while (index != NONE) {
+        const Session& session = record(shard, index);
+        if (session.key[0].load(memory_order_relaxed) == key0 &&
+            session.key[1].load(memory_order_relaxed) == key1) {
+            return index;
+        }
+        index = session.next.load(memory_order_relaxed);
+    }
+    return NONE;
+}
+
+void SessionStore::unlink(Shard& shard, uint32_t index) {
+    Session& session = record(shard, index);
+
+    // Bucket chain; readers inside this window retry
+    Bucket& bucket = shard.buckets[bucketIndexOf(session.key[0].load(memory_order_relaxed))];
+    uint32_t next = session.next.load(memory_order_relaxed);
+    uint32_t sequence = beginWrite(bucket.sequence);
+    uint32_t current = bucket.head.load(memory_order_relaxed);
+    if (current == index) {
+        bucket.head.store(next, memory_order_release);
+    } else {
+        while (current != NONE) {
+            Session& previous = record(shard, current);
+            if (previous.next.load(memory_order_relaxed) == index) {
+                previous.next.store(next, memory_order_release);
+                break;
+            }
+            current = previous.next.load(memory_order_relaxed);
+        }
+    }
+    endWrite(bucket.sequence, sequence);
+
+    // User list
+    long userId = session.userId.load(memory_order_relaxed);
+    if (session.userPrev != NONE) {
+        record(shard, session.userPrev).userNext = session.userNext;
+    } else if (session.userNext != NONE) {
+        shard.userHeads[userId] = session.userNext;
+    } else {
+        shard.userHeads.erase(userId);
+    }
+    if (session.userNext != NONE) {
+        record(shard, session.userNext).userPrev = session.userPrev;
+    }
+
+    unschedule(shard, index);
+
+    session.key[0].store(0, memory_order_relaxed);
+    session.key[1].store(0, memory_order_relaxed);
+    session.userId.store(0, memory_order_relaxed);
+    session.next.store(shard.freeHead, memory_order_relaxed);
+    shard.freeHead = index;
+    shard.sessionCount--;
+}
+
+// ---------------------------------------------------------------------------
+// Timing wheel (shard lock held)
+// ---------------------------------------------------------------------------
+
+void SessionStore::schedule(Shard& shard, uint32_t index, int64_t expiresAt) {
+    // Level L holds sessions due 64^L to 64^(L+1) seconds from wheelTime,
+    // in the slot of their expiry's L-th 6-bit digit
+    int64_t due = expiresAt < shard.wheelTime ? shard.wheelTime : expiresAt;
+    int64_t delta = due - shard.wheelTime;
+    const int64_t span = int64_t(1) << (WHEEL_BITS * WHEEL_LEVELS);
+    if (delta >= span) {
+        due = shard.wheelTime + span - 1;   // Rescheduled when its slot comes up
+        delta = span - 1;
+    }
+
+    size_t level = 0;
+    while (level + 1 < WHEEL_LEVELS && delta >= (int64_t(1) << (WHEEL_BITS * (level + 1)))) {
+        level++;
+    }
+    size_t slot = level * WHEEL_SIZE +
+                  static_cast<size_t>((due >> (WHEEL_BITS * level)) & (WHEEL_SIZE - 1));
+
+    Session& session = record(shard, index);
+    session.wheelSlot = static_cast<uint32_t>(slot);
+    session.wheelPrev = NONE;
+    session.wheelNext = shard.wheel[slot];
+    if (session.wheelNext != NONE) {
+        record(shard, session.wheelNext).wheelPrev = index;
+    }
+    shard.wheel[slot] = index;
+    shard.wheelCounts[level]++;
+}
+
+void SessionStore::unschedule(Shard& shard, uint32_t index) {
+    Session& session = record(shard, index);
+    if (session.wheelPrev != NONE) {
+        record(shard, session.wheelPrev).wheelNext = session.wheelNext;
+    } else {
+        shard.wheel[session.wheelSlot] = session.wheelNext;
+    }
+    if (session.wheelNext != NONE) {
+        record(shard, session.wheelNext).wheelPrev = session.wheelPrev;
+    }
+    session.wheelPrev = session.wheelNext = NONE;
+    shard.wheelCounts[session.wheelSlot / WHEEL_SIZE]--;
+}
+
+void SessionStore::cascade(Shard& shard, size_t level, size_t slot) {
+    uint32_t index = shard.wheel[level * WHEEL_SIZE + slot];
+    shard.wheel[level * WHEEL_SIZE + slot] = NONE;
+    while (index != NONE) {
+        Session& session = record(shard, index);
+        uint32_t next = session.wheelNext;
+        shard.wheelCounts[level]--;
+        schedule(shard, index, session.expiresAt.load(memory_order_relaxed));
+        index = next;
+    }
+}
+
+void SessionStore::advance(Shard& shard, time_t now) {
+    if (shard.sessionCount == 0) {
+        shard.wheelTime = static_cast<int64_t>(now) + 1;
+        return;
+    }
+
+    while (shard.wheelTime <= static_cast<int64_t>(now)) {
+        size_t index = static_cast<size_t>(shard.wheelTime & (WHEEL_SIZE - 1));
+        if (index == 0) {
+            // Move the next stretch of each coarser level down
+            for (size_t level = 1; level < WHEEL_LEVELS; level++) {
+                size_t slot = static_cast<size_t>(
+                    (shard.wheelTime >> (WHEEL_BITS * level)) & (WHEEL_SIZE - 1));
+                cascade(shard, level, slot);
+                if (slot != 0) break;
+            }
+        } else if (shard.wheelCounts[0] == 0) {
+            // Nothing due before the next cascade
+            int64_t nextCascade = (shard.wheelTime | (WHEEL_SIZE - 1)) + 1;
+            shard.wheelTime = min(nextCascade, static_cast<int64_t>(now) + 1);
+            continue;
+        }
+
+        uint32_t due = shard.wheel[index];
+        while (due != NONE) {
+            Session& session = record(shard, due);
+            uint32_t next = session.wheelNext;
+            if (session.expiresAt.load(memory_order_relaxed) <= shard.wheelTime) {
+                unlink(shard, due);
+            } else {
+                unschedule(shard, due);   // Clamped beyond the wheel's span
+                schedule(shard, due, session.expiresAt.load(memory_order_relaxed));
+            }
+            due = next;
+        }
+        shard.wheelTime++;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Sessions
+// ---------------------------------------------------------------------------
+
+bool SessionStore::create(long userId, int ttlSeconds, time_t now, string& token) {
+    size_t shardIndex = shardIndexOf(userId);
+    Shard& shard = shards[shardIndex];
+    lock_guard<mutex> lock(shard.lock);
+    advance(shard, now);
+
+    uint64_t key[2];
+    do {
+        if (!randomBytes(key, sizeof(key))) return false;
+        key[1] = (key[1] & ~static_cast<uint64_t>(shardMask)) | shardIndex;
+    } while (find(shard, key[0], key[1]) != NONE);
+
+    uint32_t index = allocate(shard);
+    if (index == NONE) return false;
+
+    Session& session = record(shard, index);
+    int64_t expiresAt = static_cast<int64_t>(now) + ttlSeconds;
+    session.key[0].store(key[0], memory_order_relaxed);
+    session.key[1].store(key[1], memory_order_relaxed);
+    session.userId.store(userId, memory_order_relaxed);
+    session.expiresAt.store(expiresAt, memory_order_relaxed);
+
+    Bucket& bucket = shard.buckets[bucketIndexOf(key[0])];
+    session.next.store(bucket.head.load(memory_order_relaxed), memory_order_relaxed);
+    uint32_t sequence = beginWrite(bucket.sequence);
+    bucket.head.store(index, memory_order_release);
+    endWrite(bucket.sequence, sequence);
+
+    auto head = shard.userHeads.try_emplace(userId, uint32_t(NONE)).first;
+    session.userPrev = NONE;
+    session.userNext = head->second;
+    if (head->second != NONE) {
+        record(shard, head->second).userPrev = index;
+    }
+    head->second = index;
+
+    shard.sessionCount++;
+    schedule(shard, index, expiresAt);
+    token = formatToken(key[0], key[1]);
+    return true;
+}
+
+bool SessionStore::lookup(const string& token, time_t now, long& userId) const {
+    uint64_t key0;
+    uint64_t key1;
+    if (!parseToken(token, key0, key1)) return false;
+
+    const Shard& shard = shards[key1 & shardMask];
+    const Bucket& bucket = shard.buckets[bucketIndexOf(key0)];
+    const size_t chunkMask = (size_t(1) << CHUNK_BITS) - 1;
+
+    while (true) {
+        uint32_t sequence = bucket.sequence.load(memory_order_acquire);
+        if (sequence & 1) continue;     // A writer is changing the chain
+
+        bool found = false;
+        bool torn = false;
+        long user = 0;
+        int64_t expiresAt = 0;
+        size_t steps = 0;
+        uint32_t index = bucket.head.load(memory_order_acquire);
+        while (index != NONE) {
+            // Records are never freed, so a stale index is still readable
+            const Session* chunk = shard.chunks[index >> CHUNK_BITS].load(memory_order_acquire);
+            if (chunk == nullptr) {
+                torn = true;
+                break;
+            }
+            const Session& session = chunk[index & chunkMask];
+            if (session.key[0].load(memory_order_relaxed) == key0 &&
+                session.key[1].load(memory_order_relaxed) == key1) {
+                found = true;
+                user = session.userId.load(memory_order_relaxed);
+                expiresAt = session.expiresAt.load(memory_order_relaxed);
+                break;
+            }
+            index = session.next.load(memory_order_acquire);
+
+            // A chain changed under us can loop; stop walking it
+            if (++steps % 64 == 0 && bucket.sequence.load(memory_order_acquire) != sequence) {
+                torn = true;
+                break;
+            }
+        }
+
+        atomic_thread_fence(memory_order_acquire);
+        if (torn || bucket.sequence.load(memory_order_relaxed) != sequence) continue;
+
+        if (!found || static_cast<int64_t>(now) >= expiresAt) return false;
+        userId = user;
+        return true;
+    }
+}
+
+bool SessionStore::remove(const string& token) {
+    uint64_t key0;
+    uint64_t key1;
+    if (!parseToken(token, key0, key1)) return false;
+
+    Shard& shard = shards[key1 & shardMask];
+    lock_guard<mutex> lock(shard.lock);
+    uint32_t index = find(shard, key0, key1);
+    if (index == NONE) return false;
+    unlink(shard, index);
+    return true;
+}
+
+size_t SessionStore::removeUser(long userId) {
+    Shard& shard = shards[shardIndexOf(userId)];
+    lock_guard<mutex> lock(shard.lock);
+
+    auto head = shard.userHeads.find(userId);
+    if (head == shard.userHeads.end()) return 0;
+
+    size_t removed = 0;
+    uint32_t index = head->second;
+    while (index != NONE) {
+        uint32_t next = record(shard, index).userNext;
+        unlink(shard, index);
+        removed++;
+        index = next;
+    }
+    return removed;
+}
+
+void SessionStore::evictExpired(time_t now) {
+    for (size_t i = 0; i <= shardMask; i++) {
+        lock_guard<mutex> lock(shards[i].lock);
+        advance(shards[i], now);
+    }
+}
+
+size_t SessionStore::getSessionCount() const {
+    size_t total = 0;
+    for (size_t i = 0; i <= shardMask; i++) {
+        lock_guard<mutex> lock(shards[i].lock);
+        total += shards[i].sessionCount;
+    }
+    return total;
+}
+
+} // namespace Utils
+} // namespace SOBS
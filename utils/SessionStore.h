@@ -0,0 +1,164 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Utils: SessionStore.h
+ *
+ * In-process store of login sessions: token -> user ID with an expiry.
+ *
+ * Tokens are 32 hex digits (128 random bits from getrandom()); the low
+ * bits of the token select its shard, and every session of a user is
+ * created in the user's shard. Each shard is a chained hash table whose
+ * session records come from a pool that only grows, so a record's memory
+ * stays valid for the store's lifetime.
+ *
+ * lookup() takes no lock: each bucket has a sequence counter that
+ * writers make odd while they change the bucket's chain, and a reader
+ * walks the chain between two reads of the counter, retrying if it
+ * moved. Writers (create, remove, expiry) hold the shard's mutex.
+ *
+ * Expiry: lookup() refuses a session at its expiry time. Records are
+ * evicted by a hierarchical timing wheel per shard (WHEEL_LEVELS wheels
+ * of 64 one-second, 64-second, ... slots) that is advanced whenever the
+ * shard is written to, so eviction costs O(1) per session.
+ *
+ * Each shard also links a user's sessions together, so removeUser()
+ * costs O(sessions of that user).
+ */
+
+#ifndef SESSIONSTORE_H
+#define SESSIONSTORE_H
+
+#include <string>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <ctime>
+
+using namespace std;
+
+namespace SOBS {
+namespace Utils {
+
+class SessionStore {
+private:
+    static const size_t CHUNK_BITS = 10;        // Records per pool chunk: 1024
+    static const size_t MAX_CHUNKS = 1024;      // Up to ~1M sessions per shard
+    static const size_t WHEEL_BITS = 6;
+    static const size_t WHEEL_SIZE = size_t(1) << WHEEL_BITS;
+    static const size_t WHEEL_LEVELS = 4;       // 64^4 s: about 194 days
+    static const uint32_t NONE = 0;             // Record index 0 is never used
+
+    struct Session {
+        // Read by lookup() without the shard lock
+        atomic<uint64_t> key[2];
+        atomic<long> userId;
+        atomic<int64_t> expiresAt;
+        atomic<uint32_t> next;                  // Bucket chain, or free list
+
+        // Shard lock only
+        uint32_t userPrev;
+        uint32_t userNext;
+        uint32_t wheelPrev;
+        uint32_t wheelNext;
+        uint32_t wheelSlot;                     // level * WHEEL_SIZE + slot
+
+        Session();
+    };
+
+    struct Bucket {
+        atomic<uint32_t> sequence;              // Odd while the chain changes
+        atomic<uint32_t> head;
+    };
+
+    struct alignas(64) Shard {
+        mutable mutex lock;                     // Writers only
+        unique_ptr<Bucket[]> buckets;
+        atomic<Session*> chunks[MAX_CHUNKS];    // Allocated on demand, never freed
+
+        uint32_t nextIndex;                     // Records handed out so far + 1
+        uint32_t freeHead;
+        size_t sessionCount;
+        unordered_map<long, uint32_t> userHeads;
+        uint32_t wheel[WHEEL_LEVELS * WHEEL_SIZE];
+        size_t wheelCounts[WHEEL_LEVELS];       // Sessions per level
+        int64_t wheelTime;                      // Next second to expire
+
+        Shard();
+        ~Shard();
+    };
+
+    size_t shardMask;
+    size_t bucketMask;
+    uint64_t hashSeed;
+    unique_ptr<Shard[]> shards;
+
+    size_t shardIndexOf(long userId) const;
+    size_t bucketIndexOf(uint64_t key0) const;
+    static Session& record(const Shard& shard, uint32_t index);
+
+    // Writer helpers; the caller holds shard.lock
+    uint32_t allocate(Shard& shard);
+    uint32_t find(Shard& shard, uint64_t key0, uint64_t key1) const;
+    void unlink(Shard& shard, uint32_t index);
+    void schedule(Shard& shard, uint32_t index, int64_t expiresAt);
+    void unschedule(Shard& shard, uint32_t index);
+    void cascade(Shard& shard, size_t level, size_t slot);
+    void advance(Shard& shard, time_t now);
+
+    static bool parseToken(const string& token, uint64_t& key0, uint64_t& key1);
+    static string formatToken(uint64_t key0, uint64_t key1);
+
+public:
+    static const size_t DEFAULT_SHARD_COUNT = 64;
+    static const size_t DEFAULT_BUCKETS_PER_SHARD = 4096;
+    static const size_t TOKEN_LENGTH = 32;
+
+    /**
+     * Both counts are rounded up to powers of two. Buckets do not grow;
+     * chains lengthen past shardCount * bucketsPerShard sessions.
+     */
+    explicit SessionStore(size_t shardCount = DEFAULT_SHARD_COUNT,
+                          size_t bucketsPerShard = DEFAULT_BUCKETS_PER_SHARD);
+    ~SessionStore();
+
+    SessionStore(const SessionStore&) = delete;
+    SessionStore& operator=(const SessionStore&) = delete;
+
+    /**
+     * Start a session for 'userId' valid for 'ttlSeconds' from 'now'.
+     * Returns false if no random token could be drawn or the shard's
+     * pool is full.
+     */
+    bool create(long userId, int ttlSeconds, time_t now, string& token);
+
+    /**
+     * User of a live session; false if the token is unknown or expired.
+     * Lock-free.
+     */
+    bool lookup(const string& token, time_t now, long& userId) const;
+
+    /**
+     * End one session; false if the token is unknown
+     */
+    bool remove(const string& token);
+
+    /**
+     * End every session of a user; returns how many were ended
+     */
+    size_t removeUser(long userId);
+
+    /**
+     * Evict expired sessions from every shard (writers already do this
+     * for the shard they touch)
+     */
+    void evictExpired(time_t now);
+
+    size_t getSessionCount() const;
+};
+
+} // namespace Utils
+} // namespace SOBS
+
+#endif // SESSIONSTORE_H
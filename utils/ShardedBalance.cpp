@@ -0,0 +1,127 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Utils: ShardedBalance.cpp
+ *
+ * Implementation of the sharded account balance
+ */
+
+#include "ShardedBalance.h"
+
+using namespace std;
+
+namespace SOBS {
+namespace Utils {
+
+namespace {
+
+// Threads are numbered once, in order of first use, and spread
+// round-robin over the sub-balances
+atomic<size_t> nextThreadIndex(0);
+thread_local size_t threadIndex = nextThreadIndex.fetch_add(1, memory_order_relaxed);
+
+} // namespace
+
+ShardedBalance::ShardedBalance(size_t subBalanceCount, const Model::Money& initial)
+    : count(subBalanceCount == 0 ? 1 :
+            subBalanceCount > MAX_SUB_BALANCES ? MAX_SUB_BALANCES : subBalanceCount),
+      subBalances(new SubBalance[count]),
+      currency(initial.getCurrency()),
+      zero(0, currency.c_str()) {
+    for (size_t i = 0; i < count; i++) {
+        subBalances[i].units.store(0, memory_order_relaxed);
+    }
+    subBalances[0].units.store(initial.getMinorUnits(), memory_order_relaxed);
+}
+
+size_t ShardedBalance::getSubBalanceCount() const {
+    return count;
+}
+
+size_t ShardedBalance::slotOfCurrentThread() const {
+    return threadIndex % count;
+}
+
+bool ShardedBalance::addTo(size_t index, int64_t units) {
+    atomic<int64_t>& target = subBalances[index].units;
+    int64_t current = target.load(memory_order_relaxed);
+    int64_t updated;
+    do {
+        if (__builtin_add_overflow(current, units, &updated)) return false;
+    } while (!target.compare_exchange_weak(current, updated, memory_order_acq_rel,
+                                           memory_order_relaxed));
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Credits and debits
+// ---------------------------------------------------------------------------
+
+bool ShardedBalance::credit(const Model::Money& amount) {
+    if (amount.isNegative() || !amount.sameCurrency(zero)) return false;
+    return addTo(slotOfCurrentThread(), amount.getMinorUnits());
+}
+
+bool ShardedBalance::debit(const Model::Money& amount) {
+    if (amount.isNegative() || !amount.sameCurrency(zero)) return false;
+
+    int64_t taken[MAX_SUB_BALANCES] = {};
+    int64_t remaining = amount.getMinorUnits();
+    size_t start = slotOfCurrentThread();
+
+    for (size_t step = 0; step < count && remaining > 0; step++) {
+        size_t index = (start + step) % count;
+        atomic<int64_t>& source = subBalances[index].units;
+        int64_t current = source.load(memory_order_relaxed);
+        int64_t take;
+        do {
+            take = current < remaining ? current : remaining;
+            if (take <= 0) break;
+        } while (!source.compare_exchange_weak(current, current - take,
+                                               memory_order_acq_rel,
+                                               memory_order_relaxed));
+        if (take > 0) {
+            taken[index] = take;
+            remaining -= take;
+        }
+    }
+
+    if (remaining > 0) {
+        // Not enough in total: give back what was borrowed
+        for (size_t i = 0; i < count; i++) {
+            if (taken[i] > 0) subBalances[i].units.fetch_add(taken[i], memory_order_acq_rel);
+        }
+        return false;
+    }
+    return true;
+}
+
+void ShardedBalance::revertCredit(const Model::Money& amount) {
+    subBalances[slotOfCurrentThread()].units.fetch_sub(amount.getMinorUnits(),
+                                                       memory_order_acq_rel);
+}
+
+void ShardedBalance::revertDebit(const Model::Money& amount) {
+    subBalances[slotOfCurrentThread()].units.fetch_add(amount.getMinorUnits(),
+                                                       memory_order_acq_rel);
+}
+
+// ---------------------------------------------------------------------------
+// Reads
+// ---------------------------------------------------------------------------
+
+Model::Money ShardedBalance::total() const {
+    int64_t sum = 0;
+    for (size_t i = 0; i < count; i++) {
+        sum += subBalances[i].units.load(memory_order_acquire);
+    }
+    return Model::Money(sum, currency.c_str());
+}
+
+Model::Money ShardedBalance::getSubBalance(size_t index) const {
+    if (index >= count) return Model::Money(0, currency.c_str());
+    return Model::Money(subBalances[index].units.load(memory_order_acquire),
+                        currency.c_str());
+}
+
+} // namespace Utils
+} // namespace SOBS
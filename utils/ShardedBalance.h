@@ -0,0 +1,98 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Utils: ShardedBalance.h
+ *
+ * One account balance split into N sub-balances for high-fan-in accounts
+ * (merchant and salary-disbursement accounts).
+ *
+ * - Each sub-balance is an atomic on its own cache line. A thread always
+ *   credits "its" sub-balance, so concurrent credits do not contend.
+ * - total() sums the sub-balances.
+ * - debit() takes from the thread's own sub-balance first and borrows
+ *   the rest from the others; if the total is short nothing is taken.
+ *   Debits must be serialized by the caller (LedgerEngine holds the
+ *   account lock); credits need no lock.
+ */
+
+#ifndef SHARDEDBALANCE_H
+#define SHARDEDBALANCE_H
+
+#include <string>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include "../model/Money.h"
+
+using namespace std;
+
+namespace SOBS {
+namespace Utils {
+
+class ShardedBalance {
+private:
+    struct alignas(64) SubBalance {
+        atomic<int64_t> units;
+    };
+
+    size_t count;
+    unique_ptr<SubBalance[]> subBalances;
+    string currency;
+    Model::Money zero;          // Zero in 'currency', for currency checks
+
+    bool addTo(size_t index, int64_t units);
+
+public:
+    static const size_t MAX_SUB_BALANCES = 64;
+
+    /**
+     * 'subBalanceCount' is clamped to 1..MAX_SUB_BALANCES;
+     * 'initial' goes into the first sub-balance
+     */
+    ShardedBalance(size_t subBalanceCount, const Model::Money& initial);
+
+    ShardedBalance(const ShardedBalance&) = delete;
+    ShardedBalance& operator=(const ShardedBalance&) = delete;
+
+    size_t getSubBalanceCount() const;
+
+    /**
+     * Sub-balance the calling thread credits
+     */
+    size_t slotOfCurrentThread() const;
+
+    /**
+     * Add a non-negative amount to the calling thread's sub-balance.
+     * Returns false on overflow or currency mismatch.
+     */
+    bool credit(const Model::Money& amount);
+
+    /**
+     * Take a non-negative amount, borrowing across sub-balances.
+     * Returns false (and takes nothing) if the total is insufficient.
+     */
+    bool debit(const Model::Money& amount);
+
+    /**
+     * Undo a credit unconditionally (the sub-balance may go negative)
+     */
+    void revertCredit(const Model::Money& amount);
+
+    /**
+     * Undo a debit unconditionally: the amount returns to the calling
+     * thread's sub-balance, bringing the total back to its earlier value
+     */
+    void revertDebit(const Model::Money& amount);
+
+    /**
+     * Sum of all sub-balances
+     */
+    Model::Money total() const;
+
+    Model::Money getSubBalance(size_t index) const;
+};
+
+} // namespace Utils
+} // namespace SOBS
+
+#endif // SHARDEDBALANCE_H
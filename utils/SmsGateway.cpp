@@ -0,0 +1,40 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Utils: SmsGateway.cpp
+ *
+ * Implementation of the console SMS stand-in
+ */
+
+#include "SmsGateway.h"
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+namespace SOBS {
+namespace Utils {
+
+namespace {
+
+bool showCodes() {
+    static const bool enabled = [] {
+        const char* value = getenv("SOBS_SMS_CONSOLE");
+        return value != nullptr && strcmp(value, "1") == 0;
+    }();
+    return enabled;
+}
+
+} // namespace
+
+bool SmsGateway::sendCode(const string& phoneNumber, const string& purpose,
+                          const string& code) {
+    // In real implementation, would call the SMS gateway API
+    string line = "[SMS] " + phoneNumber + ": Your SOBS " + purpose + " code is " +
+                  (showCodes() ? code : string(code.size(), '*')) + "\n";
+    cerr << line << flush;      // One write, so concurrent lines do not interleave
+    return true;
+}
+
+} // namespace Utils
+} // namespace SOBS
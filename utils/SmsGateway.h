@@ -0,0 +1,32 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Utils: SmsGateway.h
+ *
+ * Stand-in for the SMS provider. Messages are written to stderr, never
+ * stdout, which carries batch-mode responses. The code itself is masked
+ * unless SOBS_SMS_CONSOLE=1 is set, for local runs without a gateway.
+ */
+
+#ifndef SMSGATEWAY_H
+#define SMSGATEWAY_H
+
+#include <string>
+
+using namespace std;
+
+namespace SOBS {
+namespace Utils {
+
+class SmsGateway {
+public:
+    /**
+     * Send a one-time code; 'purpose' names it ("verification", "transfer")
+     */
+    static bool sendCode(const string& phoneNumber, const string& purpose,
+                         const string& code);
+};
+
+} // namespace Utils
+} // namespace SOBS
+
+#endif // SMSGATEWAY_H
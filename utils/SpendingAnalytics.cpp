@@ -0,0 +1,143 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Utils: SpendingAnalytics.cpp
+ *
+ * Implementation of the spending insights
+ */
+
+#include "SpendingAnalytics.h"
+#include "Clock.h"
+#include <cmath>
+
+using namespace std;
+
+namespace SOBS {
+namespace Utils {
+
+namespace {
+
+const char* const DAY_NAMES[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+const char* const MONTH_NAMES[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                   "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+
+// Local midnight 'days' after the day containing 't'
+time_t dayStart(time_t t, int days) {
+    struct tm local;
+    localtime_r(&t, &local);
+    local.tm_hour = local.tm_min = local.tm_sec = 0;
+    local.tm_mday += days;          // mktime() normalizes the overflow
+    local.tm_isdst = -1;
+    return mktime(&local);
+}
+
+// Local midnight on the 1st, 'months' after the month containing 't'
+time_t monthStart(time_t t, int months) {
+    struct tm local;
+    localtime_r(&t, &local);
+    local.tm_hour = local.tm_min = local.tm_sec = 0;
+    local.tm_mday = 1;
+    local.tm_mon += months;
+    local.tm_isdst = -1;
+    return mktime(&local);
+}
+
+} // namespace
+
+SpendingAnalytics::SpendingAnalytics(const PostingJournal& journal) : journal(journal) {}
+
+bool SpendingAnalytics::parsePeriod(const string& text, AnalyticsPeriod& period) {
+    if (text == "week") {
+        period = AnalyticsPeriod::WEEK;
+    } else if (text == "month") {
+        period = AnalyticsPeriod::MONTH;
+    } else if (text == "year") {
+        period = AnalyticsPeriod::YEAR;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Report
+// ---------------------------------------------------------------------------
+
+bool SpendingAnalytics::report(long accountId, AnalyticsPeriod period, time_t now,
+                               SpendingReport& out) const {
+    // Period bounds, the previous period's start and the bucket starts
+    time_t previousFrom;
+    out.period = period;
+    out.buckets.clear();
+    if (period == AnalyticsPeriod::WEEK) {
+        out.from = dayStart(now, -6);
+        out.to = dayStart(now, 1);
+        previousFrom = dayStart(now, -13);
+        for (int day = 0; day < 7; day++) {
+            time_t start = dayStart(out.from, day);
+            struct tm local;
+            localtime_r(&start, &local);
+            out.buckets.push_back(SpendingBucket{DAY_NAMES[local.tm_wday], start,
+                                                 Model::Money(), Model::Money()});
+        }
+    } else if (period == AnalyticsPeriod::MONTH) {
+        out.from = monthStart(now, 0);
+        out.to = monthStart(now, 1);
+        previousFrom = monthStart(now, -1);
+        for (int week = 0; week < 5; week++) {
+            time_t start = dayStart(out.from, 7 * week);
+            if (start >= out.to) break;
+            out.buckets.push_back(SpendingBucket{"Week " + to_string(week + 1), start,
+                                                 Model::Money(), Model::Money()});
+        }
+    } else {
+        struct tm local;
+        localtime_r(&now, &local);
+        out.from = monthStart(now, -local.tm_mon);
+        out.to = monthStart(out.from, 12);
+        previousFrom = monthStart(out.from, -12);
+        for (int month = 0; month < 12; month++) {
+            out.buckets.push_back(SpendingBucket{MONTH_NAMES[month], monthStart(out.from, month),
+                                                 Model::Money(), Model::Money()});
+        }
+    }
+
+    // One rollup lookup per bucket, plus the previous period's span
+    int64_t fromDay = Clock::localDay(out.from);
+    int64_t today = Clock::localDay(now);
+    int64_t days = today - fromDay + 1;     // Days elapsed so far, today included
+    if (days < 1) days = 1;
+    int64_t previousFromDay = Clock::localDay(previousFrom);
+    int64_t previousEndDay = previousFromDay + days < fromDay ? previousFromDay + days : fromDay;
+
+    SpendingRollups::Totals totals;
+    int64_t previousSpent = 0;
+    bool found = journal.readRollups(accountId, [&](const SpendingRollups& rollups) {
+        for (size_t b = 0; b < out.buckets.size(); b++) {
+            time_t end = b + 1 < out.buckets.size() ? out.buckets[b + 1].start : out.to;
+            SpendingRollups::Totals bucket = period == AnalyticsPeriod::YEAR ?
+                rollups.sumMonths(Clock::localMonth(out.buckets[b].start), Clock::localMonth(end)) :
+                rollups.sumDays(Clock::localDay(out.buckets[b].start), Clock::localDay(end));
+            out.buckets[b].spent = Model::Money::fromMinorUnits(bucket.totalSpent());
+            out.buckets[b].income = Model::Money::fromMinorUnits(bucket.totalIncome());
+            totals.add(bucket);
+        }
+        previousSpent = rollups.sumDays(previousFromDay, previousEndDay).totalSpent();
+    });
+
+    int64_t spent = totals.totalSpent();
+    for (size_t c = 0; c < SpendingReport::CATEGORY_COUNT; c++) {
+        out.spentByCategory[c] = Model::Money::fromMinorUnits(totals.spent[c]);
+    }
+    out.totalSpent = Model::Money::fromMinorUnits(spent);
+    out.totalIncome = Model::Money::fromMinorUnits(totals.totalIncome());
+    out.avgDaily = Model::Money::fromMinorUnits(spent / days);
+
+    // Trend: the same span at the start of the previous period
+    out.trendPercent = previousSpent == 0 ? 0 :
+        static_cast<int>(llround(static_cast<double>(spent - previousSpent) * 100.0 /
+                                 static_cast<double>(previousSpent)));
+    return found;
+}
+
+} // namespace Utils
+} // namespace SOBS
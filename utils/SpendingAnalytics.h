@@ -0,0 +1,81 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Utils: SpendingAnalytics.h
+ *
+ * Spending insights for one account over a week, month or year:
+ * spending per category, spending and income per day / week / month
+ * bucket, average daily spending and the trend against the same span of
+ * the previous period.
+ *
+ * Reads the journal's per-account rollups, so a report adds up one
+ * counter per day (week and month periods) or per month (year period)
+ * and never reads a transaction.
+ */
+
+#ifndef SPENDINGANALYTICS_H
+#define SPENDINGANALYTICS_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <ctime>
+#include "PostingJournal.h"
+#include "../model/Money.h"
+#include "../model/Transaction.h"
+
+using namespace std;
+
+namespace SOBS {
+namespace Utils {
+
+enum class AnalyticsPeriod {
+    WEEK,       // Last 7 days, one bucket per day
+    MONTH,      // Current month, one bucket per week
+    YEAR        // Current year, one bucket per month
+};
+
+struct SpendingBucket {
+    string label;                       // "Mon", "Week 2", "Mar"
+    time_t start;
+    Model::Money spent;
+    Model::Money income;
+};
+
+struct SpendingReport {
+    static const size_t CATEGORY_COUNT = SpendingRollups::CATEGORY_COUNT;
+
+    AnalyticsPeriod period;
+    time_t from;                        // Period start
+    time_t to;                          // Period end (exclusive)
+    Model::Money totalSpent;
+    Model::Money totalIncome;
+    Model::Money spentByCategory[CATEGORY_COUNT];  // Indexed by TransactionCategory
+    vector<SpendingBucket> buckets;
+    Model::Money avgDaily;              // totalSpent over the days elapsed
+    int trendPercent;                   // Spending vs the previous period, same span
+};
+
+class SpendingAnalytics {
+private:
+    const PostingJournal& journal;
+
+public:
+    explicit SpendingAnalytics(const PostingJournal& journal);
+
+    /**
+     * "week", "month" or "year"
+     */
+    static bool parsePeriod(const string& text, AnalyticsPeriod& period);
+
+    /**
+     * Report for the period containing 'now'. An account with no journal
+     * yet gets an all-zero report and false is returned.
+     */
+    bool report(long accountId, AnalyticsPeriod period, time_t now,
+                SpendingReport& out) const;
+};
+
+} // namespace Utils
+} // namespace SOBS
+
+#endif // SPENDINGANALYTICS_H
@@ -0,0 +1,97 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Utils: SpendingRollups.cpp
+ *
+ * Implementation of the per-account spending rollups
+ */
+
+#include "SpendingRollups.h"
+#include "Clock.h"
+
+using namespace std;
+
+namespace SOBS {
+namespace Utils {
+
+SpendingRollups::Totals::Totals() : spent(), income() {}
+
+void SpendingRollups::Totals::add(const Totals& other) {
+    for (size_t c = 0; c < CATEGORY_COUNT; c++) {
+        spent[c] += other.spent[c];
+        income[c] += other.income[c];
+    }
+}
+
+int64_t SpendingRollups::Totals::totalSpent() const {
+    int64_t total = 0;
+    for (size_t c = 0; c < CATEGORY_COUNT; c++) total += spent[c];
+    return total;
+}
+
+int64_t SpendingRollups::Totals::totalIncome() const {
+    int64_t total = 0;
+    for (size_t c = 0; c < CATEGORY_COUNT; c++) total += income[c];
+    return total;
+}
+
+SpendingRollups::SpendingRollups()
+    : currentDay(INT64_MIN), currentDayTotals(nullptr), currentMonthTotals(nullptr) {}
+
+void SpendingRollups::selectDay(time_t postedAt) {
+    int64_t dayKey = Clock::localDay(postedAt);
+    if (dayKey != currentDay) {
+        currentDay = dayKey;
+        currentDayTotals = &days[dayKey];
+        currentMonthTotals = &months[Clock::localMonth(postedAt)];
+    }
+}
+
+void SpendingRollups::add(time_t postedAt, Model::TransactionCategory category,
+                          int64_t amountUnits) {
+    selectDay(postedAt);
+    size_t c = static_cast<size_t>(category) % CATEGORY_COUNT;
+    Totals& day = *currentDayTotals;
+    Totals& month = *currentMonthTotals;
+    if (amountUnits < 0) {
+        day.spent[c] -= amountUnits;
+        month.spent[c] -= amountUnits;
+    } else {
+        day.income[c] += amountUnits;
+        month.income[c] += amountUnits;
+    }
+}
+
+void SpendingRollups::cancel(time_t postedAt, Model::TransactionCategory category,
+                             int64_t reversalUnits) {
+    selectDay(postedAt);
+    size_t c = static_cast<size_t>(category) % CATEGORY_COUNT;
+    Totals& day = *currentDayTotals;
+    Totals& month = *currentMonthTotals;
+    if (reversalUnits > 0) {
+        day.spent[c] -= reversalUnits;
+        month.spent[c] -= reversalUnits;
+    } else {
+        day.income[c] += reversalUnits;
+        month.income[c] += reversalUnits;
+    }
+}
+
+SpendingRollups::Totals SpendingRollups::sum(const map<int64_t, Totals>& counters,
+                                             int64_t first, int64_t end) {
+    Totals totals;
+    for (auto it = counters.lower_bound(first); it != counters.end() && it->first < end; ++it) {
+        totals.add(it->second);
+    }
+    return totals;
+}
+
+SpendingRollups::Totals SpendingRollups::sumDays(int64_t firstDay, int64_t endDay) const {
+    return sum(days, firstDay, endDay);
+}
+
+SpendingRollups::Totals SpendingRollups::sumMonths(int64_t firstMonth, int64_t endMonth) const {
+    return sum(months, firstMonth, endMonth);
+}
+
+} // namespace Utils
+} // namespace SOBS
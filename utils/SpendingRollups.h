@@ -0,0 +1,87 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Utils: SpendingRollups.h
+ *
+ * Per-account spending and income counters by category, kept per local
+ * day and per local month and updated as each entry is posted. Period
+ * queries then add up one counter per day or month instead of reading
+ * transactions. Weeks are sums of at most seven days.
+ *
+ * Not synchronized: PostingJournal owns one per account and only uses
+ * it under that account's lock.
+ */
+
+#ifndef SPENDINGROLLUPS_H
+#define SPENDINGROLLUPS_H
+
+#include <map>
+#include <cstdint>
+#include <cstddef>
+#include <ctime>
+#include "../model/Transaction.h"
+
+using namespace std;
+
+namespace SOBS {
+namespace Utils {
+
+class SpendingRollups {
+public:
+    static const size_t CATEGORY_COUNT =
+        static_cast<size_t>(Model::TransactionCategory::REFUND) + 1;
+
+    /**
+     * Minor units by category (indexed by TransactionCategory)
+     */
+    struct Totals {
+        int64_t spent[CATEGORY_COUNT];      // Debits, as positive amounts
+        int64_t income[CATEGORY_COUNT];     // Credits
+
+        Totals();
+        void add(const Totals& other);
+        int64_t totalSpent() const;
+        int64_t totalIncome() const;
+    };
+
+private:
+    map<int64_t, Totals> days;              // Key: Clock::localDay()
+    map<int64_t, Totals> months;            // Key: Clock::localMonth()
+
+    // Entries arrive in time order: the current day's and month's counters
+    int64_t currentDay;
+    Totals* currentDayTotals;
+    Totals* currentMonthTotals;
+
+    static Totals sum(const map<int64_t, Totals>& counters, int64_t first, int64_t end);
+
+    // Point the current day's and month's counters at 'postedAt'
+    void selectDay(time_t postedAt);
+
+public:
+    SpendingRollups();
+
+    SpendingRollups(const SpendingRollups&) = delete;
+    SpendingRollups& operator=(const SpendingRollups&) = delete;
+
+    /**
+     * Count a posted entry; negative amounts are spending
+     */
+    void add(time_t postedAt, Model::TransactionCategory category, int64_t amountUnits);
+
+    /**
+     * Take back an entry counted by add(), given the reversing amount:
+     * a reversal of +X cancels X of spending, one of -X cancels X of income
+     */
+    void cancel(time_t postedAt, Model::TransactionCategory category, int64_t reversalUnits);
+
+    /**
+     * Totals over local days [firstDay, endDay) / months [firstMonth, endMonth)
+     */
+    Totals sumDays(int64_t firstDay, int64_t endDay) const;
+    Totals sumMonths(int64_t firstMonth, int64_t endMonth) const;
+};
+
+} // namespace Utils
+} // namespace SOBS
+
+#endif // SPENDINGROLLUPS_H
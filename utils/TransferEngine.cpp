@@ -0,0 +1,316 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Utils: TransferEngine.cpp
+ *
+ * Implementation of the transfer engine
+ */
+
+#include "TransferEngine.h"
+#include "Clock.h"
+#include <sstream>
+
+using namespace std;
+
+namespace SOBS {
+namespace Utils {
+
+const char* const TransferEngine::SETTLEMENT_ACCOUNT_NUMBER = "00000000000000";
+
+TransferEngine::TransferEngine(LedgerEngine& ledger, WriteAheadLog& wal,
+                               PostingJournal& journal, DashboardSummaries& summaries)
+    : ledger(ledger), wal(wal), journal(journal), summaries(summaries),
+      completedCount(0), rejectedCount(0) {}
+
+void TransferEngine::openSettlementAccount() {
+    call_once(settlementOpened, [this]() {
+        Model::Account settlement(0, Model::AccountType::CHECKING);
+        settlement.setAccountNumber(SETTLEMENT_ACCOUNT_NUMBER);
+        ledger.openAccount(settlement);
+    });
+}
+
+// ---------------------------------------------------------------------------
+// Execution
+// ---------------------------------------------------------------------------
+
+bool TransferEngine::journalTransfer(const Model::Account& sender,
+                                     const Model::Account& recipient,
+                                     const Model::Money& amount,
+                                     Model::TransactionCategory category,
+                                     const string& reference, const string& description,
+                                     time_t postedAt) {
+    // Accounts join the journal at their balance before this transfer.
+    // Both are locked here except a sharded recipient, whose total other
+    // threads may be crediting; shardBalance() opens those beforehand.
+    if (!journal.hasAccount(sender.getAccountId())) {
+        Model::Money opening = sender.getBalance();
+        opening.add(amount);
+        journal.openAccount(sender.getAccountId(), opening);
+    }
+    if (!journal.hasAccount(recipient.getAccountId())) {
+        Model::Money opening = recipient.getBalance();
+        opening.subtract(amount);
+        journal.openAccount(recipient.getAccountId(), opening);
+    }
+
+    Model::Money debit = amount;
+    if (!debit.negate()) return false;
+    const JournalLeg legs[] = {
+        {sender.getAccountId(), debit},
+        {recipient.getAccountId(), amount}
+    };
+    return journal.append(legs, 2, category, reference, description, postedAt) != 0;
+}
+
+bool TransferEngine::recordApplied(const Model::Account& sender,
+                                   const Model::Account& recipient,
+                                   const Model::Money& amount,
+                                   Model::TransactionCategory category,
+                                   const string& reference, const string& description,
+                                   time_t postedAt, uint64_t* lsn) {
+    // In-memory steps first: the log only ever holds transfers that applied
+    if (!journalTransfer(sender, recipient, amount, category, reference, description,
+                         postedAt)) {
+        return false;
+    }
+
+    Model::Money debit = amount;
+    debit.negate();         // journalTransfer() refused amounts that cannot be negated
+    if (lsn != nullptr && wal.isOpen()) {
+        // One record per transfer, appended in apply order
+        string record;
+        encodeTransfer(record, postedAt, sender.getAccountNumber(), recipient.getAccountNumber(),
+                       amount, category, reference, description);
+        *lsn = wal.append(record);
+        if (*lsn == 0) {
+            // The ledger undoes both legs; cancel the journal entries to match
+            const JournalLeg reversal[] = {
+                {sender.getAccountId(), amount},
+                {recipient.getAccountId(), debit}
+            };
+            journal.append(reversal, 2, category, reference, "Reversal: " + description,
+                           postedAt, true);
+            return false;
+        }
+    }
+
+    summaries.recordPosting(sender.getUserId(), debit, category, reference, description,
+                            postedAt);
+    summaries.recordPosting(recipient.getUserId(), amount, category, reference, description,
+                            postedAt);
+    return true;
+}
+
+TransferOutcome TransferEngine::execute(const string& senderAccountNumber,
+                                        const string& recipientAccountNumber,
+                                        const Model::Money& amount,
+                                        const string& description,
+                                        const string& reference,
+                                        Model::TransactionCategory category) {
+    uint64_t lsn = 0;
+    time_t now = Clock::now();
+    TransferOutcome outcome = ledger.transfer(
+        senderAccountNumber, recipientAccountNumber, amount, description,
+        [&](const Model::Account& sender, const Model::Account& recipient) {
+            return recordApplied(sender, recipient, amount, category,
+                                 reference, description, now, &lsn);
+        }, now);
+
+    // The locks are gone and later transfers may build on this one, so a
+    // failed sync cannot be undone: report it as applied but not durable
+    if (outcome == TransferOutcome::COMPLETED && lsn != 0 && !wal.waitDurable(lsn)) {
+        outcome = TransferOutcome::NOT_DURABLE;
+    }
+
+    if (outcome == TransferOutcome::COMPLETED || outcome == TransferOutcome::NOT_DURABLE) {
+        completedCount.fetch_add(1, memory_order_relaxed);
+    } else {
+        rejectedCount.fetch_add(1, memory_order_relaxed);
+    }
+    return outcome;
+}
+
+size_t TransferEngine::executeBatch(const string& senderAccountNumber,
+                                    const vector<TransferInstruction>& instructions,
+                                    const vector<string>& references,
+                                    vector<TransferOutcome>& outcomes) {
+    uint64_t lastLsn = 0;
+    time_t now = Clock::now();
+    size_t completed = ledger.transferBatch(
+        senderAccountNumber, instructions, outcomes,
+        [&](size_t index, const Model::Account& sender, const Model::Account& recipient) {
+            const TransferInstruction& instruction = instructions[index];
+            uint64_t lsn = 0;
+            if (!recordApplied(sender, recipient, instruction.amount,
+                               Model::TransactionCategory::TRANSFER,
+                               index < references.size() ? references[index] : string(),
+                               instruction.description, now, &lsn)) {
+                return false;
+            }
+            if (lsn != 0) lastLsn = lsn;
+            return true;
+        }, now);
+    size_t applied = completed;
+
+    // One durability wait covers every record of the batch
+    if (lastLsn != 0 && !wal.waitDurable(lastLsn)) {
+        for (TransferOutcome& outcome : outcomes) {
+            if (outcome == TransferOutcome::COMPLETED) outcome = TransferOutcome::NOT_DURABLE;
+        }
+        completed = 0;
+    }
+
+    completedCount.fetch_add(applied, memory_order_relaxed);
+    rejectedCount.fetch_add(outcomes.size() - applied, memory_order_relaxed);
+    return completed;
+}
+
+bool TransferEngine::replay(const string& record) {
+    stringstream fields(record);
+    string kind, sender, recipient, amountText, reference, description;
+    long long postedAt = 0;
+    int categoryValue = -1;
+    Model::Money amount;
+    if (!(fields >> kind >> postedAt >> sender >> recipient >> amountText >> categoryValue
+                 >> reference) ||
+        kind != "T" || postedAt <= 0 || !Model::Money::parse(amountText, amount) ||
+        categoryValue < 0 || categoryValue > static_cast<int>(Model::TransactionCategory::REFUND)) {
+        return false;
+    }
+    getline(fields >> ws, description);
+    if (reference == "-") reference.clear();
+    if (recipient == SETTLEMENT_ACCOUNT_NUMBER) openSettlementAccount();
+
+    Model::TransactionCategory category = static_cast<Model::TransactionCategory>(categoryValue);
+    time_t at = static_cast<time_t>(postedAt);
+    return ledger.transfer(
+        sender, recipient, amount, description,
+        [&](const Model::Account& from, const Model::Account& to) {
+            return recordApplied(from, to, amount, category, reference, description, at, nullptr);
+        }, at) == TransferOutcome::COMPLETED;
+}
+
+void TransferEngine::encodeTransfer(string& out, time_t postedAt,
+                                    const string& senderAccountNumber,
+                                    const string& recipientAccountNumber,
+                                    const Model::Money& amount,
+                                    Model::TransactionCategory category,
+                                    const string& reference, const string& description) {
+    char amountText[Model::Money::MAX_TEXT_LENGTH];
+    size_t amountLength = amount.format(amountText);
+    out += "T ";
+    out += to_string(static_cast<long long>(postedAt));
+    out += ' ';
+    out += senderAccountNumber;
+    out += ' ';
+    out += recipientAccountNumber;
+    out += ' ';
+    out.append(amountText, amountLength);
+    out += ' ';
+    out += to_string(static_cast<int>(category));
+    out += ' ';
+    out += reference.empty() ? "-" : reference;
+    out += ' ';
+    for (char c : description) {
+        out += (c == '\n' ? ' ' : c);
+    }
+    out += '\n';
+}
+
+bool TransferEngine::shardBalance(const string& accountNumber, size_t subBalanceCount) {
+    return ledger.shardBalance(accountNumber, subBalanceCount,
+                               [this](const Model::Account& account) {
+        if (!journal.hasAccount(account.getAccountId())) {
+            journal.openAccount(account.getAccountId(), account.getBalance());
+        }
+    });
+}
+
+bool TransferEngine::execute(Model::Transfer& transfer) {
+    if (transfer.getStatus() == Model::TransferStatus::PENDING_OTP) {
+        return false;  // Need OTP verification first
+    }
+
+    TransferOutcome outcome = execute(transfer.getSenderAccountNumber(),
+                                      transfer.getRecipientAccountNumber(),
+                                      transfer.getAmount(),
+                                      transfer.getDescription(),
+                                      transfer.getTransferRef());
+    if (outcome != TransferOutcome::COMPLETED && outcome != TransferOutcome::NOT_DURABLE) {
+        transfer.setStatus(Model::TransferStatus::FAILED);
+        return false;
+    }
+    // The money moved either way; only a durable transfer counts as success
+    return transfer.complete() && outcome == TransferOutcome::COMPLETED;
+}
+
+TransferOutcome TransferEngine::payBill(const string& accountNumber,
+                                       Model::BillPayment& payment) {
+    if (!payment.validateBill()) {
+        payment.setStatus(Model::PaymentStatus::FAILED);
+        return TransferOutcome::INVALID_AMOUNT;
+    }
+
+    openSettlementAccount();
+    TransferOutcome outcome = execute(accountNumber, SETTLEMENT_ACCOUNT_NUMBER,
+                                      payment.getAmount(),
+                                      payment.getServiceProvider() + " " +
+                                          payment.getBillAccountNumber(),
+                                      payment.getBillRef(),
+                                      Model::TransactionCategory::BILL_PAYMENT);
+    payment.setStatus(outcome == TransferOutcome::COMPLETED ||
+                      outcome == TransferOutcome::NOT_DURABLE ?
+                      Model::PaymentStatus::COMPLETED : Model::PaymentStatus::FAILED);
+    return outcome;
+}
+
+// ---------------------------------------------------------------------------
+// Outcome descriptions
+// ---------------------------------------------------------------------------
+
+const char* TransferEngine::outcomeCode(TransferOutcome outcome) {
+    switch (outcome) {
+        case TransferOutcome::COMPLETED: return "OK";
+        case TransferOutcome::INVALID_AMOUNT: return "ERR_INVALID_AMOUNT";
+        case TransferOutcome::SAME_ACCOUNT: return "ERR_SAME_ACCOUNT";
+        case TransferOutcome::SENDER_NOT_FOUND: return "ERR_INVALID_SENDER_ACCOUNT";
+        case TransferOutcome::RECIPIENT_NOT_FOUND: return "ERR_INVALID_RECIPIENT_ACCOUNT";
+        case TransferOutcome::SENDER_INACTIVE: return "ERR_ACCOUNT_INACTIVE";
+        case TransferOutcome::RECIPIENT_INACTIVE: return "ERR_RECIPIENT_INACTIVE";
+        case TransferOutcome::INSUFFICIENT_FUNDS: return "ERR_INSUFFICIENT_FUNDS";
+        case TransferOutcome::DAILY_LIMIT_EXCEEDED: return "ERR_DAILY_LIMIT_EXCEEDED";
+        case TransferOutcome::BALANCE_OVERFLOW: return "ERR_BALANCE_OVERFLOW";
+        case TransferOutcome::LOG_FAILED: return "ERR_DATABASE";
+        case TransferOutcome::NOT_DURABLE: return "ERR_NOT_DURABLE";
+    }
+    return "ERR_UNKNOWN";
+}
+
+const char* TransferEngine::outcomeMessage(TransferOutcome outcome) {
+    switch (outcome) {
+        case TransferOutcome::COMPLETED: return "Transfer completed successfully";
+        case TransferOutcome::INVALID_AMOUNT: return "Transfer amount must be positive";
+        case TransferOutcome::SAME_ACCOUNT: return "Cannot transfer to the same account";
+        case TransferOutcome::SENDER_NOT_FOUND: return "Sender account not found";
+        case TransferOutcome::RECIPIENT_NOT_FOUND: return "Recipient account not found";
+        case TransferOutcome::SENDER_INACTIVE: return "Sender account is not active";
+        case TransferOutcome::RECIPIENT_INACTIVE: return "Recipient account is not active";
+        case TransferOutcome::INSUFFICIENT_FUNDS: return "Insufficient funds";
+        case TransferOutcome::DAILY_LIMIT_EXCEEDED: return "Daily transfer limit exceeded";
+        case TransferOutcome::BALANCE_OVERFLOW: return "Recipient balance would overflow";
+        case TransferOutcome::LOG_FAILED: return "Transfer could not be logged";
+        case TransferOutcome::NOT_DURABLE: return "Transfer applied but could not be made durable";
+    }
+    return "Unknown transfer outcome";
+}
+
+uint64_t TransferEngine::getCompletedCount() const {
+    return completedCount.load(memory_order_relaxed);
+}
+
+uint64_t TransferEngine::getRejectedCount() const {
+    return rejectedCount.load(memory_order_relaxed);
+}
+
+} // namespace Utils
+} // namespace SOBS
@@ -0,0 +1,162 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Utils: TransferEngine.h
+ *
+ * Executes account-to-account transfers against the embedded ledger.
+ *
+ * Both legs are applied by LedgerEngine::transfer under the two account
+ * locks, taken in account-number order, so concurrent transfers cannot
+ * deadlock and transfers on disjoint accounts run fully in parallel.
+ * While the accounts are still locked, each transfer is appended to the
+ * posting journal as a balanced DEBIT/CREDIT pair and then, when the
+ * write-ahead log is open, as one transfer record (encodeTransfer); the
+ * caller waits for durability after the locks are released. Both owners'
+ * dashboard summaries are updated once the record is logged. If the log
+ * append fails the journal entries are reversed and the ledger undoes
+ * both legs, so the log never holds a transfer that did not apply. On
+ * startup each record is replayed through the same steps (replay()), so
+ * balances, journal history and summaries all come back.
+ *
+ * Bill payments are transfers into the bank's settlement account
+ * (SETTLEMENT_ACCOUNT_NUMBER), journaled as BILL_PAYMENT.
+ */
+
+#ifndef TRANSFERENGINE_H
+#define TRANSFERENGINE_H
+
+#include <string>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+#include "LedgerEngine.h"
+#include "WriteAheadLog.h"
+#include "PostingJournal.h"
+#include "DashboardSummaries.h"
+#include "../model/Transfer.h"
+#include "../model/BillPayment.h"
+
+using namespace std;
+
+namespace SOBS {
+namespace Utils {
+
+class TransferEngine {
+private:
+    LedgerEngine& ledger;
+    WriteAheadLog& wal;
+    PostingJournal& journal;
+    DashboardSummaries& summaries;
+
+    once_flag settlementOpened;
+    atomic<uint64_t> completedCount;
+    atomic<uint64_t> rejectedCount;
+
+    void openSettlementAccount();
+
+    bool journalTransfer(const Model::Account& sender, const Model::Account& recipient,
+                         const Model::Money& amount, Model::TransactionCategory category,
+                         const string& reference, const string& description,
+                         time_t postedAt);
+
+    // Journal, log and summarize one applied transfer (both accounts
+    // locked); '*lsn' gets the log record's sequence number, if logged.
+    // A null 'lsn' (replay) skips the log.
+    bool recordApplied(const Model::Account& sender, const Model::Account& recipient,
+                       const Model::Money& amount, Model::TransactionCategory category,
+                       const string& reference, const string& description,
+                       time_t postedAt, uint64_t* lsn);
+
+public:
+    // Receives bill payments; only ever credited
+    static const char* const SETTLEMENT_ACCOUNT_NUMBER;
+
+    TransferEngine(LedgerEngine& ledger, WriteAheadLog& wal, PostingJournal& journal,
+                   DashboardSummaries& summaries);
+
+    TransferEngine(const TransferEngine&) = delete;
+    TransferEngine& operator=(const TransferEngine&) = delete;
+
+    /**
+     * Move 'amount' between two ledger accounts.
+     * Returns COMPLETED once both legs are applied and journaled (and
+     * durable, if the write-ahead log is open). NOT_DURABLE means the
+     * transfer applied (balances, journal and summaries all changed) but
+     * the log sync failed, so it may not survive a crash. Any other
+     * outcome leaves both accounts unchanged. 'reference' is stored on
+     * both journal entries.
+     */
+    TransferOutcome execute(const string& senderAccountNumber,
+                            const string& recipientAccountNumber,
+                            const Model::Money& amount, const string& description,
+                            const string& reference = string(),
+                            Model::TransactionCategory category =
+                                Model::TransactionCategory::TRANSFER);
+
+    /**
+     * Execute a batch of transfers from one sender under a single sender
+     * lock (LedgerEngine::transferBatch). Each completed line is journaled
+     * with references[i] and logged; the batch waits for durability once.
+     * If that wait fails, every applied line becomes NOT_DURABLE.
+     * Returns the number of COMPLETED lines.
+     */
+    size_t executeBatch(const string& senderAccountNumber,
+                        const vector<TransferInstruction>& instructions,
+                        const vector<string>& references,
+                        vector<TransferOutcome>& outcomes);
+
+    /**
+     * Apply one transfer record read back from the write-ahead log through
+     * the same steps as execute(), at its original time and without
+     * logging it again. False for a malformed record or a transfer that
+     * no longer applies.
+     */
+    bool replay(const string& record);
+
+    /**
+     * Log record of one applied transfer, a single line:
+     * "T <postedAt> <sender> <recipient> <amount> <category> <reference> <description>"
+     * (an empty reference is written as "-")
+     */
+    static void encodeTransfer(string& out, time_t postedAt,
+                               const string& senderAccountNumber,
+                               const string& recipientAccountNumber,
+                               const Model::Money& amount, Model::TransactionCategory category,
+                               const string& reference, const string& description);
+
+    /**
+     * Shard a high-fan-in account's balance (LedgerEngine::shardBalance).
+     * Its journal account is opened at the exact balance first, since
+     * lock-free credits leave no moment at which it could be read later.
+     */
+    bool shardBalance(const string& accountNumber, size_t subBalanceCount);
+
+    /**
+     * Execute a transfer model: COMPLETED once applied, FAILED otherwise.
+     * Returns true only for a durable transfer; one still waiting for
+     * its OTP is left untouched and returns false.
+     */
+    bool execute(Model::Transfer& transfer);
+
+    /**
+     * Pay a bill from a ledger account into the settlement account, as
+     * a BILL_PAYMENT transfer referenced by the bill. The payment becomes
+     * COMPLETED once applied (NOT_DURABLE included), FAILED otherwise;
+     * an incomplete bill is INVALID_AMOUNT and moves nothing.
+     */
+    TransferOutcome payBill(const string& accountNumber, Model::BillPayment& payment);
+
+    /**
+     * API error code ("ERR_INSUFFICIENT_FUNDS") and message for an outcome
+     */
+    static const char* outcomeCode(TransferOutcome outcome);
+    static const char* outcomeMessage(TransferOutcome outcome);
+
+    // Statistics: transfers applied (COMPLETED or NOT_DURABLE) and refused
+    uint64_t getCompletedCount() const;
+    uint64_t getRejectedCount() const;
+};
+
+} // namespace Utils
+} // namespace SOBS
+
+#endif // TRANSFERENGINE_H
@@ -0,0 +1,232 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * Utils: WriteAheadLog.cpp
+ *
+ * Implementation of the group-commit write-ahead log
+ */
+
+#include "WriteAheadLog.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+using namespace std;
+
+namespace SOBS {
+namespace Utils {
+
+namespace {
+
+uint32_t checksum(const char* data, size_t length) {
+    // FNV-1a, enough to detect torn writes at the tail of the log
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+void appendUint32(string& out, uint32_t value) {
+    char bytes[4];
+    memcpy(bytes, &value, sizeof(bytes));
+    out.append(bytes, sizeof(bytes));
+}
+
+uint32_t readUint32(const char* data) {
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+} // namespace
+
+WriteAheadLog::WriteAheadLog()
+    : fd(-1), lastLsn(0), durableLsn(0), waitingCommitters(0),
+      running(false), failed(false), flushWindow(0),
+      syncCount(0), recordCount(0) {}
+
+WriteAheadLog::~WriteAheadLog() {
+    close();
+}
+
+bool WriteAheadLog::open(const string& path, chrono::microseconds window,
+                         const function<void(const string&)>& replayRecord) {
+    lock_guard<mutex> lock(mutex_);
+    if (fd >= 0) return true;  // Already open
+
+    int file = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0600);
+    if (file < 0) return false;
+
+    // Replay every intact record; stop at the first torn one
+    string contents;
+    char buffer[65536];
+    ssize_t n;
+    while ((n = ::read(file, buffer, sizeof(buffer))) > 0) {
+        contents.append(buffer, static_cast<size_t>(n));
+    }
+
+    size_t offset = 0;
+    while (offset + 8 <= contents.size()) {
+        uint32_t length = readUint32(contents.data() + offset);
+        uint32_t sum = readUint32(contents.data() + offset + 4);
+        if (offset + 8 + length > contents.size()) break;
+
+        const char* payload = contents.data() + offset + 8;
+        if (checksum(payload, length) != sum) break;
+
+        if (replayRecord) replayRecord(string(payload, length));
+        offset += 8 + length;
+        lastLsn++;
+    }
+
+    if (offset < contents.size() && ftruncate(file, static_cast<off_t>(offset)) != 0) {
+        ::close(file);
+        return false;
+    }
+
+    this->path = path;
+    fd = file;
+    durableLsn = lastLsn;
+    recordCount = lastLsn;
+    flushWindow = window;
+    failed = false;
+    running = true;
+    flusher = thread(&WriteAheadLog::flusherLoop, this);
+    return true;
+}
+
+void WriteAheadLog::close() {
+    {
+        lock_guard<mutex> lock(mutex_);
+        if (!running) return;
+        running = false;
+    }
+    flushRequested.notify_all();
+    if (flusher.joinable()) flusher.join();
+
+    lock_guard<mutex> lock(mutex_);
+    ::close(fd);
+    fd = -1;
+    flushed.notify_all();
+}
+
+bool WriteAheadLog::isOpen() const {
+    lock_guard<mutex> lock(mutex_);
+    return fd >= 0;
+}
+
+uint64_t WriteAheadLog::append(const string& payload) {
+    lock_guard<mutex> lock(mutex_);
+    // After a failed write nothing more can become durable
+    if (!running || failed) return 0;
+
+    appendUint32(pendingBatch, static_cast<uint32_t>(payload.size()));
+    appendUint32(pendingBatch, checksum(payload.data(), payload.size()));
+    pendingBatch += payload;
+    recordCount++;
+    return ++lastLsn;
+}
+
+bool WriteAheadLog::waitDurable(uint64_t lsn) {
+    unique_lock<mutex> lock(mutex_);
+    if (durableLsn >= lsn) return true;
+    if (!running || failed) return false;
+
+    waitingCommitters++;
+    flushRequested.notify_one();
+    flushed.wait(lock, [&] { return durableLsn >= lsn || failed || !running; });
+    waitingCommitters--;
+
+    return durableLsn >= lsn;
+}
+
+void WriteAheadLog::flusherLoop() {
+    unique_lock<mutex> lock(mutex_);
+
+    while (true) {
+        flushRequested.wait(lock, [&] {
+            return !running || (waitingCommitters > 0 && !pendingBatch.empty());
+        });
+
+        // Group commit: give other committers the rest of the window
+        // to join this batch before paying for the sync
+        if (running && flushWindow.count() > 0) {
+            flushRequested.wait_for(lock, flushWindow, [&] {
+                return !running || pendingBatch.size() >= MAX_BATCH_BYTES;
+            });
+        }
+
+        if (!pendingBatch.empty()) {
+            string batch;
+            batch.swap(pendingBatch);
+            uint64_t batchLsn = lastLsn;
+
+            lock.unlock();
+            bool ok = writeBatch(batch);
+            lock.lock();
+
+            syncCount++;
+            if (ok) {
+                durableLsn = batchLsn;
+            } else {
+                // The file may end in a torn batch: never write after it.
+                // Records appended meanwhile fail their waitDurable()
+                failed = true;
+                pendingBatch.clear();
+            }
+            flushed.notify_all();
+        }
+
+        if (!running) break;
+    }
+}
+
+bool WriteAheadLog::writeBatch(const string& batch) {
+    const char* data = batch.data();
+    size_t remaining = batch.size();
+    while (remaining > 0) {
+        ssize_t written = ::write(fd, data, remaining);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        remaining -= static_cast<size_t>(written);
+    }
+    return fdatasync(fd) == 0;
+}
+
+void WriteAheadLog::setFlushWindow(chrono::microseconds window) {
+    lock_guard<mutex> lock(mutex_);
+    flushWindow = window;
+}
+
+chrono::microseconds WriteAheadLog::getFlushWindow() const {
+    lock_guard<mutex> lock(mutex_);
+    return flushWindow;
+}
+
+uint64_t WriteAheadLog::getSyncCount() const {
+    lock_guard<mutex> lock(mutex_);
+    return syncCount;
+}
+
+uint64_t WriteAheadLog::getRecordCount() const {
+    lock_guard<mutex> lock(mutex_);
+    return recordCount;
+}
+
+uint64_t WriteAheadLog::getDurableLsn() const {
+    lock_guard<mutex> lock(mutex_);
+    return durableLsn;
+}
+
+string WriteAheadLog::getPath() const {
+    lock_guard<mutex> lock(mutex_);
+    return path;
+}
+
+} // namespace Utils
+} // namespace SOBS
@@ -11,8 +11,9 @@
 
 #include <string>
 #include <ctime>
-#include <sstream>
-#include <iomanip>
+#include "JsonWriter.h"
+#include "../utils/Clock.h"
+#include "../model/Money.h"
 
 using namespace std;
 
@@ -29,11 +30,7 @@ private:
     string errorCode;
 
     string getCurrentTimestamp() const {
-        time_t now = time(nullptr);
-        char buffer[80];
-        struct tm* timeinfo = localtime(&now);
-        strftime(buffer, 80, "%Y-%m-%dT%H:%M:%S", timeinfo);
-        return string(buffer);
+        return Utils::Clock::currentTimestamp();
     }
 
 public:
@@ -78,18 +75,19 @@ public:
 
     // JSON serialization (simplified)
     string toJson() const {
-        stringstream ss;
-        ss << "{\n"
-           << "  \"success\": " << (success ? "true" : "false") << ",\n"
-           << "  \"message\": \"" << message << "\",\n"
-           << "  \"timestamp\": \"" << timestamp << "\"";
+        string& buffer = JsonWriter::threadBuffer();
+        JsonWriter writer(buffer);
+        writer.beginObject()
+              .member("success", success)
+              .member("message", message)
+              .member("timestamp", timestamp);
         
         if (!errorCode.empty()) {
-            ss << ",\n  \"errorCode\": \"" << errorCode << "\"";
+            writer.member("errorCode", errorCode);
         }
         
-        ss << "\n}";
-        return ss.str();
+        writer.endObject();
+        return buffer;
     }
 };
 
@@ -97,59 +95,74 @@ public:
 
 struct LoginResponseData {
     string sessionToken;
+    int64_t expiresIn = 0;      // Seconds the session stays valid
     string customerId;
     string fullName;
     string email;
     
+    void writeJson(JsonWriter& writer) const {
+        writer.beginObject()
+              .member("sessionToken", sessionToken)
+              .member("expiresIn", expiresIn)
+              .member("customerId", customerId)
+              .member("fullName", fullName)
+              .member("email", email)
+              .endObject();
+    }
+    
     string toJson() const {
-        stringstream ss;
-        ss << "{\n"
-           << "    \"sessionToken\": \"" << sessionToken << "\",\n"
-           << "    \"customerId\": \"" << customerId << "\",\n"
-           << "    \"fullName\": \"" << fullName << "\",\n"
-           << "    \"email\": \"" << email << "\"\n"
-           << "  }";
-        return ss.str();
+        string& buffer = JsonWriter::threadBuffer();
+        JsonWriter writer(buffer, JsonWriter::defaultStyle(), 1);
+        writeJson(writer);
+        return buffer;
     }
 };
 
 struct BalanceResponseData {
     string accountNumber;
-    double balance;
-    double availableBalance;
+    Model::Money balance;
+    Model::Money availableBalance;
     string currency;
     
+    void writeJson(JsonWriter& writer) const {
+        writer.beginObject()
+              .member("accountNumber", accountNumber)
+              .decimalMember("balance", balance.getMinorUnits(), Model::Money::DECIMALS)
+              .decimalMember("availableBalance", availableBalance.getMinorUnits(), Model::Money::DECIMALS)
+              .member("currency", currency)
+              .endObject();
+    }
+    
     string toJson() const {
-        stringstream ss;
-        ss << fixed << setprecision(2);
-        ss << "{\n"
-           << "    \"accountNumber\": \"" << accountNumber << "\",\n"
-           << "    \"balance\": " << balance << ",\n"
-           << "    \"availableBalance\": " << availableBalance << ",\n"
-           << "    \"currency\": \"" << currency << "\"\n"
-           << "  }";
-        return ss.str();
+        string& buffer = JsonWriter::threadBuffer();
+        JsonWriter writer(buffer, JsonWriter::defaultStyle(), 1);
+        writeJson(writer);
+        return buffer;
     }
 };
 
 struct TransferResponseData {
     string transferRef;
-    double amount;
+    Model::Money amount;
     string recipientName;
     string status;
     string completedAt;
     
+    void writeJson(JsonWriter& writer) const {
+        writer.beginObject()
+              .member("transferRef", transferRef)
+              .decimalMember("amount", amount.getMinorUnits(), Model::Money::DECIMALS)
+              .member("recipientName", recipientName)
+              .member("status", status)
+              .member("completedAt", completedAt)
+              .endObject();
+    }
+    
     string toJson() const {
-        stringstream ss;
-        ss << fixed << setprecision(2);
-        ss << "{\n"
-           << "    \"transferRef\": \"" << transferRef << "\",\n"
-           << "    \"amount\": " << amount << ",\n"
-           << "    \"recipientName\": \"" << recipientName << "\",\n"
-           << "    \"status\": \"" << status << "\",\n"
-           << "    \"completedAt\": \"" << completedAt << "\"\n"
-           << "  }";
-        return ss.str();
+        string& buffer = JsonWriter::threadBuffer();
+        JsonWriter writer(buffer, JsonWriter::defaultStyle(), 1);
+        writeJson(writer);
+        return buffer;
     }
 };
 
@@ -157,62 +170,99 @@ struct BillPaymentResponseData {
     string billRef;
     string billType;
     string provider;
-    double amount;
+    Model::Money amount;
     string status;
     
+    void writeJson(JsonWriter& writer) const {
+        writer.beginObject()
+              .member("billRef", billRef)
+              .member("billType", billType)
+              .member("provider", provider)
+              .decimalMember("amount", amount.getMinorUnits(), Model::Money::DECIMALS)
+              .member("status", status)
+              .endObject();
+    }
+    
     string toJson() const {
-        stringstream ss;
-        ss << fixed << setprecision(2);
-        ss << "{\n"
-           << "    \"billRef\": \"" << billRef << "\",\n"
-           << "    \"billType\": \"" << billType << "\",\n"
-           << "    \"provider\": \"" << provider << "\",\n"
-           << "    \"amount\": " << amount << ",\n"
-           << "    \"status\": \"" << status << "\"\n"
-           << "  }";
-        return ss.str();
+        string& buffer = JsonWriter::threadBuffer();
+        JsonWriter writer(buffer, JsonWriter::defaultStyle(), 1);
+        writeJson(writer);
+        return buffer;
     }
 };
 
 // Helper class for formatted JSON responses
 class JsonResponseBuilder {
+private:
+    static void writeTimestamp(JsonWriter& writer) {
+        char buffer[Utils::Clock::TIMESTAMP_LENGTH + 1];
+        size_t length = Utils::Clock::currentTimestamp(buffer);
+        writer.key("timestamp").value(buffer, length);
+    }
+
 public:
     static string buildSuccessResponse(const string& data, 
                                             const string& message = "Operation successful") {
-        stringstream ss;
-        time_t now = time(nullptr);
-        char buffer[80];
-        struct tm* timeinfo = localtime(&now);
-        strftime(buffer, 80, "%Y-%m-%dT%H:%M:%S", timeinfo);
-        
-        ss << "{\n"
-           << "  \"success\": true,\n"
-           << "  \"message\": \"" << message << "\",\n"
-           << "  \"data\": " << data << ",\n"
-           << "  \"timestamp\": \"" << buffer << "\"\n"
-           << "}";
-        return ss.str();
+        string& buffer = JsonWriter::threadBuffer();
+        appendSuccessResponse(buffer, data, message);
+        return buffer;
     }
     
     static string buildErrorResponse(const string& message,
                                           const string& errorCode = "") {
-        stringstream ss;
-        time_t now = time(nullptr);
-        char buffer[80];
-        struct tm* timeinfo = localtime(&now);
-        strftime(buffer, 80, "%Y-%m-%dT%H:%M:%S", timeinfo);
-        
-        ss << "{\n"
-           << "  \"success\": false,\n"
-           << "  \"message\": \"" << message << "\"";
+        string& buffer = JsonWriter::threadBuffer();
+        appendErrorResponse(buffer, message, errorCode);
+        return buffer;
+    }
+    
+    /**
+     * Append a success response to 'out' (e.g. a socket or stdout buffer);
+     * 'data' is already-serialized JSON and is copied once
+     */
+    static void appendSuccessResponse(string& out, const string& data,
+                                      const string& message = "Operation successful",
+                                      JsonWriter::Style style = JsonWriter::defaultStyle()) {
+        JsonWriter writer(out, style);
+        writer.beginObject()
+              .member("success", true)
+              .member("message", message)
+              .rawMember("data", data);
+        writeTimestamp(writer);
+        writer.endObject();
+    }
+    
+    /**
+     * Append a success response whose data is written in place by
+     * 'writeData(JsonWriter&)', without serializing it to a string first
+     */
+    template<typename WriteData>
+    static void writeSuccessResponse(string& out, WriteData writeData,
+                                     const string& message = "Operation successful",
+                                     JsonWriter::Style style = JsonWriter::defaultStyle()) {
+        JsonWriter writer(out, style);
+        writer.beginObject()
+              .member("success", true)
+              .member("message", message)
+              .key("data");
+        writeData(writer);
+        writeTimestamp(writer);
+        writer.endObject();
+    }
+    
+    static void appendErrorResponse(string& out, const string& message,
+                                    const string& errorCode = "",
+                                    JsonWriter::Style style = JsonWriter::defaultStyle()) {
+        JsonWriter writer(out, style);
+        writer.beginObject()
+              .member("success", false)
+              .member("message", message);
         
         if (!errorCode.empty()) {
-            ss << ",\n  \"errorCode\": \"" << errorCode << "\"";
+            writer.member("errorCode", errorCode);
         }
         
-        ss << ",\n  \"timestamp\": \"" << buffer << "\"\n"
-           << "}";
-        return ss.str();
+        writeTimestamp(writer);
+        writer.endObject();
     }
 };
 
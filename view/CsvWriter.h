@@ -0,0 +1,162 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * View: CsvWriter.h
+ *
+ * Streaming CSV (RFC 4180) writer for account statements.
+ * Part of the MVC Architecture - View Layer
+ *
+ * - Rows are formatted into a fixed CHUNK_SIZE buffer that is handed to
+ *   a sink whenever it fills, so memory use does not grow with the
+ *   number of rows.
+ * - Fields are quoted only when they contain a comma, quote or line
+ *   break. Text fields that a spreadsheet would run as a formula
+ *   (leading '=', '+', '-', '@') are prefixed with a single quote.
+ * - Amounts and timestamps are formatted without printf or streams.
+ */
+
+#ifndef CSVWRITER_H
+#define CSVWRITER_H
+
+#include <string>
+#include <functional>
+#include <cstring>
+#include <cstdint>
+#include <ctime>
+#include "../model/Money.h"
+#include "../utils/Clock.h"
+
+using namespace std;
+
+namespace SOBS {
+namespace View {
+
+class CsvWriter {
+public:
+    /**
+     * Receives each full chunk; returning false aborts the output
+     */
+    typedef function<bool(const char* data, size_t length)> Sink;
+
+    static const size_t CHUNK_SIZE = 64 * 1024;
+
+private:
+    Sink sink;
+    char buffer[CHUNK_SIZE];
+    size_t used;
+    bool rowStarted;
+    bool failed;
+    uint64_t bytesWritten;
+
+    void put(char c) {
+        if (used == CHUNK_SIZE) flush();
+        buffer[used++] = c;
+    }
+
+    void put(const char* data, size_t length) {
+        while (length > 0) {
+            if (used == CHUNK_SIZE) flush();
+            size_t n = CHUNK_SIZE - used < length ? CHUNK_SIZE - used : length;
+            memcpy(buffer + used, data, n);
+            used += n;
+            data += n;
+            length -= n;
+        }
+    }
+
+    void separator() {
+        if (rowStarted) put(',');
+        rowStarted = true;
+    }
+
+public:
+    explicit CsvWriter(const Sink& sink)
+        : sink(sink), used(0), rowStarted(false), failed(false), bytesWritten(0) {}
+
+    CsvWriter(const CsvWriter&) = delete;
+    CsvWriter& operator=(const CsvWriter&) = delete;
+
+    CsvWriter& field(const char* text, size_t length) {
+        separator();
+        bool quote = false;
+        for (size_t i = 0; i < length && !quote; i++) {
+            char c = text[i];
+            quote = c == ',' || c == '"' || c == '\n' || c == '\r';
+        }
+        if (!quote) {
+            put(text, length);
+            return *this;
+        }
+
+        put('"');
+        size_t start = 0;
+        for (size_t i = 0; i < length; i++) {
+            if (text[i] == '"') {
+                put(text + start, i + 1 - start);
+                put('"');  // Doubled
+                start = i + 1;
+            }
+        }
+        put(text + start, length - start);
+        put('"');
+        return *this;
+    }
+
+    CsvWriter& field(const char* text) { return field(text, strlen(text)); }
+    CsvWriter& field(const string& text) { return field(text.data(), text.size()); }
+
+    /**
+     * Free text from users (descriptions, names), defused for spreadsheets
+     */
+    CsvWriter& textField(const string& text) {
+        if (!text.empty() && strchr("=+-@", text[0]) != nullptr) {
+            return field("'" + text);
+        }
+        return field(text);
+    }
+
+    CsvWriter& field(const Model::Money& amount) {
+        char text[Model::Money::MAX_TEXT_LENGTH];
+        return field(text, amount.format(text));
+    }
+
+    /**
+     * Local time as "YYYY-MM-DD HH:MM:SS"
+     */
+    CsvWriter& timeField(time_t t) {
+        char text[Utils::Clock::TIMESTAMP_LENGTH + 1];
+        return field(text, Utils::Clock::formatLocal(t, text));
+    }
+
+    CsvWriter& emptyField() {
+        separator();
+        return *this;
+    }
+
+    CsvWriter& endRow() {
+        put("\r\n", 2);
+        rowStarted = false;
+        return *this;
+    }
+
+    /**
+     * Hand the buffered bytes to the sink. Returns false once the sink
+     * has refused a chunk; later output is discarded.
+     */
+    bool flush() {
+        if (used > 0 && !failed) {
+            failed = !sink(buffer, used);
+            bytesWritten += used;
+        }
+        used = 0;
+        return !failed;
+    }
+
+    bool ok() const { return !failed; }
+
+    uint64_t getBytesWritten() const { return bytesWritten + used; }
+};
+
+} // namespace View
+} // namespace SOBS
+
+#endif // CSVWRITER_H
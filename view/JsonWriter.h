@@ -0,0 +1,345 @@
+/**
+ * Smart Online Banking System (SOBS)
+ * View: JsonWriter.h
+ *
+ * Streaming JSON writer that appends straight into a caller-owned buffer
+ * (no stringstream, no intermediate strings).
+ * Part of the MVC Architecture - View Layer
+ *
+ * - Pretty style reproduces the API's existing 2-space layout;
+ *   compact style emits no whitespace.
+ * - Integers and fixed-point amounts are formatted by hand.
+ * - threadBuffer() hands out a per-thread buffer whose capacity is reused.
+ */
+
+#ifndef JSONWRITER_H
+#define JSONWRITER_H
+
+#include <string>
+#include <cstdint>
+#include <cstdio>
+#include <cmath>
+
+using namespace std;
+
+namespace SOBS {
+namespace View {
+
+class JsonWriter {
+public:
+    enum class Style {
+        PRETTY,
+        COMPACT
+    };
+
+private:
+    static const int MAX_DEPTH = 32;
+
+    string& out;
+    Style style;
+    int baseDepth;           // Indent level of the top-level value
+    int depth;
+    bool hasMembers[MAX_DEPTH];
+    bool afterKey;
+
+    void newline() {
+        out += '\n';
+        out.append(static_cast<size_t>(depth) * 2, ' ');
+    }
+
+    // Separator and indentation before a member or array element
+    void beginItem() {
+        if (afterKey) {
+            afterKey = false;
+            return;
+        }
+        if (depth == baseDepth) {
+            return;  // Top-level value: no separator
+        }
+        if (hasMembers[depth]) {
+            out += ',';
+        }
+        hasMembers[depth] = true;
+        if (style == Style::PRETTY) {
+            newline();
+        }
+    }
+
+    void open(char bracket) {
+        beginItem();
+        out += bracket;
+        if (depth < MAX_DEPTH - 1) {
+            depth++;
+        }
+        hasMembers[depth] = false;
+    }
+
+    void close(char bracket) {
+        bool members = hasMembers[depth];
+        if (depth > baseDepth) {
+            depth--;
+        }
+        if (members && style == Style::PRETTY) {
+            newline();
+        }
+        out += bracket;
+    }
+
+    void appendEscaped(const char* value, size_t length) {
+        static const char* hex = "0123456789abcdef";
+        out += '"';
+        size_t runStart = 0;
+        for (size_t i = 0; i < length; i++) {
+            unsigned char c = static_cast<unsigned char>(value[i]);
+            if (c >= 0x20 && c != '"' && c != '\\') {
+                continue;
+            }
+            out.append(value + runStart, i - runStart);
+            runStart = i + 1;
+            switch (c) {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                default:
+                    out += "\\u00";
+                    out += hex[c >> 4];
+                    out += hex[c & 0x0F];
+            }
+        }
+        out.append(value + runStart, length - runStart);
+        out += '"';
+    }
+
+public:
+    explicit JsonWriter(string& out, Style style = defaultStyle(), int indentLevel = 0)
+        : out(out), style(style), baseDepth(indentLevel), depth(indentLevel),
+          afterKey(false) {
+        for (int i = 0; i < MAX_DEPTH; i++) {
+            hasMembers[i] = false;
+        }
+    }
+
+    // Structure
+    JsonWriter& beginObject() { open('{'); return *this; }
+    JsonWriter& endObject() { close('}'); return *this; }
+    JsonWriter& beginArray() { open('['); return *this; }
+    JsonWriter& endArray() { close(']'); return *this; }
+
+    JsonWriter& key(const char* name, size_t length) {
+        beginItem();
+        appendEscaped(name, length);
+        out += style == Style::PRETTY ? ": " : ":";
+        afterKey = true;
+        return *this;
+    }
+    JsonWriter& key(const string& name) { return key(name.data(), name.size()); }
+    JsonWriter& key(const char* name) { return key(name, char_traits<char>::length(name)); }
+
+    // Values
+    JsonWriter& value(const char* text, size_t length) {
+        beginItem();
+        appendEscaped(text, length);
+        return *this;
+    }
+    JsonWriter& value(const string& text) { return value(text.data(), text.size()); }
+    JsonWriter& value(const char* text) { return value(text, char_traits<char>::length(text)); }
+
+    JsonWriter& value(bool flag) {
+        beginItem();
+        out += flag ? "true" : "false";
+        return *this;
+    }
+
+    JsonWriter& value(int64_t number) {
+        beginItem();
+        appendInteger(out, number);
+        return *this;
+    }
+    JsonWriter& value(int number) { return value(static_cast<int64_t>(number)); }
+    JsonWriter& value(long long number) { return value(static_cast<int64_t>(number)); }
+
+    /**
+     * Fixed-point number, e.g. fixed(1500.5) -> 1500.50
+     */
+    JsonWriter& fixed(double number, int decimals = 2) {
+        beginItem();
+        appendFixed(out, number, decimals);
+        return *this;
+    }
+
+    /**
+     * Exact fixed-point number from integer units,
+     * e.g. decimal(150050, 2) -> 1500.50
+     */
+    JsonWriter& decimal(int64_t units, int decimals = 2) {
+        beginItem();
+        appendDecimal(out, units, decimals);
+        return *this;
+    }
+
+    JsonWriter& null() {
+        beginItem();
+        out += "null";
+        return *this;
+    }
+
+    /**
+     * Already-serialized JSON, copied once (whitespace stripped in compact style)
+     */
+    JsonWriter& raw(const string& json) {
+        beginItem();
+        if (style == Style::PRETTY) {
+            out += json;
+        } else {
+            appendCompact(out, json);
+        }
+        return *this;
+    }
+
+    // Member shorthands
+    template<typename V>
+    JsonWriter& member(const char* name, const V& v) { key(name); return value(v); }
+    JsonWriter& fixedMember(const char* name, double number, int decimals = 2) {
+        key(name);
+        return fixed(number, decimals);
+    }
+    JsonWriter& decimalMember(const char* name, int64_t units, int decimals = 2) {
+        key(name);
+        return decimal(units, decimals);
+    }
+    JsonWriter& rawMember(const char* name, const string& json) { key(name); return raw(json); }
+
+    Style getStyle() const { return style; }
+
+    // -----------------------------------------------------------------------
+    // Formatting primitives
+    // -----------------------------------------------------------------------
+
+    static void appendInteger(string& out, int64_t number) {
+        char digits[24];
+        char* end = digits + sizeof(digits);
+        char* p = end;
+        uint64_t magnitude = number < 0 ? 0 - static_cast<uint64_t>(number) :
+                                          static_cast<uint64_t>(number);
+        do {
+            *--p = static_cast<char>('0' + magnitude % 10);
+            magnitude /= 10;
+        } while (magnitude != 0);
+        if (number < 0) {
+            *--p = '-';
+        }
+        out.append(p, static_cast<size_t>(end - p));
+    }
+
+    static void appendFixed(string& out, double number, int decimals) {
+        static const int64_t scales[] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+        if (!std::isfinite(number)) {
+            out += "null";
+            return;
+        }
+        if (decimals < 0) decimals = 0;
+        if (decimals > 6) decimals = 6;
+
+        double scale = static_cast<double>(scales[decimals]);
+        double scaled = number * scale;
+        if (std::fabs(scaled) >= 9.0e15) {
+            // Beyond exact int64 range: fall back to printf
+            char buffer[64];
+            int length = snprintf(buffer, sizeof(buffer), "%.*f", decimals, number);
+            out.append(buffer, static_cast<size_t>(length));
+            return;
+        }
+
+        appendDecimal(out, llround(scaled), decimals);
+    }
+
+    /**
+     * 'units' scaled down by 10^decimals (0-18), e.g. 150050, 2 -> 1500.50
+     */
+    static void appendDecimal(string& out, int64_t units, int decimals) {
+        if (decimals < 0) decimals = 0;
+        if (decimals > 18) decimals = 18;
+
+        char digits[48];
+        char* end = digits + sizeof(digits);
+        char* p = end;
+        uint64_t magnitude = units < 0 ? 0 - static_cast<uint64_t>(units) :
+                                         static_cast<uint64_t>(units);
+        for (int i = 0; i < decimals; i++) {
+            *--p = static_cast<char>('0' + magnitude % 10);
+            magnitude /= 10;
+        }
+        if (decimals > 0) {
+            *--p = '.';
+        }
+        do {
+            *--p = static_cast<char>('0' + magnitude % 10);
+            magnitude /= 10;
+        } while (magnitude != 0);
+        if (units < 0) {
+            *--p = '-';
+        }
+        out.append(p, static_cast<size_t>(end - p));
+    }
+
+    /**
+     * Append JSON with insignificant whitespace removed. Raw control
+     * characters inside strings are escaped, so the result is one line.
+     */
+    static void appendCompact(string& out, const string& json) {
+        static const char* hex = "0123456789abcdef";
+        bool inString = false;
+        size_t runStart = 0;
+        for (size_t i = 0; i < json.size(); i++) {
+            char c = json[i];
+            if (inString) {
+                if (c == '\\') {
+                    i++;
+                } else if (c == '"') {
+                    inString = false;
+                } else if (static_cast<unsigned char>(c) < 0x20) {
+                    out.append(json, runStart, i - runStart);
+                    runStart = i + 1;
+                    out += "\\u00";
+                    out += hex[(c >> 4) & 0x0F];
+                    out += hex[c & 0x0F];
+                }
+            } else if (c == '"') {
+                inString = true;
+            } else if (c == ' ' || c == '\n' || c == '\r' || c == '\t') {
+                out.append(json, runStart, i - runStart);
+                runStart = i + 1;
+            }
+        }
+        out.append(json, runStart, json.size() - runStart);
+    }
+
+    /**
+     * Per-thread scratch buffer, cleared but keeping its capacity
+     */
+    static string& threadBuffer() {
+        thread_local string buffer;
+        buffer.clear();
+        return buffer;
+    }
+
+    /**
+     * Style used by the response builders on this thread
+     * (batch mode switches its threads to COMPACT)
+     */
+    static Style& threadStyle() {
+        thread_local Style style = Style::PRETTY;
+        return style;
+    }
+
+    static Style defaultStyle() {
+        return threadStyle();
+    }
+};
+
+} // namespace View
+} // namespace SOBS
+
+#endif // JSONWRITER_H